@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef VELOCYPACK_BSONDUMPER_H
+#define VELOCYPACK_BSONDUMPER_H 1
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Options.h"
+#include "velocypack/Sink.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// Converts VPack into BSON (http://bsonspec.org), writing the output to a
+// Sink while the value is traversed.
+// The value must be an Object or an Array. BSON has no top-level arrays,
+// so an Array is written as a document with the keys "0", "1", ... as
+// BSON does for embedded arrays.
+// Null, Bool, Double, String, Binary (subtype 0), UTCDate, MinKey, MaxKey,
+// Array and Object are mapped to the BSON type of the same name. Integers
+// are written as int32 if they fit and as int64 otherwise. Object keys are
+// translated if an AttributeTranslator is set, and must not contain NUL
+// bytes. All other types are handled as configured in
+// Options::unsupportedTypeBehavior.
+// BSON documents start with their byte size, so the sizes of all
+// documents are computed in a first pass over the value. All errors are
+// detected in that pass, before anything is written to the Sink.
+class BsonDumper {
+ public:
+  Options const* options;
+
+  BsonDumper(BsonDumper const&) = delete;
+  BsonDumper& operator=(BsonDumper const&) = delete;
+
+  explicit BsonDumper(Sink* sink, Options const* options = &Options::Defaults)
+      : options(options), _sink(sink), _nextSize(0), _pos(0) {
+    if (VELOCYPACK_UNLIKELY(sink == nullptr)) {
+      throw Exception(Exception::InternalError, "Sink cannot be a nullptr");
+    }
+    if (VELOCYPACK_UNLIKELY(options == nullptr)) {
+      throw Exception(Exception::InternalError, "Options cannot be a nullptr");
+    }
+  }
+
+  Sink* sink() const { return _sink; }
+
+  void dump(Slice const& slice);
+
+  void dump(Slice const* slice) { dump(*slice); }
+
+  static void dump(Slice const& slice, Sink* sink,
+                   Options const* options = &Options::Defaults) {
+    BsonDumper dumper(sink, options);
+    dumper.dump(slice);
+  }
+
+  // returns the BSON for the slice as a (binary) string
+  static std::string toString(Slice const& slice,
+                              Options const* options = &Options::Defaults) {
+    std::string buffer;
+    StringSink sink(&buffer);
+    dump(slice, &sink, options);
+    return buffer;
+  }
+
+ private:
+  // size of the staging buffer
+  static constexpr std::size_t bufferSize = 4096;
+
+  inline void write(uint8_t c) {
+    if (VELOCYPACK_UNLIKELY(_pos == bufferSize)) {
+      flush();
+    }
+    _buffer[_pos++] = static_cast<char>(c);
+  }
+
+  inline void write(char const* p, std::size_t len) {
+    if (VELOCYPACK_UNLIKELY(len > bufferSize - _pos)) {
+      flush();
+      if (len >= bufferSize) {
+        _sink->append(p, static_cast<ValueLength>(len));
+        return;
+      }
+    }
+    std::memcpy(&_buffer[_pos], p, len);
+    _pos += len;
+  }
+
+  // writes the N lowest bytes of value in little-endian order
+  template <std::size_t N>
+  inline void writeLittleEndian(uint64_t value) {
+    if (VELOCYPACK_UNLIKELY(N > bufferSize - _pos)) {
+      flush();
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+      _buffer[_pos++] = static_cast<char>((value >> (8 * i)) & 0xffU);
+    }
+  }
+
+  void flush() {
+    if (_pos > 0) {
+      _sink->append(&_buffer[0], static_cast<ValueLength>(_pos));
+      _pos = 0;
+    }
+  }
+
+  // returns the BSON element type used for the slice
+  uint8_t elementType(Slice const& slice) const;
+
+  // returns the byte size of a document, and records it and the sizes of
+  // all embedded documents in _sizes, in the order they are written
+  ValueLength documentSize(Slice const& slice);
+
+  // returns the byte size of an element value of the given type
+  ValueLength valueSize(Slice const& slice, uint8_t type);
+
+  void dumpDocument(Slice const& slice);
+
+  void dumpElement(char const* key, std::size_t keyLength,
+                   Slice const& slice);
+
+  void dumpString(char const*, ValueLength);
+
+  // the string an unsupported type is converted into
+  std::string unsupportedTypeString(Slice const& slice) const;
+
+ private:
+  Sink* _sink;
+
+  // byte sizes of all documents, in the order they are written
+  std::vector<ValueLength> _sizes;
+
+  // index of the next document size to write
+  std::size_t _nextSize;
+
+  // number of bytes currently held in the staging buffer
+  std::size_t _pos;
+
+  char _buffer[bufferSize];
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
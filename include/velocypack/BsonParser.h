@@ -0,0 +1,176 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef VELOCYPACK_BSONPARSER_H
+#define VELOCYPACK_BSONPARSER_H 1
+
+#include <memory>
+#include <string>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Options.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// Converts BSON (http://bsonspec.org) into VPack, adding the values to a
+// Builder while the input is decoded.
+// Each BSON document becomes an Object, and embedded arrays become Arrays.
+// double, string, binary, boolean, UTC datetime, null, min key and max key
+// are mapped to the VPack type of the same name, int32 and int64 to
+// integers, and the timestamp type to UInt. JavaScript code and symbols
+// are read as Strings, ObjectIds as Strings with their 24 hexadecimal
+// digits, undefined as Null, and the binary subtype is dropped. Regular
+// expressions, DBPointers, code with scope and decimal128 are not
+// supported. Strings and keys are validated if
+// Options::validateUtf8Strings is set. Errors throw Exception::ParseError,
+// and errorPos() returns the position of the value that caused the error.
+class BsonParser {
+ public:
+  Options const* options;
+
+  BsonParser(BsonParser const&) = delete;
+  BsonParser& operator=(BsonParser const&) = delete;
+
+  explicit BsonParser(Options const* options = &Options::Defaults);
+
+  // adds the parsed values to builder, which may have an open Array or
+  // Object
+  explicit BsonParser(Builder& builder,
+                      Options const* options = &Options::Defaults);
+
+  static std::shared_ptr<Builder> fromBson(
+      uint8_t const* start, std::size_t size,
+      Options const* options = &Options::Defaults) {
+    BsonParser parser(options);
+    parser.parse(start, size);
+    return parser.steal();
+  }
+
+  static std::shared_ptr<Builder> fromBson(
+      std::string const& data, Options const* options = &Options::Defaults) {
+    return fromBson(reinterpret_cast<uint8_t const*>(data.data()),
+                    data.size(), options);
+  }
+
+  // parses a single document, or with multi, a sequence of documents
+  // following each other as in the files written by mongodump, and
+  // returns the number of documents parsed
+  ValueLength parse(uint8_t const* start, std::size_t size,
+                    bool multi = false);
+
+  ValueLength parse(char const* start, std::size_t size, bool multi = false) {
+    return parse(reinterpret_cast<uint8_t const*>(start), size, multi);
+  }
+
+  ValueLength parse(std::string const& data, bool multi = false) {
+    return parse(data.data(), data.size(), multi);
+  }
+
+  Builder const& builder() const { return *_builderPtr; }
+
+  // the parser cannot be used anymore after steal()
+  std::shared_ptr<Builder> steal() {
+    std::shared_ptr<Builder> res(_builder);
+    _builder.reset();
+    _builderPtr = nullptr;
+    return res;
+  }
+
+  // the position of the value that caused the last error
+  std::size_t errorPos() const { return _valuePos; }
+
+ private:
+  // throws if fewer than n bytes are left in the current document
+  inline void need(std::size_t n) const {
+    if (VELOCYPACK_UNLIKELY(n > _end - _pos)) {
+      throw Exception(Exception::ParseError, "Unexpected end of BSON input");
+    }
+  }
+
+  // reads a little-endian unsigned integer of N bytes
+  template <std::size_t N>
+  inline uint64_t readUInt() {
+    need(N);
+    uint64_t value = 0;
+    for (std::size_t i = N; i > 0; --i) {
+      value = (value << 8) | _start[_pos + i - 1];
+    }
+    _pos += N;
+    return value;
+  }
+
+  // reads a non-negative int32 length
+  inline std::size_t readLength() {
+    int32_t const length = static_cast<int32_t>(readUInt<4>());
+    if (VELOCYPACK_UNLIKELY(length < 0)) {
+      throw Exception(Exception::ParseError, "Invalid BSON length");
+    }
+    return static_cast<std::size_t>(length);
+  }
+
+  // adds a value to the Builder, as the value for the pending document
+  // key if there is one
+  template <typename T>
+  inline void add(T const& value) {
+    if (_key == nullptr) {
+      _builderPtr->add(value);
+    } else {
+      char const* key = _key;
+      _key = nullptr;
+      _builderPtr->add(key, _keyLength, value);
+    }
+  }
+
+  void parseDocument(ValueType type);
+
+  void parseElement(uint8_t type);
+
+  void parseString();
+
+  void parseBinary();
+
+  void parseObjectId();
+
+ private:
+  std::shared_ptr<Builder> _builder;
+  Builder* _builderPtr;
+  uint8_t const* _start;
+  std::size_t _size;
+  std::size_t _pos;
+  // the end of the innermost document currently parsed
+  std::size_t _end;
+  std::size_t _valuePos;
+  // the key of a document element whose value is parsed next
+  char const* _key;
+  std::size_t _keyLength;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
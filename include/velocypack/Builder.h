@@ -138,6 +138,11 @@ class Builder {
     return b;  // Use return value optimization
   }
 
+  // returns a copy of slice in canonical encoding (see
+  // Options::buildCanonical). Object keys are translated with the
+  // attribute translator of Options::Defaults
+  static Builder canonicalize(Slice const& slice);
+
   void reserve(ValueLength len) {
     VELOCYPACK_ASSERT(_start == _bufferPtr->data());
     VELOCYPACK_ASSERT(_start + _pos >= _bufferPtr->data());
@@ -323,6 +328,12 @@ class Builder {
       throw Exception(Exception::BuilderExternalsDisallowed);
     }
 
+    if (VELOCYPACK_UNLIKELY(options->buildCanonical)) {
+      // canonical encoding resolves Externals, so copy the referenced
+      // value (via setCanonical) instead of storing the pointer
+      return add(Slice(sub));
+    }
+
     bool haveReported = false;
     if (!_stack.empty()) {
       if (!_keyWritten) {
@@ -363,7 +374,14 @@ class Builder {
   }
 
   // Seal the innermost array or object:
-  Builder& close();
+  Builder& close() { return closeInternal(false); }
+
+  // Seal the innermost object, whose keys must have been added in
+  // ascending order (as compared by memcmp, with shorter keys first if
+  // one is a prefix of the other). This skips sorting the index table.
+  // The order is only checked in debug builds. Arrays are sealed as
+  // with close():
+  Builder& closeSorted() { return closeInternal(true); }
 
   // whether or not a specific key is present in an Object value
   bool hasKey(std::string const& key) const;
@@ -429,6 +447,8 @@ class Builder {
     }
   }
 
+  Builder& closeInternal(bool keysSorted);
+
   // close for the empty case:
   Builder& closeEmptyArrayOrObject(ValueLength tos, bool isArray);
 
@@ -439,6 +459,16 @@ class Builder {
   // close for the array case:
   Builder& closeArray(ValueLength tos, std::vector<ValueLength>& index);
 
+  // stores the members of an Object in the order of its sorted index
+  // table, for canonical encoding
+  void orderObjectMembers(ValueLength tos, std::vector<ValueLength>& index);
+
+  // adds a Double in canonical encoding
+  void addCanonicalDouble(double v);
+
+  // adds a copy of item in canonical encoding
+  void setCanonical(Slice const& item);
+
   void addNull() {
     appendByte(0x18);
   }
@@ -452,6 +482,10 @@ class Builder {
   }
 
   void addDouble(double v) {
+    if (VELOCYPACK_UNLIKELY(options->buildCanonical)) {
+      addCanonicalDouble(v);
+      return;
+    }
     uint64_t dv;
     ValueLength vSize = sizeof(double);
     memcpy(&dv, &v, vSize);
@@ -470,6 +504,9 @@ class Builder {
     } else if (v < 0 && v >= -6) {
       // SmallInt
       appendByte(static_cast<uint8_t>(0x40 + v));
+    } else if (v > 0 && options->buildCanonical) {
+      // canonical encoding stores non-negative integers as UInts
+      appendUInt(static_cast<uint64_t>(v), 0x27);
     } else {
       // regular int
       appendInt(v, 0x1f);
@@ -576,7 +613,8 @@ class Builder {
     }
 
     try {
-      if (options->attributeTranslator != nullptr) {
+      if (options->attributeTranslator != nullptr &&
+          !options->buildCanonical) {
         // check if a translation for the attribute name exists
         uint8_t const* translated =
             options->attributeTranslator->translate(attrName, attrLength);
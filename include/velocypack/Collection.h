@@ -27,20 +27,86 @@
 #ifndef VELOCYPACK_COLLECTION_H
 #define VELOCYPACK_COLLECTION_H 1
 
+#include <algorithm>
 #include <functional>
+#include <limits>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Builder.h"
+#include "velocypack/CompiledPath.h"
 #include "velocypack/Iterator.h"
 #include "velocypack/Slice.h"
+#include "velocypack/StringRef.h"
+#include "velocypack/Traversal.h"
 
 namespace arangodb {
 namespace velocypack {
 
+// options for Collection::sortBy()
+struct SortOptions {
+  // sort in descending instead of ascending order
+  bool descending = false;
+
+  // keep the original order of members with equal sort keys
+  bool stable = false;
+
+  // if non-zero, only the first limit members of the sorted result are
+  // returned (top-k). this uses a partial sort, which is cheaper than
+  // sorting the entire Array
+  ValueLength limit = 0;
+
+  // maximum number of threads used for sorting an Array with at least
+  // parallelThreshold members. the Array is sorted in chunks, which are
+  // then merged. with more than one thread, less is called from several
+  // threads at the same time and must be safe to call concurrently.
+  // extract is always called on the calling thread only
+  unsigned threads = 1;
+  ValueLength parallelThreshold = 65536;
+};
+
+// result of Collection::aggregate(). only numeric members are taken into
+// account. min, max and average() are NaN if there were no numeric members.
+// NaN members propagate: if there is one, min, max and sum are NaN
+struct NumericAggregate {
+  ValueLength count = 0;
+  double sum = 0.0;
+  double min = std::numeric_limits<double>::quiet_NaN();
+  double max = std::numeric_limits<double>::quiet_NaN();
+
+  double average() const noexcept {
+    if (count == 0) {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    return sum / static_cast<double>(count);
+  }
+};
+
+// an aggregation computed for each group by Collection::groupBy(). the
+// result is stored under the given name in the group's Object:
+// - Count: number of members in the group. with a path, only members for
+//   which the path resolves to a non-null value are counted
+// - Sum: sum of the numeric values the path resolves to (as a double)
+// - Min, Max: minimum and maximum of these numeric values, or null if
+//   there are none
+// - Collect: Array of all values the path resolves to (missing values are
+//   left out), in the order of the input
+struct GroupAggregation {
+  enum Type { Count, Sum, Min, Max, Collect };
+
+  GroupAggregation(std::string name, Type type, CompiledPath path = CompiledPath())
+      : name(std::move(name)), type(type), path(std::move(path)) {}
+
+  std::string name;
+  Type type;
+  CompiledPath path;
+};
+
 class Collection {
  public:
   enum VisitationOrder { PreOrder = 1, PostOrder = 2 };
@@ -50,34 +116,129 @@ class Collection {
 
   typedef std::function<bool(Slice const&, ValueLength)> Predicate;
 
+  // SFINAE helpers for the templated overloads below. they only take part
+  // in overload resolution for callables with the signature of a Predicate,
+  // of a sort key extractor or of a visitRecursive() callback
+  template <typename F>
+  using IsPredicate = decltype(std::declval<F&>()(std::declval<Slice const&>(),
+                                                  std::declval<ValueLength>()));
+  template <typename F>
+  using SortKey = typename std::decay<decltype(std::declval<F&>()(std::declval<Slice const&>()))>::type;
+  template <typename F>
+  using IsVisitor = decltype(std::declval<F&>()(std::declval<Slice const&>(),
+                                                std::declval<Slice const&>()));
+
   Collection() = delete;
   Collection(Collection const&) = delete;
   Collection& operator=(Collection const&) = delete;
 
+  // the methods taking a Predicate are provided as non-template functions
+  // for binary compatibility. the templated overloads accept any callable
+  // (e.g. a lambda) with the same signature, which the compiler can inline
+  // instead of calling it through a std::function for each member
+
   static void forEach(Slice const& slice, Predicate const& predicate);
 
   static void forEach(Slice const* slice, Predicate const& predicate) {
     return forEach(*slice, predicate);
   }
 
+  template <typename F, typename = IsPredicate<F>>
+  static void forEach(Slice const& slice, F&& predicate) {
+    ArrayIterator it(slice);
+    ValueLength index = 0;
+
+    while (it.valid()) {
+      if (!predicate(it.value(), index)) {
+        // abort
+        return;
+      }
+      it.next();
+      ++index;
+    }
+  }
+
+  template <typename F, typename = IsPredicate<F>>
+  static void forEach(Slice const* slice, F&& predicate) {
+    forEach(*slice, std::forward<F>(predicate));
+  }
+
   static Builder filter(Slice const& slice, Predicate const& predicate);
 
   static Builder filter(Slice const* slice, Predicate const& predicate) {
     return filter(*slice, predicate);
   }
 
+  template <typename F, typename = IsPredicate<F>>
+  static Builder filter(Slice const& slice, F&& predicate) {
+    // construct a new Array
+    Builder b;
+    b.add(Value(ValueType::Array));
+
+    ArrayIterator it(slice);
+    ValueLength index = 0;
+
+    while (it.valid()) {
+      Slice s = it.value();
+      if (predicate(s, index)) {
+        b.add(s);
+      }
+      it.next();
+      ++index;
+    }
+    b.close();
+    return b;
+  }
+
+  template <typename F, typename = IsPredicate<F>>
+  static Builder filter(Slice const* slice, F&& predicate) {
+    return filter(*slice, std::forward<F>(predicate));
+  }
+
   static Slice find(Slice const& slice, Predicate const& predicate);
 
   static Slice find(Slice const* slice, Predicate const& predicate) {
     return find(*slice, predicate);
   }
 
+  template <typename F, typename = IsPredicate<F>>
+  static Slice find(Slice const& slice, F&& predicate) {
+    ArrayIterator it(slice);
+    ValueLength index = 0;
+
+    while (it.valid()) {
+      Slice s = it.value();
+      if (predicate(s, index)) {
+        return s;
+      }
+      it.next();
+      ++index;
+    }
+
+    return Slice();
+  }
+
+  template <typename F, typename = IsPredicate<F>>
+  static Slice find(Slice const* slice, F&& predicate) {
+    return find(*slice, std::forward<F>(predicate));
+  }
+
   static bool contains(Slice const& slice, Predicate const& predicate);
 
   static bool contains(Slice const* slice, Predicate const& predicate) {
     return contains(*slice, predicate);
   }
 
+  template <typename F, typename = IsPredicate<F>>
+  static bool contains(Slice const& slice, F&& predicate) {
+    return !find(slice, std::forward<F>(predicate)).isNone();
+  }
+
+  template <typename F, typename = IsPredicate<F>>
+  static bool contains(Slice const* slice, F&& predicate) {
+    return contains(*slice, std::forward<F>(predicate));
+  }
+
   static bool contains(Slice const& slice, Slice const& other);
 
   static bool contains(Slice const* slice, Slice const& other) {
@@ -96,12 +257,74 @@ class Collection {
     return all(*slice, predicate);
   }
 
+  template <typename F, typename = IsPredicate<F>>
+  static bool all(Slice const& slice, F&& predicate) {
+    ArrayIterator it(slice);
+    ValueLength index = 0;
+
+    while (it.valid()) {
+      if (!predicate(it.value(), index)) {
+        return false;
+      }
+      it.next();
+      ++index;
+    }
+
+    return true;
+  }
+
+  template <typename F, typename = IsPredicate<F>>
+  static bool all(Slice const* slice, F&& predicate) {
+    return all(*slice, std::forward<F>(predicate));
+  }
+
   static bool any(Slice const& slice, Predicate const& predicate);
 
   static bool any(Slice const* slice, Predicate const& predicate) {
     return any(*slice, predicate);
   }
 
+  template <typename F, typename = IsPredicate<F>>
+  static bool any(Slice const& slice, F&& predicate) {
+    ArrayIterator it(slice);
+    ValueLength index = 0;
+
+    while (it.valid()) {
+      if (predicate(it.value(), index)) {
+        return true;
+      }
+      it.next();
+      ++index;
+    }
+
+    return false;
+  }
+
+  template <typename F, typename = IsPredicate<F>>
+  static bool any(Slice const* slice, F&& predicate) {
+    return any(*slice, std::forward<F>(predicate));
+  }
+
+  // computes count, sum, min and max of the numeric members of an Array in
+  // a single pass. Arrays with equally sized members (0x02 - 0x05) of
+  // the same type are processed by specialized (SIMD) loops
+  static NumericAggregate aggregate(Slice const& array);
+
+  // groups the members of an Array (typically Objects) by the value the
+  // key path resolves to (null if it does not exist), and computes the
+  // aggregations for each group. keys are compared like values in
+  // NormalizedCompare::equalsAnyType, so e.g. 1 and 1.0 end up in the same
+  // group, and UTCDate keys are grouped by their binary representation. the
+  // result is an Array with one Object per group, in the order of first
+  // appearance, which contains the group key under keyName and the
+  // results of the aggregations under their names
+  static Builder groupBy(Slice const& array, CompiledPath const& key,
+                         std::vector<GroupAggregation> const& aggregations,
+                         std::string const& keyName = "key");
+  static Builder& groupBy(Builder& builder, Slice const& array, CompiledPath const& key,
+                          std::vector<GroupAggregation> const& aggregations,
+                          std::string const& keyName = "key");
+
   static std::vector<std::string> keys(Slice const& slice);
 
   static std::vector<std::string> keys(Slice const* slice) {
@@ -138,6 +361,22 @@ class Collection {
     }
   }
 
+  // returns the keys without copying them. the StringRefs point into the
+  // Object (or into the attribute translator for translated keys)
+  static void keys(Slice const& slice, std::vector<StringRef>& result) {
+    ObjectIterator it(slice);
+    result.reserve(checkOverflow(it.size()));
+
+    while (it.valid()) {
+      result.emplace_back(it.key(true));
+      it.next();
+    }
+  }
+
+  static void keys(Slice const* slice, std::vector<StringRef>& result) {
+    keys(*slice, result);
+  }
+
   template<typename T>
   static void unorderedKeys(Slice const& slice, T& result) {
     ObjectIterator it(slice, true);
@@ -206,6 +445,26 @@ class Collection {
   }
   static Builder& merge(Builder& builder, Slice const& left, Slice const& right, bool mergeValues, bool nullMeansRemove = false);
 
+  // set operations on Arrays. members are hashed and compared with
+  // NormalizedCompare::equalsAnyType, so e.g. 1 and 1.0 are considered
+  // identical, and UTCDate or Binary members are compared on the binary
+  // level. the results contain no duplicates and keep the members in the
+  // order in which they were first seen (left before right). the variants
+  // taking a Builder add the result Array to it
+  static Builder unique(Slice const& array);
+  static Builder& unique(Builder& builder, Slice const& array);
+
+  static Builder setUnion(Slice const& left, Slice const& right);
+  static Builder& setUnion(Builder& builder, Slice const& left, Slice const& right);
+
+  // members of left that are also contained in right
+  static Builder setIntersection(Slice const& left, Slice const& right);
+  static Builder& setIntersection(Builder& builder, Slice const& left, Slice const& right);
+
+  // members of left that are not contained in right
+  static Builder setDifference(Slice const& left, Slice const& right);
+  static Builder& setDifference(Builder& builder, Slice const& left, Slice const& right);
+
   static void visitRecursive(
       Slice const& slice, VisitationOrder order,
       std::function<bool(Slice const&, Slice const&)> const& func);
@@ -216,9 +475,146 @@ class Collection {
     visitRecursive(*slice, order, func);
   }
 
+  // visitRecursive() is implemented on top of Traversal, which does not
+  // recurse. callers that want to skip subtrees, need the current path or
+  // visit many documents should use a Traversal directly
+  template <typename F, typename = IsVisitor<F>>
+  static void visitRecursive(Slice const& slice, VisitationOrder order, F&& func) {
+    Traversal traversal;
+    traversal.visit(slice,
+                    (order == PreOrder) ? Traversal::MembersFirst : Traversal::ValueFirst,
+                    [&func](Slice const& key, Slice const& value, Traversal::Path const&) {
+                      return func(key, value) ? Traversal::Continue : Traversal::Stop;
+                    });
+  }
+
+  template <typename F, typename = IsVisitor<F>>
+  static void visitRecursive(Slice const* slice, VisitationOrder order, F&& func) {
+    visitRecursive(*slice, order, std::forward<F>(func));
+  }
+
   static Builder sort(
       Slice const& array,
       std::function<bool (Slice const&, Slice const&)> lessthan);
+
+  // sorts an Array by a key that is extracted only once per member, so
+  // that comparisons do not need to decode the members again. extract
+  // must have the signature K(Slice const&), and less must be a strict
+  // weak ordering on K
+  template <typename Extract, typename Less, typename Key = SortKey<Extract>,
+            typename = decltype(std::declval<Less&>()(std::declval<Key const&>(),
+                                                      std::declval<Key const&>()))>
+  static Builder sortBy(Slice const& array, Extract&& extract, Less&& less,
+                        SortOptions const& options = SortOptions()) {
+    struct Entry {
+      Key key;
+      Slice value;
+      ValueLength position;
+    };
+
+    ArrayIterator it(array);
+    std::vector<Entry> entries;
+    entries.reserve(checkOverflow(it.size()));
+    while (it.valid()) {
+      Slice s = it.value();
+      entries.push_back(Entry{extract(s), s, it.index()});
+      it.next();
+    }
+
+    bool const descending = options.descending;
+    bool const stable = options.stable;
+    auto compare = [&less, descending, stable](Entry const& a, Entry const& b) -> bool {
+      Key const& l = descending ? b.key : a.key;
+      Key const& r = descending ? a.key : b.key;
+      if (less(l, r)) {
+        return true;
+      }
+      if (!stable || less(r, l)) {
+        return false;
+      }
+      // equal keys
+      return a.position < b.position;
+    };
+
+    if (options.limit > 0 && options.limit < entries.size()) {
+      auto middle = entries.begin() + static_cast<std::ptrdiff_t>(options.limit);
+      std::partial_sort(entries.begin(), middle, entries.end(), compare);
+      entries.erase(middle, entries.end());
+    } else if (options.threads > 1 && entries.size() >= options.parallelThreshold) {
+      parallelSort(entries, compare, options.threads);
+    } else {
+      std::sort(entries.begin(), entries.end(), compare);
+    }
+
+    Builder b;
+    b.openArray();
+    for (auto const& e : entries) {
+      b.add(e.value);
+    }
+    b.close();
+    return b;
+  }
+
+  template <typename Extract, typename Key = SortKey<Extract>>
+  static Builder sortBy(Slice const& array, Extract&& extract,
+                        SortOptions const& options = SortOptions()) {
+    return sortBy(array, std::forward<Extract>(extract), std::less<Key>(), options);
+  }
+
+  // sorts an Array by the value the path resolves to for each member.
+  // values are ordered by type first (null or missing, bool, number,
+  // string, array, object), then numbers by their numeric value and
+  // strings by their binary representation. Arrays, Objects and values
+  // of other types compare equal among themselves
+  static Builder sortBy(Slice const& array, CompiledPath const& path,
+                        SortOptions const& options = SortOptions());
+
+ private:
+  // runs all tasks, each in its own thread, and waits for them. the first
+  // exception thrown by a task is rethrown
+  static void runParallel(std::vector<std::function<void()>>& tasks);
+
+  // sorts the values in chunks in parallel, and merges the sorted chunks
+  template <typename T, typename Compare>
+  static void parallelSort(std::vector<T>& values, Compare& compare, unsigned threads) {
+    std::size_t const n = values.size();
+    std::size_t const chunks = (std::min)(static_cast<std::size_t>(threads), n);
+    std::vector<std::size_t> bounds;
+    for (std::size_t i = 0; i <= chunks; ++i) {
+      bounds.push_back(n * i / chunks);
+    }
+
+    auto begin = values.begin();
+    std::vector<std::function<void()>> tasks;
+    for (std::size_t i = 0; i < chunks; ++i) {
+      std::size_t lo = bounds[i];
+      std::size_t hi = bounds[i + 1];
+      tasks.emplace_back([begin, lo, hi, &compare]() {
+        std::sort(begin + lo, begin + hi, compare);
+      });
+    }
+    runParallel(tasks);
+
+    // merge neighboring chunks until only one is left
+    while (bounds.size() > 2) {
+      std::vector<std::size_t> merged;
+      tasks.clear();
+      for (std::size_t i = 0; i + 1 < bounds.size(); i += 2) {
+        merged.push_back(bounds[i]);
+        if (i + 2 < bounds.size()) {
+          std::size_t lo = bounds[i];
+          std::size_t mid = bounds[i + 1];
+          std::size_t hi = bounds[i + 2];
+          tasks.emplace_back([begin, lo, mid, hi, &compare]() {
+            std::inplace_merge(begin + lo, begin + mid, begin + hi, compare);
+          });
+        }
+      }
+      merged.push_back(n);
+      runParallel(tasks);
+      bounds = std::move(merged);
+    }
+  }
 };
 
 struct IsEqualPredicate {
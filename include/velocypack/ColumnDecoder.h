@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef VELOCYPACK_COLUMNDECODER_H
+#define VELOCYPACK_COLUMNDECODER_H 1
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/CompiledPath.h"
+#include "velocypack/Slice.h"
+#include "velocypack/StringRef.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// A Column holds the values of an Array (or of one attribute of the
+// Objects in an Array) in a contiguous buffer of native values, plus a
+// null mask. Bool values are stored as uint8_t so that the buffer stays
+// contiguous. StringRef values point into the decoded VPack data, which
+// must stay valid while the column is used
+template <typename T>
+struct Column {
+  typedef typename std::conditional<std::is_same<T, bool>::value, uint8_t,
+                                    T>::type value_type;
+
+  // the decoded values. positions that are null hold a default value
+  std::vector<value_type> values;
+  // one entry per value: 1 if the source value was null, missing or not
+  // of the column's type, 0 otherwise
+  std::vector<uint8_t> nulls;
+  // number of null entries
+  std::size_t nullCount = 0;
+
+  std::size_t size() const noexcept { return values.size(); }
+
+  bool empty() const noexcept { return values.empty(); }
+
+  bool isNull(std::size_t position) const { return nulls[position] != 0; }
+
+  void reserve(std::size_t n) {
+    values.reserve(n);
+    nulls.reserve(n);
+  }
+
+  void clear() noexcept {
+    values.clear();
+    nulls.clear();
+    nullCount = 0;
+  }
+
+  void append(value_type value) {
+    values.push_back(value);
+    nulls.push_back(0);
+  }
+
+  void appendNull() {
+    values.push_back(value_type());
+    nulls.push_back(1);
+    ++nullCount;
+  }
+};
+
+typedef Column<double> DoubleColumn;
+typedef Column<int64_t> IntColumn;
+typedef Column<bool> BoolColumn;
+typedef Column<StringRef> StringColumn;
+
+// The ColumnDecoder converts the members of an Array into Columns in a
+// single pass. Values are appended to the column. The following values
+// are accepted per column type, all others are added as null:
+// - DoubleColumn: all number types
+// - IntColumn: Int, SmallInt and UInt values that fit into an int64_t
+// - BoolColumn: Bool values
+// - StringColumn: String values
+// Arrays with equally sized members (0x02 - 0x05) are decoded without
+// inspecting each member's byte size, and use SIMD instructions where
+// possible
+class ColumnDecoder {
+ public:
+  ColumnDecoder() = delete;
+  ColumnDecoder(ColumnDecoder const&) = delete;
+  ColumnDecoder& operator=(ColumnDecoder const&) = delete;
+
+  // decodes all members of the Array
+  // throws Exception::InvalidValueType if the slice is not an Array
+  static void decode(Slice array, DoubleColumn& column);
+  static void decode(Slice array, IntColumn& column);
+  static void decode(Slice array, BoolColumn& column);
+  static void decode(Slice array, StringColumn& column);
+
+  // decodes the attribute with the given name from each member of an
+  // Array of Objects. members that are no Objects or that do not contain
+  // the attribute are added as null
+  static void decode(Slice array, StringRef const& attribute, DoubleColumn& column);
+  static void decode(Slice array, StringRef const& attribute, IntColumn& column);
+  static void decode(Slice array, StringRef const& attribute, BoolColumn& column);
+  static void decode(Slice array, StringRef const& attribute, StringColumn& column);
+
+  // decodes the value the path resolves to for each member of the Array
+  static void decode(Slice array, CompiledPath const& path, DoubleColumn& column);
+  static void decode(Slice array, CompiledPath const& path, IntColumn& column);
+  static void decode(Slice array, CompiledPath const& path, BoolColumn& column);
+  static void decode(Slice array, CompiledPath const& path, StringColumn& column);
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
@@ -68,6 +68,12 @@ static bool equalsStrings(Slice lhs, Slice rhs);
 // function to compare two arbitrary Slices
 static bool equals(Slice lhs, Slice rhs);
 
+// function to compare two arbitrary Slices like equals(), but without
+// throwing: values of types that equals() rejects (e.g. UTCDate, Binary
+// or Custom) are equal only if they are equal on the binary level. this
+// is consistent with Slice::normalizedHash()
+static bool equalsAnyType(Slice lhs, Slice rhs);
+
 struct Hash {
   size_t operator()(arangodb::velocypack::Slice const&) const;
 };
@@ -84,6 +90,13 @@ struct Equal {
 };
 
 };
+
+// helper struct for comparing VelocyPack Slices in canonical encoding (see
+// Options::buildCanonical), for which binary equality means that
+// NormalizedCompare considers them equal. unlike with NormalizedCompare,
+// NaN equals NaN, and integers beyond 2^53 are not equal to nearby
+// Doubles. both Slices must be in canonical encoding, which is not checked
+using CanonicalCompare = BinaryCompare;
   
 }
 }
@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef VELOCYPACK_COMPILEDFILTER_H
+#define VELOCYPACK_COMPILEDFILTER_H 1
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Buffer.h"
+#include "velocypack/Builder.h"
+#include "velocypack/CompiledPath.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// A CompiledFilter is a predicate over documents that has been compiled
+// once into a flat sequence of instructions. It is evaluated directly on
+// the VPack data: attribute values are looked up with CompiledPaths and
+// compared in place, without building any intermediate values. Each path
+// is resolved at most once per document, even if the filter refers to it
+// multiple times.
+//
+// Filter expressions are given as VPack Arrays, with the operator first:
+//   ["==", path, value], ["!=", path, value]
+//   ["<", path, value], ["<=", path, value], [">", path, value],
+//   [">=", path, value]
+//   ["in", path, [value, ...]]
+//   ["exists", path]
+//   ["and", expression, ...], ["or", expression, ...], ["not", expression]
+// Paths are strings in one of the syntaxes of CompiledPath. Equality uses
+// NormalizedCompare::equalsAnyType, so e.g. 1 and 1.0 are equal, values
+// of types such as UTCDate or Binary are equal if they are binary equal,
+// and "!=" is true for a missing attribute. The ordering operators only
+// accept numbers, strings and booleans: they compare numbers numerically,
+// strings by their binary representation and booleans with false < true.
+// They are false for missing attributes, for operands of different types
+// and for all other types, including UTCDate, Binary, Arrays and Objects.
+// "and" and "or" are evaluated with short-circuiting. An empty "and" is
+// true, an empty "or" is false.
+class CompiledFilter {
+ public:
+  // compiles the filter expression. throws Exception::InvalidValueType on
+  // malformed expressions and Exception::InvalidAttributePath on invalid
+  // paths. the expression is copied and need not be kept
+  explicit CompiledFilter(Slice expression);
+
+  // whether or not the document satisfies the filter
+  bool matches(Slice document) const;
+
+  // batch evaluation: appends the positions of all matching members of
+  // the Array to positions, in ascending order
+  void select(Slice array, std::vector<ValueLength>& positions) const;
+
+  // batch evaluation: appends the positions of all matching documents to
+  // positions, in ascending order
+  void select(std::vector<Slice> const& documents,
+              std::vector<ValueLength>& positions) const;
+
+  // number of matching members of the Array
+  ValueLength count(Slice array) const;
+
+  // adds an Array with all matching members of array to the builder
+  Builder& filter(Builder& builder, Slice array) const;
+  Builder filter(Slice array) const;
+
+  // number of instructions of the compiled program
+  std::size_t size() const noexcept { return _program.size(); }
+
+ private:
+  enum class OpCode : uint8_t {
+    Const,        // result = operand != 0
+    Exists,       // result = path exists
+    Equal,        // result = path == constant
+    NotEqual,     // result = path != constant
+    Less,         // result = path < constant
+    LessEqual,    // result = path <= constant
+    Greater,      // result = path > constant
+    GreaterEqual, // result = path >= constant
+    In,           // result = path in list
+    Not,          // result = !result
+    JumpIfFalse,  // continue at operand if !result
+    JumpIfTrue    // continue at operand if result
+  };
+
+  struct Instruction {
+    Instruction(OpCode op, uint32_t path, uint32_t operand)
+        : op(op), path(path), operand(operand) {}
+
+    OpCode op;
+    // index into _paths
+    uint32_t path;
+    // constant (offset into _constants), index into _lists or jump target
+    uint32_t operand;
+  };
+
+  // values of an "in" list, sorted by their normalized hash values
+  typedef std::vector<std::pair<std::size_t, ValueLength>> List;
+
+  void compile(Slice expression);
+  uint32_t addPath(Slice path);
+  uint32_t addConstant(Slice value);
+  void emit(OpCode op, uint32_t path, uint32_t operand) {
+    _program.emplace_back(op, path, operand);
+  }
+
+  // evaluates the program. resolved holds the values of all paths for
+  // the document, nullptr for paths that have not been resolved yet
+  bool evaluate(Slice document, uint8_t const** resolved) const;
+
+  template <typename F>
+  void evaluateAll(F&& next, ValueLength n, std::vector<ValueLength>* positions,
+                   ValueLength* count) const;
+
+  bool contains(List const& list, Slice value) const;
+
+  std::vector<Instruction> _program;
+  std::vector<CompiledPath> _paths;
+  std::vector<std::string> _pathExpressions;
+  std::vector<List> _lists;
+  // copies of all constants of the expression, back to back
+  Buffer<uint8_t> _constants;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
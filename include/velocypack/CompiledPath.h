@@ -0,0 +1,232 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_COMPILEDPATH_H
+#define VELOCYPACK_COMPILEDPATH_H 1
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/Slice.h"
+#include "velocypack/StringRef.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// A CompiledPath is an attribute path that has been parsed once into a
+// sequence of lookup steps, so that it can be evaluated over many Slices
+// without any further parsing or memory allocations.
+//
+// Two syntaxes are supported:
+// - a JSON Pointer (RFC 6901), e.g. "/foo/bar/0". A "*" token is treated
+//   as a wildcard step. All-digit tokens act as array indexes when applied
+//   to an Array and as attribute names when applied to an Object
+// - a subset of JSONPath, e.g. "$.foo.bar[0]", "foo['b.a.r'][*]" or
+//   "foo.*.bar". The leading "$" is optional, so "*.bar" is the same as
+//   "$.*.bar". Negative array indexes count from the end of the array
+class CompiledPath {
+ public:
+  enum class StepType : uint8_t {
+    Attribute,         // lookup of an attribute in an Object
+    Index,             // lookup of a position in an Array
+    AttributeOrIndex,  // JSON Pointer token made of digits only
+    Wildcard           // all members of an Array or all values of an Object
+  };
+
+  struct Step {
+    Step(StepType type, std::string&& name, int64_t index)
+        : type(type), name(std::move(name)), index(index) {}
+
+    StringRef key() const noexcept {
+      return StringRef(name.data(), name.size());
+    }
+
+    StepType type;
+    std::string name;
+    int64_t index;
+  };
+
+  // creates an empty path, which will always resolve to the start Slice
+  CompiledPath() : _hasWildcard(false) {}
+
+  // compiles a path expression in JSON Pointer or JSONPath syntax
+  // throws Exception::InvalidAttributePath on malformed input
+  explicit CompiledPath(StringRef const& expression);
+
+  explicit CompiledPath(std::string const& expression)
+      : CompiledPath(StringRef(expression)) {}
+
+  explicit CompiledPath(char const* expression)
+      : CompiledPath(StringRef(expression)) {}
+
+  // creates a path consisting of plain attribute lookups only
+  explicit CompiledPath(std::vector<std::string> const& attributes);
+
+  std::vector<Step> const& steps() const noexcept { return _steps; }
+
+  std::size_t size() const noexcept { return _steps.size(); }
+
+  bool empty() const noexcept { return _steps.empty(); }
+
+  // whether or not the path contains at least one wildcard step and
+  // can thus produce more than a single result
+  bool hasWildcard() const noexcept { return _hasWildcard; }
+
+  // returns the (first) value the path resolves to, or a None Slice if
+  // the path does not exist in the slice
+  Slice get(Slice slice) const {
+    if (!_hasWildcard) {
+      slice = slice.resolveExternals();
+      for (auto const& step : _steps) {
+        slice = resolveStep(slice, step);
+        if (slice.isNone()) {
+          break;
+        }
+      }
+      return slice;
+    }
+
+    Slice result;
+    forEach(slice, [&result](Slice const& s) -> bool {
+      result = s;
+      return false;
+    });
+    return result;
+  }
+
+  // whether or not the path resolves to at least one value
+  bool exists(Slice slice) const { return !get(slice).isNone(); }
+
+  // calls the callback for each value the path resolves to. the callback
+  // must have the signature bool(Slice const&) and return false to abort
+  // the iteration. returns false if the iteration was aborted
+  template <typename F>
+  bool forEach(Slice slice, F&& callback) const {
+    return visit(slice.resolveExternals(), 0, callback);
+  }
+
+  // returns the JSON Pointer representation of the path, or the JSONPath
+  // representation if the path cannot be expressed as a JSON Pointer.
+  // compiling the result yields the same steps
+  std::string toString() const;
+
+  // resolves a single non-wildcard step. returns a None Slice if the step
+  // cannot be applied to the slice
+  static Slice resolveStep(Slice slice, Step const& step) {
+    switch (step.type) {
+      case StepType::Attribute: {
+        if (!slice.isObject()) {
+          return Slice();
+        }
+        return slice.get(step.key()).resolveExternals();
+      }
+      case StepType::AttributeOrIndex: {
+        if (slice.isObject()) {
+          return slice.get(step.key()).resolveExternals();
+        }
+        return resolveIndex(slice, step.index);
+      }
+      case StepType::Index: {
+        return resolveIndex(slice, step.index);
+      }
+      case StepType::Wildcard: {
+        break;
+      }
+    }
+    throw Exception(Exception::InvalidAttributePath,
+                    "Wildcard cannot be resolved to a single value");
+  }
+
+ private:
+  static Slice resolveIndex(Slice slice, int64_t index) {
+    if (!slice.isArray()) {
+      return Slice();
+    }
+    ValueLength const n = slice.length();
+    if (index < 0) {
+      if (static_cast<ValueLength>(-(index + 1)) >= n) {
+        return Slice();
+      }
+      return slice.at(n - static_cast<ValueLength>(-(index + 1)) - 1).resolveExternals();
+    }
+    if (static_cast<ValueLength>(index) >= n) {
+      return Slice();
+    }
+    return slice.at(static_cast<ValueLength>(index)).resolveExternals();
+  }
+
+  template <typename F>
+  bool visit(Slice slice, std::size_t position, F& callback) const {
+    while (position < _steps.size()) {
+      Step const& step = _steps[position++];
+      if (step.type == StepType::Wildcard) {
+        if (slice.isArray()) {
+          ArrayIterator it(slice);
+          while (it.valid()) {
+            if (!visit(it.value().resolveExternals(), position, callback)) {
+              return false;
+            }
+            it.next();
+          }
+        } else if (slice.isObject()) {
+          ObjectIterator it(slice, true);
+          while (it.valid()) {
+            if (!visit(it.value().resolveExternals(), position, callback)) {
+              return false;
+            }
+            it.next();
+          }
+        }
+        return true;
+      }
+
+      slice = resolveStep(slice, step);
+      if (slice.isNone()) {
+        // path does not exist here
+        return true;
+      }
+    }
+
+    return callback(slice);
+  }
+
+  void parseJsonPointer(StringRef const& expression);
+  void parseJsonPath(StringRef const& expression);
+  void addStep(StepType type, std::string&& name, int64_t index);
+
+ private:
+  std::vector<Step> _steps;
+  bool _hasWildcard;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
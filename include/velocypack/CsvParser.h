@@ -0,0 +1,186 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef VELOCYPACK_CSVPARSER_H
+#define VELOCYPACK_CSVPARSER_H 1
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Options.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// Converts CSV (RFC 4180) into a VPack Array with one value per row.
+// If header is set, the first row holds the column names and every other
+// row becomes an Object with one attribute per column. The keys of each
+// row are added in the sorted order of the column names, which is computed
+// once, so that the index tables of the rows need no sorting. Otherwise
+// every row becomes an Array.
+// Fields are separated by the delimiter and may be enclosed in quotes, in
+// which case they can contain delimiters, line breaks and doubled quotes.
+// Rows end with LF, CRLF or CR. Empty lines are skipped, as is a UTF-8
+// byte order mark at the start of the input.
+// If detectTypes is set, unquoted fields that are JSON numbers, true or
+// false are converted into numbers and booleans, and empty unquoted fields
+// and null into Null. All other fields become Strings.
+// Errors throw Exception::ParseError, and errorPos() returns the position
+// of the row that caused the error.
+class CsvParser {
+ public:
+  Options const* options;
+
+  // separates the fields of a row
+  char delimiter;
+
+  // encloses fields
+  char quote;
+
+  // whether the first row holds the column names
+  bool header;
+
+  // whether to convert unquoted fields into numbers, booleans and nulls
+  bool detectTypes;
+
+  CsvParser(CsvParser const&) = delete;
+  CsvParser& operator=(CsvParser const&) = delete;
+
+  explicit CsvParser(Options const* options = &Options::Defaults);
+
+  // adds the parsed Array to builder, which may have an open Array or
+  // Object
+  explicit CsvParser(Builder& builder,
+                     Options const* options = &Options::Defaults);
+
+  static std::shared_ptr<Builder> fromCsv(
+      uint8_t const* start, std::size_t size,
+      Options const* options = &Options::Defaults) {
+    CsvParser parser(options);
+    parser.parse(start, size);
+    return parser.steal();
+  }
+
+  static std::shared_ptr<Builder> fromCsv(
+      std::string const& data, Options const* options = &Options::Defaults) {
+    return fromCsv(reinterpret_cast<uint8_t const*>(data.data()), data.size(),
+                   options);
+  }
+
+  // parses the input into an Array of rows and returns the number of rows,
+  // not counting the header
+  ValueLength parse(uint8_t const* start, std::size_t size);
+
+  ValueLength parse(char const* start, std::size_t size) {
+    return parse(reinterpret_cast<uint8_t const*>(start), size);
+  }
+
+  ValueLength parse(std::string const& data) {
+    return parse(data.data(), data.size());
+  }
+
+  Builder const& builder() const { return *_builderPtr; }
+
+  // the parser cannot be used anymore after steal()
+  std::shared_ptr<Builder> steal() {
+    std::shared_ptr<Builder> res(_builder);
+    _builder.reset();
+    _builderPtr = nullptr;
+    return res;
+  }
+
+  // the column names from the header of the last input parsed
+  std::vector<std::string> const& columns() const { return _columns; }
+
+  // the position of the row that caused the last error
+  std::size_t errorPos() const { return _rowPos; }
+
+ private:
+  struct Field {
+    // offset of the field in the input, or in _unescaped if it contained
+    // doubled quotes
+    std::size_t offset;
+    std::size_t length;
+    bool quoted;
+    bool unescaped;
+  };
+
+  // reads the fields of the next row into _fields. returns false at the
+  // end of the input
+  bool readRow();
+
+  void readQuotedField(Field& field);
+
+  // returns the start of a field's contents
+  inline char const* fieldData(Field const& field) const {
+    return field.unescaped
+               ? _unescaped.data() + field.offset
+               : reinterpret_cast<char const*>(_start) + field.offset;
+  }
+
+  void readHeader();
+
+  void addRow();
+
+  // adds the field as a value, or as the value for the key if it is not
+  // a nullptr
+  void addField(Field const& field, std::string const* key);
+
+  // adds the value, or the key and the value
+  template <typename T>
+  inline void add(std::string const* key, T const& value) {
+    if (key == nullptr) {
+      _builderPtr->add(value);
+    } else {
+      _builderPtr->add(key->data(), key->size(), value);
+    }
+  }
+
+  // adds a field that is a JSON number, and returns false if it is not
+  bool addNumber(char const* p, std::size_t length, std::string const* key);
+
+ private:
+  std::shared_ptr<Builder> _builder;
+  Builder* _builderPtr;
+  uint8_t const* _start;
+  std::size_t _size;
+  std::size_t _pos;
+  std::size_t _rowPos;
+  std::vector<Field> _fields;
+  // contents of the quoted fields of the current row with doubled quotes
+  std::string _unescaped;
+  std::vector<std::string> _columns;
+  // column numbers in the order of their names
+  std::vector<std::size_t> _sortedColumns;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
@@ -27,6 +27,7 @@
 #ifndef VELOCYPACK_DUMPER_H
 #define VELOCYPACK_DUMPER_H 1
 
+#include <cstring>
 #include <string>
 
 #include "velocypack/velocypack-common.h"
@@ -37,9 +38,13 @@
 
 namespace arangodb {
 namespace velocypack {
+class ArrayIterator;
+class ObjectIterator;
 
 // Dumps VPack into a JSON output string
 class Dumper {
+  friend class ParallelDumper;
+
  public:
   Options const* options;
 
@@ -47,7 +52,7 @@ class Dumper {
   Dumper& operator=(Dumper const&) = delete;
 
   explicit Dumper(Sink* sink, Options const* options = &Options::Defaults)
-      : options(options), _sink(sink), _indentation(0) {
+      : options(options), _sink(sink), _indentation(0), _pos(0) {
     if (VELOCYPACK_UNLIKELY(sink == nullptr)) {
       throw Exception(Exception::InternalError, "Sink cannot be a nullptr");
     }
@@ -58,12 +63,22 @@ class Dumper {
 
   ~Dumper() {}
 
+  // note: output is staged in an internal buffer and handed to the sink
+  // in large blocks. the buffer is flushed before any public method
+  // returns and before a CustomTypeHandler is invoked, so writing to the
+  // sink directly from a CustomTypeHandler is fine
   Sink* sink() const { return _sink; }
 
   void dump(Slice const& slice) {
     _indentation = 0;
     _sink->reserve(slice.byteSize());
-    dumpValue(&slice);
+    try {
+      dumpRoot(&slice);
+    } catch (...) {
+      flush();
+      throw;
+    }
+    flush();
   }
 
   void dump(Slice const* slice) { dump(*slice); }
@@ -92,55 +107,192 @@ class Dumper {
     return toString(*slice, options);
   }
 
-  void append(Slice const& slice) { dumpValue(&slice); }
+  // returns the exact number of characters dumping the slice with the
+  // options produces, without producing the output. throws the same
+  // exceptions as dumping would. CustomTypeHandlers are invoked with a
+  // Dumper whose sink only counts the characters
+  static ValueLength outputLength(Slice const& slice,
+                                  Options const* options = &Options::Defaults);
+
+  static ValueLength outputLength(Slice const* slice,
+                                  Options const* options = &Options::Defaults) {
+    return outputLength(*slice, options);
+  }
+
+  void append(Slice const& slice) { append(&slice); }
 
-  void append(Slice const* slice) { dumpValue(slice); }
+  void append(Slice const* slice) {
+    try {
+      dumpRoot(slice);
+    } catch (...) {
+      flush();
+      throw;
+    }
+    flush();
+  }
 
   void appendString(char const* src, ValueLength len) {
-    _sink->reserve(2 + len);
-    _sink->push_back('"');
-    dumpString(src, len);
-    _sink->push_back('"');
+    try {
+      write('"');
+      dumpString(src, len);
+      write('"');
+    } catch (...) {
+      flush();
+      throw;
+    }
+    flush();
   }
 
   void appendString(std::string const& str) {
-    _sink->reserve(2 + str.size());
-    _sink->push_back('"');
-    dumpString(str.data(), str.size());
-    _sink->push_back('"');
+    appendString(str.data(), str.size());
   }
 
-  void appendUInt(uint64_t);
+  void appendUInt(uint64_t v) {
+    dumpUInt(v);
+    flush();
+  }
 
-  void appendDouble(double);
+  void appendDouble(double v) {
+    dumpDouble(v);
+    flush();
+  }
 
  private:
+  // size of the staging buffer
+  static constexpr std::size_t bufferSize = 4096;
+
+  // appends a single character to the staging buffer
+  inline void write(char c) {
+    if (VELOCYPACK_UNLIKELY(_pos == bufferSize)) {
+      flush();
+    }
+    _buffer[_pos++] = c;
+  }
+
+  // appends a range of characters to the staging buffer. ranges that do
+  // not fit into the buffer are handed to the sink directly
+  inline void write(char const* p, std::size_t len) {
+    if (VELOCYPACK_UNLIKELY(len > bufferSize - _pos)) {
+      flush();
+      if (len >= bufferSize) {
+        _sink->append(p, static_cast<ValueLength>(len));
+        return;
+      }
+    }
+    std::memcpy(&_buffer[_pos], p, len);
+    _pos += len;
+  }
+
+  // makes sure the staging buffer has room for len more characters.
+  // len must not exceed bufferSize
+  inline void ensureSpace(std::size_t len) {
+    if (VELOCYPACK_UNLIKELY(len > bufferSize - _pos)) {
+      flush();
+    }
+  }
+
+  // hands the contents of the staging buffer to the sink
+  void flush() {
+    if (_pos > 0) {
+      _sink->append(&_buffer[0], static_cast<ValueLength>(_pos));
+      _pos = 0;
+    }
+  }
+
+  void dumpUInt(uint64_t);
+
+  void dumpDouble(double);
+
   void dumpUnicodeCharacter(uint16_t value);
 
   void dumpInteger(Slice const*);
 
+  // dumps the value if it is a number that can be represented in JSON
+  // and returns true, returns false for all other values
+  bool dumpNumber(Slice const*);
+
   void dumpString(char const*, ValueLength);
 
+  ValueLength valueLength(Slice const*, Slice const* base);
+
+  ValueLength stringLength(char const*, ValueLength) const;
+
+  ValueLength unsupportedTypeLength(Slice const*) const;
+
   inline void dumpValue(Slice const& slice, Slice const* base = nullptr) {
     dumpValue(&slice, base);
   }
 
   void dumpValue(Slice const*, Slice const* = nullptr);
 
+  // dumps a value passed to dump() or append(), applying the projection
+  // from the options if there is one
+  inline void dumpRoot(Slice const* slice) {
+    if (VELOCYPACK_LIKELY(options->projection == nullptr)) {
+      dumpValue(slice);
+    } else {
+      // 0 is Projection::start()
+      dumpProjected(slice, 0, nullptr);
+    }
+  }
+
+  // dumps the value, leaving out the members of Arrays and Objects the
+  // projection does not select in the given Projection::State
+  void dumpProjected(Slice const*, uint32_t state, Slice const* base);
+
+  // writes the separator and indentation before a member of a container
+  // whose members are not all dumped
+  void separateMember(bool& first) {
+    if (first) {
+      first = false;
+    } else if (options->prettyPrint) {
+      write(",\n", 2);
+    } else {
+      write(',');
+    }
+    if (options->prettyPrint) {
+      indent();
+    }
+  }
+
+  // dumps the next count members of an Array or Object, including the
+  // separators between them, as they appear inside the container
+  void dumpArrayMembers(ArrayIterator&, ValueLength count, Slice const* base);
+
+  void dumpObjectMembers(ObjectIterator&, ValueLength count, Slice const* base);
+
+  void openContainer(char c) {
+    write(c);
+    if (options->prettyPrint) {
+      write('\n');
+      ++_indentation;
+    }
+  }
+
+  void closeContainer(char c) {
+    if (options->prettyPrint) {
+      --_indentation;
+      indent();
+    }
+    write(c);
+  }
+
   void indent() {
     std::size_t n = _indentation;
-    _sink->reserve(2 * n);
     for (std::size_t i = 0; i < n; ++i) {
-      _sink->append("  ", 2);
+      write("  ", 2);
     }
   }
 
   void handleUnsupportedType(Slice const* slice) {
     if (options->unsupportedTypeBehavior == Options::NullifyUnsupportedType) {
-      _sink->append("null", 4);
+      write("null", 4);
       return;
     } else if (options->unsupportedTypeBehavior == Options::ConvertUnsupportedType) {
-      _sink->append(std::string("\"(non-representable type ") + slice->typeName() + ")\"");
+      write("\"(non-representable type ", 25);
+      char const* name = slice->typeName();
+      write(name, std::strlen(name));
+      write(")\"", 2);
       return;
     }
 
@@ -151,6 +303,11 @@ class Dumper {
   Sink* _sink;
 
   int _indentation;
+
+  // number of characters currently held in the staging buffer
+  std::size_t _pos;
+
+  char _buffer[bufferSize];
 };
 
 }  // namespace arangodb::velocypack
@@ -41,6 +41,7 @@ class Exception : public virtual std::exception {
   enum ExceptionType {
     InternalError = 1,
     NotImplemented = 2,
+    IoError = 3,
 
     NoJsonEquivalent = 10,
     ParseError = 11,
@@ -97,6 +98,8 @@ class Exception : public virtual std::exception {
         return "Internal error";
       case NotImplemented:
         return "Not implemented";
+      case IoError:
+        return "I/O error";
       case NoJsonEquivalent:
         return "Type has no equivalent in JSON";
       case ParseError:
@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef VELOCYPACK_FILEDESCRIPTORSINK_H
+#define VELOCYPACK_FILEDESCRIPTORSINK_H 1
+
+#ifndef _WIN32
+
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Sink.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// A Sink that writes to a POSIX file descriptor, e.g. a file, a pipe or a
+// socket. Output is collected in a staging buffer of bufferSize bytes, and
+// the buffer is written to the file descriptor once it is full. Appends
+// that do not fit into the buffer are written together with the staged
+// data in a single writev() call, without copying them. With
+// writeInBackground, full buffers are written by a background thread while
+// the next buffer is filled.
+// Output is only guaranteed to be written after flush(). The destructor
+// flushes, but cannot report errors. Write errors throw an Exception of
+// type IoError, and all later writes to the sink will fail. The file
+// descriptor is not closed by the sink.
+class FileDescriptorSink final : public Sink {
+ public:
+  static constexpr std::size_t defaultBufferSize = 1024 * 1024;
+
+  explicit FileDescriptorSink(int fd,
+                              std::size_t bufferSize = defaultBufferSize,
+                              bool writeInBackground = false);
+
+  ~FileDescriptorSink();
+
+  void push_back(char c) override final {
+    if (VELOCYPACK_UNLIKELY(_length == _bufferSize)) {
+      writeBuffer();
+    }
+    _buffer[_length++] = c;
+  }
+
+  void append(std::string const& p) override final {
+    append(p.data(), p.size());
+  }
+
+  void append(char const* p) override final { append(p, strlen(p)); }
+
+  void append(char const* p, ValueLength len) override final {
+    if (VELOCYPACK_LIKELY(len <= _bufferSize - _length)) {
+      memcpy(_buffer + _length, p, checkOverflow(len));
+      _length += static_cast<std::size_t>(len);
+    } else {
+      appendLarge(p, len);
+    }
+  }
+
+  void reserve(ValueLength) override final {}
+
+  // writes all output to the file descriptor, waiting for the background
+  // thread if there is one
+  void flush();
+
+  int fd() const noexcept { return _fd; }
+
+  std::size_t bufferSize() const noexcept { return _bufferSize; }
+
+  bool writeInBackground() const noexcept { return _writeInBackground; }
+
+  // number of bytes appended to the sink so far
+  ValueLength length() const noexcept { return _written + _length; }
+
+ private:
+  void appendLarge(char const* p, ValueLength len);
+
+  // hands the full staging buffer over for writing
+  void writeBuffer();
+
+  // writes the staged data followed by len bytes at p, which may be empty
+  void writeDirect(char const* p, ValueLength len);
+
+  void waitForBackground();
+
+  void runBackground();
+
+ private:
+  int const _fd;
+
+  std::size_t const _bufferSize;
+
+  bool const _writeInBackground;
+
+  std::unique_ptr<char[]> _buffers[2];
+
+  // the staging buffer currently being filled, and its fill level
+  char* _buffer;
+
+  std::size_t _length;
+
+  // number of bytes that have left the staging buffer
+  ValueLength _written;
+
+  // errno of the first failed write, 0 if none failed
+  int _error;
+
+  // state shared with the background thread
+  std::mutex _mutex;
+
+  std::condition_variable _condition;
+
+  char const* _pending;
+
+  std::size_t _pendingLength;
+
+  bool _stopping;
+
+  std::thread _thread;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
+
+#endif
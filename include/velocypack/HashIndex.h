@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef VELOCYPACK_HASHINDEX_H
+#define VELOCYPACK_HASHINDEX_H 1
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Builder.h"
+#include "velocypack/CompiledPath.h"
+#include "velocypack/Slice.h"
+#include "velocypack/StringRef.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// A HashIndex maps the values of a key path to the documents of an Array
+// (or of a vector of document Slices) that contain them, so that point
+// lookups do not need to scan all documents. Keys are hashed and compared
+// like in NormalizedCompare::equalsAnyType, so keys of types such as
+// UTCDate or Binary are compared on the binary level. Documents for which
+// the path does not exist are not indexed. Multiple documents may have the
+// same key.
+//
+// The index does not contain copies of the documents or keys, only their
+// hash values and locations: byte offsets for an Array, positions for a
+// vector of Slices. The data itself must be passed to all lookups. The
+// index is kept as a VPack Binary value, which can be stored next to the
+// data with slice() and used again later without any deserialization
+// with fromBinary(), e.g. from memory-mapped storage. fromBinary() checks
+// the structure of the index, but cannot check that the locations point
+// to the starts of documents, so only trusted index data may be loaded.
+//
+// The Binary value contains (all integers are little endian):
+//   magic "VPHI" (4 bytes), format version (1 byte), kind (1 byte, 0 for
+//   an Array and 1 for a vector), hash function (1 byte, 1 for xxhash and
+//   2 for fasthash, see HashType in CMakeLists.txt), 1 reserved byte,
+//   number of indexed documents (8 bytes), number of slots (8 bytes, a
+//   power of two), byte size of the Array or number of documents in the
+//   vector (8 bytes), length of the path (8 bytes), the path as returned
+//   by CompiledPath::toString() (padded with zeros to a multiple of 8
+//   bytes), and the slots: 8 bytes hash value and 8 bytes location each.
+//   A location of 0 marks an empty slot, so locations in vectors are
+//   stored as position + 1. Indexes can only be loaded by builds that use
+//   the same hash function.
+class HashIndex {
+ public:
+  // builds an index over the documents of an Array. throws
+  // Exception::InvalidValueType if array is not an Array
+  HashIndex(Slice array, CompiledPath const& path);
+
+  // builds an index over a vector of documents
+  HashIndex(std::vector<Slice> const& documents, CompiledPath const& path);
+
+  // uses an index that was previously stored as a VPack Binary value. the
+  // index's data is not copied and must stay valid while the index is
+  // used. throws Exception::InvalidValueType if the value is not a valid
+  // index or was built with a different hash function
+  static HashIndex fromBinary(Slice binary);
+
+  // the index as a VPack Binary value
+  Slice slice() const { return _owned ? _builder.slice() : _external; }
+
+  CompiledPath const& path() const noexcept { return _path; }
+
+  // number of indexed documents
+  ValueLength size() const;
+
+  // whether or not the index was built over a vector of documents
+  bool isPositional() const;
+
+  // returns the first document (in the order of the input) with the key,
+  // or a None Slice if there is none. the data must be the same as the
+  // one the index was built for. throws Exception::InvalidValueType if
+  // the kind of data does not match
+  Slice find(Slice array, Slice key) const;
+  Slice find(std::vector<Slice> const& documents, Slice key) const;
+
+  // as above, for String keys
+  Slice find(Slice array, StringRef key) const;
+  Slice find(std::vector<Slice> const& documents, StringRef key) const;
+
+  // appends all documents with the key to result, in the order of the
+  // input. returns the number of documents found
+  ValueLength findAll(Slice array, Slice key, std::vector<Slice>& result) const;
+  ValueLength findAll(std::vector<Slice> const& documents, Slice key,
+                      std::vector<Slice>& result) const;
+
+ private:
+  HashIndex() = default;
+
+  void build(std::vector<std::pair<uint64_t, uint64_t>> const& entries,
+             uint8_t kind, uint64_t dataSize);
+
+  // calls found(document) for all documents with the key, until it
+  // returns false. resolve(location) returns the document at a location
+  template <typename R, typename F>
+  void lookup(Slice key, uint8_t kind, uint64_t dataSize, R const& resolve,
+              F const& found) const;
+
+  // start of the Binary value's payload
+  uint8_t const* data() const;
+
+  // the index's data is owned by _builder, unless the index was created
+  // by fromBinary()
+  bool _owned = false;
+  Builder _builder;
+  Slice _external;
+  CompiledPath _path;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
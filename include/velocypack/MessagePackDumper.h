@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef VELOCYPACK_MESSAGEPACKDUMPER_H
+#define VELOCYPACK_MESSAGEPACKDUMPER_H 1
+
+#include <cstring>
+#include <string>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Options.h"
+#include "velocypack/Sink.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// Converts VPack into MessagePack (https://msgpack.org), writing the
+// output to a Sink while the value is traversed.
+// Null, Bool, Double, integers, String, Binary, Array and Object are mapped
+// to the MessagePack type of the same name, using the smallest encoding
+// for integers, strings and containers. Doubles are always written as
+// float64. UTCDate values are written as timestamps (extension type -1).
+// Object keys are translated if an AttributeTranslator is set. All other
+// types are handled as configured in Options::unsupportedTypeBehavior.
+// Values converted into strings or null cannot be converted back.
+class MessagePackDumper {
+ public:
+  Options const* options;
+
+  MessagePackDumper(MessagePackDumper const&) = delete;
+  MessagePackDumper& operator=(MessagePackDumper const&) = delete;
+
+  explicit MessagePackDumper(Sink* sink,
+                             Options const* options = &Options::Defaults)
+      : options(options), _sink(sink), _pos(0) {
+    if (VELOCYPACK_UNLIKELY(sink == nullptr)) {
+      throw Exception(Exception::InternalError, "Sink cannot be a nullptr");
+    }
+    if (VELOCYPACK_UNLIKELY(options == nullptr)) {
+      throw Exception(Exception::InternalError, "Options cannot be a nullptr");
+    }
+  }
+
+  Sink* sink() const { return _sink; }
+
+  void dump(Slice const& slice) {
+    try {
+      dumpValue(&slice);
+    } catch (...) {
+      flush();
+      throw;
+    }
+    flush();
+  }
+
+  void dump(Slice const* slice) { dump(*slice); }
+
+  static void dump(Slice const& slice, Sink* sink,
+                   Options const* options = &Options::Defaults) {
+    MessagePackDumper dumper(sink, options);
+    dumper.dump(slice);
+  }
+
+  // returns the MessagePack for the slice as a (binary) string
+  static std::string toString(Slice const& slice,
+                              Options const* options = &Options::Defaults) {
+    std::string buffer;
+    StringSink sink(&buffer);
+    dump(slice, &sink, options);
+    return buffer;
+  }
+
+ private:
+  // size of the staging buffer
+  static constexpr std::size_t bufferSize = 4096;
+
+  inline void write(uint8_t c) {
+    if (VELOCYPACK_UNLIKELY(_pos == bufferSize)) {
+      flush();
+    }
+    _buffer[_pos++] = static_cast<char>(c);
+  }
+
+  inline void write(char const* p, std::size_t len) {
+    if (VELOCYPACK_UNLIKELY(len > bufferSize - _pos)) {
+      flush();
+      if (len >= bufferSize) {
+        _sink->append(p, static_cast<ValueLength>(len));
+        return;
+      }
+    }
+    std::memcpy(&_buffer[_pos], p, len);
+    _pos += len;
+  }
+
+  // writes the N lowest bytes of value in big-endian order
+  template <std::size_t N>
+  inline void writeBigEndian(uint64_t value) {
+    if (VELOCYPACK_UNLIKELY(N > bufferSize - _pos)) {
+      flush();
+    }
+    for (std::size_t i = N; i > 0; --i) {
+      _buffer[_pos++] = static_cast<char>((value >> (8 * (i - 1))) & 0xffU);
+    }
+  }
+
+  template <std::size_t N>
+  inline void writeHead(uint8_t head, uint64_t value) {
+    write(head);
+    writeBigEndian<N>(value);
+  }
+
+  void flush() {
+    if (_pos > 0) {
+      _sink->append(&_buffer[0], static_cast<ValueLength>(_pos));
+      _pos = 0;
+    }
+  }
+
+  void dumpValue(Slice const*);
+
+  void dumpUInt(uint64_t);
+
+  void dumpInt(int64_t);
+
+  // writes the head of a string, binary, array or map with the given
+  // number of bytes or members. fixHead is used for lengths below
+  // fixLimit, head8 (if not 0) for lengths up to 255, head16 for lengths
+  // up to 65535 and head16 + 1 for 32 bit lengths
+  void dumpLength(ValueLength length, uint8_t fixHead, ValueLength fixLimit,
+                  uint8_t head8, uint8_t head16);
+
+  void dumpString(char const*, ValueLength);
+
+  void dumpUTCDate(int64_t);
+
+  void handleUnsupportedType(Slice const*);
+
+ private:
+  Sink* _sink;
+
+  // number of bytes currently held in the staging buffer
+  std::size_t _pos;
+
+  char _buffer[bufferSize];
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
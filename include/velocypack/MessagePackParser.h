@@ -0,0 +1,162 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef VELOCYPACK_MESSAGEPACKPARSER_H
+#define VELOCYPACK_MESSAGEPACKPARSER_H 1
+
+#include <memory>
+#include <string>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Options.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// Converts MessagePack (https://msgpack.org) into VPack, adding the values
+// to a Builder while the input is decoded.
+// nil, booleans, integers, floats, strings, binaries, arrays and maps are
+// mapped to the VPack type of the same name. Timestamps (extension type
+// -1) are converted into UTCDate values with millisecond precision. Map
+// keys must be strings, and other extension types are not supported.
+// Strings are validated if Options::validateUtf8Strings is set. Errors
+// throw Exception::ParseError, and errorPos() returns the position of the
+// value that caused the error.
+class MessagePackParser {
+ public:
+  Options const* options;
+
+  MessagePackParser(MessagePackParser const&) = delete;
+  MessagePackParser& operator=(MessagePackParser const&) = delete;
+
+  explicit MessagePackParser(Options const* options = &Options::Defaults);
+
+  // adds the parsed values to builder, which may have an open Array or
+  // Object
+  explicit MessagePackParser(Builder& builder,
+                             Options const* options = &Options::Defaults);
+
+  static std::shared_ptr<Builder> fromMessagePack(
+      uint8_t const* start, std::size_t size,
+      Options const* options = &Options::Defaults) {
+    MessagePackParser parser(options);
+    parser.parse(start, size);
+    return parser.steal();
+  }
+
+  static std::shared_ptr<Builder> fromMessagePack(
+      std::string const& data, Options const* options = &Options::Defaults) {
+    return fromMessagePack(reinterpret_cast<uint8_t const*>(data.data()),
+                           data.size(), options);
+  }
+
+  // parses a single value, or with multi, a sequence of values following
+  // each other, and returns the number of values parsed
+  ValueLength parse(uint8_t const* start, std::size_t size,
+                    bool multi = false);
+
+  ValueLength parse(char const* start, std::size_t size, bool multi = false) {
+    return parse(reinterpret_cast<uint8_t const*>(start), size, multi);
+  }
+
+  ValueLength parse(std::string const& data, bool multi = false) {
+    return parse(data.data(), data.size(), multi);
+  }
+
+  Builder const& builder() const { return *_builderPtr; }
+
+  // the parser cannot be used anymore after steal()
+  std::shared_ptr<Builder> steal() {
+    std::shared_ptr<Builder> res(_builder);
+    _builder.reset();
+    _builderPtr = nullptr;
+    return res;
+  }
+
+  // the position of the value that caused the last error
+  std::size_t errorPos() const { return _valuePos; }
+
+ private:
+  // throws if fewer than n bytes are left
+  inline void need(std::size_t n) const {
+    if (VELOCYPACK_UNLIKELY(n > _size - _pos)) {
+      throw Exception(Exception::ParseError,
+                      "Unexpected end of MessagePack input");
+    }
+  }
+
+  // reads a big-endian unsigned integer of N bytes
+  template <std::size_t N>
+  inline uint64_t readUInt() {
+    need(N);
+    uint64_t value = 0;
+    for (std::size_t i = 0; i < N; ++i) {
+      value = (value << 8) | _start[_pos + i];
+    }
+    _pos += N;
+    return value;
+  }
+
+  // adds a value to the Builder, as the value for the pending map key if
+  // there is one
+  template <typename T>
+  inline void add(T const& value) {
+    if (_key == nullptr) {
+      _builderPtr->add(value);
+    } else {
+      char const* key = _key;
+      _key = nullptr;
+      _builderPtr->add(key, _keyLength, value);
+    }
+  }
+
+  void parseValue();
+
+  void parseString(std::size_t length);
+
+  void parseArray(std::size_t length);
+
+  void parseMap(std::size_t length);
+
+  void parseExtension(std::size_t length);
+
+ private:
+  std::shared_ptr<Builder> _builder;
+  Builder* _builderPtr;
+  uint8_t const* _start;
+  std::size_t _size;
+  std::size_t _pos;
+  std::size_t _valuePos;
+  // the key of a map entry whose value is parsed next
+  char const* _key;
+  std::size_t _keyLength;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
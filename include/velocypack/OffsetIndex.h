@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef VELOCYPACK_OFFSETINDEX_H
+#define VELOCYPACK_OFFSETINDEX_H 1
+
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// An OffsetIndex provides random access to the members of an Array or
+// Object. Compact Arrays and Objects (0x13 and 0x14) have no index table,
+// so Slice::at() has to walk over all preceding members and iterating by
+// position is quadratic. The OffsetIndex collects the member offsets of
+// such values lazily in a single pass on first access, and serves all
+// further lookups from this side table. The underlying data is not
+// modified. For all other Array and Object types the lookups are passed
+// through to the Slice, which can already access members directly.
+//
+// The OffsetIndex does not own the Slice's data, which must stay valid
+// while the index is used. Building the index is not thread-safe.
+class OffsetIndex {
+ public:
+  // throws Exception::InvalidValueType if the slice is neither an Array
+  // nor an Object
+  explicit OffsetIndex(Slice slice);
+
+  OffsetIndex(OffsetIndex const&) = default;
+  OffsetIndex(OffsetIndex&&) = default;
+  OffsetIndex& operator=(OffsetIndex const&) = default;
+  OffsetIndex& operator=(OffsetIndex&&) = default;
+
+  Slice slice() const noexcept { return _slice; }
+
+  // number of members of the Array or Object
+  ValueLength length() const noexcept { return _length; }
+
+  // whether or not the slice is a compact Array or Object, for which
+  // the side table is used
+  bool isCompact() const noexcept { return _compact; }
+
+  // whether or not the side table has been built already
+  bool isBuilt() const noexcept { return _built; }
+
+  // builds the side table right away instead of on first access
+  void build() const {
+    if (!_built) {
+      buildOffsets();
+    }
+  }
+
+  // return the offset of the nth member (for Objects: of its key),
+  // relative to the start of the slice
+  ValueLength getNthOffset(ValueLength index) const {
+    if (!_compact) {
+      return _slice.getNthOffset(index);
+    }
+    if (VELOCYPACK_UNLIKELY(index >= _length)) {
+      throw Exception(Exception::IndexOutOfBounds);
+    }
+    build();
+    return _offsets[static_cast<std::size_t>(index)];
+  }
+
+  // extract the nth member from an Array
+  Slice at(ValueLength index) const {
+    if (VELOCYPACK_UNLIKELY(!_slice.isArray())) {
+      throw Exception(Exception::InvalidValueType, "Expecting type Array");
+    }
+    return Slice(_slice.start() + getNthOffset(index));
+  }
+
+  Slice operator[](ValueLength index) const { return at(index); }
+
+  // extract the nth key from an Object
+  Slice keyAt(ValueLength index, bool translate = true) const {
+    Slice key = nthKey(index);
+    if (translate) {
+      return key.makeKey();
+    }
+    return key;
+  }
+
+  // extract the nth value from an Object
+  Slice valueAt(ValueLength index) const {
+    Slice key = nthKey(index);
+    return Slice(key.start() + key.byteSize());
+  }
+
+ private:
+  Slice nthKey(ValueLength index) const {
+    if (VELOCYPACK_UNLIKELY(!_slice.isObject())) {
+      throw Exception(Exception::InvalidValueType, "Expecting type Object");
+    }
+    return Slice(_slice.start() + getNthOffset(index));
+  }
+
+  void buildOffsets() const;
+
+ private:
+  Slice _slice;
+  ValueLength _length;
+  bool _compact;
+  mutable bool _built;
+  mutable std::vector<ValueLength> _offsets;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
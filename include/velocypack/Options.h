@@ -36,6 +36,7 @@ namespace velocypack {
 class AttributeTranslator;
 class Dumper;
 struct Options;
+class Projection;
 class Slice;
 
 struct CustomTypeHandler {
@@ -68,6 +69,24 @@ struct Options {
   // allow building Objects without index table?
   bool buildUnindexedObjects = false;
 
+  // build values in canonical encoding with Builder (and Parser), so that
+  // values that NormalizedCompare considers equal are byte-identical and
+  // can be compared with CanonicalCompare. Slices carry no flag for this,
+  // so callers must ensure that both sides of a comparison were built
+  // canonically. In canonical encoding, Arrays with equally sized members
+  // use 0x02 - 0x05 without an index table, other Arrays and Objects have
+  // index tables, except for one-member Objects, which use 0x14.
+  // Object members are stored in key order, keys are not translated,
+  // integral Doubles become integers, non-negative integers are UInts and
+  // Externals are resolved. Added Slices are converted, too. The options
+  // buildUnindexedArrays, buildUnindexedObjects and attributeTranslator are
+  // ignored, and duplicate Object keys throw DuplicateAttributeName
+  bool buildCanonical = false;
+
+  // only dump the parts of Arrays and Objects selected by the projection
+  // when dumping with Dumper. the projection is not owned by the Options
+  Projection const* projection = nullptr;
+
   // pretty-print JSON output when dumping with Dumper
   bool prettyPrint = false;
 
@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef VELOCYPACK_PARALLELDUMPER_H
+#define VELOCYPACK_PARALLELDUMPER_H 1
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Dumper.h"
+#include "velocypack/Options.h"
+#include "velocypack/Sink.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb {
+namespace velocypack {
+class ArrayIterator;
+class ObjectIterator;
+
+// Dumps large VPack values into JSON using a pool of worker threads.
+// Arrays and Objects of at least chunkSize bytes are split into ranges of
+// members. Each range is dumped into a buffer of its own by one of the
+// workers, and the buffers are written to the sink in order. Members that
+// are large Arrays or Objects themselves are split the same way. The output
+// is the same as the output of Dumper with the same Options, including
+// prettyPrint indentation.
+// Values smaller than chunkSize, and all values if the Options have a
+// projection or a customTypeHandler (which need not be thread-safe), are
+// dumped by the calling thread. dump() may be called from
+// multiple threads at the same time, which will then share the worker
+// pool. If dumping fails, the output of all ranges before the failing one
+// has been written to the sink when the exception is rethrown.
+class ParallelDumper {
+ public:
+  Options const* options;
+
+  ParallelDumper(ParallelDumper const&) = delete;
+  ParallelDumper& operator=(ParallelDumper const&) = delete;
+
+  // creates the worker pool. threads == 0 uses one thread per hardware
+  // thread
+  explicit ParallelDumper(Options const* options = &Options::Defaults,
+                          std::size_t threads = 0,
+                          ValueLength chunkSize = 1024 * 1024);
+
+  ~ParallelDumper();
+
+  std::size_t threads() const { return _workers.size(); }
+
+  ValueLength chunkSize() const { return _chunkSize; }
+
+  void dump(Slice const& slice, Sink* sink);
+
+  void dump(Slice const* slice, Sink* sink) { dump(*slice, sink); }
+
+  std::string toString(Slice const& slice) {
+    std::string buffer;
+    StringSink sink(&buffer);
+    dump(slice, &sink);
+    return buffer;
+  }
+
+  std::string toString(Slice const* slice) { return toString(*slice); }
+
+ private:
+  // a piece of the output, either literal text produced while splitting
+  // or the output of a range of members, which is ready once done is
+  struct Segment {
+    std::string output;
+    std::future<void> done;
+  };
+
+  void split(Dumper& planner, std::string& literal, Slice const* value,
+             std::deque<Segment>& segments);
+
+  void addLiteral(Dumper& planner, std::string& literal,
+                  std::deque<Segment>& segments);
+
+  template <typename Iterator>
+  void addRange(Dumper& planner, std::string& literal, Iterator const& it,
+                ValueLength count, Slice const* base,
+                std::deque<Segment>& segments);
+
+  static void dumpRange(Options const* options, ArrayIterator it,
+                        ValueLength count, Slice base, int indentation,
+                        std::string* output);
+
+  static void dumpRange(Options const* options, ObjectIterator it,
+                        ValueLength count, Slice base, int indentation,
+                        std::string* output);
+
+  void work();
+
+  // stops the workers and waits for them to finish
+  void stop();
+
+ private:
+  ValueLength const _chunkSize;
+
+  std::vector<std::thread> _workers;
+
+  std::mutex _mutex;
+
+  std::condition_variable _condition;
+
+  std::deque<std::function<void()>> _queue;
+
+  bool _stopping;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
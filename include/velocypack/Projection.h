@@ -0,0 +1,163 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef VELOCYPACK_PROJECTION_H
+#define VELOCYPACK_PROJECTION_H 1
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/CompiledPath.h"
+#include "velocypack/Slice.h"
+#include "velocypack/StringRef.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// A Projection selects parts of VPack values by a set of CompiledPaths,
+// e.g. "name", "address.city" or "$.items[*].price". With Mode::Include,
+// only the selected parts are kept, with Mode::Exclude, everything but the
+// selected parts is kept. Containers on the way to a selected part are
+// kept in both modes, with their other members removed or kept. Wildcards
+// match all members of Arrays and all attributes of Objects, array indexes
+// match the member at that position. Paths must not be empty and must not
+// contain negative array indexes.
+//
+// The paths are compiled into a deterministic state machine once, so that
+// a Dumper can apply the Projection while writing the output, by looking
+// up each attribute name or array index only once (see
+// Options::projection).
+class Projection {
+ public:
+  enum class Mode : uint8_t { Include, Exclude };
+
+  // what to do with a member of a container, see action()
+  enum class Action : uint8_t {
+    Skip,     // leave out the member
+    Dump,     // output the member unchanged
+    Project   // output the member, applying the projection to its members
+  };
+
+  // a position in the state machine
+  typedef uint32_t State;
+
+  // the state of members not matched by any path
+  static constexpr State noMatch = UINT32_MAX;
+
+  // throws Exception::InvalidAttributePath for empty paths and paths with
+  // negative array indexes
+  explicit Projection(std::vector<CompiledPath> const& paths,
+                      Mode mode = Mode::Include);
+
+  // compiles each of the expressions into a CompiledPath
+  explicit Projection(std::vector<std::string> const& expressions,
+                      Mode mode = Mode::Include);
+
+  Mode mode() const noexcept { return _mode; }
+
+  // the state for the members of the top-level value
+  State start() const noexcept { return 0; }
+
+  // the state for the value of attribute name in an Object in state
+  State attribute(State state, StringRef const& name) const {
+    auto const& transitions = _states[state].attributes;
+    auto it = std::lower_bound(
+        transitions.begin(), transitions.end(), name,
+        [](std::pair<std::string, State> const& t, StringRef const& n) {
+          return n.compare(t.first) > 0;
+        });
+    if (it != transitions.end() && name.equals(StringRef(it->first))) {
+      return it->second;
+    }
+    return _states[state].other;
+  }
+
+  // the state for the value of an Object attribute that has no name, i.e.
+  // that can only be matched by a wildcard
+  State otherAttribute(State state) const noexcept {
+    return _states[state].other;
+  }
+
+  // the state for the member at position index in an Array in state
+  State index(State state, ValueLength index) const {
+    auto const& transitions = _states[state].indexes;
+    auto it = std::lower_bound(
+        transitions.begin(), transitions.end(), index,
+        [](std::pair<ValueLength, State> const& t, ValueLength i) {
+          return t.first < i;
+        });
+    if (it != transitions.end() && it->first == index) {
+      return it->second;
+    }
+    return _states[state].other;
+  }
+
+  // what to do with a container member with the given value, for which
+  // attribute() or index() returned state
+  Action action(State state, Slice value) const {
+    bool const include = (_mode == Mode::Include);
+    if (state == noMatch) {
+      return include ? Action::Skip : Action::Dump;
+    }
+    if (_states[state].selected) {
+      return include ? Action::Dump : Action::Skip;
+    }
+    // a path continues below this member
+    value = value.resolveExternals();
+    if (value.isObject() || value.isArray()) {
+      return Action::Project;
+    }
+    return include ? Action::Skip : Action::Dump;
+  }
+
+ private:
+  struct StateInfo {
+    StateInfo() : selected(false), other(noMatch) {}
+
+    // whether a path ends here
+    bool selected;
+    // sorted by attribute name and index
+    std::vector<std::pair<std::string, State>> attributes;
+    std::vector<std::pair<ValueLength, State>> indexes;
+    // the state for all other attributes and indexes, set by wildcards
+    State other;
+  };
+
+  void compile(std::vector<CompiledPath> const& paths);
+
+ private:
+  Mode const _mode;
+
+  std::vector<StateInfo> _states;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
@@ -27,12 +27,14 @@
 #ifndef VELOCYPACK_SINK_H
 #define VELOCYPACK_SINK_H 1
 
+#include <cstring>
 #include <string>
 #include <fstream>
 #include <sstream>
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Buffer.h"
+#include "velocypack/Exception.h"
 
 namespace arangodb {
 namespace velocypack {
@@ -100,6 +102,43 @@ struct StringSinkImpl final : public Sink {
 
 typedef StringSinkImpl<std::string> StringSink;
 
+// writes into memory of a fixed size provided by the caller, e.g. memory
+// sized with Dumper::outputLength(). throws if the output does not fit
+struct CharArraySink final : public Sink {
+  CharArraySink(char* data, ValueLength size)
+      : data(data), size(size), length(0) {}
+
+  void push_back(char c) override final {
+    checkSpace(1);
+    data[length++] = c;
+  }
+
+  void append(std::string const& p) override final {
+    append(p.data(), p.size());
+  }
+
+  void append(char const* p) override final { append(p, strlen(p)); }
+
+  void append(char const* p, ValueLength len) override final {
+    checkSpace(len);
+    memcpy(data + length, p, checkOverflow(len));
+    length += len;
+  }
+
+  void reserve(ValueLength) override final {}
+
+  char* data;
+  ValueLength size;
+  ValueLength length;
+
+ private:
+  void checkSpace(ValueLength len) const {
+    if (VELOCYPACK_UNLIKELY(len > size - length)) {
+      throw Exception(Exception::IndexOutOfBounds, "CharArraySink is full");
+    }
+  }
+};
+
 template <typename T>
 struct StreamSinkImpl final : public Sink {
   explicit StreamSinkImpl(T* stream) : stream(stream) {}
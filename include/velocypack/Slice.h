@@ -34,6 +34,7 @@
 #include <iosfwd>
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include <type_traits>
 
 #include "velocypack/velocypack-common.h"
@@ -0,0 +1,218 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_TRAVERSAL_H
+#define VELOCYPACK_TRAVERSAL_H 1
+
+#include <utility>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// A Traversal visits all (nested) members of an Array or Object. It does
+// not recurse but keeps the iterators of all enclosing values on an
+// explicit stack, so arbitrarily deep nesting cannot overflow the native
+// stack. The stack and the path are kept between calls to visit(), so a
+// Traversal that is reused for many documents does not allocate anymore
+// once it has seen the maximum nesting depth.
+//
+// The callback is invoked as callback(key, value, path) for each member,
+// with key being the attribute name for Object members and a None slice
+// for Array members. Object keys are produced by Slice::makeKey(), so
+// integer keys have already been translated into their String names via
+// the attribute translator. path contains one entry for each enclosing
+// member, the last entry being the current member itself. The callback
+// must return one of the Actions below.
+//
+// A Traversal must not be used by multiple threads at the same time, and
+// visit() must not be called again from inside its own callback.
+class Traversal {
+ public:
+  enum Action {
+    Continue = 0,  // go on with the traversal
+    Skip = 1,      // do not visit the members of the current value
+    Stop = 2       // abort the traversal
+  };
+
+  enum Order {
+    // the callback is invoked for a value before its members are visited.
+    // in this order, Skip prevents the descent into the value
+    ValueFirst = 1,
+    // the callback is invoked for a value after its members have been
+    // visited. Skip is treated like Continue in this order
+    MembersFirst = 2
+  };
+
+  struct PathEntry {
+    PathEntry(Slice key, ValueLength index) noexcept
+        : key(key), index(index) {}
+
+    // translated attribute name (see makeKey()) for Object members, None
+    // for Array members
+    Slice key;
+    // position of the member in its enclosing Array or Object
+    ValueLength index;
+  };
+
+  typedef std::vector<PathEntry> Path;
+
+  Traversal() = default;
+  Traversal(Traversal const&) = delete;
+  Traversal& operator=(Traversal const&) = delete;
+
+  // visits all members of slice, which must be an Array or an Object
+  // (throws Exception::InvalidValueType otherwise). the top-level slice
+  // itself is not passed to the callback. returns false if the traversal
+  // was aborted by the callback returning Stop, and true otherwise
+  template <typename F>
+  bool visit(Slice const& slice, Order order, F&& callback) {
+    if (!slice.isObject() && !slice.isArray()) {
+      throw Exception(Exception::InvalidValueType,
+                      "Expecting type Object or Array");
+    }
+
+    _stack.clear();
+    _path.clear();
+    _stack.emplace_back(slice);
+
+    while (!_stack.empty()) {
+      Frame& frame = _stack.back();
+
+      if (frame.descended) {
+        // all members of the current member have been visited
+        frame.descended = false;
+        if (order == MembersFirst) {
+          Slice key, value;
+          frame.current(key, value);
+          if (callback(key, value, static_cast<Path const&>(_path)) == Stop) {
+            return false;
+          }
+        }
+        _path.pop_back();
+        frame.next();
+        continue;
+      }
+
+      if (!frame.valid()) {
+        _stack.pop_back();
+        continue;
+      }
+
+      Slice key, value;
+      frame.current(key, value);
+      _path.emplace_back(key, frame.index());
+      bool const isCompound = (value.isObject() || value.isArray());
+
+      if (order == ValueFirst) {
+        Action action = callback(key, value, static_cast<Path const&>(_path));
+        if (action == Stop) {
+          return false;
+        }
+        if (isCompound && action != Skip) {
+          // note: frame must not be used after the push, which may
+          // reallocate the stack
+          frame.descended = true;
+          _stack.emplace_back(value);
+          continue;
+        }
+      } else if (isCompound) {
+        frame.descended = true;
+        _stack.emplace_back(value);
+        continue;
+      } else if (callback(key, value, static_cast<Path const&>(_path)) == Stop) {
+        return false;
+      }
+
+      _path.pop_back();
+      frame.next();
+    }
+
+    return true;
+  }
+
+  template <typename F>
+  bool visit(Slice const* slice, Order order, F&& callback) {
+    return visit(*slice, order, std::forward<F>(callback));
+  }
+
+ private:
+  // iteration state for one Array or Object. only one of the iterators is
+  // used, the other one is positioned on an empty value
+  struct Frame {
+    explicit Frame(Slice value)
+        : arrayIt(value.isObject() ? Slice::emptyArraySlice() : value),
+          objectIt(value.isObject() ? value : Slice::emptyObjectSlice()),
+          isObject(value.isObject()),
+          descended(false) {}
+
+    bool valid() const noexcept {
+      return isObject ? objectIt.valid() : arrayIt.valid();
+    }
+
+    ValueLength index() const noexcept {
+      return isObject ? objectIt.index() : arrayIt.index();
+    }
+
+    void current(Slice& key, Slice& value) const {
+      if (isObject) {
+        auto pair = *objectIt;
+        key = pair.key;
+        value = pair.value;
+      } else {
+        key = Slice();
+        value = arrayIt.value();
+      }
+    }
+
+    void next() {
+      if (isObject) {
+        objectIt.next();
+      } else {
+        arrayIt.next();
+      }
+    }
+
+    ArrayIterator arrayIt;
+    ObjectIterator objectIt;
+    bool isObject;
+    // whether or not the members of the current member are being visited
+    bool descended;
+  };
+
+  std::vector<Frame> _stack;
+  Path _path;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
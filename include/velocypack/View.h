@@ -0,0 +1,315 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef VELOCYPACK_VIEW_H
+#define VELOCYPACK_VIEW_H 1
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// Views are lazy sequences of Slices. They are created from an Array
+// (ArrayView) or from the values of an Object (ObjectValuesView), and can
+// be composed with filter(), map(), range() and concat(). Composing views
+// does not copy or build anything: all stages are only run when the view
+// is iterated with forEach(), and the Slices handed out point into the
+// original data, which must stay valid while the view is used. A view can
+// be materialized into an Array with toBuilder() at the end of a pipeline.
+//
+// Views are cheap to copy. They hold their source views and functions by
+// value, so a pipeline can be returned from a function or stored. Each
+// forEach() runs the whole pipeline again.
+//
+// All views provide
+//   template <typename F> bool forEach(F&& callback) const
+// which calls callback(Slice const&) for each member, until the callback
+// returns false. forEach() returns false if it was aborted that way.
+
+template <typename Source, typename F>
+class FilterView;
+template <typename Source, typename F>
+class MapView;
+template <typename Source>
+class RangeView;
+template <typename First, typename Second>
+class ConcatView;
+
+template <typename Derived>
+class View {
+ public:
+  // members for which predicate(Slice const&) returns true
+  template <typename F>
+  FilterView<Derived, typename std::decay<F>::type> filter(F&& predicate) const {
+    return FilterView<Derived, typename std::decay<F>::type>(self(), std::forward<F>(predicate));
+  }
+
+  // the results of func(Slice const&) for all members. func must return
+  // a Slice, e.g. a sub-value of the member
+  template <typename F>
+  MapView<Derived, typename std::decay<F>::type> map(F&& func) const {
+    return MapView<Derived, typename std::decay<F>::type>(self(), std::forward<F>(func));
+  }
+
+  // at most limit members, starting with the member at position offset
+  RangeView<Derived> range(ValueLength offset,
+                           ValueLength limit = (std::numeric_limits<ValueLength>::max)()) const {
+    return RangeView<Derived>(self(), offset, limit);
+  }
+
+  // all members of this view, followed by all members of other
+  template <typename Other>
+  ConcatView<Derived, Other> concat(Other const& other) const {
+    return ConcatView<Derived, Other>(self(), other);
+  }
+
+  // number of members. this iterates over the view, unless the number is
+  // known upfront
+  ValueLength length() const {
+    ValueLength count = 0;
+    self().forEach([&count](Slice const&) {
+      ++count;
+      return true;
+    });
+    return count;
+  }
+
+  bool empty() const {
+    return self().forEach([](Slice const&) { return false; });
+  }
+
+  // adds all members as a new Array to the builder
+  Builder& toBuilder(Builder& builder) const {
+    builder.openArray();
+    self().forEach([&builder](Slice const& value) {
+      builder.add(value);
+      return true;
+    });
+    builder.close();
+    return builder;
+  }
+
+  Builder toBuilder() const {
+    Builder builder;
+    toBuilder(builder);
+    return builder;
+  }
+
+ protected:
+  Derived const& self() const noexcept { return static_cast<Derived const&>(*this); }
+};
+
+// the members of an Array
+class ArrayView : public View<ArrayView> {
+ public:
+  explicit ArrayView(Slice slice)
+      : _slice(slice), _offset(0), _length(0) {
+    if (!slice.isArray()) {
+      throw Exception(Exception::InvalidValueType, "Expecting type Array");
+    }
+    _length = slice.length();
+  }
+
+  template <typename F>
+  bool forEach(F&& callback) const {
+    if (_length == 0) {
+      return true;
+    }
+    // members of all Array types are stored back to back, so only the
+    // first one needs to be looked up by position
+    Slice current = _slice.at(_offset);
+    ValueLength n = _length;
+    while (true) {
+      if (!callback(static_cast<Slice const&>(current))) {
+        return false;
+      }
+      if (--n == 0) {
+        return true;
+      }
+      current = Slice(current.start() + current.byteSize());
+    }
+  }
+
+  // ranges over an Array do not need to iterate over the skipped members
+  ArrayView range(ValueLength offset,
+                  ValueLength limit = (std::numeric_limits<ValueLength>::max)()) const {
+    ArrayView result(*this);
+    offset = (std::min)(offset, _length);
+    result._offset = _offset + offset;
+    result._length = (std::min)(limit, _length - offset);
+    return result;
+  }
+
+  ValueLength length() const noexcept { return _length; }
+  bool empty() const noexcept { return _length == 0; }
+
+ private:
+  Slice _slice;
+  ValueLength _offset;
+  ValueLength _length;
+};
+
+// the values of an Object, in the order of ObjectIterator
+class ObjectValuesView : public View<ObjectValuesView> {
+ public:
+  explicit ObjectValuesView(Slice slice) : _slice(slice) {
+    if (!slice.isObject()) {
+      throw Exception(Exception::InvalidValueType, "Expecting type Object");
+    }
+  }
+
+  template <typename F>
+  bool forEach(F&& callback) const {
+    ObjectIterator it(_slice);
+    while (it.valid()) {
+      if (!callback(static_cast<Slice const&>(it.value()))) {
+        return false;
+      }
+      it.next();
+    }
+    return true;
+  }
+
+  ValueLength length() const { return _slice.length(); }
+  bool empty() const { return _slice.isEmptyObject(); }
+
+ private:
+  Slice _slice;
+};
+
+template <typename Source, typename F>
+class FilterView : public View<FilterView<Source, F>> {
+ public:
+  template <typename G>
+  FilterView(Source const& source, G&& predicate)
+      : _source(source), _predicate(std::forward<G>(predicate)) {}
+
+  template <typename C>
+  bool forEach(C&& callback) const {
+    F const& predicate = _predicate;
+    return _source.forEach([&predicate, &callback](Slice const& value) {
+      return !predicate(value) || callback(value);
+    });
+  }
+
+ private:
+  Source _source;
+  F _predicate;
+};
+
+template <typename Source, typename F>
+class MapView : public View<MapView<Source, F>> {
+ public:
+  template <typename G>
+  MapView(Source const& source, G&& func)
+      : _source(source), _func(std::forward<G>(func)) {}
+
+  template <typename C>
+  bool forEach(C&& callback) const {
+    F const& func = _func;
+    return _source.forEach([&func, &callback](Slice const& value) {
+      return callback(static_cast<Slice const&>(Slice(func(value))));
+    });
+  }
+
+  // mapping does not change the number of members
+  ValueLength length() const { return _source.length(); }
+  bool empty() const { return _source.empty(); }
+
+ private:
+  Source _source;
+  F _func;
+};
+
+template <typename Source>
+class RangeView : public View<RangeView<Source>> {
+ public:
+  RangeView(Source const& source, ValueLength offset, ValueLength limit)
+      : _source(source), _offset(offset), _limit(limit) {}
+
+  template <typename C>
+  bool forEach(C&& callback) const {
+    if (_limit == 0) {
+      return true;
+    }
+    ValueLength skip = _offset;
+    ValueLength remaining = _limit;
+    bool done = false;
+    bool result = _source.forEach([&](Slice const& value) {
+      if (skip > 0) {
+        --skip;
+        return true;
+      }
+      if (!callback(value)) {
+        return false;
+      }
+      if (--remaining == 0) {
+        // stop the source, but do not report an abort to our caller
+        done = true;
+        return false;
+      }
+      return true;
+    });
+    return result || done;
+  }
+
+ private:
+  Source _source;
+  ValueLength _offset;
+  ValueLength _limit;
+};
+
+template <typename First, typename Second>
+class ConcatView : public View<ConcatView<First, Second>> {
+ public:
+  ConcatView(First const& first, Second const& second)
+      : _first(first), _second(second) {}
+
+  template <typename C>
+  bool forEach(C&& callback) const {
+    return _first.forEach(callback) && _second.forEach(callback);
+  }
+
+  ValueLength length() const { return _first.length() + _second.length(); }
+  bool empty() const { return _first.empty() && _second.empty(); }
+
+ private:
+  First _first;
+  Second _second;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
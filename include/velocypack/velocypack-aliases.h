@@ -49,6 +49,20 @@ using VPackObjectIterator = arangodb::velocypack::ObjectIterator;
 #endif
 #endif
 
+#ifdef VELOCYPACK_BSONDUMPER_H
+#ifndef VELOCYPACK_ALIAS_BSONDUMPER
+#define VELOCYPACK_ALIAS_BSONDUMPER
+using VPackBsonDumper = arangodb::velocypack::BsonDumper;
+#endif
+#endif
+
+#ifdef VELOCYPACK_BSONPARSER_H
+#ifndef VELOCYPACK_ALIAS_BSONPARSER
+#define VELOCYPACK_ALIAS_BSONPARSER
+using VPackBsonParser = arangodb::velocypack::BsonParser;
+#endif
+#endif
+
 #ifdef VELOCYPACK_BUILDER_H
 #ifndef VELOCYPACK_ALIAS_BUILDER
 #define VELOCYPACK_ALIAS_BUILDER
@@ -64,6 +78,7 @@ using VPackArrayBuilder = arangodb::velocypack::ArrayBuilder;
 #ifndef VELOCYPACK_ALIAS_COMPARE
 #define VELOCYPACK_ALIAS_COMPARE
 using VPackNormalizedCompare = arangodb::velocypack::NormalizedCompare;
+using VPackCanonicalCompare = arangodb::velocypack::CanonicalCompare;
 #endif
 #endif
 
@@ -79,6 +94,7 @@ template<typename T> using VPackBuffer = arangodb::velocypack::Buffer<T>;
 #ifndef VELOCYPACK_ALIAS_SINK
 #define VELOCYPACK_ALIAS_SINK
 using VPackSink = arangodb::velocypack::Sink;
+using VPackCharArraySink = arangodb::velocypack::CharArraySink;
 using VPackCharBufferSink = arangodb::velocypack::CharBufferSink;
 using VPackStringSink = arangodb::velocypack::StringSink;
 using VPackStringStreamSink = arangodb::velocypack::StringStreamSink;
@@ -92,6 +108,39 @@ using VPackCollection = arangodb::velocypack::Collection;
 #endif
 #endif
 
+#ifdef VELOCYPACK_COLUMNDECODER_H
+#ifndef VELOCYPACK_ALIAS_COLUMNDECODER
+#define VELOCYPACK_ALIAS_COLUMNDECODER
+using VPackColumnDecoder = arangodb::velocypack::ColumnDecoder;
+template<typename T> using VPackColumn = arangodb::velocypack::Column<T>;
+using VPackDoubleColumn = arangodb::velocypack::DoubleColumn;
+using VPackIntColumn = arangodb::velocypack::IntColumn;
+using VPackBoolColumn = arangodb::velocypack::BoolColumn;
+using VPackStringColumn = arangodb::velocypack::StringColumn;
+#endif
+#endif
+
+#ifdef VELOCYPACK_COMPILEDFILTER_H
+#ifndef VELOCYPACK_ALIAS_COMPILEDFILTER
+#define VELOCYPACK_ALIAS_COMPILEDFILTER
+using VPackCompiledFilter = arangodb::velocypack::CompiledFilter;
+#endif
+#endif
+
+#ifdef VELOCYPACK_COMPILEDPATH_H
+#ifndef VELOCYPACK_ALIAS_COMPILEDPATH
+#define VELOCYPACK_ALIAS_COMPILEDPATH
+using VPackCompiledPath = arangodb::velocypack::CompiledPath;
+#endif
+#endif
+
+#ifdef VELOCYPACK_CSVPARSER_H
+#ifndef VELOCYPACK_ALIAS_CSVPARSER
+#define VELOCYPACK_ALIAS_CSVPARSER
+using VPackCsvParser = arangodb::velocypack::CsvParser;
+#endif
+#endif
+
 #ifdef VELOCYPACK_ATTRIBUTETRANSLATOR_H
 #ifndef VELOCYPACK_ALIAS_ATTRIBUTETRANSLATOR
 #define VELOCYPACK_ALIAS_ATTRIBUTETRANSLATOR
@@ -113,6 +162,22 @@ using VPackException = arangodb::velocypack::Exception;
 #endif
 #endif
 
+#ifdef VELOCYPACK_FILEDESCRIPTORSINK_H
+#ifndef _WIN32
+#ifndef VELOCYPACK_ALIAS_FILEDESCRIPTORSINK
+#define VELOCYPACK_ALIAS_FILEDESCRIPTORSINK
+using VPackFileDescriptorSink = arangodb::velocypack::FileDescriptorSink;
+#endif
+#endif
+#endif
+
+#ifdef VELOCYPACK_HASHINDEX_H
+#ifndef VELOCYPACK_ALIAS_HASHINDEX
+#define VELOCYPACK_ALIAS_HASHINDEX
+using VPackHashIndex = arangodb::velocypack::HashIndex;
+#endif
+#endif
+
 #ifdef VELOCYPACK_HEXDUMP_H
 #ifndef VELOCYPACK_ALIAS_HEXDUMP
 #define VELOCYPACK_ALIAS_HEXDUMP
@@ -120,6 +185,27 @@ using VPackHexDump = arangodb::velocypack::HexDump;
 #endif
 #endif
 
+#ifdef VELOCYPACK_MESSAGEPACKDUMPER_H
+#ifndef VELOCYPACK_ALIAS_MESSAGEPACKDUMPER
+#define VELOCYPACK_ALIAS_MESSAGEPACKDUMPER
+using VPackMessagePackDumper = arangodb::velocypack::MessagePackDumper;
+#endif
+#endif
+
+#ifdef VELOCYPACK_MESSAGEPACKPARSER_H
+#ifndef VELOCYPACK_ALIAS_MESSAGEPACKPARSER
+#define VELOCYPACK_ALIAS_MESSAGEPACKPARSER
+using VPackMessagePackParser = arangodb::velocypack::MessagePackParser;
+#endif
+#endif
+
+#ifdef VELOCYPACK_OFFSETINDEX_H
+#ifndef VELOCYPACK_ALIAS_OFFSETINDEX
+#define VELOCYPACK_ALIAS_OFFSETINDEX
+using VPackOffsetIndex = arangodb::velocypack::OffsetIndex;
+#endif
+#endif
+
 #ifdef VELOCYPACK_OPTIONS_H
 #ifndef VELOCYPACK_ALIAS_OPTIONS
 #define VELOCYPACK_ALIAS_OPTIONS
@@ -128,6 +214,13 @@ using VPackCustomTypeHandler = arangodb::velocypack::CustomTypeHandler;
 #endif
 #endif
 
+#ifdef VELOCYPACK_PARALLELDUMPER_H
+#ifndef VELOCYPACK_ALIAS_PARALLELDUMPER
+#define VELOCYPACK_ALIAS_PARALLELDUMPER
+using VPackParallelDumper = arangodb::velocypack::ParallelDumper;
+#endif
+#endif
+
 #ifdef VELOCYPACK_PARSER_H
 #ifndef VELOCYPACK_ALIAS_PARSER
 #define VELOCYPACK_ALIAS_PARSER
@@ -135,6 +228,13 @@ using VPackParser = arangodb::velocypack::Parser;
 #endif
 #endif
 
+#ifdef VELOCYPACK_PROJECTION_H
+#ifndef VELOCYPACK_ALIAS_PROJECTION
+#define VELOCYPACK_ALIAS_PROJECTION
+using VPackProjection = arangodb::velocypack::Projection;
+#endif
+#endif
+
 #ifdef VELOCYPACK_SERIALIZABLE_H
 #ifndef VELOCYPACK_ALIAS_SERIALIZABLE
 #define VELOCYPACK_ALIAS_SERIALIZABLE
@@ -164,6 +264,13 @@ using VPackStringRef = arangodb::velocypack::StringRef;
 #endif
 #endif
 
+#ifdef VELOCYPACK_TRAVERSAL_H
+#ifndef VELOCYPACK_ALIAS_TRAVERSAL
+#define VELOCYPACK_ALIAS_TRAVERSAL
+using VPackTraversal = arangodb::velocypack::Traversal;
+#endif
+#endif
+
 #ifdef VELOCYPACK_UTF8HELPER_H
 #ifndef VELOCYPACK_ALIAS_UTF8HELPER
 #define VELOCYPACK_ALIAS_UTF8HELPER
@@ -199,4 +306,12 @@ using VPackValueType = arangodb::velocypack::ValueType;
 using VPackVersion = arangodb::velocypack::Version;
 #endif
 #endif
+
+#ifdef VELOCYPACK_VIEW_H
+#ifndef VELOCYPACK_ALIAS_VIEW
+#define VELOCYPACK_ALIAS_VIEW
+using VPackArrayView = arangodb::velocypack::ArrayView;
+using VPackObjectValuesView = arangodb::velocypack::ObjectValuesView;
+#endif
+#endif
 }
@@ -29,23 +29,38 @@
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/AttributeTranslator.h"
+#include "velocypack/BsonDumper.h"
+#include "velocypack/BsonParser.h"
 #include "velocypack/Buffer.h"
 #include "velocypack/Builder.h"
 #include "velocypack/Collection.h"
+#include "velocypack/ColumnDecoder.h"
+#include "velocypack/CompiledFilter.h"
+#include "velocypack/CompiledPath.h"
+#include "velocypack/CsvParser.h"
 #include "velocypack/Dumper.h"
 #include "velocypack/Exception.h"
+#include "velocypack/FileDescriptorSink.h"
+#include "velocypack/HashIndex.h"
 #include "velocypack/HexDump.h"
 #include "velocypack/Iterator.h"
+#include "velocypack/MessagePackDumper.h"
+#include "velocypack/MessagePackParser.h"
+#include "velocypack/OffsetIndex.h"
 #include "velocypack/Options.h"
+#include "velocypack/ParallelDumper.h"
 #include "velocypack/Parser.h"
+#include "velocypack/Projection.h"
 #include "velocypack/Sink.h"
 #include "velocypack/Slice.h"
 #include "velocypack/SliceContainer.h"
 #include "velocypack/StringRef.h"
+#include "velocypack/Traversal.h"
 #include "velocypack/Utf8Helper.h"
 #include "velocypack/Validator.h"
 #include "velocypack/Value.h"
 #include "velocypack/ValueType.h"
 #include "velocypack/Version.h"
+#include "velocypack/View.h"
 
 #endif
@@ -0,0 +1,302 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <cstring>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/BsonDumper.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/ValueType.h"
+
+using namespace arangodb::velocypack;
+
+constexpr std::size_t BsonDumper::bufferSize;
+
+// increments the decimal representation of an Array index, which is used
+// as its key in BSON, in place. This is cheaper than converting each index
+static inline void nextIndex(char* key, std::size_t& length) {
+  std::size_t i = length;
+  while (i > 0) {
+    --i;
+    if (key[i] != '9') {
+      ++key[i];
+      return;
+    }
+    key[i] = '0';
+  }
+  // all digits were 9
+  key[0] = '1';
+  key[length++] = '0';
+}
+
+void BsonDumper::dump(Slice const& slice) {
+  Slice const value = slice.resolveExternals();
+  if (VELOCYPACK_UNLIKELY(!value.isObject() && !value.isArray())) {
+    throw Exception(Exception::InvalidValueType,
+                    "BSON documents must be Objects or Arrays");
+  }
+
+  _sizes.clear();
+  _nextSize = 0;
+  documentSize(value);
+
+  dumpDocument(value);
+  flush();
+}
+
+uint8_t BsonDumper::elementType(Slice const& slice) const {
+  switch (slice.type()) {
+    case ValueType::Null:
+      return 0x0a;
+    case ValueType::Bool:
+      return 0x08;
+    case ValueType::Double:
+      return 0x01;
+    case ValueType::SmallInt:
+    case ValueType::Int: {
+      int64_t const v = slice.getInt();
+      return (v >= INT32_MIN && v <= INT32_MAX) ? 0x10 : 0x12;
+    }
+    case ValueType::UInt: {
+      uint64_t const v = slice.getUInt();
+      if (v <= static_cast<uint64_t>(INT32_MAX)) {
+        return 0x10;
+      }
+      if (v <= static_cast<uint64_t>(INT64_MAX)) {
+        return 0x12;
+      }
+      throw Exception(Exception::NumberOutOfRange,
+                      "Number out of range for BSON");
+    }
+    case ValueType::String:
+      return 0x02;
+    case ValueType::Binary:
+      return 0x05;
+    case ValueType::UTCDate:
+      return 0x09;
+    case ValueType::Array:
+      return 0x04;
+    case ValueType::Object:
+      return 0x03;
+    case ValueType::MinKey:
+      return 0xff;
+    case ValueType::MaxKey:
+      return 0x7f;
+    default: {
+      // None, Illegal, BCD and Custom
+      if (options->unsupportedTypeBehavior ==
+          Options::NullifyUnsupportedType) {
+        return 0x0a;
+      } else if (options->unsupportedTypeBehavior ==
+                 Options::ConvertUnsupportedType) {
+        return 0x02;
+      }
+      throw Exception(Exception::InvalidValueType,
+                      "Type has no equivalent in BSON");
+    }
+  }
+}
+
+ValueLength BsonDumper::documentSize(Slice const& slice) {
+  std::size_t const index = _sizes.size();
+  _sizes.push_back(0);
+
+  // size, members and the terminating NUL byte
+  ValueLength size = 4 + 1;
+  if (slice.isArray()) {
+    char key[24] = {'0'};
+    std::size_t keyLength = 1;
+    ArrayIterator it(slice);
+    while (it.valid()) {
+      Slice const value = it.value().resolveExternals();
+      size += 2 + keyLength + valueSize(value, elementType(value));
+      nextIndex(&key[0], keyLength);
+      it.next();
+    }
+  } else {
+    ObjectIterator it(slice, !options->dumpAttributesInIndexOrder);
+    while (it.valid()) {
+      auto current = (*it);
+      if (VELOCYPACK_UNLIKELY(!current.key.isString())) {
+        throw Exception(Exception::InvalidValueType,
+                        "Object keys must be strings");
+      }
+      ValueLength keyLength;
+      char const* key = current.key.getString(keyLength);
+      if (VELOCYPACK_UNLIKELY(
+              std::memchr(key, '\0', checkOverflow(keyLength)) != nullptr)) {
+        throw Exception(Exception::InvalidValueType,
+                        "BSON keys must not contain NUL bytes");
+      }
+      Slice const value = current.value.resolveExternals();
+      size += 2 + keyLength + valueSize(value, elementType(value));
+      it.next();
+    }
+  }
+
+  if (VELOCYPACK_UNLIKELY(size > static_cast<ValueLength>(INT32_MAX))) {
+    throw Exception(Exception::NumberOutOfRange, "Value too long for BSON");
+  }
+  _sizes[index] = size;
+  return size;
+}
+
+ValueLength BsonDumper::valueSize(Slice const& slice, uint8_t type) {
+  switch (type) {
+    case 0x01:
+    case 0x09:
+    case 0x12:
+      return 8;
+    case 0x02:
+      if (slice.isString()) {
+        return 4 + slice.getStringLength() + 1;
+      }
+      return 4 + unsupportedTypeString(slice).size() + 1;
+    case 0x03:
+    case 0x04:
+      return documentSize(slice);
+    case 0x05:
+      return 4 + 1 + slice.getBinaryLength();
+    case 0x08:
+      return 1;
+    case 0x10:
+      return 4;
+    default:
+      // null, MinKey and MaxKey
+      return 0;
+  }
+}
+
+void BsonDumper::dumpDocument(Slice const& slice) {
+  writeLittleEndian<4>(_sizes[_nextSize++]);
+
+  if (slice.isArray()) {
+    char key[24] = {'0'};
+    std::size_t keyLength = 1;
+    ArrayIterator it(slice);
+    while (it.valid()) {
+      dumpElement(&key[0], keyLength, it.value().resolveExternals());
+      nextIndex(&key[0], keyLength);
+      it.next();
+    }
+  } else {
+    ObjectIterator it(slice, !options->dumpAttributesInIndexOrder);
+    while (it.valid()) {
+      auto current = (*it);
+      ValueLength keyLength;
+      char const* key = current.key.getString(keyLength);
+      dumpElement(key, checkOverflow(keyLength),
+                  current.value.resolveExternals());
+      it.next();
+    }
+  }
+
+  write(0x00);
+}
+
+void BsonDumper::dumpElement(char const* key, std::size_t keyLength,
+                             Slice const& slice) {
+  uint8_t const type = elementType(slice);
+  if (VELOCYPACK_LIKELY(keyLength + 2 <= bufferSize - _pos)) {
+    // type, key and terminating NUL byte in one go
+    _buffer[_pos] = static_cast<char>(type);
+    std::memcpy(&_buffer[_pos + 1], key, keyLength);
+    _buffer[_pos + 1 + keyLength] = '\0';
+    _pos += keyLength + 2;
+  } else {
+    write(type);
+    write(key, keyLength);
+    write(0x00);
+  }
+
+  switch (type) {
+    case 0x01: {
+      double const v = slice.getDouble();
+      uint64_t bits;
+      memcpy(&bits, &v, sizeof(bits));
+      writeLittleEndian<8>(bits);
+      break;
+    }
+    case 0x02: {
+      if (slice.isString()) {
+        ValueLength len;
+        char const* p = slice.getString(len);
+        dumpString(p, len);
+      } else {
+        std::string const value = unsupportedTypeString(slice);
+        dumpString(value.data(), value.size());
+      }
+      break;
+    }
+    case 0x03:
+    case 0x04: {
+      dumpDocument(slice);
+      break;
+    }
+    case 0x05: {
+      ValueLength len;
+      uint8_t const* p = slice.getBinary(len);
+      writeLittleEndian<4>(len);
+      // generic binary subtype
+      write(0x00);
+      write(reinterpret_cast<char const*>(p), checkOverflow(len));
+      break;
+    }
+    case 0x08: {
+      write(slice.getBool() ? 0x01 : 0x00);
+      break;
+    }
+    case 0x09: {
+      writeLittleEndian<8>(static_cast<uint64_t>(slice.getUTCDate()));
+      break;
+    }
+    case 0x10: {
+      writeLittleEndian<4>(static_cast<uint64_t>(slice.getInt()));
+      break;
+    }
+    case 0x12: {
+      writeLittleEndian<8>(static_cast<uint64_t>(slice.getInt()));
+      break;
+    }
+    default: {
+      // null, MinKey and MaxKey have no value
+      break;
+    }
+  }
+}
+
+void BsonDumper::dumpString(char const* p, ValueLength len) {
+  // length including the terminating NUL byte
+  writeLittleEndian<4>(len + 1);
+  write(p, checkOverflow(len));
+  write(0x00);
+}
+
+std::string BsonDumper::unsupportedTypeString(Slice const& slice) const {
+  std::string value("(non-representable type ");
+  value.append(slice.typeName());
+  value.push_back(')');
+  return value;
+}
@@ -0,0 +1,280 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <cstring>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/BsonParser.h"
+#include "velocypack/Utf8Helper.h"
+#include "velocypack/Value.h"
+
+using namespace arangodb::velocypack;
+
+BsonParser::BsonParser(Options const* options)
+    : options(options),
+      _builderPtr(nullptr),
+      _start(nullptr),
+      _size(0),
+      _pos(0),
+      _end(0),
+      _valuePos(0),
+      _key(nullptr),
+      _keyLength(0) {
+  if (VELOCYPACK_UNLIKELY(options == nullptr)) {
+    throw Exception(Exception::InternalError, "Options cannot be a nullptr");
+  }
+  _builder.reset(new Builder(options));
+  _builderPtr = _builder.get();
+}
+
+BsonParser::BsonParser(Builder& builder, Options const* options)
+    : options(options),
+      _builderPtr(nullptr),
+      _start(nullptr),
+      _size(0),
+      _pos(0),
+      _end(0),
+      _valuePos(0),
+      _key(nullptr),
+      _keyLength(0) {
+  if (VELOCYPACK_UNLIKELY(options == nullptr)) {
+    throw Exception(Exception::InternalError, "Options cannot be a nullptr");
+  }
+  _builder.reset(&builder, BuilderNonDeleter());
+  _builderPtr = _builder.get();
+}
+
+ValueLength BsonParser::parse(uint8_t const* start, std::size_t size,
+                              bool multi) {
+  _start = start;
+  _size = size;
+  _pos = 0;
+  _end = size;
+  _valuePos = 0;
+  _key = nullptr;
+  if (options->clearBuilderBeforeParse) {
+    _builderPtr->clear();
+  }
+
+  ValueLength nr = 0;
+  do {
+    _valuePos = _pos;
+    parseDocument(ValueType::Object);
+    ++nr;
+  } while (multi && _pos < _size);
+
+  if (_pos != _size) {
+    _valuePos = _pos;
+    throw Exception(Exception::ParseError, "Expecting end of BSON input");
+  }
+  return nr;
+}
+
+void BsonParser::parseDocument(ValueType type) {
+  std::size_t const begin = _pos;
+  std::size_t const length = readLength();
+  // size, at least one byte for the type of each element and the
+  // terminating NUL byte
+  if (VELOCYPACK_UNLIKELY(length < 5)) {
+    throw Exception(Exception::ParseError, "Invalid BSON document size");
+  }
+  _pos = begin;
+  need(length);
+  _pos = begin + 4;
+
+  // all elements must be contained in the document, which makes the
+  // terminating NUL byte the end of every key
+  std::size_t const outerEnd = _end;
+  _end = begin + length;
+  if (VELOCYPACK_UNLIKELY(_start[_end - 1] != 0x00)) {
+    throw Exception(Exception::ParseError, "Invalid BSON document size");
+  }
+
+  add(Value(type));
+  while (true) {
+    _valuePos = _pos;
+    need(1);
+    uint8_t const elementType = _start[_pos++];
+    if (elementType == 0x00) {
+      break;
+    }
+
+    uint8_t const* key = _start + _pos;
+    std::size_t const keyLength = static_cast<std::size_t>(
+        static_cast<uint8_t const*>(std::memchr(key, 0x00, _end - _pos)) -
+        key);
+    if (type == ValueType::Object) {
+      // Array elements are added in order, ignoring their keys
+      if (options->validateUtf8Strings &&
+          !Utf8Helper::isValidUtf8(key, keyLength)) {
+        throw Exception(Exception::InvalidUtf8Sequence);
+      }
+      _key = reinterpret_cast<char const*>(key);
+      _keyLength = keyLength;
+    }
+    _pos += keyLength + 1;
+
+    parseElement(elementType);
+  }
+
+  if (VELOCYPACK_UNLIKELY(_pos != _end)) {
+    throw Exception(Exception::ParseError, "Invalid BSON document size");
+  }
+  _end = outerEnd;
+  _builderPtr->close();
+}
+
+void BsonParser::parseElement(uint8_t type) {
+  switch (type) {
+    case 0x01: {
+      uint64_t const bits = readUInt<8>();
+      double v;
+      memcpy(&v, &bits, sizeof(v));
+      add(Value(v));
+      break;
+    }
+    case 0x02:
+    case 0x0d:
+    case 0x0e: {
+      // string, JavaScript code and symbol
+      parseString();
+      break;
+    }
+    case 0x03: {
+      parseDocument(ValueType::Object);
+      break;
+    }
+    case 0x04: {
+      parseDocument(ValueType::Array);
+      break;
+    }
+    case 0x05: {
+      parseBinary();
+      break;
+    }
+    case 0x06:
+    case 0x0a: {
+      // undefined and null
+      add(Value(ValueType::Null));
+      break;
+    }
+    case 0x07: {
+      parseObjectId();
+      break;
+    }
+    case 0x08: {
+      uint64_t const v = readUInt<1>();
+      if (VELOCYPACK_UNLIKELY(v > 1)) {
+        throw Exception(Exception::ParseError, "Invalid BSON boolean");
+      }
+      add(Value(v == 1));
+      break;
+    }
+    case 0x09: {
+      add(Value(static_cast<int64_t>(readUInt<8>()), ValueType::UTCDate));
+      break;
+    }
+    case 0x10: {
+      add(Value(static_cast<int64_t>(static_cast<int32_t>(readUInt<4>()))));
+      break;
+    }
+    case 0x11: {
+      // timestamp, as used internally by MongoDB
+      add(Value(readUInt<8>()));
+      break;
+    }
+    case 0x12: {
+      add(Value(static_cast<int64_t>(readUInt<8>())));
+      break;
+    }
+    case 0x7f: {
+      add(Value(ValueType::MaxKey));
+      break;
+    }
+    case 0xff: {
+      add(Value(ValueType::MinKey));
+      break;
+    }
+    default: {
+      // regular expression, DBPointer, code with scope, decimal128 and
+      // invalid types
+      throw Exception(Exception::ParseError, "Unsupported BSON type");
+    }
+  }
+}
+
+void BsonParser::parseString() {
+  // length including the terminating NUL byte
+  std::size_t const length = readLength();
+  need(length);
+  if (VELOCYPACK_UNLIKELY(length == 0 || _start[_pos + length - 1] != 0x00)) {
+    throw Exception(Exception::ParseError, "Invalid BSON string");
+  }
+  uint8_t const* p = _start + _pos;
+  if (options->validateUtf8Strings && !Utf8Helper::isValidUtf8(p, length - 1)) {
+    throw Exception(Exception::InvalidUtf8Sequence);
+  }
+  add(ValuePair(p, length - 1, ValueType::String));
+  _pos += length;
+}
+
+void BsonParser::parseBinary() {
+  std::size_t length = readLength();
+  need(1 + length);
+  uint8_t const subtype = _start[_pos++];
+  uint8_t const* p = _start + _pos;
+  _pos += length;
+
+  if (subtype == 0x02) {
+    // the deprecated binary subtype repeats the length of the data
+    if (VELOCYPACK_UNLIKELY(length < 4)) {
+      throw Exception(Exception::ParseError, "Invalid BSON binary");
+    }
+    uint64_t inner = 0;
+    for (std::size_t i = 4; i > 0; --i) {
+      inner = (inner << 8) | p[i - 1];
+    }
+    if (VELOCYPACK_UNLIKELY(inner != length - 4)) {
+      throw Exception(Exception::ParseError, "Invalid BSON binary");
+    }
+    p += 4;
+    length -= 4;
+  }
+  add(ValuePair(p, length, ValueType::Binary));
+}
+
+void BsonParser::parseObjectId() {
+  static char const hexDigits[] = "0123456789abcdef";
+
+  need(12);
+  char hex[24];
+  for (std::size_t i = 0; i < 12; ++i) {
+    uint8_t const c = _start[_pos + i];
+    hex[2 * i] = hexDigits[c >> 4];
+    hex[2 * i + 1] = hexDigits[c & 0x0fU];
+  }
+  _pos += 12;
+  add(ValuePair(&hex[0], sizeof(hex), ValueType::String));
+}
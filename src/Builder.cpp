@@ -25,6 +25,8 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <array>
+#include <cmath>
+#include <limits>
 #include <unordered_set>
 
 #include "velocypack/velocypack-common.h"
@@ -58,6 +60,17 @@ thread_local std::unique_ptr<std::vector<SortEntry>> sortEntries;
 // thread-local, reusable set to track usage of duplicate keys
 thread_local std::unique_ptr<std::unordered_set<StringRef>> duplicateKeys;
 
+// thread-local, reusable buffer used for reordering the members of objects
+// in canonical encoding
+thread_local std::unique_ptr<std::vector<uint8_t>> memberBuffer;
+
+// options used by Builder::canonicalize
+Options const canonicalOptions = []() {
+  Options options;
+  options.buildCanonical = true;
+  return options;
+}();
+
 // Find the actual bytes of the attribute name of the VPack value
 // at position base, also determine the length len of the attribute.
 // This takes into account the different possibilities for the format
@@ -532,7 +545,49 @@ Builder& Builder::closeArray(ValueLength tos, std::vector<ValueLength>& index) {
   return *this;
 }
 
-Builder& Builder::close() {
+void Builder::orderObjectMembers(ValueLength tos,
+                                 std::vector<ValueLength>& index) {
+  VELOCYPACK_ASSERT(index.size() > 1);
+
+  // the members are stored contiguously in the order they were added
+  ValueLength dataStart = index[0];
+  bool inOrder = true;
+  for (std::size_t i = 1; i < index.size(); ++i) {
+    uint64_t lena;
+    uint64_t lenb;
+    uint8_t const* a = ::findAttrName(_start + tos + index[i - 1], lena);
+    uint8_t const* b = ::findAttrName(_start + tos + index[i], lenb);
+    if (VELOCYPACK_UNLIKELY(lena == lenb &&
+                            memcmp(a, b, checkOverflow(lena)) == 0)) {
+      // the order of equal keys is not defined
+      throw Exception(Exception::DuplicateAttributeName);
+    }
+    if (index[i] < index[i - 1]) {
+      inOrder = false;
+    }
+    dataStart = (std::min)(dataStart, index[i]);
+  }
+  if (inOrder) {
+    return;
+  }
+
+  if (::memberBuffer == nullptr) {
+    ::memberBuffer.reset(new std::vector<uint8_t>());
+  } else {
+    ::memberBuffer->clear();
+  }
+  for (auto& offset : index) {
+    Slice key(_start + tos + offset);
+    Slice value(key.start() + key.byteSize());
+    uint8_t const* end = value.start() + value.byteSize();
+    offset = dataStart + ::memberBuffer->size();
+    ::memberBuffer->insert(::memberBuffer->end(), key.start(), end);
+  }
+  memcpy(_start + tos + dataStart, ::memberBuffer->data(),
+         ::memberBuffer->size());
+}
+
+Builder& Builder::closeInternal(bool keysSorted) {
   if (VELOCYPACK_UNLIKELY(isClosed())) {
     throw Exception(Exception::BuilderNeedOpenCompound);
   }
@@ -553,10 +608,15 @@ Builder& Builder::close() {
   // From now on index.size() > 0
   VELOCYPACK_ASSERT(index.size() > 0);
 
-  // check if we can use the compact Array / Object format
-  if (head == 0x13 || head == 0x14 ||
-      (head == 0x06 && options->buildUnindexedArrays) ||
-      (head == 0x0b && (options->buildUnindexedObjects || index.size() == 1))) {
+  // check if we can use the compact Array / Object format. canonical
+  // encoding only uses it for Objects with one member, as the other
+  // layouts do
+  if (options->buildCanonical
+          ? (!isArray && index.size() == 1)
+          : (head == 0x13 || head == 0x14 ||
+             (head == 0x06 && options->buildUnindexedArrays) ||
+             (head == 0x0b &&
+              (options->buildUnindexedObjects || index.size() == 1)))) {
     if (closeCompactArrayOrObject(tos, isArray, index)) {
       return *this;
     }
@@ -612,7 +672,23 @@ Builder& Builder::close() {
   advance(offsetSize * index.size());
   // Object
   if (index.size() >= 2) {
-    sortObjectIndex(_start + tos, index);
+    if (keysSorted) {
+#ifdef VELOCYPACK_DEBUG
+      for (std::size_t i = 1; i < index.size(); ++i) {
+        uint64_t lena;
+        uint64_t lenb;
+        uint8_t const* a = ::findAttrName(_start + tos + index[i - 1], lena);
+        uint8_t const* b = ::findAttrName(_start + tos + index[i], lenb);
+        int c = memcmp(a, b, checkOverflow((std::min)(lena, lenb)));
+        VELOCYPACK_ASSERT(c < 0 || (c == 0 && lena <= lenb));
+      }
+#endif
+    } else {
+      sortObjectIndex(_start + tos, index);
+    }
+    if (options->buildCanonical) {
+      orderObjectMembers(tos, index);
+    }
   }
   for (std::size_t i = 0; i < index.size(); ++i) {
     uint64_t x = index[i];
@@ -737,7 +813,6 @@ uint8_t* Builder::set(Value const& item) {
       static_assert(sizeof(double) == sizeof(uint64_t),
                     "size of double is not 8 bytes");
       double v = 0.0;
-      uint64_t x;
       switch (ctype) {
         case Value::CType::Double:
           v = item.getDouble();
@@ -752,10 +827,7 @@ uint8_t* Builder::set(Value const& item) {
           throw Exception(Exception::BuilderUnexpectedValue,
                           "Must give number for ValueType::Double");
       }
-      reserve(1 + sizeof(double));
-      appendByteUnchecked(0x1b);
-      memcpy(&x, &v, sizeof(double));
-      appendLengthUnchecked<sizeof(double)>(x);
+      addDouble(v);
       break;
     }
     case ValueType::External: {
@@ -768,6 +840,11 @@ uint8_t* Builder::set(Value const& item) {
         throw Exception(Exception::BuilderUnexpectedValue,
                         "Must give void pointer for ValueType::External");
       }
+      if (options->buildCanonical) {
+        // canonical encoding stores a copy of the value pointed to
+        setCanonical(Slice(static_cast<uint8_t const*>(item.getExternal())));
+        break;
+      }
       reserve(1 + sizeof(void*));
       // store pointer. this doesn't need to be portable
       appendByteUnchecked(0x1d);
@@ -977,6 +1054,12 @@ uint8_t* Builder::set(Slice const& item) {
     throw Exception(Exception::BuilderCustomDisallowed);
   }
 
+  if (options->buildCanonical) {
+    auto const oldPos = _pos;
+    setCanonical(item);
+    return _start + oldPos;
+  }
+
   ValueLength const l = item.byteSize();
   reserve(l);
   memcpy(_start + _pos, item.start(), checkOverflow(l));
@@ -1038,6 +1121,121 @@ uint8_t* Builder::set(ValuePair const& pair) {
                   "ValueType::Custom are valid for ValuePair argument");
 }
 
+Builder Builder::canonicalize(Slice const& slice) {
+  Builder b(&::canonicalOptions);
+  b.add(slice);
+  return b;  // Use return value optimization
+}
+
+void Builder::addCanonicalDouble(double v) {
+  if (std::isnan(v)) {
+    // all NaNs are stored with the same bit pattern
+    v = std::numeric_limits<double>::quiet_NaN();
+  } else if (v == std::trunc(v)) {
+    // integral values that fit into an integer are stored as integers.
+    // -0.0 becomes 0
+    if (v >= 0.0 && v < 18446744073709551616.0) {
+      addUInt(static_cast<uint64_t>(v));
+      return;
+    }
+    if (v < 0.0 && v >= -9223372036854775808.0) {
+      addInt(static_cast<int64_t>(v));
+      return;
+    }
+  }
+
+  uint64_t dv;
+  memcpy(&dv, &v, sizeof(double));
+  reserve(1 + sizeof(double));
+  appendByteUnchecked(0x1b);
+  appendLengthUnchecked<sizeof(double)>(dv);
+}
+
+void Builder::setCanonical(Slice const& item) {
+  // keys and values are written without the checks done by set(), which
+  // the caller has done for item
+  switch (item.type()) {
+    case ValueType::External: {
+      if (options->disallowExternals) {
+        throw Exception(Exception::BuilderExternalsDisallowed);
+      }
+      setCanonical(item.resolveExternal());
+      break;
+    }
+    case ValueType::Double: {
+      addCanonicalDouble(item.getDouble());
+      break;
+    }
+    case ValueType::Int:
+    case ValueType::SmallInt: {
+      addInt(item.getIntUnchecked());
+      break;
+    }
+    case ValueType::UInt: {
+      addUInt(item.getUIntUnchecked());
+      break;
+    }
+    case ValueType::String: {
+      ValueLength size;
+      char const* p = item.getStringUnchecked(size);
+      if (size <= 126) {
+        // short string
+        reserve(1 + size);
+        appendByteUnchecked(static_cast<uint8_t>(0x40 + size));
+      } else {
+        // long string
+        reserve(1 + 8 + size);
+        appendByteUnchecked(0xbf);
+        appendLengthUnchecked<8>(size);
+      }
+      memcpy(_start + _pos, p, checkOverflow(size));
+      advance(size);
+      break;
+    }
+    case ValueType::Binary: {
+      ValueLength size;
+      uint8_t const* p = item.getBinary(size);
+      appendUInt(size, 0xbf);
+      reserve(size);
+      memcpy(_start + _pos, p, checkOverflow(size));
+      advance(size);
+      break;
+    }
+    case ValueType::Array: {
+      addCompoundValue(0x06);
+      ArrayIterator it(item);
+      while (it.valid()) {
+        reportAdd();
+        setCanonical(it.value());
+        it.next();
+      }
+      closeInternal(false);
+      break;
+    }
+    case ValueType::Object: {
+      addCompoundValue(0x0b);
+      ObjectIterator it(item, true);
+      while (it.valid()) {
+        reportAdd();
+        // key(true) guarantees a String as returned type
+        setCanonical(it.key(true));
+        setCanonical(it.value());
+        it.next();
+      }
+      closeInternal(false);
+      break;
+    }
+    default: {
+      // all other types have a single encoding
+      ValueLength const l = item.byteSize();
+      reserve(l);
+      memcpy(_start + _pos, item.start(), checkOverflow(l));
+      advance(l);
+      break;
+    }
+  }
+}
+
 bool Builder::checkAttributeUniqueness(Slice obj) const {
   VELOCYPACK_ASSERT(options->checkAttributeUniqueness == true);
   VELOCYPACK_ASSERT(obj.isObject());
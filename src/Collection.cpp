@@ -24,15 +24,26 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Collection.h"
+#include "velocypack/Compare.h"
+#include "velocypack/CompiledPath.h"
 #include "velocypack/Iterator.h"
 #include "velocypack/Slice.h"
 #include "velocypack/Value.h"
 #include "velocypack/ValueType.h"
 
+#if ASM_OPTIMIZATIONS == 1 && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace arangodb::velocypack;
 
 // indicator for "element not found" in indexOf() method
@@ -48,80 +59,458 @@ static void appendArray(Builder& builder, Slice const& slice) {
   }
 }
 
-// convert a vector of strings into an unordered_set of strings
-static inline std::unordered_set<std::string> makeSet(
-    std::vector<std::string> const& keys) {
-  std::unordered_set<std::string> s;
-  for (auto const& it : keys) {
-    s.emplace(it);
+namespace {
+
+// hash set of Slices using open addressing with linear probing. values
+// are hashed and compared with NormalizedCompare::equalsAnyType, so e.g. 1
+// and 1.0 are considered identical, and UTCDate or Binary values are
+// compared on the binary level. the set does not own the Slices' data
+class SliceSet {
+  struct Entry {
+    uint8_t const* start;
+    std::size_t hash;
+    // insertion order
+    std::size_t position;
+  };
+
+ public:
+  explicit SliceSet(ValueLength expected) : _size(0) {
+    std::size_t capacity = 16;
+    while (capacity < checkOverflow(expected) * 2) {
+      capacity <<= 1;
+    }
+    _entries.resize(capacity, Entry{nullptr, 0, 0});
   }
-  return s;
-}
 
-void Collection::forEach(Slice const& slice, Predicate const& predicate) {
-  ArrayIterator it(slice);
-  ValueLength index = 0;
+  // inserts the value. returns false if an identical value was
+  // already present
+  bool insert(Slice const& value) {
+    std::size_t const hash = _hasher(value);
+    std::size_t slot = find(value, hash);
+    if (_entries[slot].start != nullptr) {
+      return false;
+    }
+    if ((_size + 1) * 2 > _entries.size()) {
+      grow();
+      slot = find(value, hash);
+    }
+    _entries[slot] = Entry{value.start(), hash, _size};
+    ++_size;
+    return true;
+  }
 
-  while (it.valid()) {
-    if (!predicate(it.value(), index)) {
-      // abort
-      return;
+  // returns the position of the value in insertion order, inserting it
+  // first if it was not present yet
+  std::size_t position(Slice const& value) {
+    std::size_t const hash = _hasher(value);
+    std::size_t slot = find(value, hash);
+    if (_entries[slot].start != nullptr) {
+      return _entries[slot].position;
     }
-    it.next();
-    ++index;
+    if ((_size + 1) * 2 > _entries.size()) {
+      grow();
+      slot = find(value, hash);
+    }
+    _entries[slot] = Entry{value.start(), hash, _size};
+    return _size++;
   }
-}
 
-Builder Collection::filter(Slice const& slice, Predicate const& predicate) {
-  // construct a new Array
-  Builder b;
-  b.add(Value(ValueType::Array));
+  std::size_t size() const noexcept { return _size; }
 
-  ArrayIterator it(slice);
-  ValueLength index = 0;
+  bool contains(Slice const& value) const {
+    return _entries[find(value, _hasher(value))].start != nullptr;
+  }
+
+ private:
+  // returns the slot of the value, or the empty slot where it would be
+  // inserted
+  std::size_t find(Slice const& value, std::size_t hash) const {
+    std::size_t const mask = _entries.size() - 1;
+    std::size_t slot = hash & mask;
+    while (true) {
+      Entry const& e = _entries[slot];
+      if (e.start == nullptr ||
+          (e.hash == hash &&
+           NormalizedCompare::equalsAnyType(Slice(e.start), value))) {
+        return slot;
+      }
+      slot = (slot + 1) & mask;
+    }
+  }
 
+  void grow() {
+    std::vector<Entry> old(_entries.size() * 2, Entry{nullptr, 0, 0});
+    old.swap(_entries);
+    std::size_t const mask = _entries.size() - 1;
+    for (auto const& e : old) {
+      if (e.start != nullptr) {
+        std::size_t slot = e.hash & mask;
+        while (_entries[slot].start != nullptr) {
+          slot = (slot + 1) & mask;
+        }
+        _entries[slot] = e;
+      }
+    }
+  }
+
+  std::vector<Entry> _entries;
+  std::size_t _size;
+  NormalizedCompare::Hash _hasher;
+};
+
+// add all members of the array that have not been seen before
+void addUnseen(Builder& builder, SliceSet& seen, Slice const& array) {
+  ArrayIterator it(array);
   while (it.valid()) {
     Slice s = it.value();
-    if (predicate(s, index)) {
-      b.add(s);
+    if (seen.insert(s)) {
+      builder.add(s);
     }
     it.next();
-    ++index;
   }
-  b.close();
-  return b;
 }
 
-Slice Collection::find(Slice const& slice, Predicate const& predicate) {
-  ArrayIterator it(slice);
-  ValueLength index = 0;
+// add all members of left that are (or are not) contained in right,
+// without duplicates
+void addFiltered(Builder& builder, Slice const& left, Slice const& right,
+                 bool contained) {
+  SliceSet other(right.length());
+  {
+    ArrayIterator it(right);
+    while (it.valid()) {
+      other.insert(it.value());
+      it.next();
+    }
+  }
 
+  ArrayIterator it(left);
+  SliceSet seen(it.size());
   while (it.valid()) {
     Slice s = it.value();
-    if (predicate(s, index)) {
-      return s;
+    if (other.contains(s) == contained && seen.insert(s)) {
+      builder.add(s);
     }
     it.next();
-    ++index;
+  }
+}
+
+// sort key for Collection::sortBy() with a path
+struct NormalizedSortKey {
+  explicit NormalizedSortKey(Slice value) : rank(0), number(0.0) {
+    switch (value.type()) {
+      case ValueType::None:
+      case ValueType::Null:
+        rank = 0;
+        break;
+      case ValueType::Bool:
+        rank = 1;
+        number = value.isTrue() ? 1.0 : 0.0;
+        break;
+      case ValueType::Double:
+      case ValueType::Int:
+      case ValueType::UInt:
+      case ValueType::SmallInt:
+        rank = 2;
+        number = value.getNumber<double>();
+        break;
+      case ValueType::String:
+        rank = 3;
+        string = value.stringRef();
+        break;
+      case ValueType::Array:
+        rank = 4;
+        break;
+      case ValueType::Object:
+        rank = 5;
+        break;
+      default:
+        rank = 6;
+        break;
+    }
   }
 
-  return Slice();
+  bool operator<(NormalizedSortKey const& other) const noexcept {
+    if (rank != other.rank) {
+      return rank < other.rank;
+    }
+    if (rank == 3) {
+      return string.compare(other.string) < 0;
+    }
+    if (VELOCYPACK_UNLIKELY(std::isnan(number) || std::isnan(other.number))) {
+      // NaN is ordered after all other numbers, so that the order is a
+      // strict weak ordering
+      return !std::isnan(number) && std::isnan(other.number);
+    }
+    return number < other.number;
+  }
+
+  uint8_t rank;
+  double number;
+  StringRef string;
+};
+
+// adds the aggregate of a part of an Array to the overall result. NaN
+// values propagate: once min or max is NaN, it stays NaN
+inline void mergeAggregate(NumericAggregate& result, ValueLength count,
+                           double sum, double min, double max) {
+  if (count == 0) {
+    return;
+  }
+  if (result.count == 0) {
+    result.min = min;
+    result.max = max;
+  } else {
+    if (min < result.min || std::isnan(min)) {
+      result.min = min;
+    }
+    if (max > result.max || std::isnan(max)) {
+      result.max = max;
+    }
+  }
+  result.count += count;
+  result.sum += sum;
 }
 
-bool Collection::contains(Slice const& slice, Predicate const& predicate) {
-  ArrayIterator it(slice);
-  ValueLength index = 0;
+inline void aggregateValue(NumericAggregate& result, Slice value) {
+  if (value.isNumber()) {
+    double v = value.getNumber<double>();
+    mergeAggregate(result, 1, v, v, v);
+  }
+}
 
-  while (it.valid()) {
-    Slice s = it.value();
-    if (predicate(s, index)) {
-      return true;
+// aggregates an Array of SmallInts (all members are 1 byte)
+void aggregateSmallInts(uint8_t const* p, ValueLength n, NumericAggregate& result) {
+  // SmallInts 0x30 - 0x3f are mapped to 0 - 15 (i.e. value + 6), so that
+  // they can be summed up and compared as unsigned bytes
+  int64_t sum = 0;
+  uint8_t min = 0xff;
+  uint8_t max = 0;
+  ValueLength i = 0;
+
+#if ASM_OPTIMIZATIONS == 1 && defined(__SSE2__)
+  if (n >= 16) {
+    __m128i sums = _mm_setzero_si128();
+    __m128i mins = _mm_set1_epi8(static_cast<char>(0xff));
+    __m128i maxs = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+      __m128i v = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i)),
+                               _mm_set1_epi8(0x30));
+      // 0 - 9 become 6 - 15, 10 - 15 (negative values) become 0 - 5
+      __m128i negative = _mm_cmpgt_epi8(v, _mm_set1_epi8(9));
+      v = _mm_sub_epi8(_mm_add_epi8(v, _mm_set1_epi8(6)),
+                       _mm_and_si128(negative, _mm_set1_epi8(16)));
+      sums = _mm_add_epi64(sums, _mm_sad_epu8(v, _mm_setzero_si128()));
+      mins = _mm_min_epu8(mins, v);
+      maxs = _mm_max_epu8(maxs, v);
+    }
+    alignas(16) uint64_t s[2];
+    alignas(16) uint8_t lo[16];
+    alignas(16) uint8_t hi[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(&s[0]), sums);
+    _mm_store_si128(reinterpret_cast<__m128i*>(&lo[0]), mins);
+    _mm_store_si128(reinterpret_cast<__m128i*>(&hi[0]), maxs);
+    sum = static_cast<int64_t>(s[0] + s[1]);
+    for (std::size_t j = 0; j < 16; ++j) {
+      min = (std::min)(min, lo[j]);
+      max = (std::max)(max, hi[j]);
     }
-    it.next();
-    ++index;
+  }
+#endif
+
+  for (; i < n; ++i) {
+    uint8_t v = p[i] - 0x30;
+    v = (v > 9) ? v - 10 : v + 6;
+    sum += v;
+    min = (std::min)(min, v);
+    max = (std::max)(max, v);
   }
 
-  return false;
+  mergeAggregate(result, n, static_cast<double>(sum - 6 * static_cast<int64_t>(n)),
+                 static_cast<double>(min) - 6.0, static_cast<double>(max) - 6.0);
+}
+
+// aggregates an Array of Doubles (all members are 9 bytes). min and max
+// are NaN if any member is NaN. NaNs are tracked separately, because
+// min/max instructions and std::min/std::max return one of their operands
+// when the other one is NaN, depending on the operand order
+void aggregateDoubles(uint8_t const* p, ValueLength n, NumericAggregate& result) {
+  double sum = 0.0;
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+  bool nan = false;
+  ValueLength i = 0;
+
+#if ASM_OPTIMIZATIONS == 1 && defined(__SSE2__)
+  if (n >= 2) {
+    __m128d sums = _mm_setzero_pd();
+    __m128d mins = _mm_set1_pd(min);
+    __m128d maxs = _mm_set1_pd(max);
+    __m128d nans = _mm_setzero_pd();
+    for (; i + 2 <= n; i += 2) {
+      double a, b;
+      std::memcpy(&a, p + i * 9 + 1, sizeof(double));
+      std::memcpy(&b, p + i * 9 + 10, sizeof(double));
+      __m128d v = _mm_set_pd(b, a);
+      sums = _mm_add_pd(sums, v);
+      mins = _mm_min_pd(mins, v);
+      maxs = _mm_max_pd(maxs, v);
+      nans = _mm_or_pd(nans, _mm_cmpunord_pd(v, v));
+    }
+    alignas(16) double s[2];
+    alignas(16) double lo[2];
+    alignas(16) double hi[2];
+    _mm_store_pd(&s[0], sums);
+    _mm_store_pd(&lo[0], mins);
+    _mm_store_pd(&hi[0], maxs);
+    sum = s[0] + s[1];
+    min = (std::min)(lo[0], lo[1]);
+    max = (std::max)(hi[0], hi[1]);
+    nan = (_mm_movemask_pd(nans) != 0);
+  }
+#endif
+
+  for (; i < n; ++i) {
+    double v;
+    std::memcpy(&v, p + i * 9 + 1, sizeof(double));
+    sum += v;
+    if (std::isnan(v)) {
+      nan = true;
+    } else {
+      min = (std::min)(min, v);
+      max = (std::max)(max, v);
+    }
+  }
+
+  if (nan) {
+    min = max = std::numeric_limits<double>::quiet_NaN();
+  }
+  mergeAggregate(result, n, sum, min, max);
+}
+
+// aggregates an Array of Int (0x20 - 0x27) or UInt (0x28 - 0x2f) values
+// that all have the same byte length
+template <ValueLength length, bool isSigned>
+void aggregateIntegers(uint8_t const* p, ValueLength n, NumericAggregate& result) {
+  typedef typename std::conditional<isSigned, int64_t, uint64_t>::type T;
+  // sums of values with up to 4 bytes cannot overflow
+  typedef typename std::conditional<(length <= 4), T, double>::type S;
+
+  S sum = 0;
+  T min = (std::numeric_limits<T>::max)();
+  T max = (std::numeric_limits<T>::min)();
+  for (ValueLength i = 0; i < n; ++i) {
+    uint64_t raw = readIntegerFixed<uint64_t, length>(p + i * (length + 1) + 1);
+    T v;
+    if (isSigned && length < 8) {
+      // sign-extend
+      v = static_cast<T>(static_cast<int64_t>(raw << (64 - 8 * length)) >> (64 - 8 * length));
+    } else {
+      v = static_cast<T>(raw);
+    }
+    sum += static_cast<S>(v);
+    min = (std::min)(min, v);
+    max = (std::max)(max, v);
+  }
+
+  mergeAggregate(result, n, static_cast<double>(sum), static_cast<double>(min),
+                 static_cast<double>(max));
+}
+
+template <bool isSigned>
+void aggregateIntegers(uint8_t const* p, ValueLength length, ValueLength n,
+                       NumericAggregate& result) {
+  switch (length) {
+    case 1: return aggregateIntegers<1, isSigned>(p, n, result);
+    case 2: return aggregateIntegers<2, isSigned>(p, n, result);
+    case 3: return aggregateIntegers<3, isSigned>(p, n, result);
+    case 4: return aggregateIntegers<4, isSigned>(p, n, result);
+    case 5: return aggregateIntegers<5, isSigned>(p, n, result);
+    case 6: return aggregateIntegers<6, isSigned>(p, n, result);
+    case 7: return aggregateIntegers<7, isSigned>(p, n, result);
+    default: return aggregateIntegers<8, isSigned>(p, n, result);
+  }
+}
+
+// aggregates an Array with equally sized members
+void aggregateFixedWidth(uint8_t const* p, ValueLength width, ValueLength n,
+                         NumericAggregate& result) {
+  uint8_t const h = *p;
+
+  // check if all members are of the same type
+  bool same = true;
+  if (width == 1) {
+    for (ValueLength i = 0; i < n; ++i) {
+      if (p[i] < 0x30 || p[i] > 0x3f) {
+        same = false;
+        break;
+      }
+    }
+    if (same) {
+      aggregateSmallInts(p, n, result);
+      return;
+    }
+  } else {
+    for (ValueLength i = 1; i < n; ++i) {
+      if (p[i * width] != h) {
+        same = false;
+        break;
+      }
+    }
+  }
+
+  if (same) {
+    if (h == 0x1b) {
+      aggregateDoubles(p, n, result);
+      return;
+    }
+    if (h >= 0x20 && h <= 0x27) {
+      aggregateIntegers<true>(p, width - 1, n, result);
+      return;
+    }
+    if (h >= 0x28 && h <= 0x2f) {
+      aggregateIntegers<false>(p, width - 1, n, result);
+      return;
+    }
+  }
+
+  // mixed types
+  for (ValueLength i = 0; i < n; ++i) {
+    aggregateValue(result, Slice(p + i * width));
+  }
+}
+
+void checkArrays(Slice const& left, Slice const& right) {
+  if (!left.isArray() || !right.isArray()) {
+    throw Exception(Exception::InvalidValueType, "Expecting type Array");
+  }
+}
+
+} // namespace
+
+// convert a vector of strings into an unordered_set of strings
+static inline std::unordered_set<std::string> makeSet(
+    std::vector<std::string> const& keys) {
+  std::unordered_set<std::string> s;
+  for (auto const& it : keys) {
+    s.emplace(it);
+  }
+  return s;
+}
+
+void Collection::forEach(Slice const& slice, Predicate const& predicate) {
+  forEach<Predicate const&>(slice, predicate);
+}
+
+Builder Collection::filter(Slice const& slice, Predicate const& predicate) {
+  return filter<Predicate const&>(slice, predicate);
+}
+
+Slice Collection::find(Slice const& slice, Predicate const& predicate) {
+  return find<Predicate const&>(slice, predicate);
+}
+
+bool Collection::contains(Slice const& slice, Predicate const& predicate) {
+  return contains<Predicate const&>(slice, predicate);
 }
 
 bool Collection::contains(Slice const& slice, Slice const& other) {
@@ -153,35 +542,164 @@ ValueLength Collection::indexOf(Slice const& slice, Slice const& other) {
 }
 
 bool Collection::all(Slice const& slice, Predicate const& predicate) {
-  ArrayIterator it(slice);
-  ValueLength index = 0;
+  return all<Predicate const&>(slice, predicate);
+}
+
+bool Collection::any(Slice const& slice, Predicate const& predicate) {
+  return any<Predicate const&>(slice, predicate);
+}
+
+NumericAggregate Collection::aggregate(Slice const& array) {
+  NumericAggregate result;
+
+  ArrayIterator it(array);
+  ValueLength const n = it.size();
+  if (n == 0) {
+    return result;
+  }
+
+  uint8_t const h = array.head();
+  if (h >= 0x02 && h <= 0x05) {
+    // all members have the same byte size
+    uint8_t const* p = it.value().start();
+    aggregateFixedWidth(p, Slice(p).byteSize(), n, result);
+    return result;
+  }
 
   while (it.valid()) {
-    Slice s = it.value();
-    if (!predicate(s, index)) {
-      return false;
-    }
+    aggregateValue(result, it.value());
     it.next();
-    ++index;
   }
+  return result;
+}
 
-  return true;
+Builder Collection::groupBy(Slice const& array, CompiledPath const& key,
+                            std::vector<GroupAggregation> const& aggregations,
+                            std::string const& keyName) {
+  Builder b;
+  groupBy(b, array, key, aggregations, keyName);
+  return b;
 }
 
-bool Collection::any(Slice const& slice, Predicate const& predicate) {
-  ArrayIterator it(slice);
-  ValueLength index = 0;
+Builder& Collection::groupBy(Builder& builder, Slice const& array, CompiledPath const& key,
+                             std::vector<GroupAggregation> const& aggregations,
+                             std::string const& keyName) {
+  if (!array.isArray()) {
+    throw Exception(Exception::InvalidValueType, "Expecting type Array");
+  }
+
+  // values for Collect aggregations, chained per group and aggregation
+  struct Collected {
+    uint8_t const* start;
+    std::size_t next;
+  };
+  struct CollectedList {
+    std::size_t first;
+    std::size_t last;
+  };
+  std::size_t const none = (std::numeric_limits<std::size_t>::max)();
+  std::size_t const n = aggregations.size();
+
+  ArrayIterator it(array);
+  // groups refer to the key values in the input, which are not copied.
+  // the state of aggregation a of group g is at position g * n + a
+  SliceSet groups((std::min)(it.size(), ValueLength(1024)));
+  std::vector<Slice> keys;
+  std::vector<NumericAggregate> states;
+  std::vector<CollectedList> lists;
+  std::vector<Collected> collected;
 
   while (it.valid()) {
-    Slice s = it.value();
-    if (predicate(s, index)) {
-      return true;
+    Slice doc = it.value();
+    Slice k = key.get(doc);
+    if (k.isNone()) {
+      k = Slice::nullSlice();
+    }
+
+    std::size_t const group = groups.position(k);
+    if (group == keys.size()) {
+      keys.push_back(k);
+      states.resize(states.size() + n);
+      lists.resize(lists.size() + n, CollectedList{none, none});
+    }
+
+    for (std::size_t a = 0; a < n; ++a) {
+      GroupAggregation const& aggregation = aggregations[a];
+      NumericAggregate& state = states[group * n + a];
+
+      if (aggregation.type == GroupAggregation::Count && aggregation.path.empty()) {
+        ++state.count;
+        continue;
+      }
+
+      Slice v = aggregation.path.get(doc);
+      switch (aggregation.type) {
+        case GroupAggregation::Count:
+          if (!v.isNone() && !v.isNull()) {
+            ++state.count;
+          }
+          break;
+        case GroupAggregation::Sum:
+        case GroupAggregation::Min:
+        case GroupAggregation::Max:
+          aggregateValue(state, v);
+          break;
+        case GroupAggregation::Collect:
+          if (!v.isNone()) {
+            CollectedList& list = lists[group * n + a];
+            if (list.last == none) {
+              list.first = collected.size();
+            } else {
+              collected[list.last].next = collected.size();
+            }
+            list.last = collected.size();
+            collected.push_back(Collected{v.start(), none});
+          }
+          break;
+      }
     }
     it.next();
-    ++index;
   }
 
-  return false;
+  builder.openArray();
+  for (std::size_t group = 0; group < keys.size(); ++group) {
+    builder.openObject();
+    builder.add(keyName, keys[group]);
+    for (std::size_t a = 0; a < n; ++a) {
+      GroupAggregation const& aggregation = aggregations[a];
+      NumericAggregate const& state = states[group * n + a];
+      switch (aggregation.type) {
+        case GroupAggregation::Count:
+          builder.add(aggregation.name, Value(state.count));
+          break;
+        case GroupAggregation::Sum:
+          builder.add(aggregation.name, Value(state.sum));
+          break;
+        case GroupAggregation::Min:
+        case GroupAggregation::Max:
+          if (state.count == 0) {
+            builder.add(aggregation.name, Value(ValueType::Null));
+          } else {
+            builder.add(aggregation.name,
+                        Value(aggregation.type == GroupAggregation::Min ? state.min : state.max));
+          }
+          break;
+        case GroupAggregation::Collect: {
+          builder.add(aggregation.name, Value(ValueType::Array));
+          std::size_t i = lists[group * n + a].first;
+          while (i != none) {
+            builder.add(Slice(collected[i].start));
+            i = collected[i].next;
+          }
+          builder.close();
+          break;
+        }
+      }
+    }
+    builder.close();
+  }
+  builder.close();
+  return builder;
 }
 
 std::vector<std::string> Collection::keys(Slice const& slice) {
@@ -347,6 +865,83 @@ Builder Collection::merge(Slice const& left, Slice const& right,
   return b;
 }
 
+// merges two sorted Objects (0x0b - 0x0e) in a single walk over both
+// index tables, which are ordered by attribute name. duplicate keys are
+// treated like in the hash-based merge: only the first value for a key
+// from the right Object is used, and it replaces all values for that key
+// from the left Object
+static void mergeSorted(Builder& builder, Slice const& left, Slice const& right,
+                        bool mergeValues, bool nullMeansRemove) {
+  VELOCYPACK_ASSERT(left.isSorted() && right.isSorted());
+
+  ValueLength const nl = left.length();
+  ValueLength const nr = right.length();
+  ValueLength i = 0;
+  ValueLength j = 0;
+
+  auto addRight = [&builder, nullMeansRemove](StringRef const& key, Slice const& value) {
+    if (!nullMeansRemove || !value.isNull()) {
+      builder.add(key, value);
+    }
+  };
+
+  // moves the position behind all entries with the current key
+  auto skip = [](Slice const& slice, ValueLength& position, ValueLength n, StringRef& key) {
+    StringRef const current = key;
+    while (++position < n) {
+      key = slice.keyAt(position).stringRef();
+      if (!key.equals(current)) {
+        break;
+      }
+    }
+  };
+
+  StringRef leftKey;
+  StringRef rightKey;
+  if (nl > 0) {
+    leftKey = left.keyAt(0).stringRef();
+  }
+  if (nr > 0) {
+    rightKey = right.keyAt(0).stringRef();
+  }
+
+  while (i < nl && j < nr) {
+    int res = leftKey.compare(rightKey);
+    if (res < 0) {
+      // only in left
+      builder.add(leftKey, left.valueAt(i));
+      if (++i < nl) {
+        leftKey = left.keyAt(i).stringRef();
+      }
+    } else if (res > 0) {
+      // only in right
+      addRight(rightKey, right.valueAt(j));
+      skip(right, j, nr, rightKey);
+    } else {
+      // in both
+      Slice leftValue = left.valueAt(i);
+      Slice rightValue = right.valueAt(j);
+      if (mergeValues && leftValue.isObject() && rightValue.isObject()) {
+        builder.add(ValuePair(rightKey, ValueType::String));
+        Collection::merge(builder, leftValue, rightValue, true, nullMeansRemove);
+      } else {
+        addRight(rightKey, rightValue);
+      }
+      skip(left, i, nl, leftKey);
+      skip(right, j, nr, rightKey);
+    }
+  }
+
+  while (i < nl) {
+    builder.add(left.keyAt(i).stringRef(), left.valueAt(i));
+    ++i;
+  }
+  while (j < nr) {
+    addRight(rightKey, right.valueAt(j));
+    skip(right, j, nr, rightKey);
+  }
+}
+
 Builder& Collection::merge(Builder& builder, Slice const& left, Slice const& right,
                            bool mergeValues, bool nullMeansRemove) {
   if (!left.isObject() || !right.isObject()) {
@@ -355,6 +950,13 @@ Builder& Collection::merge(Builder& builder, Slice const& left, Slice const& rig
 
   builder.add(Value(ValueType::Object));
 
+  if (left.isSorted() && right.isSorted()) {
+    // no hashing needed
+    mergeSorted(builder, left, right, mergeValues, nullMeansRemove);
+    builder.close();
+    return builder;
+  }
+
   std::unordered_map<StringRef, Slice> rightValues;
   {
     ObjectIterator it(right);
@@ -415,100 +1017,76 @@ Builder& Collection::merge(Builder& builder, Slice const& left, Slice const& rig
   return builder;
 }
 
-template <Collection::VisitationOrder order>
-static bool doVisit(
-    Slice const& slice,
-    std::function<bool(Slice const& key, Slice const& value)> const& func);
-
-template <Collection::VisitationOrder order>
-static bool visitObject(
-    Slice const& value,
-    std::function<bool(Slice const& key, Slice const& value)> const& func) {
-  ObjectIterator it(value);
-
-  while (it.valid()) {
-    auto current = (*it);
-    // sub-object?
-    Slice v = current.value;
-    bool const isCompound = (v.isObject() || v.isArray());
-
-    if (isCompound && order == Collection::PreOrder) {
-      if (!doVisit<order>(v, func)) {
-        return false;
-      }
-    }
-
-    if (!func(current.key, v)) {
-      return false;
-    }
-
-    if (isCompound && order == Collection::PostOrder) {
-      if (!doVisit<order>(v, func)) {
-        return false;
-      }
-    }
+Builder Collection::unique(Slice const& array) {
+  Builder b;
+  unique(b, array);
+  return b;
+}
 
-    it.next();
+Builder& Collection::unique(Builder& builder, Slice const& array) {
+  if (!array.isArray()) {
+    throw Exception(Exception::InvalidValueType, "Expecting type Array");
   }
-  return true;
+
+  builder.openArray();
+  SliceSet seen(array.length());
+  addUnseen(builder, seen, array);
+  builder.close();
+  return builder;
 }
 
-template <Collection::VisitationOrder order>
-static bool visitArray(
-    Slice const& value,
-    std::function<bool(Slice const& key, Slice const& value)> const& func) {
-  ArrayIterator it(value);
+Builder Collection::setUnion(Slice const& left, Slice const& right) {
+  Builder b;
+  setUnion(b, left, right);
+  return b;
+}
 
-  while (it.valid()) {
-    // sub-object?
-    Slice v = it.value();
-    bool const isCompound = (v.isObject() || v.isArray());
+Builder& Collection::setUnion(Builder& builder, Slice const& left, Slice const& right) {
+  checkArrays(left, right);
 
-    if (isCompound && order == Collection::PreOrder) {
-      if (!doVisit<order>(v, func)) {
-        return false;
-      }
-    }
+  builder.openArray();
+  SliceSet seen(left.length() + right.length());
+  addUnseen(builder, seen, left);
+  addUnseen(builder, seen, right);
+  builder.close();
+  return builder;
+}
 
-    if (!func(Slice(), v)) {
-      return false;
-    }
+Builder Collection::setIntersection(Slice const& left, Slice const& right) {
+  Builder b;
+  setIntersection(b, left, right);
+  return b;
+}
 
-    if (isCompound && order == Collection::PostOrder) {
-      if (!doVisit<order>(v, func)) {
-        return false;
-      }
-    }
+Builder& Collection::setIntersection(Builder& builder, Slice const& left, Slice const& right) {
+  checkArrays(left, right);
 
-    it.next();
-  }
+  builder.openArray();
+  addFiltered(builder, left, right, true);
+  builder.close();
+  return builder;
+}
 
-  return true;
+Builder Collection::setDifference(Slice const& left, Slice const& right) {
+  Builder b;
+  setDifference(b, left, right);
+  return b;
 }
 
-template <Collection::VisitationOrder order>
-static bool doVisit(
-    Slice const& slice,
-    std::function<bool(Slice const& key, Slice const& value)> const& func) {
-  if (slice.isObject()) {
-    return visitObject<order>(slice, func);
-  }
-  if (slice.isArray()) {
-    return visitArray<order>(slice, func);
-  }
+Builder& Collection::setDifference(Builder& builder, Slice const& left, Slice const& right) {
+  checkArrays(left, right);
 
-  throw Exception(Exception::InvalidValueType,
-                  "Expecting type Object or Array");
+  builder.openArray();
+  addFiltered(builder, left, right, false);
+  builder.close();
+  return builder;
 }
 
 void Collection::visitRecursive(
     Slice const& slice, Collection::VisitationOrder order,
     std::function<bool(Slice const&, Slice const&)> const& func) {
-  if (order == Collection::PreOrder) {
-    doVisit<Collection::PreOrder>(slice, func);
-  } else {
-    doVisit<Collection::PostOrder>(slice, func);
-  }
+  using Visitor = std::function<bool(Slice const&, Slice const&)>;
+  visitRecursive<Visitor const&>(slice, order, func);
 }
 
 Builder Collection::sort(
@@ -518,10 +1096,11 @@ Builder Collection::sort(
     throw Exception(Exception::InvalidValueType, "Expecting type Array");
   }
   std::vector<Slice> subValues;
-  ValueLength len = array.length();
-  subValues.reserve(checkOverflow(len));
-  for (ValueLength i = 0; i < len; i++) {
-    subValues.push_back(array[i]);
+  ArrayIterator it(array);
+  subValues.reserve(checkOverflow(it.size()));
+  while (it.valid()) {
+    subValues.push_back(it.value());
+    it.next();
   }
   std::sort(subValues.begin(), subValues.end(), lessthan);
   Builder b;
@@ -533,3 +1112,51 @@ Builder Collection::sort(
   return b;
 }
 
+Builder Collection::sortBy(Slice const& array, CompiledPath const& path,
+                           SortOptions const& options) {
+  return sortBy(array, [&path](Slice const& value) {
+    return NormalizedSortKey(path.get(value));
+  }, options);
+}
+
+void Collection::runParallel(std::vector<std::function<void()>>& tasks) {
+  std::exception_ptr error;
+  std::mutex mutex;
+
+  auto run = [&error, &mutex](std::function<void()> const& task) {
+    try {
+      task();
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  // the first task is run by the calling thread
+  std::size_t started = 1;
+  try {
+    threads.reserve(tasks.size());
+    for (; started < tasks.size(); ++started) {
+      threads.emplace_back(run, std::cref(tasks[started]));
+    }
+  } catch (...) {
+    // no more threads can be started. the remaining tasks are run by the
+    // calling thread
+  }
+  if (!tasks.empty()) {
+    run(tasks[0]);
+  }
+  for (std::size_t i = started; i < tasks.size(); ++i) {
+    run(tasks[i]);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
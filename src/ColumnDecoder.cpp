@@ -0,0 +1,321 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <cstring>
+#include <limits>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/ColumnDecoder.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+
+#if ASM_OPTIMIZATIONS == 1 && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// converts a single value into the column's type. returns false if the
+// value cannot be represented in the column
+inline bool convert(Slice slice, double& result) {
+  if (slice.isDouble()) {
+    result = slice.getDouble();
+    return true;
+  }
+  if (slice.isInteger()) {
+    result = slice.getNumber<double>();
+    return true;
+  }
+  return false;
+}
+
+inline bool convert(Slice slice, int64_t& result) {
+  if (slice.isSmallInt()) {
+    result = slice.getSmallInt();
+    return true;
+  }
+  if (slice.isInt()) {
+    result = slice.getInt();
+    return true;
+  }
+  if (slice.isUInt()) {
+    uint64_t v = slice.getUInt();
+    if (v > static_cast<uint64_t>((std::numeric_limits<int64_t>::max)())) {
+      return false;
+    }
+    result = static_cast<int64_t>(v);
+    return true;
+  }
+  return false;
+}
+
+inline bool convert(Slice slice, uint8_t& result) {
+  if (slice.isBool()) {
+    result = slice.isTrue() ? 1 : 0;
+    return true;
+  }
+  return false;
+}
+
+inline bool convert(Slice slice, StringRef& result) {
+  if (slice.isString()) {
+    ValueLength length;
+    char const* p = slice.getString(length);
+    result = StringRef(p, length);
+    return true;
+  }
+  return false;
+}
+
+template <typename T>
+inline void appendValue(Column<T>& column, Slice slice) {
+  typename Column<T>::value_type value;
+  if (convert(slice.resolveExternal(), value)) {
+    column.append(value);
+  } else {
+    column.appendNull();
+  }
+}
+
+// decodes a run of single-byte members. returns the number of members
+// that were decoded, which may be less than n. the remaining members
+// must be decoded one by one
+template <typename T>
+inline ValueLength decodeSingleBytes(uint8_t const*, ValueLength, Column<T>&) {
+  return 0;
+}
+
+#if ASM_OPTIMIZATIONS == 1 && defined(__SSE2__)
+// decodes blocks of 16 SmallInts into signed bytes. returns false if the
+// block contains any other type
+inline bool smallIntBlock(uint8_t const* p, int8_t* out) {
+  __m128i const h = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+  // SmallInts are 0x30 - 0x3f
+  __m128i const d = _mm_sub_epi8(h, _mm_set1_epi8(0x30));
+  __m128i const limit = _mm_set1_epi8(0x0f);
+  if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(d, limit), limit)) != 0xffff) {
+    return false;
+  }
+  // 0x30 - 0x39 are 0 to 9, 0x3a - 0x3f are -6 to -1
+  __m128i const negative = _mm_cmpgt_epi8(d, _mm_set1_epi8(9));
+  __m128i const v = _mm_sub_epi8(d, _mm_and_si128(negative, _mm_set1_epi8(16)));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+  return true;
+}
+
+template <typename T>
+inline ValueLength decodeSmallInts(uint8_t const* p, ValueLength n, Column<T>& column) {
+  ValueLength done = 0;
+  alignas(16) int8_t block[16];
+  while (n - done >= 16 && smallIntBlock(p + done, &block[0])) {
+    for (std::size_t i = 0; i < 16; ++i) {
+      column.values.push_back(static_cast<typename Column<T>::value_type>(block[i]));
+    }
+    column.nulls.resize(column.nulls.size() + 16, 0);
+    done += 16;
+  }
+  return done;
+}
+
+template <>
+inline ValueLength decodeSingleBytes(uint8_t const* p, ValueLength n, Column<double>& column) {
+  return decodeSmallInts(p, n, column);
+}
+
+template <>
+inline ValueLength decodeSingleBytes(uint8_t const* p, ValueLength n, Column<int64_t>& column) {
+  return decodeSmallInts(p, n, column);
+}
+
+template <>
+inline ValueLength decodeSingleBytes(uint8_t const* p, ValueLength n, Column<bool>& column) {
+  ValueLength done = 0;
+  while (n - done >= 16) {
+    __m128i const h = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + done));
+    // false is 0x19, true is 0x1a
+    __m128i const isBool = _mm_or_si128(_mm_cmpeq_epi8(h, _mm_set1_epi8(0x19)),
+                                        _mm_cmpeq_epi8(h, _mm_set1_epi8(0x1a)));
+    if (_mm_movemask_epi8(isBool) != 0xffff) {
+      break;
+    }
+    std::size_t const size = column.values.size();
+    column.values.resize(size + 16);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(column.values.data() + size),
+                     _mm_sub_epi8(h, _mm_set1_epi8(0x19)));
+    column.nulls.resize(size + 16, 0);
+    done += 16;
+  }
+  return done;
+}
+#endif
+
+// appends a member of an Array with equally sized members
+template <typename T>
+inline void appendFixedWidth(Column<T>& column, uint8_t const* p) {
+  appendValue(column, Slice(p));
+}
+
+inline void appendFixedWidth(Column<double>& column, uint8_t const* p) {
+  if (*p == 0x1b) {
+    // Double
+    double value;
+    std::memcpy(&value, p + 1, sizeof(double));
+    column.append(value);
+  } else {
+    appendValue(column, Slice(p));
+  }
+}
+
+// decodes the members of an Array with equally sized members, without
+// computing each member's byte size
+template <typename T>
+void decodeFixedWidth(uint8_t const* p, ValueLength width, ValueLength n,
+                      Column<T>& column) {
+  if (width == 1) {
+    while (n > 0) {
+      ValueLength done = decodeSingleBytes(p, n, column);
+      p += done;
+      n -= done;
+      // decode the next block one by one
+      ValueLength const count = (std::min)(n, static_cast<ValueLength>(16));
+      for (ValueLength i = 0; i < count; ++i) {
+        appendValue(column, Slice(p + i));
+      }
+      p += count;
+      n -= count;
+    }
+    return;
+  }
+
+  for (ValueLength i = 0; i < n; ++i) {
+    appendFixedWidth(column, p);
+    p += width;
+  }
+}
+
+template <typename T>
+void decodeArray(Slice array, Column<T>& column) {
+  array = array.resolveExternals();
+  ArrayIterator it(array);
+  ValueLength const n = it.size();
+  column.reserve(column.size() + checkOverflow(n));
+
+  if (n == 0) {
+    return;
+  }
+
+  uint8_t const h = array.head();
+  if (h >= 0x02 && h <= 0x05) {
+    // all members have the same byte size
+    uint8_t const* p = it.value().start();
+    decodeFixedWidth(p, Slice(p).byteSize(), n, column);
+    return;
+  }
+
+  while (it.valid()) {
+    appendValue(column, it.value());
+    it.next();
+  }
+}
+
+template <typename T, typename F>
+void decodeMembers(Slice array, Column<T>& column, F&& extract) {
+  ArrayIterator it(array.resolveExternals());
+  column.reserve(column.size() + checkOverflow(it.size()));
+
+  while (it.valid()) {
+    appendValue(column, extract(it.value().resolveExternal()));
+    it.next();
+  }
+}
+
+template <typename T>
+void decodeAttribute(Slice array, StringRef const& attribute, Column<T>& column) {
+  decodeMembers(array, column, [&attribute](Slice member) -> Slice {
+    if (!member.isObject()) {
+      return Slice();
+    }
+    return member.get(attribute);
+  });
+}
+
+template <typename T>
+void decodePath(Slice array, CompiledPath const& path, Column<T>& column) {
+  decodeMembers(array, column, [&path](Slice member) -> Slice {
+    return path.get(member);
+  });
+}
+
+} // namespace
+
+void ColumnDecoder::decode(Slice array, DoubleColumn& column) {
+  decodeArray(array, column);
+}
+
+void ColumnDecoder::decode(Slice array, IntColumn& column) {
+  decodeArray(array, column);
+}
+
+void ColumnDecoder::decode(Slice array, BoolColumn& column) {
+  decodeArray(array, column);
+}
+
+void ColumnDecoder::decode(Slice array, StringColumn& column) {
+  decodeArray(array, column);
+}
+
+void ColumnDecoder::decode(Slice array, StringRef const& attribute, DoubleColumn& column) {
+  decodeAttribute(array, attribute, column);
+}
+
+void ColumnDecoder::decode(Slice array, StringRef const& attribute, IntColumn& column) {
+  decodeAttribute(array, attribute, column);
+}
+
+void ColumnDecoder::decode(Slice array, StringRef const& attribute, BoolColumn& column) {
+  decodeAttribute(array, attribute, column);
+}
+
+void ColumnDecoder::decode(Slice array, StringRef const& attribute, StringColumn& column) {
+  decodeAttribute(array, attribute, column);
+}
+
+void ColumnDecoder::decode(Slice array, CompiledPath const& path, DoubleColumn& column) {
+  decodePath(array, path, column);
+}
+
+void ColumnDecoder::decode(Slice array, CompiledPath const& path, IntColumn& column) {
+  decodePath(array, path, column);
+}
+
+void ColumnDecoder::decode(Slice array, CompiledPath const& path, BoolColumn& column) {
+  decodePath(array, path, column);
+}
+
+void ColumnDecoder::decode(Slice array, CompiledPath const& path, StringColumn& column) {
+  decodePath(array, path, column);
+}
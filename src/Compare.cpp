@@ -78,7 +78,12 @@ bool NormalizedCompare::equalsStrings(Slice lhs, Slice rhs) {
   return (nl == nr && (memcmp(left, right, nl) == 0));
 }
 
-bool NormalizedCompare::equals(Slice lhs, Slice rhs) {
+namespace {
+
+// compares two Slices like NormalizedCompare::equals. if anyType is set,
+// values of types that have no normalized comparison are compared on the
+// binary level instead of throwing
+bool equalsNormalized(Slice lhs, Slice rhs, bool anyType) {
   lhs = lhs.resolveExternals();
   rhs = rhs.resolveExternals();
   ValueType lhsType = valueTypeGroup(lhs.type());
@@ -105,10 +110,10 @@ bool NormalizedCompare::equals(Slice lhs, Slice rhs) {
     case ValueType::Int:
     case ValueType::UInt:
     case ValueType::SmallInt: {
-      return equalsNumbers(lhs, rhs);
+      return NormalizedCompare::equalsNumbers(lhs, rhs);
     }
     case ValueType::String: {
-      return equalsStrings(lhs, rhs);
+      return NormalizedCompare::equalsStrings(lhs, rhs);
     }
     case ValueType::Array: {
       ArrayIterator lhsValue(lhs);
@@ -121,7 +126,7 @@ bool NormalizedCompare::equals(Slice lhs, Slice rhs) {
       }
       for (ValueLength i = 0; i < n; ++i) {
         // recurse
-        if (!equals(lhsValue.value(), rhsValue.value())) {
+        if (!equalsNormalized(lhsValue.value(), rhsValue.value(), anyType)) {
           return false;
         }
         lhsValue.next();
@@ -136,21 +141,37 @@ bool NormalizedCompare::equals(Slice lhs, Slice rhs) {
       Collection::unorderedKeys(rhs, keys);
       for (auto const& key : keys) {
         // recurse
-        if (!equals(lhs.get(key), rhs.get(key))) {
+        if (!equalsNormalized(lhs.get(key), rhs.get(key), anyType)) {
           return false;
         }
       }
       return true;
     }
     case ValueType::Custom: {
+      if (anyType) {
+        return lhs.binaryEquals(rhs);
+      }
       throw Exception(Exception::NotImplemented, "equals comparison for Custom type is not implemented");
     }
     default: {
+      if (anyType) {
+        return lhs.binaryEquals(rhs);
+      }
       throw Exception(Exception::InternalError, "invalid value type for equals comparison");
     }
   }
 }
 
+}
+
+bool NormalizedCompare::equals(Slice lhs, Slice rhs) {
+  return equalsNormalized(lhs, rhs, false);
+}
+
+bool NormalizedCompare::equalsAnyType(Slice lhs, Slice rhs) {
+  return equalsNormalized(lhs, rhs, true);
+}
+
 size_t NormalizedCompare::Hash::operator()(arangodb::velocypack::Slice const& slice) const {
   return static_cast<size_t>(slice.normalizedHash());
 }
@@ -0,0 +1,391 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/CompiledFilter.h"
+#include "velocypack/Compare.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/StringRef.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// number of paths for which the resolved values are kept on the stack
+constexpr std::size_t MaxStackPaths = 16;
+
+// returns a negative value, 0 or a positive value if lhs is less than,
+// equal to or greater than rhs. sets comparable to false if the values
+// cannot be ordered
+int compareOrdered(Slice lhs, Slice rhs, bool& comparable) {
+  comparable = true;
+  if (lhs.isNumber() && rhs.isNumber()) {
+    if ((lhs.isInt() || lhs.isSmallInt()) && (rhs.isInt() || rhs.isSmallInt())) {
+      int64_t l = lhs.getInt();
+      int64_t r = rhs.getInt();
+      return (l < r) ? -1 : (l > r ? 1 : 0);
+    }
+    if (lhs.isUInt() && rhs.isUInt()) {
+      uint64_t l = lhs.getUInt();
+      uint64_t r = rhs.getUInt();
+      return (l < r) ? -1 : (l > r ? 1 : 0);
+    }
+    double l = lhs.getNumber<double>();
+    double r = rhs.getNumber<double>();
+    if (std::isnan(l) || std::isnan(r)) {
+      comparable = false;
+      return 0;
+    }
+    return (l < r) ? -1 : (l > r ? 1 : 0);
+  }
+  if (lhs.isString() && rhs.isString()) {
+    ValueLength l, r;
+    char const* lp = lhs.getStringUnchecked(l);
+    char const* rp = rhs.getStringUnchecked(r);
+    int res = std::memcmp(lp, rp, checkOverflow((std::min)(l, r)));
+    if (res != 0) {
+      return res;
+    }
+    return (l < r) ? -1 : (l > r ? 1 : 0);
+  }
+  if (lhs.isBool() && rhs.isBool()) {
+    return static_cast<int>(lhs.getBool()) - static_cast<int>(rhs.getBool());
+  }
+  comparable = false;
+  return 0;
+}
+
+bool equalValues(Slice lhs, Slice rhs) {
+  if (lhs.isString() && rhs.isString()) {
+    ValueLength l, r;
+    char const* lp = lhs.getStringUnchecked(l);
+    char const* rp = rhs.getStringUnchecked(r);
+    return l == r && std::memcmp(lp, rp, checkOverflow(l)) == 0;
+  }
+  if (lhs.isNone() || rhs.isNone()) {
+    return false;
+  }
+  return NormalizedCompare::equalsAnyType(lhs, rhs);
+}
+
+Slice expectOperand(Slice expression, ValueLength index) {
+  Slice operand = expression.at(index);
+  if (operand.isNone()) {
+    throw Exception(Exception::InvalidValueType, "Expecting filter operand");
+  }
+  return operand;
+}
+
+}  // namespace
+
+CompiledFilter::CompiledFilter(Slice expression) {
+  compile(expression);
+}
+
+bool CompiledFilter::matches(Slice document) const {
+  if (_paths.size() <= MaxStackPaths) {
+    uint8_t const* resolved[MaxStackPaths];
+    std::fill_n(resolved, _paths.size(), nullptr);
+    return evaluate(document, resolved);
+  }
+  std::vector<uint8_t const*> resolved(_paths.size(), nullptr);
+  return evaluate(document, resolved.data());
+}
+
+void CompiledFilter::select(Slice array, std::vector<ValueLength>& positions) const {
+  ArrayIterator it(array);
+  evaluateAll([&it]() {
+    Slice s = it.value();
+    it.next();
+    return s;
+  }, it.size(), &positions, nullptr);
+}
+
+void CompiledFilter::select(std::vector<Slice> const& documents,
+                            std::vector<ValueLength>& positions) const {
+  auto it = documents.begin();
+  evaluateAll([&it]() { return *it++; }, documents.size(), &positions, nullptr);
+}
+
+ValueLength CompiledFilter::count(Slice array) const {
+  ValueLength result = 0;
+  ArrayIterator it(array);
+  evaluateAll([&it]() {
+    Slice s = it.value();
+    it.next();
+    return s;
+  }, it.size(), nullptr, &result);
+  return result;
+}
+
+Builder& CompiledFilter::filter(Builder& builder, Slice array) const {
+  ArrayIterator it(array);
+  std::vector<uint8_t const*> resolved(_paths.size());
+
+  builder.openArray();
+  while (it.valid()) {
+    Slice s = it.value();
+    std::fill(resolved.begin(), resolved.end(), nullptr);
+    if (evaluate(s, resolved.data())) {
+      builder.add(s);
+    }
+    it.next();
+  }
+  builder.close();
+  return builder;
+}
+
+Builder CompiledFilter::filter(Slice array) const {
+  Builder b;
+  filter(b, array);
+  return b;
+}
+
+// evaluates the program for n documents, which are produced by next().
+// the storage for resolved paths is allocated only once
+template <typename F>
+void CompiledFilter::evaluateAll(F&& next, ValueLength n,
+                                 std::vector<ValueLength>* positions,
+                                 ValueLength* count) const {
+  std::vector<uint8_t const*> resolved(_paths.size());
+  for (ValueLength i = 0; i < n; ++i) {
+    std::fill(resolved.begin(), resolved.end(), nullptr);
+    if (evaluate(next(), resolved.data())) {
+      if (positions != nullptr) {
+        positions->push_back(i);
+      }
+      if (count != nullptr) {
+        ++*count;
+      }
+    }
+  }
+}
+
+bool CompiledFilter::evaluate(Slice document, uint8_t const** resolved) const {
+  auto value = [this, &document, resolved](uint32_t path) -> Slice {
+    if (resolved[path] == nullptr) {
+      resolved[path] = _paths[path].get(document).start();
+    }
+    return Slice(resolved[path]);
+  };
+
+  bool result = true;
+  bool comparable;
+  std::size_t const n = _program.size();
+  std::size_t pc = 0;
+
+  while (pc < n) {
+    Instruction const& ins = _program[pc];
+    switch (ins.op) {
+      case OpCode::Const:
+        result = (ins.operand != 0);
+        break;
+      case OpCode::Exists:
+        result = !value(ins.path).isNone();
+        break;
+      case OpCode::Equal:
+        result = equalValues(value(ins.path), Slice(_constants.data() + ins.operand));
+        break;
+      case OpCode::NotEqual:
+        result = !equalValues(value(ins.path), Slice(_constants.data() + ins.operand));
+        break;
+      case OpCode::Less:
+        result = compareOrdered(value(ins.path), Slice(_constants.data() + ins.operand),
+                                comparable) < 0 && comparable;
+        break;
+      case OpCode::LessEqual:
+        result = compareOrdered(value(ins.path), Slice(_constants.data() + ins.operand),
+                                comparable) <= 0 && comparable;
+        break;
+      case OpCode::Greater:
+        result = compareOrdered(value(ins.path), Slice(_constants.data() + ins.operand),
+                                comparable) > 0 && comparable;
+        break;
+      case OpCode::GreaterEqual:
+        result = compareOrdered(value(ins.path), Slice(_constants.data() + ins.operand),
+                                comparable) >= 0 && comparable;
+        break;
+      case OpCode::In:
+        result = contains(_lists[ins.operand], value(ins.path));
+        break;
+      case OpCode::Not:
+        result = !result;
+        break;
+      case OpCode::JumpIfFalse:
+        if (!result) {
+          pc = ins.operand;
+          continue;
+        }
+        break;
+      case OpCode::JumpIfTrue:
+        if (result) {
+          pc = ins.operand;
+          continue;
+        }
+        break;
+    }
+    ++pc;
+  }
+
+  return result;
+}
+
+bool CompiledFilter::contains(List const& list, Slice value) const {
+  if (value.isNone()) {
+    return false;
+  }
+  std::size_t const hash = NormalizedCompare::Hash()(value);
+  auto it = std::lower_bound(list.begin(), list.end(),
+                             std::make_pair(hash, ValueLength(0)));
+  while (it != list.end() && (*it).first == hash) {
+    if (equalValues(value, Slice(_constants.data() + (*it).second))) {
+      return true;
+    }
+    ++it;
+  }
+  return false;
+}
+
+void CompiledFilter::compile(Slice expression) {
+  if (!expression.isArray() || expression.isEmptyArray() ||
+      !expression.at(0).isString()) {
+    throw Exception(Exception::InvalidValueType,
+                    "Expecting filter expression Array with operator");
+  }
+
+  StringRef const op(expression.at(0));
+  ValueLength const n = expression.length();
+
+  if (op == "and" || op == "or") {
+    if (n == 1) {
+      emit(OpCode::Const, 0, op == "and" ? 1 : 0);
+      return;
+    }
+    OpCode const jump = (op == "and") ? OpCode::JumpIfFalse : OpCode::JumpIfTrue;
+    std::vector<std::size_t> jumps;
+    for (ValueLength i = 1; i < n; ++i) {
+      compile(expression.at(i));
+      if (i + 1 < n) {
+        jumps.push_back(_program.size());
+        emit(jump, 0, 0);
+      }
+    }
+    // all jumps go to the end of the sub-expression
+    for (auto const& j : jumps) {
+      _program[j].operand = static_cast<uint32_t>(_program.size());
+    }
+    return;
+  }
+
+  if (op == "not") {
+    if (n != 2) {
+      throw Exception(Exception::InvalidValueType, "Expecting one operand for 'not'");
+    }
+    compile(expression.at(1));
+    emit(OpCode::Not, 0, 0);
+    return;
+  }
+
+  if (op == "exists") {
+    if (n != 2) {
+      throw Exception(Exception::InvalidValueType, "Expecting one operand for 'exists'");
+    }
+    emit(OpCode::Exists, addPath(expression.at(1)), 0);
+    return;
+  }
+
+  if (n != 3) {
+    throw Exception(Exception::InvalidValueType, "Expecting two filter operands");
+  }
+  uint32_t const path = addPath(expectOperand(expression, 1));
+  Slice const operand = expectOperand(expression, 2);
+
+  if (op == "in") {
+    if (!operand.isArray()) {
+      throw Exception(Exception::InvalidValueType, "Expecting Array for 'in'");
+    }
+    List list;
+    NormalizedCompare::Hash hasher;
+    ArrayIterator it(operand);
+    list.reserve(checkOverflow(it.size()));
+    while (it.valid()) {
+      Slice v = it.value();
+      list.emplace_back(hasher(v), addConstant(v));
+      it.next();
+    }
+    std::sort(list.begin(), list.end());
+    emit(OpCode::In, path, static_cast<uint32_t>(_lists.size()));
+    _lists.emplace_back(std::move(list));
+    return;
+  }
+
+  OpCode code;
+  if (op == "==") {
+    code = OpCode::Equal;
+  } else if (op == "!=") {
+    code = OpCode::NotEqual;
+  } else if (op == "<") {
+    code = OpCode::Less;
+  } else if (op == "<=") {
+    code = OpCode::LessEqual;
+  } else if (op == ">") {
+    code = OpCode::Greater;
+  } else if (op == ">=") {
+    code = OpCode::GreaterEqual;
+  } else {
+    throw Exception(Exception::InvalidValueType, "Unknown filter operator");
+  }
+  emit(code, path, addConstant(operand));
+}
+
+uint32_t CompiledFilter::addPath(Slice path) {
+  if (!path.isString()) {
+    throw Exception(Exception::InvalidValueType, "Expecting String for filter path");
+  }
+  std::string expression = path.copyString();
+  // each distinct path is resolved only once per document
+  for (std::size_t i = 0; i < _pathExpressions.size(); ++i) {
+    if (_pathExpressions[i] == expression) {
+      return static_cast<uint32_t>(i);
+    }
+  }
+  _paths.emplace_back(expression);
+  _pathExpressions.emplace_back(std::move(expression));
+  return static_cast<uint32_t>(_paths.size() - 1);
+}
+
+uint32_t CompiledFilter::addConstant(Slice value) {
+  ValueLength const offset = _constants.size();
+  if (offset > UINT32_MAX) {
+    throw Exception(Exception::NumberOutOfRange, "Filter expression is too large");
+  }
+  _constants.append(value.start(), value.byteSize());
+  return static_cast<uint32_t>(offset);
+}
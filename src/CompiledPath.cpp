@@ -0,0 +1,292 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/CompiledPath.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// parses a sequence of decimal digits, optionally preceded by a minus sign
+// returns false if the input is not a valid number
+bool parseIndex(char const* p, char const* e, int64_t& result) {
+  bool negative = false;
+  if (p < e && *p == '-') {
+    negative = true;
+    ++p;
+  }
+  if (p == e || e - p > 18) {
+    return false;
+  }
+  int64_t value = 0;
+  while (p < e) {
+    if (*p < '0' || *p > '9') {
+      return false;
+    }
+    value = value * 10 + (*p - '0');
+    ++p;
+  }
+  result = negative ? -value : value;
+  return true;
+}
+
+inline bool isJsonPathDelimiter(char c) {
+  return (c == '.' || c == '[');
+}
+
+// whether a JSON Pointer token is an array index, i.e. made of digits only
+// and without leading zeros
+bool isJsonPointerIndex(std::string const& token, int64_t& index) {
+  if (token.empty() || (token.size() > 1 && token[0] == '0')) {
+    return false;
+  }
+  for (char c : token) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+  }
+  return parseIndex(token.data(), token.data() + token.size(), index);
+}
+
+}  // namespace
+
+CompiledPath::CompiledPath(StringRef const& expression)
+    : _hasWildcard(false) {
+  if (expression.empty()) {
+    // the empty path refers to the start value itself
+    return;
+  }
+  if (expression[0] == '/') {
+    parseJsonPointer(expression);
+  } else {
+    parseJsonPath(expression);
+  }
+}
+
+CompiledPath::CompiledPath(std::vector<std::string> const& attributes)
+    : _hasWildcard(false) {
+  if (attributes.empty()) {
+    throw Exception(Exception::InvalidAttributePath);
+  }
+  _steps.reserve(attributes.size());
+  for (auto const& it : attributes) {
+    addStep(StepType::Attribute, std::string(it), 0);
+  }
+}
+
+std::string CompiledPath::toString() const {
+  // JSON Pointer cannot express Index steps, and turns "*" and digit-only
+  // attribute names into other step types. such paths are returned in
+  // JSONPath syntax, which in turn cannot express AttributeOrIndex steps.
+  // paths compiled from either syntax can thus be compiled again from
+  // the result
+  bool jsonPointer = true;
+  for (auto const& step : _steps) {
+    int64_t index;
+    if (step.type == StepType::Index ||
+        (step.type == StepType::Attribute &&
+         (step.name == "*" || isJsonPointerIndex(step.name, index)))) {
+      jsonPointer = false;
+      break;
+    }
+  }
+
+  std::string result;
+  if (!jsonPointer) {
+    result.push_back('$');
+  }
+  for (auto const& step : _steps) {
+    if (!jsonPointer) {
+      VELOCYPACK_ASSERT(step.type != StepType::AttributeOrIndex);
+      result.push_back('[');
+      if (step.type == StepType::Wildcard) {
+        result.push_back('*');
+      } else if (step.type == StepType::Index) {
+        result.append(std::to_string(step.index));
+      } else {
+        result.push_back('\'');
+        for (char c : step.name) {
+          if (c == '\'' || c == '\\') {
+            result.push_back('\\');
+          }
+          result.push_back(c);
+        }
+        result.push_back('\'');
+      }
+      result.push_back(']');
+      continue;
+    }
+
+    result.push_back('/');
+    if (step.type == StepType::Wildcard) {
+      result.push_back('*');
+      continue;
+    }
+    for (char c : step.name) {
+      if (c == '~') {
+        result.append("~0", 2);
+      } else if (c == '/') {
+        result.append("~1", 2);
+      } else {
+        result.push_back(c);
+      }
+    }
+  }
+  return result;
+}
+
+void CompiledPath::addStep(StepType type, std::string&& name, int64_t index) {
+  if (type == StepType::Wildcard) {
+    _hasWildcard = true;
+  }
+  _steps.emplace_back(type, std::move(name), index);
+}
+
+void CompiledPath::parseJsonPointer(StringRef const& expression) {
+  VELOCYPACK_ASSERT(!expression.empty() && expression[0] == '/');
+
+  char const* p = expression.data() + 1;
+  char const* e = expression.data() + expression.size();
+
+  while (true) {
+    std::string token;
+    while (p < e && *p != '/') {
+      char c = *p++;
+      if (c == '~') {
+        // ~0 => ~, ~1 => /
+        if (p == e || (*p != '0' && *p != '1')) {
+          throw Exception(Exception::InvalidAttributePath,
+                          "Invalid escape sequence in JSON Pointer");
+        }
+        c = (*p++ == '0') ? '~' : '/';
+      }
+      token.push_back(c);
+    }
+
+    int64_t index = 0;
+    if (token.size() == 1 && token[0] == '*') {
+      addStep(StepType::Wildcard, std::string(), 0);
+    } else if (isJsonPointerIndex(token, index)) {
+      addStep(StepType::AttributeOrIndex, std::move(token), index);
+    } else {
+      addStep(StepType::Attribute, std::move(token), 0);
+    }
+
+    if (p == e) {
+      break;
+    }
+    VELOCYPACK_ASSERT(*p == '/');
+    ++p;
+  }
+}
+
+void CompiledPath::parseJsonPath(StringRef const& expression) {
+  char const* p = expression.data();
+  char const* e = expression.data() + expression.size();
+
+  if (*p == '$') {
+    ++p;
+  } else if (!isJsonPathDelimiter(*p)) {
+    // bare attribute name or wildcard at the start, e.g. "foo.bar" or
+    // "*.bar"
+    char const* s = p;
+    while (p < e && !isJsonPathDelimiter(*p)) {
+      ++p;
+    }
+    if (p - s == 1 && *s == '*') {
+      addStep(StepType::Wildcard, std::string(), 0);
+    } else {
+      addStep(StepType::Attribute, std::string(s, p - s), 0);
+    }
+  }
+
+  while (p < e) {
+    if (*p == '.') {
+      ++p;
+      char const* s = p;
+      while (p < e && !isJsonPathDelimiter(*p)) {
+        ++p;
+      }
+      if (p == s) {
+        throw Exception(Exception::InvalidAttributePath,
+                        "Expecting attribute name after '.'");
+      }
+      if (p - s == 1 && *s == '*') {
+        addStep(StepType::Wildcard, std::string(), 0);
+      } else {
+        addStep(StepType::Attribute, std::string(s, p - s), 0);
+      }
+      continue;
+    }
+
+    if (*p != '[') {
+      throw Exception(Exception::InvalidAttributePath,
+                      "Expecting '.' or '['");
+    }
+    ++p;
+    if (p < e && (*p == '\'' || *p == '"')) {
+      // quoted attribute name
+      char const quote = *p++;
+      std::string name;
+      while (p < e && *p != quote) {
+        if (*p == '\\' && p + 1 < e) {
+          ++p;
+        }
+        name.push_back(*p++);
+      }
+      if (p == e) {
+        throw Exception(Exception::InvalidAttributePath,
+                        "Unterminated attribute name");
+      }
+      ++p;
+      if (p == e || *p != ']') {
+        throw Exception(Exception::InvalidAttributePath, "Expecting ']'");
+      }
+      ++p;
+      addStep(StepType::Attribute, std::move(name), 0);
+      continue;
+    }
+
+    char const* s = p;
+    while (p < e && *p != ']') {
+      ++p;
+    }
+    if (p == e) {
+      throw Exception(Exception::InvalidAttributePath, "Expecting ']'");
+    }
+    int64_t index = 0;
+    if (p - s == 1 && *s == '*') {
+      addStep(StepType::Wildcard, std::string(), 0);
+    } else if (parseIndex(s, p, index)) {
+      addStep(StepType::Index, std::string(), index);
+    } else {
+      throw Exception(Exception::InvalidAttributePath,
+                      "Expecting array index or '*'");
+    }
+    ++p;
+  }
+}
@@ -0,0 +1,421 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/CsvParser.h"
+#include "velocypack/Utf8Helper.h"
+#include "velocypack/Value.h"
+
+#include "asm-functions.h"
+
+using namespace arangodb::velocypack;
+
+CsvParser::CsvParser(Options const* options)
+    : options(options),
+      delimiter(','),
+      quote('"'),
+      header(true),
+      detectTypes(true),
+      _builderPtr(nullptr),
+      _start(nullptr),
+      _size(0),
+      _pos(0),
+      _rowPos(0) {
+  if (VELOCYPACK_UNLIKELY(options == nullptr)) {
+    throw Exception(Exception::InternalError, "Options cannot be a nullptr");
+  }
+  _builder.reset(new Builder(options));
+  _builderPtr = _builder.get();
+}
+
+CsvParser::CsvParser(Builder& builder, Options const* options)
+    : options(options),
+      delimiter(','),
+      quote('"'),
+      header(true),
+      detectTypes(true),
+      _builderPtr(nullptr),
+      _start(nullptr),
+      _size(0),
+      _pos(0),
+      _rowPos(0) {
+  if (VELOCYPACK_UNLIKELY(options == nullptr)) {
+    throw Exception(Exception::InternalError, "Options cannot be a nullptr");
+  }
+  _builder.reset(&builder, BuilderNonDeleter());
+  _builderPtr = _builder.get();
+}
+
+ValueLength CsvParser::parse(uint8_t const* start, std::size_t size) {
+  if (VELOCYPACK_UNLIKELY(delimiter == quote || delimiter == '\r' ||
+                          delimiter == '\n' || quote == '\r' ||
+                          quote == '\n')) {
+    throw Exception(Exception::InternalError,
+                    "Invalid CSV delimiter or quote character");
+  }
+
+  _start = start;
+  _size = size;
+  _pos = 0;
+  _rowPos = 0;
+  _columns.clear();
+  _sortedColumns.clear();
+  if (options->clearBuilderBeforeParse) {
+    _builderPtr->clear();
+  }
+
+  // skip a UTF-8 byte order mark
+  if (size >= 3 && start[0] == 0xef && start[1] == 0xbb && start[2] == 0xbf) {
+    _pos = 3;
+  }
+
+  if (header && readRow()) {
+    readHeader();
+  }
+
+  _builderPtr->add(Value(ValueType::Array));
+  ValueLength nr = 0;
+  while (readRow()) {
+    addRow();
+    ++nr;
+  }
+  _builderPtr->close();
+  return nr;
+}
+
+bool CsvParser::readRow() {
+  // skip empty lines
+  while (_pos < _size && (_start[_pos] == '\n' || _start[_pos] == '\r')) {
+    ++_pos;
+  }
+  if (_pos >= _size) {
+    return false;
+  }
+
+  _rowPos = _pos;
+  _fields.clear();
+  _unescaped.clear();
+  uint8_t const d = static_cast<uint8_t>(delimiter);
+  uint8_t const q = static_cast<uint8_t>(quote);
+
+  while (true) {
+    Field field{_pos, 0, false, false};
+    if (_pos < _size && _start[_pos] == q) {
+      readQuotedField(field);
+      if (VELOCYPACK_UNLIKELY(_pos < _size && _start[_pos] != d &&
+                              _start[_pos] != '\r' && _start[_pos] != '\n')) {
+        throw Exception(Exception::ParseError,
+                        "Unexpected character after quoted CSV field");
+      }
+    } else {
+      // quotes inside unquoted fields are kept as they are
+      std::size_t p = _pos;
+      while (true) {
+        p += CSVFieldScan(_start + p, _size - p, d, q);
+        if (p < _size && _start[p] == q) {
+          ++p;
+          continue;
+        }
+        break;
+      }
+      field.length = p - _pos;
+      _pos = p;
+    }
+    _fields.push_back(field);
+
+    if (_pos >= _size) {
+      break;
+    }
+    uint8_t const c = _start[_pos++];
+    if (c == d) {
+      continue;
+    }
+    // end of the row
+    if (c == '\r' && _pos < _size && _start[_pos] == '\n') {
+      ++_pos;
+    }
+    break;
+  }
+  return true;
+}
+
+void CsvParser::readQuotedField(Field& field) {
+  uint8_t const q = static_cast<uint8_t>(quote);
+  field.quoted = true;
+
+  // skip the opening quote
+  std::size_t const contentStart = ++_pos;
+  std::size_t begin = contentStart;
+  std::size_t p = contentStart;
+  while (true) {
+    // stops at quotes and line breaks, which are part of the field
+    p += CSVFieldScan(_start + p, _size - p, q, q);
+    if (VELOCYPACK_UNLIKELY(p >= _size)) {
+      throw Exception(Exception::ParseError, "Unterminated quoted CSV field");
+    }
+    if (_start[p] != q) {
+      ++p;
+      continue;
+    }
+    if (p + 1 < _size && _start[p + 1] == q) {
+      // a doubled quote, which stands for a single one
+      if (!field.unescaped) {
+        field.unescaped = true;
+        field.offset = _unescaped.size();
+      }
+      _unescaped.append(reinterpret_cast<char const*>(_start) + begin,
+                        p + 1 - begin);
+      p += 2;
+      begin = p;
+      continue;
+    }
+    break;
+  }
+
+  if (field.unescaped) {
+    _unescaped.append(reinterpret_cast<char const*>(_start) + begin,
+                      p - begin);
+    field.length = _unescaped.size() - field.offset;
+  } else {
+    field.offset = contentStart;
+    field.length = p - contentStart;
+  }
+  // skip the closing quote
+  _pos = p + 1;
+}
+
+void CsvParser::readHeader() {
+  for (auto const& field : _fields) {
+    char const* p = fieldData(field);
+    if (options->validateUtf8Strings &&
+        !Utf8Helper::isValidUtf8(reinterpret_cast<uint8_t const*>(p),
+                                 field.length)) {
+      throw Exception(Exception::InvalidUtf8Sequence);
+    }
+    _columns.emplace_back(p, field.length);
+  }
+
+  // the order in which the keys of each row are added. std::string
+  // compares like the Builder sorts Object keys
+  _sortedColumns.resize(_columns.size());
+  for (std::size_t i = 0; i < _columns.size(); ++i) {
+    _sortedColumns[i] = i;
+  }
+  std::sort(_sortedColumns.begin(), _sortedColumns.end(),
+            [this](std::size_t a, std::size_t b) {
+              return _columns[a] < _columns[b];
+            });
+  for (std::size_t i = 1; i < _sortedColumns.size(); ++i) {
+    if (_columns[_sortedColumns[i - 1]] == _columns[_sortedColumns[i]]) {
+      throw Exception(Exception::ParseError, "Duplicate CSV column name");
+    }
+  }
+}
+
+void CsvParser::addRow() {
+  if (!header) {
+    _builderPtr->openArray();
+    for (auto const& field : _fields) {
+      addField(field, nullptr);
+    }
+    _builderPtr->close();
+    return;
+  }
+
+  if (VELOCYPACK_UNLIKELY(_fields.size() != _columns.size())) {
+    throw Exception(Exception::ParseError,
+                    "Wrong number of fields in CSV row");
+  }
+  _builderPtr->openObject();
+  for (std::size_t column : _sortedColumns) {
+    addField(_fields[column], &_columns[column]);
+  }
+  _builderPtr->closeSorted();
+}
+
+void CsvParser::addField(Field const& field, std::string const* key) {
+  char const* p = fieldData(field);
+  std::size_t const length = field.length;
+
+  if (detectTypes && !field.quoted) {
+    if (length == 0) {
+      add(key, Value(ValueType::Null));
+      return;
+    }
+    switch (p[0]) {
+      case 'n': {
+        if (length == 4 && memcmp(p, "null", 4) == 0) {
+          add(key, Value(ValueType::Null));
+          return;
+        }
+        break;
+      }
+      case 't': {
+        if (length == 4 && memcmp(p, "true", 4) == 0) {
+          add(key, Value(true));
+          return;
+        }
+        break;
+      }
+      case 'f': {
+        if (length == 5 && memcmp(p, "false", 5) == 0) {
+          add(key, Value(false));
+          return;
+        }
+        break;
+      }
+      case '-':
+      case '0':
+      case '1':
+      case '2':
+      case '3':
+      case '4':
+      case '5':
+      case '6':
+      case '7':
+      case '8':
+      case '9': {
+        if (addNumber(p, length, key)) {
+          return;
+        }
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+
+  if (options->validateUtf8Strings &&
+      !Utf8Helper::isValidUtf8(reinterpret_cast<uint8_t const*>(p), length)) {
+    throw Exception(Exception::InvalidUtf8Sequence);
+  }
+  add(key, ValuePair(p, length, ValueType::String));
+}
+
+bool CsvParser::addNumber(char const* p, std::size_t length,
+                          std::string const* key) {
+  // check for the JSON number grammar, so that e.g. leading zeros, hex
+  // numbers and trailing text keep a field a String
+  std::size_t i = 0;
+  bool const negative = (p[0] == '-');
+  if (negative) {
+    ++i;
+  }
+  std::size_t const digitsStart = i;
+  if (i < length && p[i] == '0') {
+    ++i;
+  } else {
+    while (i < length && p[i] >= '0' && p[i] <= '9') {
+      ++i;
+    }
+  }
+  std::size_t const digitsEnd = i;
+  if (digitsEnd == digitsStart) {
+    return false;
+  }
+
+  bool isInteger = true;
+  if (i < length && p[i] == '.') {
+    std::size_t const fractionStart = ++i;
+    while (i < length && p[i] >= '0' && p[i] <= '9') {
+      ++i;
+    }
+    if (i == fractionStart) {
+      return false;
+    }
+    isInteger = false;
+  }
+  if (i < length && (p[i] == 'e' || p[i] == 'E')) {
+    ++i;
+    if (i < length && (p[i] == '+' || p[i] == '-')) {
+      ++i;
+    }
+    std::size_t const exponentStart = i;
+    while (i < length && p[i] >= '0' && p[i] <= '9') {
+      ++i;
+    }
+    if (i == exponentStart) {
+      return false;
+    }
+    isInteger = false;
+  }
+  if (i != length) {
+    return false;
+  }
+
+  if (isInteger) {
+    uint64_t value = 0;
+    bool overflow = false;
+    for (std::size_t j = digitsStart; j < digitsEnd; ++j) {
+      uint64_t const digit = static_cast<uint64_t>(p[j] - '0');
+      if (value > (UINT64_MAX - digit) / 10) {
+        overflow = true;
+        break;
+      }
+      value = value * 10 + digit;
+    }
+    if (!overflow) {
+      if (!negative) {
+        add(key, Value(value));
+        return true;
+      }
+      if (value <= static_cast<uint64_t>(INT64_MAX)) {
+        add(key, Value(-static_cast<int64_t>(value)));
+        return true;
+      }
+      if (value == toUInt64(INT64_MIN)) {
+        add(key, Value(INT64_MIN));
+        return true;
+      }
+    }
+    // too large for an integer, so it becomes a Double
+  }
+
+  // strtod needs a NUL-terminated copy of the field
+  char buffer[64];
+  std::string large;
+  char const* s;
+  if (length < sizeof(buffer)) {
+    memcpy(&buffer[0], p, length);
+    buffer[length] = '\0';
+    s = &buffer[0];
+  } else {
+    large.assign(p, length);
+    s = large.c_str();
+  }
+  double const value = strtod(s, nullptr);
+  if (!std::isfinite(value)) {
+    // out of range for a Double, so it is kept as a String
+    return false;
+  }
+  add(key, Value(value));
+  return true;
+}
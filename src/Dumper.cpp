@@ -29,225 +29,173 @@
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Dumper.h"
 #include "velocypack/Iterator.h"
+#include "velocypack/Projection.h"
 #include "velocypack/ValueType.h"
+#include "asm-functions.h"
+#include "number-format.h"
 
 using namespace arangodb::velocypack;
 
-// forward for fpconv function declared elsewhere
-namespace arangodb {
-namespace velocypack {
-int fpconv_dtoa(double fp, char dest[24]);
-}
-};
-
-void Dumper::appendUInt(uint64_t v) {
-  if (10000000000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 10000000000000000000ULL) % 10);
-  }
-  if (1000000000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 1000000000000000000ULL) % 10);
-  }
-  if (100000000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 100000000000000000ULL) % 10);
-  }
-  if (10000000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 10000000000000000ULL) % 10);
-  }
-  if (1000000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 1000000000000000ULL) % 10);
-  }
-  if (100000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 100000000000000ULL) % 10);
-  }
-  if (10000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 10000000000000ULL) % 10);
-  }
-  if (1000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 1000000000000ULL) % 10);
-  }
-  if (100000000000ULL <= v) {
-    _sink->push_back('0' + (v / 100000000000ULL) % 10);
-  }
-  if (10000000000ULL <= v) {
-    _sink->push_back('0' + (v / 10000000000ULL) % 10);
-  }
-  if (1000000000ULL <= v) {
-    _sink->push_back('0' + (v / 1000000000ULL) % 10);
-  }
-  if (100000000ULL <= v) {
-    _sink->push_back('0' + (v / 100000000ULL) % 10);
-  }
-  if (10000000ULL <= v) {
-    _sink->push_back('0' + (v / 10000000ULL) % 10);
+namespace {
+
+// escape characters for the ASCII characters that need escaping in JSON,
+// 0 for all others
+char const EscapeTable[256] = {
+    // 0    1    2    3    4    5    6    7    8    9    A    B    C    D    E
+    // F
+    'u',  'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r',
+    'u',
+    'u',  // 00
+    'u',  'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u',
+    'u',  // 10
+    0,    0,   '"', 0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,
+    '/',  // 20
+    0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,
+    0,  // 30~4F
+    0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    '\\', 0,   0,   0,  // 50
+    0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,
+    0,  // 60~FF
+    0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,    0,   0,   0};
+
+// returns the length of a run of bytes at the end of a string without a
+// trailing multi-byte UTF-8 sequence that is cut off by the end of the
+// string, so that the sequence is handled (and reported) byte-wise
+std::size_t withoutTruncatedSequence(uint8_t const* p, std::size_t run) {
+  std::size_t i = run;
+  std::size_t continuation = 0;
+  while (i > 0 && continuation < 3 && (p[i - 1] & 0xc0U) == 0x80U) {
+    --i;
+    ++continuation;
   }
-  if (1000000ULL <= v) {
-    _sink->push_back('0' + (v / 1000000ULL) % 10);
+  if (i == 0) {
+    return run;
   }
-  if (100000ULL <= v) {
-    _sink->push_back('0' + (v / 100000ULL) % 10);
-  }
-  if (10000ULL <= v) {
-    _sink->push_back('0' + (v / 10000ULL) % 10);
-  }
-  if (1000ULL <= v) {
-    _sink->push_back('0' + (v / 1000ULL) % 10);
-  }
-  if (100ULL <= v) {
-    _sink->push_back('0' + (v / 100ULL) % 10);
-  }
-  if (10ULL <= v) {
-    _sink->push_back('0' + (v / 10ULL) % 10);
+  uint8_t const lead = p[i - 1];
+  std::size_t needed;
+  if ((lead & 0xe0U) == 0xc0U) {
+    needed = 1;
+  } else if ((lead & 0xf0U) == 0xe0U) {
+    needed = 2;
+  } else if ((lead & 0xf8U) == 0xf0U) {
+    needed = 3;
+  } else {
+    return run;
   }
+  return (continuation < needed) ? i - 1 : run;
+}
+
+// a Sink that only counts the characters written to it. used for
+// computing the output length of custom types, which is only known once
+// the CustomTypeHandler has written them
+struct LengthSink final : public Sink {
+  void push_back(char) override final { ++length; }
+  void append(std::string const& p) override final { length += p.size(); }
+  void append(char const* p) override final { length += strlen(p); }
+  void append(char const*, ValueLength len) override final { length += len; }
+  void reserve(ValueLength) override final {}
+
+  ValueLength length = 0;
+};
+
+}  // namespace
 
-  _sink->push_back('0' + (v % 10));
+void Dumper::dumpUInt(uint64_t v) {
+  ensureSpace(maxIntegerLength);
+  _pos += formatUInt(v, &_buffer[_pos]);
 }
 
-void Dumper::appendDouble(double v) {
-  char temp[24];
-  int len = fpconv_dtoa(v, &temp[0]);
-  _sink->append(&temp[0], static_cast<ValueLength>(len));
+void Dumper::dumpDouble(double v) {
+  ensureSpace(maxDoubleLength);
+  _pos += formatDouble(v, &_buffer[_pos]);
 }
 
 void Dumper::dumpUnicodeCharacter(uint16_t value) {
-  _sink->append("\\u", 2);
+  write("\\u", 2);
   
   uint16_t p;
   p = (value & 0xf000U) >> 12;
-  _sink->push_back((p < 10) ? ('0' + p) : ('A' + p - 10));
+  write((p < 10) ? ('0' + p) : ('A' + p - 10));
 
   p = (value & 0x0f00U) >> 8;
-  _sink->push_back((p < 10) ? ('0' + p) : ('A' + p - 10));
+  write((p < 10) ? ('0' + p) : ('A' + p - 10));
 
   p = (value & 0x00f0U) >> 4;
-  _sink->push_back((p < 10) ? ('0' + p) : ('A' + p - 10));
+  write((p < 10) ? ('0' + p) : ('A' + p - 10));
   
   p = (value & 0x000fU);
-  _sink->push_back((p < 10) ? ('0' + p) : ('A' + p - 10));
+  write((p < 10) ? ('0' + p) : ('A' + p - 10));
 }
 
 void Dumper::dumpInteger(Slice const* slice) {
   VELOCYPACK_ASSERT(slice->isInteger());
 
   if (slice->isType(ValueType::UInt)) {
-    uint64_t v = slice->getUIntUnchecked();
-
-    appendUInt(v);
-  } else if (slice->isType(ValueType::Int)) {
-    int64_t v = slice->getIntUnchecked();
-    if (v == INT64_MIN) {
-      _sink->append("-9223372036854775808", 20);
-      return;
-    }
-    if (v < 0) {
-      _sink->push_back('-');
-      v = -v;
-    }
-
-    if (1000000000000000000LL <= v) {
-      _sink->push_back('0' + (v / 1000000000000000000LL) % 10);
-    }
-    if (100000000000000000LL <= v) {
-      _sink->push_back('0' + (v / 100000000000000000LL) % 10);
-    }
-    if (10000000000000000LL <= v) {
-      _sink->push_back('0' + (v / 10000000000000000LL) % 10);
-    }
-    if (1000000000000000LL <= v) {
-      _sink->push_back('0' + (v / 1000000000000000LL) % 10);
-    }
-    if (100000000000000LL <= v) {
-      _sink->push_back('0' + (v / 100000000000000LL) % 10);
-    }
-    if (10000000000000LL <= v) {
-      _sink->push_back('0' + (v / 10000000000000LL) % 10);
-    }
-    if (1000000000000LL <= v) {
-      _sink->push_back('0' + (v / 1000000000000LL) % 10);
-    }
-    if (100000000000LL <= v) {
-      _sink->push_back('0' + (v / 100000000000LL) % 10);
-    }
-    if (10000000000LL <= v) {
-      _sink->push_back('0' + (v / 10000000000LL) % 10);
-    }
-    if (1000000000LL <= v) {
-      _sink->push_back('0' + (v / 1000000000LL) % 10);
-    }
-    if (100000000LL <= v) {
-      _sink->push_back('0' + (v / 100000000LL) % 10);
-    }
-    if (10000000LL <= v) {
-      _sink->push_back('0' + (v / 10000000LL) % 10);
-    }
-    if (1000000LL <= v) {
-      _sink->push_back('0' + (v / 1000000LL) % 10);
-    }
-    if (100000LL <= v) {
-      _sink->push_back('0' + (v / 100000LL) % 10);
-    }
-    if (10000LL <= v) {
-      _sink->push_back('0' + (v / 10000LL) % 10);
-    }
-    if (1000LL <= v) {
-      _sink->push_back('0' + (v / 1000LL) % 10);
-    }
-    if (100LL <= v) {
-      _sink->push_back('0' + (v / 100LL) % 10);
-    }
-    if (10LL <= v) {
-      _sink->push_back('0' + (v / 10LL) % 10);
-    }
+    dumpUInt(slice->getUIntUnchecked());
+  } else {
+    int64_t const v = slice->isType(ValueType::Int)
+                          ? slice->getIntUnchecked()
+                          : slice->getSmallIntUnchecked();
+    ensureSpace(maxIntegerLength);
+    _pos += formatInt(v, &_buffer[_pos]);
+  }
+}
 
-    _sink->push_back('0' + (v % 10));
-  } else if (slice->isType(ValueType::SmallInt)) {
-    int64_t v = slice->getSmallIntUnchecked();
-    if (v < 0) {
-      _sink->push_back('-');
-      v = -v;
+inline bool Dumper::dumpNumber(Slice const* slice) {
+  uint8_t const head = slice->head();
+  if (head == 0x1b) {
+    double const v = slice->getDouble();
+    if (std::isnan(v) || !std::isfinite(v)) {
+      return false;
     }
-    _sink->push_back('0' + static_cast<char>(v));
+    dumpDouble(v);
+    return true;
   }
+  if (head >= 0x20 && head <= 0x3f) {
+    dumpInteger(slice);
+    return true;
+  }
+  return false;
 }
 
 void Dumper::dumpString(char const* src, ValueLength len) {
-  static char const EscapeTable[256] = {
-      // 0    1    2    3    4    5    6    7    8    9    A    B    C    D    E
-      // F
-      'u',  'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r',
-      'u',
-      'u',  // 00
-      'u',  'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
-      'u',
-      'u',  // 10
-      0,    0,   '"', 0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,
-      '/',  // 20
-      0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,
-      0,  // 30~4F
-      0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      '\\', 0,   0,   0,  // 50
-      0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,
-      0,  // 60~FF
-      0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-      0,    0,   0,   0};
-
-  _sink->reserve(len);
+  bool const escapeForwardSlashes = options->escapeForwardSlashes;
+  bool const escapeUnicode = options->escapeUnicode;
 
   uint8_t const* p = reinterpret_cast<uint8_t const*>(src);
   uint8_t const* e = p + len;
   while (p < e) {
+    // append the longest run of bytes that need no escaping at once. the
+    // run ends before the next byte that needs escaping, so that byte can
+    // be handled below
+    std::size_t run = JSONStringScan(p, static_cast<std::size_t>(e - p),
+                                     escapeForwardSlashes, escapeUnicode);
+    if (run > 0) {
+      if (!escapeUnicode && p + run == e) {
+        run = withoutTruncatedSequence(p, run);
+      }
+      write(reinterpret_cast<char const*>(p), run);
+      p += run;
+      if (p == e) {
+        break;
+      }
+    }
+
     uint8_t c = *p;
 
     if ((c & 0x80U) == 0) {
@@ -255,24 +203,24 @@ void Dumper::dumpString(char const* src, ValueLength len) {
       char esc = EscapeTable[c];
 
       if (esc) {
-        if (c != '/' || options->escapeForwardSlashes) {
+        if (c != '/' || escapeForwardSlashes) {
           // escape forward slashes only when requested
-          _sink->push_back('\\');
+          write('\\');
         }
-        _sink->push_back(static_cast<char>(esc));
+        write(static_cast<char>(esc));
 
         if (esc == 'u') {
           uint16_t i1 = (((uint16_t)c) & 0xf0U) >> 4;
           uint16_t i2 = (((uint16_t)c) & 0x0fU);
 
-          _sink->append("00", 2);
-          _sink->push_back(
+          write("00", 2);
+          write(
               static_cast<char>((i1 < 10) ? ('0' + i1) : ('A' + i1 - 10)));
-          _sink->push_back(
+          write(
               static_cast<char>((i2 < 10) ? ('0' + i2) : ('A' + i2 - 10)));
         }
       } else {
-        _sink->push_back(static_cast<char>(c));
+        write(static_cast<char>(c));
       }
     } else if ((c & 0xe0U) == 0xc0U) {
       // two-byte sequence
@@ -280,11 +228,11 @@ void Dumper::dumpString(char const* src, ValueLength len) {
         throw Exception(Exception::InvalidUtf8Sequence);
       }
       
-      if (options->escapeUnicode) {
+      if (escapeUnicode) {
         uint16_t value = ((((uint16_t) *p & 0x1fU) << 6) | ((uint16_t) *(p + 1) & 0x3fU));
         dumpUnicodeCharacter(value);
       } else {
-        _sink->append(reinterpret_cast<char const*>(p), 2);
+        write(reinterpret_cast<char const*>(p), 2);
       }
       ++p;
     } else if ((c & 0xf0U) == 0xe0U) {
@@ -293,11 +241,11 @@ void Dumper::dumpString(char const* src, ValueLength len) {
         throw Exception(Exception::InvalidUtf8Sequence);
       }
 
-      if (options->escapeUnicode) {
+      if (escapeUnicode) {
         uint16_t value = ((((uint16_t) *p & 0x0fU) << 12) | (((uint16_t) *(p + 1) & 0x3fU) << 6) | ((uint16_t) *(p + 2) & 0x3fU));
         dumpUnicodeCharacter(value);
       } else {
-        _sink->append(reinterpret_cast<char const*>(p), 3);
+        write(reinterpret_cast<char const*>(p), 3);
       }
       p += 2;
     } else if ((c & 0xf8U) == 0xf0U) {
@@ -306,7 +254,7 @@ void Dumper::dumpString(char const* src, ValueLength len) {
         throw Exception(Exception::InvalidUtf8Sequence);
       }
 
-      if (options->escapeUnicode) {
+      if (escapeUnicode) {
         uint32_t value = ((((uint32_t) *p & 0x0fU) << 18) | (((uint32_t) *(p + 1) & 0x3fU) << 12) | (((uint32_t) *(p + 2) & 0x3fU) << 6) | ((uint32_t) *(p + 3) & 0x3fU));
         // construct the surrogate pairs
         value -= 0x10000U;
@@ -315,13 +263,273 @@ void Dumper::dumpString(char const* src, ValueLength len) {
         uint16_t low = (value & 0x3ffU) + 0xdc00U;
         dumpUnicodeCharacter(low);
       } else {
-        _sink->append(reinterpret_cast<char const*>(p), 4);
+        write(reinterpret_cast<char const*>(p), 4);
+      }
+      p += 3;
+    }
+
+    ++p;
+  }
+}
+
+ValueLength Dumper::outputLength(Slice const& slice, Options const* options) {
+  LengthSink sink;
+  Dumper dumper(&sink, options);
+  if (options->projection != nullptr) {
+    // the projection is applied while dumping, so the output is counted
+    dumper.dump(slice);
+    return sink.length;
+  }
+  return dumper.valueLength(&slice, nullptr);
+}
+
+ValueLength Dumper::stringLength(char const* src, ValueLength len) const {
+  bool const escapeForwardSlashes = options->escapeForwardSlashes;
+  bool const escapeUnicode = options->escapeUnicode;
+
+  // follows dumpString() step by step, including the exceptions thrown
+  // for invalid UTF-8 sequences
+  ValueLength length = 0;
+  uint8_t const* p = reinterpret_cast<uint8_t const*>(src);
+  uint8_t const* e = p + len;
+  while (p < e) {
+    std::size_t run = JSONStringScan(p, static_cast<std::size_t>(e - p),
+                                     escapeForwardSlashes, escapeUnicode);
+    if (run > 0) {
+      if (!escapeUnicode && p + run == e) {
+        run = withoutTruncatedSequence(p, run);
+      }
+      length += run;
+      p += run;
+      if (p == e) {
+        break;
+      }
+    }
+
+    uint8_t c = *p;
+
+    if ((c & 0x80U) == 0) {
+      char esc = EscapeTable[c];
+      if (esc) {
+        length += (c != '/' || escapeForwardSlashes) ? 2 : 1;
+        if (esc == 'u') {
+          length += 4;
+        }
+      } else {
+        ++length;
       }
+    } else if ((c & 0xe0U) == 0xc0U) {
+      if (p + 1 >= e) {
+        throw Exception(Exception::InvalidUtf8Sequence);
+      }
+      length += escapeUnicode ? 6 : 2;
+      ++p;
+    } else if ((c & 0xf0U) == 0xe0U) {
+      if (p + 2 >= e) {
+        throw Exception(Exception::InvalidUtf8Sequence);
+      }
+      length += escapeUnicode ? 6 : 3;
+      p += 2;
+    } else if ((c & 0xf8U) == 0xf0U) {
+      if (p + 3 >= e) {
+        throw Exception(Exception::InvalidUtf8Sequence);
+      }
+      // a surrogate pair if escaped
+      length += escapeUnicode ? 12 : 4;
       p += 3;
     }
 
     ++p;
   }
+  return length;
+}
+
+ValueLength Dumper::unsupportedTypeLength(Slice const* slice) const {
+  if (options->unsupportedTypeBehavior == Options::NullifyUnsupportedType) {
+    return 4;
+  } else if (options->unsupportedTypeBehavior == Options::ConvertUnsupportedType) {
+    return 27 + strlen(slice->typeName());
+  }
+
+  throw Exception(Exception::NoJsonEquivalent);
+}
+
+ValueLength Dumper::valueLength(Slice const* slice, Slice const* base) {
+  if (base == nullptr) {
+    base = slice;
+  }
+
+  bool const prettyPrint = options->prettyPrint;
+
+  switch (slice->type()) {
+    case ValueType::Null: {
+      return 4;
+    }
+
+    case ValueType::Bool: {
+      return slice->getBool() ? 4 : 5;
+    }
+
+    case ValueType::Array: {
+      ArrayIterator it(*slice);
+      ValueLength const n = it.size();
+      // brackets and separators
+      ValueLength length = 2 + (n > 0 ? n - 1 : 0);
+      if (prettyPrint) {
+        ++_indentation;
+        // newline after the opening bracket, indentation and newline for
+        // each member
+        length += 1 + n * (2 * _indentation + 1);
+      }
+      while (it.valid()) {
+        Slice const value = it.value();
+        length += valueLength(&value, slice);
+        it.next();
+      }
+      if (prettyPrint) {
+        --_indentation;
+        length += 2 * _indentation;
+      }
+      return length;
+    }
+
+    case ValueType::Object: {
+      // the length does not depend on the order of the members, so they
+      // are visited in storage order, which is cheaper than index order
+      ObjectIterator it(*slice, true);
+      ValueLength const n = it.size();
+      // braces, separators and the colons between keys and values
+      ValueLength length = 2 + (n > 0 ? n - 1 : 0) + n * (prettyPrint ? 3 : 1);
+      if (prettyPrint) {
+        ++_indentation;
+        length += 1 + n * (2 * _indentation + 1);
+      }
+      while (it.valid()) {
+        auto current = (*it);
+        length += valueLength(&current.key, slice);
+        length += valueLength(&current.value, slice);
+        it.next();
+      }
+      if (prettyPrint) {
+        --_indentation;
+        length += 2 * _indentation;
+      }
+      return length;
+    }
+
+    case ValueType::Double: {
+      double const v = slice->getDouble();
+      if (std::isnan(v) || !std::isfinite(v)) {
+        return unsupportedTypeLength(slice);
+      }
+      return doubleLength(v);
+    }
+
+    case ValueType::Int:
+    case ValueType::SmallInt: {
+      return intLength(slice->getInt());
+    }
+
+    case ValueType::UInt: {
+      return uintLength(slice->getUIntUnchecked());
+    }
+
+    case ValueType::String: {
+      ValueLength len;
+      char const* p = slice->getString(len);
+      return 2 + stringLength(p, len);
+    }
+
+    case ValueType::External: {
+      Slice const external(reinterpret_cast<uint8_t const*>(slice->getExternal()));
+      return valueLength(&external, base);
+    }
+
+    case ValueType::UTCDate:
+    case ValueType::None:
+    case ValueType::Binary:
+    case ValueType::Illegal:
+    case ValueType::MinKey:
+    case ValueType::MaxKey: {
+      return unsupportedTypeLength(slice);
+    }
+
+    case ValueType::BCD: {
+      throw Exception(Exception::NotImplemented);
+    }
+
+    case ValueType::Custom: {
+      if (options->customTypeHandler == nullptr) {
+        throw Exception(Exception::NeedCustomTypeHandler);
+      }
+      // the output of the handler ends up in the counting sink
+      flush();
+      Sink* sink = _sink;
+      ValueLength const before = static_cast<LengthSink*>(sink)->length;
+      options->customTypeHandler->dump(*slice, this, *base);
+      flush();
+      return static_cast<LengthSink*>(sink)->length - before;
+    }
+  }
+
+  return 0;
+}
+
+void Dumper::dumpArrayMembers(ArrayIterator& it, ValueLength count,
+                              Slice const* base) {
+  if (options->prettyPrint) {
+    while (count-- > 0) {
+      indent();
+      dumpValue(it.value(), base);
+      if (!it.isLast()) {
+        write(',');
+      }
+      write('\n');
+      it.next();
+    }
+  } else {
+    while (count-- > 0) {
+      if (!it.isFirst()) {
+        write(',');
+      }
+      // numbers are formatted right here, so that Arrays of numbers
+      // are dumped in one loop without a dumpValue call per member
+      Slice const value = it.value();
+      if (!dumpNumber(&value)) {
+        dumpValue(&value, base);
+      }
+      it.next();
+    }
+  }
+}
+
+void Dumper::dumpObjectMembers(ObjectIterator& it, ValueLength count,
+                               Slice const* base) {
+  if (options->prettyPrint) {
+    while (count-- > 0) {
+      auto current = (*it);
+      indent();
+      dumpValue(current.key, base);
+      write(" : ", 3);
+      dumpValue(current.value, base);
+      if (!it.isLast()) {
+        write(',');
+      }
+      write('\n');
+      it.next();
+    }
+  } else {
+    while (count-- > 0) {
+      if (!it.isFirst()) {
+        write(',');
+      }
+      auto current = (*it);
+      dumpValue(current.key, base);
+      write(':');
+      dumpValue(current.value, base);
+      it.next();
+    }
+  }
 }
 
 void Dumper::dumpValue(Slice const* slice, Slice const* base) {
@@ -332,82 +540,32 @@ void Dumper::dumpValue(Slice const* slice, Slice const* base) {
 
   switch (slice->type()) {
     case ValueType::Null: {
-      _sink->append("null", 4);
+      write("null", 4);
       break;
     }
 
     case ValueType::Bool: {
       if (slice->getBool()) {
-        _sink->append("true", 4);
+        write("true", 4);
       } else {
-        _sink->append("false", 5);
+        write("false", 5);
       }
       break;
     }
 
     case ValueType::Array: {
       ArrayIterator it(*slice);
-      _sink->push_back('[');
-      if (options->prettyPrint) {
-        _sink->push_back('\n');
-        ++_indentation;
-        while (it.valid()) {
-          indent();
-          dumpValue(it.value(), slice);
-          if (!it.isLast()) {
-            _sink->push_back(',');
-          }
-          _sink->push_back('\n');
-          it.next();
-        }
-        --_indentation;
-        indent();
-      } else {
-        while (it.valid()) {
-          if (!it.isFirst()) {
-            _sink->push_back(',');
-          }
-          dumpValue(it.value(), slice);
-          it.next();
-        }
-      }
-      _sink->push_back(']');
+      openContainer('[');
+      dumpArrayMembers(it, it.size(), slice);
+      closeContainer(']');
       break;
     }
 
     case ValueType::Object: {
       ObjectIterator it(*slice, !options->dumpAttributesInIndexOrder);
-      _sink->push_back('{');
-      if (options->prettyPrint) {
-        _sink->push_back('\n');
-        ++_indentation;
-        while (it.valid()) {
-          auto current = (*it);
-          indent();
-          dumpValue(current.key, slice);
-          _sink->append(" : ", 3);
-          dumpValue(current.value, slice);
-          if (!it.isLast()) {
-            _sink->push_back(',');
-          }
-          _sink->push_back('\n');
-          it.next();
-        }
-        --_indentation;
-        indent();
-      } else {
-        while (it.valid()) {
-          if (!it.isFirst()) {
-            _sink->push_back(',');
-          }
-          auto current = (*it);
-          dumpValue(current.key, slice);
-          _sink->push_back(':');
-          dumpValue(current.value, slice);
-          it.next();
-        }
-      }
-      _sink->push_back('}');
+      openContainer('{');
+      dumpObjectMembers(it, it.size(), slice);
+      closeContainer('}');
       break;
     }
 
@@ -416,7 +574,7 @@ void Dumper::dumpValue(Slice const* slice, Slice const* base) {
       if (std::isnan(v) || !std::isfinite(v)) {
         handleUnsupportedType(slice);
       } else {
-        appendDouble(v);
+        dumpDouble(v);
       }
       break;
     }
@@ -431,10 +589,9 @@ void Dumper::dumpValue(Slice const* slice, Slice const* base) {
     case ValueType::String: {
       ValueLength len;
       char const* p = slice->getString(len);
-      _sink->reserve(2 + len);
-      _sink->push_back('"');
+      write('"');
       dumpString(p, len);
-      _sink->push_back('"');
+      write('"');
       break;
     }
     
@@ -463,9 +620,98 @@ void Dumper::dumpValue(Slice const* slice, Slice const* base) {
       if (options->customTypeHandler == nullptr) {
         throw Exception(Exception::NeedCustomTypeHandler);
       } else {
+        // the handler may write to the sink directly
+        flush();
         options->customTypeHandler->dump(*slice, this, *base);
       }
       break;
     }
   }
 }
+
+void Dumper::dumpProjected(Slice const* slice, uint32_t state,
+                           Slice const* base) {
+  if (base == nullptr) {
+    base = slice;
+  }
+
+  Projection const* projection = options->projection;
+
+  switch (slice->type()) {
+    case ValueType::Array: {
+      ArrayIterator it(*slice);
+      bool first = true;
+      openContainer('[');
+      while (it.valid()) {
+        Slice const value = it.value();
+        Projection::State const next = projection->index(state, it.index());
+        Projection::Action const action = projection->action(next, value);
+        if (action != Projection::Action::Skip) {
+          separateMember(first);
+          if (action == Projection::Action::Dump) {
+            dumpValue(&value, slice);
+          } else {
+            dumpProjected(&value, next, slice);
+          }
+        }
+        it.next();
+      }
+      if (options->prettyPrint && !first) {
+        write('\n');
+      }
+      closeContainer(']');
+      break;
+    }
+
+    case ValueType::Object: {
+      ObjectIterator it(*slice, !options->dumpAttributesInIndexOrder);
+      bool first = true;
+      openContainer('{');
+      while (it.valid()) {
+        auto current = (*it);
+        Projection::State next;
+        if (current.key.isString()) {
+          ValueLength len;
+          char const* p = current.key.getString(len);
+          next = projection->attribute(state, StringRef(p, len));
+        } else {
+          next = projection->otherAttribute(state);
+        }
+        Projection::Action const action =
+            projection->action(next, current.value);
+        if (action != Projection::Action::Skip) {
+          separateMember(first);
+          dumpValue(current.key, slice);
+          if (options->prettyPrint) {
+            write(" : ", 3);
+          } else {
+            write(':');
+          }
+          if (action == Projection::Action::Dump) {
+            dumpValue(current.value, slice);
+          } else {
+            dumpProjected(&current.value, next, slice);
+          }
+        }
+        it.next();
+      }
+      if (options->prettyPrint && !first) {
+        write('\n');
+      }
+      closeContainer('}');
+      break;
+    }
+
+    case ValueType::External: {
+      Slice const external(reinterpret_cast<uint8_t const*>(slice->getExternal()));
+      dumpProjected(&external, state, base);
+      break;
+    }
+
+    default: {
+      // only members of Arrays and Objects can be left out
+      dumpValue(slice, base);
+      break;
+    }
+  }
+}
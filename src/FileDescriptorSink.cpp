@@ -0,0 +1,252 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef _WIN32
+
+#include <cerrno>
+
+#include <poll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Exception.h"
+#include "velocypack/FileDescriptorSink.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// writes all data described by the iovecs, continuing after partial writes
+// and interrupted calls. returns 0 on success, or the errno of the failed
+// write
+int writeAll(int fd, struct iovec* iov, int count) {
+  while (count > 0) {
+    ssize_t n = ::writev(fd, iov, count);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        // non-blocking file descriptor, e.g. a socket. wait until it
+        // becomes writable again
+        struct pollfd p;
+        p.fd = fd;
+        p.events = POLLOUT;
+        p.revents = 0;
+        if (::poll(&p, 1, -1) >= 0 || errno == EINTR) {
+          continue;
+        }
+      }
+      return errno;
+    }
+
+    std::size_t written = static_cast<std::size_t>(n);
+    while (count > 0 && written >= iov->iov_len) {
+      written -= iov->iov_len;
+      ++iov;
+      --count;
+    }
+    if (count > 0) {
+      iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+      iov->iov_len -= written;
+    }
+  }
+  return 0;
+}
+
+[[noreturn]] void throwWriteError() {
+  throw Exception(Exception::IoError, "Cannot write to file descriptor");
+}
+
+}  // namespace
+
+constexpr std::size_t FileDescriptorSink::defaultBufferSize;
+
+FileDescriptorSink::FileDescriptorSink(int fd, std::size_t bufferSize,
+                                       bool writeInBackground)
+    : _fd(fd),
+      _bufferSize(bufferSize),
+      _writeInBackground(writeInBackground),
+      _buffer(nullptr),
+      _length(0),
+      _written(0),
+      _error(0),
+      _pending(nullptr),
+      _pendingLength(0),
+      _stopping(false) {
+  if (fd < 0) {
+    throw Exception(Exception::InternalError, "Invalid file descriptor");
+  }
+  if (bufferSize == 0) {
+    throw Exception(Exception::InternalError, "Buffer size must not be 0");
+  }
+
+  _buffers[0].reset(new char[bufferSize]);
+  _buffer = _buffers[0].get();
+
+  if (writeInBackground) {
+    _buffers[1].reset(new char[bufferSize]);
+    _thread = std::thread(&FileDescriptorSink::runBackground, this);
+  }
+}
+
+FileDescriptorSink::~FileDescriptorSink() {
+  try {
+    flush();
+  } catch (...) {
+    // destructors must not throw
+  }
+
+  if (_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> guard(_mutex);
+      _stopping = true;
+    }
+    _condition.notify_all();
+    _thread.join();
+  }
+}
+
+void FileDescriptorSink::flush() {
+  if (_writeInBackground) {
+    if (_length > 0) {
+      writeBuffer();
+    }
+    waitForBackground();
+  } else {
+    writeDirect(nullptr, 0);
+  }
+}
+
+void FileDescriptorSink::appendLarge(char const* p, ValueLength len) {
+  if (!_writeInBackground || len >= _bufferSize) {
+    // write the staged data and the new data with a single call, instead
+    // of copying the new data into the buffer first
+    writeDirect(p, len);
+    return;
+  }
+
+  // fill up the buffer, hand it to the background thread and stage the
+  // rest in the other buffer
+  std::size_t const n = _bufferSize - _length;
+  memcpy(_buffer + _length, p, n);
+  _length += n;
+  writeBuffer();
+  memcpy(_buffer, p + n, static_cast<std::size_t>(len) - n);
+  _length = static_cast<std::size_t>(len) - n;
+}
+
+void FileDescriptorSink::writeBuffer() {
+  if (!_writeInBackground) {
+    writeDirect(nullptr, 0);
+    return;
+  }
+
+  // the other buffer can only be reused once its data has been written
+  waitForBackground();
+  {
+    std::lock_guard<std::mutex> guard(_mutex);
+    _pending = _buffer;
+    _pendingLength = _length;
+  }
+  _condition.notify_all();
+
+  _written += _length;
+  _length = 0;
+  _buffer = (_buffer == _buffers[0].get()) ? _buffers[1].get()
+                                           : _buffers[0].get();
+}
+
+void FileDescriptorSink::writeDirect(char const* p, ValueLength len) {
+  if (_writeInBackground) {
+    // keep the output in order
+    waitForBackground();
+  } else if (_error != 0) {
+    throwWriteError();
+  }
+
+  struct iovec iov[2];
+  int count = 0;
+  if (_length > 0) {
+    iov[count].iov_base = _buffer;
+    iov[count].iov_len = _length;
+    ++count;
+  }
+  if (len > 0) {
+    iov[count].iov_base = const_cast<char*>(p);
+    iov[count].iov_len = checkOverflow(len);
+    ++count;
+  }
+
+  int error = writeAll(_fd, &iov[0], count);
+  if (error != 0) {
+    // the background thread is idle here
+    _error = error;
+    throwWriteError();
+  }
+
+  _written += _length + len;
+  _length = 0;
+}
+
+void FileDescriptorSink::waitForBackground() {
+  std::unique_lock<std::mutex> guard(_mutex);
+  _condition.wait(guard, [this]() { return _pending == nullptr; });
+
+  if (_error != 0) {
+    throwWriteError();
+  }
+}
+
+void FileDescriptorSink::runBackground() {
+  std::unique_lock<std::mutex> guard(_mutex);
+
+  while (true) {
+    _condition.wait(guard,
+                    [this]() { return _stopping || _pending != nullptr; });
+
+    if (_pending == nullptr) {
+      // stopping and nothing left to write
+      return;
+    }
+
+    struct iovec iov;
+    iov.iov_base = const_cast<char*>(_pending);
+    iov.iov_len = _pendingLength;
+
+    guard.unlock();
+    int error = writeAll(_fd, &iov, 1);
+    guard.lock();
+
+    if (error != 0) {
+      _error = error;
+    }
+    _pending = nullptr;
+    _condition.notify_all();
+  }
+}
+
+#endif
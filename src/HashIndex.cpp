@@ -0,0 +1,316 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <cstring>
+#include <string>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/HashIndex.h"
+#include "velocypack/Compare.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/Value.h"
+#include "velocypack/ValueType.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// layout of the Binary value, see HashIndex.h
+constexpr char Magic[] = {'V', 'P', 'H', 'I'};
+constexpr uint8_t FormatVersion = 1;
+constexpr uint8_t KindArray = 0;
+constexpr uint8_t KindVector = 1;
+
+// the stored hash values are Slice::normalizedHash() values, which depend
+// on the hash function VelocyPack was built with
+#ifdef VELOCYPACK_XXHASH
+constexpr uint8_t HashTypeId = 1;
+#endif
+#ifdef VELOCYPACK_FASTHASH
+constexpr uint8_t HashTypeId = 2;
+#endif
+
+constexpr std::size_t KindOffset = 5;
+constexpr std::size_t HashTypeOffset = 6;
+constexpr std::size_t SizeOffset = 8;
+constexpr std::size_t SlotsOffset = 16;
+constexpr std::size_t DataSizeOffset = 24;
+constexpr std::size_t PathLengthOffset = 32;
+constexpr std::size_t HeaderSize = 40;
+constexpr std::size_t SlotSize = 16;
+
+inline uint64_t paddedLength(uint64_t length) {
+  return (length + 7) & ~uint64_t(7);
+}
+
+// start of the slots, behind the header and the path
+inline uint8_t const* slots(uint8_t const* data) {
+  return data + HeaderSize + paddedLength(readUInt64(data + PathLengthOffset));
+}
+
+// builds a String value for key lookups
+Builder makeKey(StringRef key) {
+  Builder b;
+  b.add(ValuePair(key.data(), key.size(), ValueType::String));
+  return b;
+}
+
+}  // namespace
+
+HashIndex::HashIndex(Slice array, CompiledPath const& path) : _path(path) {
+  if (!array.isArray()) {
+    throw Exception(Exception::InvalidValueType, "Expecting type Array");
+  }
+
+  std::vector<std::pair<uint64_t, uint64_t>> entries;
+  ArrayIterator it(array);
+  entries.reserve(checkOverflow(it.size()));
+  while (it.valid()) {
+    Slice document = it.value();
+    Slice key = _path.get(document);
+    if (!key.isNone()) {
+      // members always start behind the Array's head byte, so their
+      // offsets are never 0
+      entries.emplace_back(key.normalizedHash(),
+                           static_cast<uint64_t>(document.start() - array.start()));
+    }
+    it.next();
+  }
+
+  build(entries, KindArray, array.byteSize());
+}
+
+HashIndex::HashIndex(std::vector<Slice> const& documents, CompiledPath const& path)
+    : _path(path) {
+  std::vector<std::pair<uint64_t, uint64_t>> entries;
+  entries.reserve(documents.size());
+  for (std::size_t i = 0; i < documents.size(); ++i) {
+    Slice key = _path.get(documents[i]);
+    if (!key.isNone()) {
+      entries.emplace_back(key.normalizedHash(), static_cast<uint64_t>(i) + 1);
+    }
+  }
+
+  build(entries, KindVector, documents.size());
+}
+
+HashIndex HashIndex::fromBinary(Slice binary) {
+  if (!binary.isBinary()) {
+    throw Exception(Exception::InvalidValueType, "Expecting type Binary");
+  }
+  ValueLength length;
+  uint8_t const* data = binary.getBinary(length);
+  if (length < HeaderSize || std::memcmp(data, Magic, sizeof(Magic)) != 0 ||
+      data[4] != FormatVersion || data[KindOffset] > KindVector) {
+    throw Exception(Exception::InvalidValueType, "Invalid hash index data");
+  }
+  if (data[HashTypeOffset] != HashTypeId) {
+    throw Exception(Exception::InvalidValueType,
+                    "Hash index was built with a different hash function");
+  }
+  uint64_t const pathLength = readUInt64(data + PathLengthOffset);
+  uint64_t const slotCount = readUInt64(data + SlotsOffset);
+  if (pathLength > length - HeaderSize || slotCount == 0 ||
+      (slotCount & (slotCount - 1)) != 0 ||
+      slotCount > (length - HeaderSize) / SlotSize ||
+      length != HeaderSize + paddedLength(pathLength) + slotCount * SlotSize) {
+    throw Exception(Exception::InvalidValueType, "Invalid hash index data");
+  }
+
+  // lookups trust the slots, so check that all locations are within the
+  // data and that probing always ends at an empty slot
+  uint64_t const dataSize = readUInt64(data + DataSizeOffset);
+  // Array members start before the end of the Array
+  uint64_t const maxLocation =
+      (data[KindOffset] != KindArray) ? dataSize : (dataSize > 0 ? dataSize - 1 : 0);
+  uint8_t const* table = slots(data);
+  uint64_t used = 0;
+  for (uint64_t i = 0; i < slotCount; ++i) {
+    uint64_t const location = readUInt64(table + i * SlotSize + 8);
+    if (location != 0) {
+      if (location > maxLocation) {
+        throw Exception(Exception::InvalidValueType, "Invalid hash index data");
+      }
+      ++used;
+    }
+  }
+  if (used == slotCount || used != readUInt64(data + SizeOffset)) {
+    throw Exception(Exception::InvalidValueType, "Invalid hash index data");
+  }
+
+  HashIndex index;
+  index._external = binary;
+  index._path = CompiledPath(StringRef(reinterpret_cast<char const*>(data + HeaderSize),
+                                       checkOverflow(pathLength)));
+  return index;
+}
+
+ValueLength HashIndex::size() const {
+  return readUInt64(data() + SizeOffset);
+}
+
+bool HashIndex::isPositional() const {
+  return data()[KindOffset] == KindVector;
+}
+
+Slice HashIndex::find(Slice array, Slice key) const {
+  Slice result;
+  lookup(key, KindArray, array.byteSize(),
+         [&array](uint64_t location) { return Slice(array.start() + location); },
+         [&result](Slice document) {
+           result = document;
+           return false;
+         });
+  return result;
+}
+
+Slice HashIndex::find(std::vector<Slice> const& documents, Slice key) const {
+  Slice result;
+  lookup(key, KindVector, documents.size(),
+         [&documents](uint64_t location) { return documents[checkOverflow(location - 1)]; },
+         [&result](Slice document) {
+           result = document;
+           return false;
+         });
+  return result;
+}
+
+Slice HashIndex::find(Slice array, StringRef key) const {
+  Builder b = makeKey(key);
+  return find(array, b.slice());
+}
+
+Slice HashIndex::find(std::vector<Slice> const& documents, StringRef key) const {
+  Builder b = makeKey(key);
+  return find(documents, b.slice());
+}
+
+ValueLength HashIndex::findAll(Slice array, Slice key, std::vector<Slice>& result) const {
+  std::size_t const before = result.size();
+  lookup(key, KindArray, array.byteSize(),
+         [&array](uint64_t location) { return Slice(array.start() + location); },
+         [&result](Slice document) {
+           result.push_back(document);
+           return true;
+         });
+  return result.size() - before;
+}
+
+ValueLength HashIndex::findAll(std::vector<Slice> const& documents, Slice key,
+                               std::vector<Slice>& result) const {
+  std::size_t const before = result.size();
+  lookup(key, KindVector, documents.size(),
+         [&documents](uint64_t location) { return documents[checkOverflow(location - 1)]; },
+         [&result](Slice document) {
+           result.push_back(document);
+           return true;
+         });
+  return result.size() - before;
+}
+
+void HashIndex::build(std::vector<std::pair<uint64_t, uint64_t>> const& entries,
+                      uint8_t kind, uint64_t dataSize) {
+  // at most half of the slots are used
+  uint64_t slotCount = 8;
+  while (slotCount < entries.size() * 2) {
+    slotCount <<= 1;
+  }
+
+  std::string const path = _path.toString();
+  uint64_t const headerLength = HeaderSize + paddedLength(path.size());
+  std::vector<uint8_t> buffer(checkOverflow(headerLength + slotCount * SlotSize), 0);
+  uint8_t* p = buffer.data();
+
+  std::memcpy(p, Magic, sizeof(Magic));
+  p[4] = FormatVersion;
+  p[KindOffset] = kind;
+  p[HashTypeOffset] = HashTypeId;
+  storeUInt64(p + SizeOffset, entries.size());
+  storeUInt64(p + SlotsOffset, slotCount);
+  storeUInt64(p + DataSizeOffset, dataSize);
+  storeUInt64(p + PathLengthOffset, path.size());
+  std::memcpy(p + HeaderSize, path.data(), path.size());
+
+  // open addressing with linear probing. entries are inserted in the order
+  // of the input, so that documents with equal keys are found in this order
+  uint8_t* table = p + headerLength;
+  uint64_t const mask = slotCount - 1;
+  for (auto const& entry : entries) {
+    uint64_t slot = entry.first & mask;
+    while (readUInt64(table + slot * SlotSize + 8) != 0) {
+      slot = (slot + 1) & mask;
+    }
+    storeUInt64(table + slot * SlotSize, entry.first);
+    storeUInt64(table + slot * SlotSize + 8, entry.second);
+  }
+
+  _builder.add(ValuePair(buffer.data(), buffer.size(), ValueType::Binary));
+  _owned = true;
+}
+
+template <typename R, typename F>
+void HashIndex::lookup(Slice key, uint8_t kind, uint64_t dataSize,
+                       R const& resolve, F const& found) const {
+  uint8_t const* d = data();
+  if (d[KindOffset] != kind) {
+    throw Exception(Exception::InvalidValueType,
+                    kind == KindArray ? "Expecting index over an Array"
+                                      : "Expecting index over a vector of Slices");
+  }
+  if (readUInt64(d + DataSizeOffset) != dataSize) {
+    throw Exception(Exception::InvalidValueType,
+                    "Index does not belong to the data");
+  }
+  if (key.isNone()) {
+    return;
+  }
+
+  uint64_t const hash = key.normalizedHash();
+  uint64_t const mask = readUInt64(d + SlotsOffset) - 1;
+  uint8_t const* table = slots(d);
+  uint64_t slot = hash & mask;
+
+  while (true) {
+    uint8_t const* entry = table + slot * SlotSize;
+    uint64_t const location = readUInt64(entry + 8);
+    if (location == 0) {
+      return;
+    }
+    if (readUInt64(entry) == hash) {
+      Slice document = resolve(location);
+      if (NormalizedCompare::equalsAnyType(_path.get(document), key) &&
+          !found(document)) {
+        return;
+      }
+    }
+    slot = (slot + 1) & mask;
+  }
+}
+
+uint8_t const* HashIndex::data() const {
+  ValueLength length;
+  return slice().getBinary(length);
+}
@@ -0,0 +1,230 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <cstring>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/MessagePackDumper.h"
+#include "velocypack/ValueType.h"
+
+using namespace arangodb::velocypack;
+
+constexpr std::size_t MessagePackDumper::bufferSize;
+
+void MessagePackDumper::dumpUInt(uint64_t v) {
+  if (v <= 0x7fU) {
+    // positive fixint
+    write(static_cast<uint8_t>(v));
+  } else if (v <= 0xffU) {
+    writeHead<1>(0xcc, v);
+  } else if (v <= 0xffffU) {
+    writeHead<2>(0xcd, v);
+  } else if (v <= 0xffffffffU) {
+    writeHead<4>(0xce, v);
+  } else {
+    writeHead<8>(0xcf, v);
+  }
+}
+
+void MessagePackDumper::dumpInt(int64_t v) {
+  if (v >= 0) {
+    dumpUInt(static_cast<uint64_t>(v));
+  } else if (v >= -32) {
+    // negative fixint
+    write(static_cast<uint8_t>(v));
+  } else if (v >= INT8_MIN) {
+    writeHead<1>(0xd0, static_cast<uint64_t>(v));
+  } else if (v >= INT16_MIN) {
+    writeHead<2>(0xd1, static_cast<uint64_t>(v));
+  } else if (v >= INT32_MIN) {
+    writeHead<4>(0xd2, static_cast<uint64_t>(v));
+  } else {
+    writeHead<8>(0xd3, static_cast<uint64_t>(v));
+  }
+}
+
+void MessagePackDumper::dumpLength(ValueLength length, uint8_t fixHead,
+                                   ValueLength fixLimit, uint8_t head8,
+                                   uint8_t head16) {
+  if (length < fixLimit) {
+    write(static_cast<uint8_t>(fixHead | length));
+  } else if (head8 != 0 && length <= 0xffU) {
+    writeHead<1>(head8, length);
+  } else if (length <= 0xffffU) {
+    writeHead<2>(head16, length);
+  } else if (length <= 0xffffffffU) {
+    writeHead<4>(head16 + 1, length);
+  } else {
+    throw Exception(Exception::NumberOutOfRange,
+                    "Value too long for MessagePack");
+  }
+}
+
+void MessagePackDumper::dumpString(char const* p, ValueLength len) {
+  dumpLength(len, 0xa0, 32, 0xd9, 0xda);
+  write(p, checkOverflow(len));
+}
+
+void MessagePackDumper::dumpUTCDate(int64_t v) {
+  // milliseconds since the epoch, as a timestamp with non-negative
+  // nanoseconds
+  int64_t seconds = v / 1000;
+  int64_t milliseconds = v % 1000;
+  if (milliseconds < 0) {
+    --seconds;
+    milliseconds += 1000;
+  }
+  uint64_t const nanoseconds = static_cast<uint64_t>(milliseconds) * 1000000;
+
+  // extension type -1, followed by the timestamp in the smallest of the
+  // three formats that can hold it
+  if (seconds >= 0 && (seconds >> 34) == 0) {
+    if (nanoseconds == 0 && (seconds >> 32) == 0) {
+      write(0xd6);
+      write(0xff);
+      writeBigEndian<4>(static_cast<uint64_t>(seconds));
+    } else {
+      write(0xd7);
+      write(0xff);
+      writeBigEndian<8>((nanoseconds << 34) | static_cast<uint64_t>(seconds));
+    }
+  } else {
+    write(0xc7);
+    write(12);
+    write(0xff);
+    writeBigEndian<4>(nanoseconds);
+    writeBigEndian<8>(static_cast<uint64_t>(seconds));
+  }
+}
+
+void MessagePackDumper::handleUnsupportedType(Slice const* slice) {
+  if (options->unsupportedTypeBehavior == Options::NullifyUnsupportedType) {
+    write(0xc0);
+    return;
+  } else if (options->unsupportedTypeBehavior ==
+             Options::ConvertUnsupportedType) {
+    std::string value("(non-representable type ");
+    value.append(slice->typeName());
+    value.push_back(')');
+    dumpString(value.data(), value.size());
+    return;
+  }
+
+  throw Exception(Exception::InvalidValueType,
+                  "Type has no equivalent in MessagePack");
+}
+
+void MessagePackDumper::dumpValue(Slice const* slice) {
+  switch (slice->type()) {
+    case ValueType::Null: {
+      write(0xc0);
+      break;
+    }
+
+    case ValueType::Bool: {
+      write(slice->getBool() ? 0xc3 : 0xc2);
+      break;
+    }
+
+    case ValueType::Double: {
+      double const v = slice->getDouble();
+      uint64_t bits;
+      memcpy(&bits, &v, sizeof(bits));
+      writeHead<8>(0xcb, bits);
+      break;
+    }
+
+    case ValueType::SmallInt:
+    case ValueType::Int: {
+      dumpInt(slice->getInt());
+      break;
+    }
+
+    case ValueType::UInt: {
+      dumpUInt(slice->getUInt());
+      break;
+    }
+
+    case ValueType::String: {
+      ValueLength len;
+      char const* p = slice->getString(len);
+      dumpString(p, len);
+      break;
+    }
+
+    case ValueType::Binary: {
+      ValueLength len;
+      uint8_t const* p = slice->getBinary(len);
+      dumpLength(len, 0, 0, 0xc4, 0xc5);
+      write(reinterpret_cast<char const*>(p), checkOverflow(len));
+      break;
+    }
+
+    case ValueType::UTCDate: {
+      dumpUTCDate(slice->getUTCDate());
+      break;
+    }
+
+    case ValueType::Array: {
+      ArrayIterator it(*slice);
+      dumpLength(it.size(), 0x90, 16, 0, 0xdc);
+      while (it.valid()) {
+        Slice const value = it.value();
+        dumpValue(&value);
+        it.next();
+      }
+      break;
+    }
+
+    case ValueType::Object: {
+      ObjectIterator it(*slice, !options->dumpAttributesInIndexOrder);
+      dumpLength(it.size(), 0x80, 16, 0, 0xde);
+      while (it.valid()) {
+        auto current = (*it);
+        if (VELOCYPACK_UNLIKELY(!current.key.isString())) {
+          throw Exception(Exception::InvalidValueType,
+                          "Object keys must be strings");
+        }
+        dumpValue(&current.key);
+        dumpValue(&current.value);
+        it.next();
+      }
+      break;
+    }
+
+    case ValueType::External: {
+      Slice const external(reinterpret_cast<uint8_t const*>(slice->getExternal()));
+      dumpValue(&external);
+      break;
+    }
+
+    default: {
+      // None, Illegal, MinKey, MaxKey, BCD and Custom
+      handleUnsupportedType(slice);
+      break;
+    }
+  }
+}
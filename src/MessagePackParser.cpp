@@ -0,0 +1,360 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <cstring>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/MessagePackParser.h"
+#include "velocypack/Utf8Helper.h"
+#include "velocypack/Value.h"
+
+using namespace arangodb::velocypack;
+
+MessagePackParser::MessagePackParser(Options const* options)
+    : options(options),
+      _builderPtr(nullptr),
+      _start(nullptr),
+      _size(0),
+      _pos(0),
+      _valuePos(0),
+      _key(nullptr),
+      _keyLength(0) {
+  if (VELOCYPACK_UNLIKELY(options == nullptr)) {
+    throw Exception(Exception::InternalError, "Options cannot be a nullptr");
+  }
+  _builder.reset(new Builder(options));
+  _builderPtr = _builder.get();
+}
+
+MessagePackParser::MessagePackParser(Builder& builder, Options const* options)
+    : options(options),
+      _builderPtr(nullptr),
+      _start(nullptr),
+      _size(0),
+      _pos(0),
+      _valuePos(0),
+      _key(nullptr),
+      _keyLength(0) {
+  if (VELOCYPACK_UNLIKELY(options == nullptr)) {
+    throw Exception(Exception::InternalError, "Options cannot be a nullptr");
+  }
+  _builder.reset(&builder, BuilderNonDeleter());
+  _builderPtr = _builder.get();
+}
+
+ValueLength MessagePackParser::parse(uint8_t const* start, std::size_t size,
+                                     bool multi) {
+  _start = start;
+  _size = size;
+  _pos = 0;
+  _valuePos = 0;
+  _key = nullptr;
+  if (options->clearBuilderBeforeParse) {
+    _builderPtr->clear();
+  }
+
+  ValueLength nr = 0;
+  do {
+    parseValue();
+    ++nr;
+  } while (multi && _pos < _size);
+
+  if (_pos != _size) {
+    _valuePos = _pos;
+    throw Exception(Exception::ParseError,
+                    "Expecting end of MessagePack input");
+  }
+  return nr;
+}
+
+void MessagePackParser::parseValue() {
+  _valuePos = _pos;
+  need(1);
+  uint8_t const head = _start[_pos++];
+
+  if (head <= 0x7f) {
+    // positive fixint
+    add(Value(static_cast<uint64_t>(head)));
+    return;
+  }
+  if (head >= 0xe0) {
+    // negative fixint
+    add(Value(static_cast<int64_t>(static_cast<int8_t>(head))));
+    return;
+  }
+  if (head <= 0x8f) {
+    parseMap(head & 0x0fU);
+    return;
+  }
+  if (head <= 0x9f) {
+    parseArray(head & 0x0fU);
+    return;
+  }
+  if (head <= 0xbf) {
+    parseString(head & 0x1fU);
+    return;
+  }
+
+  switch (head) {
+    case 0xc0: {
+      add(Value(ValueType::Null));
+      break;
+    }
+    case 0xc2: {
+      add(Value(false));
+      break;
+    }
+    case 0xc3: {
+      add(Value(true));
+      break;
+    }
+    case 0xc4:
+    case 0xc5:
+    case 0xc6: {
+      std::size_t length;
+      if (head == 0xc4) {
+        length = static_cast<std::size_t>(readUInt<1>());
+      } else if (head == 0xc5) {
+        length = static_cast<std::size_t>(readUInt<2>());
+      } else {
+        length = static_cast<std::size_t>(readUInt<4>());
+      }
+      need(length);
+      add(ValuePair(_start + _pos, length, ValueType::Binary));
+      _pos += length;
+      break;
+    }
+    case 0xc7: {
+      parseExtension(static_cast<std::size_t>(readUInt<1>()));
+      break;
+    }
+    case 0xc8: {
+      parseExtension(static_cast<std::size_t>(readUInt<2>()));
+      break;
+    }
+    case 0xc9: {
+      parseExtension(static_cast<std::size_t>(readUInt<4>()));
+      break;
+    }
+    case 0xca: {
+      uint32_t const bits = static_cast<uint32_t>(readUInt<4>());
+      float v;
+      memcpy(&v, &bits, sizeof(v));
+      add(Value(static_cast<double>(v)));
+      break;
+    }
+    case 0xcb: {
+      uint64_t const bits = readUInt<8>();
+      double v;
+      memcpy(&v, &bits, sizeof(v));
+      add(Value(v));
+      break;
+    }
+    case 0xcc: {
+      add(Value(readUInt<1>()));
+      break;
+    }
+    case 0xcd: {
+      add(Value(readUInt<2>()));
+      break;
+    }
+    case 0xce: {
+      add(Value(readUInt<4>()));
+      break;
+    }
+    case 0xcf: {
+      add(Value(readUInt<8>()));
+      break;
+    }
+    case 0xd0: {
+      add(Value(static_cast<int64_t>(static_cast<int8_t>(readUInt<1>()))));
+      break;
+    }
+    case 0xd1: {
+      add(Value(static_cast<int64_t>(static_cast<int16_t>(readUInt<2>()))));
+      break;
+    }
+    case 0xd2: {
+      add(Value(static_cast<int64_t>(static_cast<int32_t>(readUInt<4>()))));
+      break;
+    }
+    case 0xd3: {
+      add(Value(static_cast<int64_t>(readUInt<8>())));
+      break;
+    }
+    case 0xd4:
+    case 0xd5:
+    case 0xd6:
+    case 0xd7:
+    case 0xd8: {
+      // fixext 1, 2, 4, 8 and 16
+      parseExtension(std::size_t(1) << (head - 0xd4));
+      break;
+    }
+    case 0xd9: {
+      parseString(static_cast<std::size_t>(readUInt<1>()));
+      break;
+    }
+    case 0xda: {
+      parseString(static_cast<std::size_t>(readUInt<2>()));
+      break;
+    }
+    case 0xdb: {
+      parseString(static_cast<std::size_t>(readUInt<4>()));
+      break;
+    }
+    case 0xdc: {
+      parseArray(static_cast<std::size_t>(readUInt<2>()));
+      break;
+    }
+    case 0xdd: {
+      parseArray(static_cast<std::size_t>(readUInt<4>()));
+      break;
+    }
+    case 0xde: {
+      parseMap(static_cast<std::size_t>(readUInt<2>()));
+      break;
+    }
+    case 0xdf: {
+      parseMap(static_cast<std::size_t>(readUInt<4>()));
+      break;
+    }
+    default: {
+      // 0xc1 is never used
+      throw Exception(Exception::ParseError, "Invalid MessagePack type");
+    }
+  }
+}
+
+void MessagePackParser::parseString(std::size_t length) {
+  need(length);
+  uint8_t const* p = _start + _pos;
+  if (options->validateUtf8Strings && !Utf8Helper::isValidUtf8(p, length)) {
+    throw Exception(Exception::InvalidUtf8Sequence);
+  }
+  add(ValuePair(p, length, ValueType::String));
+  _pos += length;
+}
+
+void MessagePackParser::parseArray(std::size_t length) {
+  // each member takes at least one byte
+  need(length);
+
+  add(Value(ValueType::Array));
+  for (std::size_t i = 0; i < length; ++i) {
+    parseValue();
+  }
+  _builderPtr->close();
+}
+
+void MessagePackParser::parseMap(std::size_t length) {
+  // each entry takes at least two bytes
+  if (VELOCYPACK_UNLIKELY(length > (_size - _pos) / 2)) {
+    throw Exception(Exception::ParseError,
+                    "Unexpected end of MessagePack input");
+  }
+
+  add(Value(ValueType::Object));
+  for (std::size_t i = 0; i < length; ++i) {
+    _valuePos = _pos;
+    need(1);
+    uint8_t const head = _start[_pos++];
+    std::size_t keyLength;
+    if (head >= 0xa0 && head <= 0xbf) {
+      keyLength = head & 0x1fU;
+    } else if (head == 0xd9) {
+      keyLength = static_cast<std::size_t>(readUInt<1>());
+    } else if (head == 0xda) {
+      keyLength = static_cast<std::size_t>(readUInt<2>());
+    } else if (head == 0xdb) {
+      keyLength = static_cast<std::size_t>(readUInt<4>());
+    } else {
+      throw Exception(Exception::ParseError,
+                      "MessagePack map keys must be strings");
+    }
+    need(keyLength);
+    uint8_t const* key = _start + _pos;
+    if (options->validateUtf8Strings &&
+        !Utf8Helper::isValidUtf8(key, keyLength)) {
+      throw Exception(Exception::InvalidUtf8Sequence);
+    }
+    _key = reinterpret_cast<char const*>(key);
+    _keyLength = keyLength;
+    _pos += keyLength;
+
+    parseValue();
+  }
+  _builderPtr->close();
+}
+
+void MessagePackParser::parseExtension(std::size_t length) {
+  need(1 + length);
+  int8_t const type = static_cast<int8_t>(_start[_pos++]);
+
+  if (type != -1) {
+    throw Exception(Exception::ParseError,
+                    "Unsupported MessagePack extension type");
+  }
+
+  // timestamp with 32 bit seconds, 30 bit nanoseconds and 34 bit seconds,
+  // or 32 bit nanoseconds and 64 bit seconds
+  int64_t seconds;
+  uint64_t nanoseconds;
+  if (length == 4) {
+    seconds = static_cast<int64_t>(readUInt<4>());
+    nanoseconds = 0;
+  } else if (length == 8) {
+    uint64_t const v = readUInt<8>();
+    seconds = static_cast<int64_t>(v & 0x3ffffffffULL);
+    nanoseconds = v >> 34;
+  } else if (length == 12) {
+    nanoseconds = readUInt<4>();
+    seconds = static_cast<int64_t>(readUInt<8>());
+  } else {
+    throw Exception(Exception::ParseError, "Invalid MessagePack timestamp");
+  }
+
+  // the timestamp in milliseconds must fit into an int64_t
+  if (nanoseconds > 999999999 || seconds > INT64_MAX / 1000 ||
+      seconds < INT64_MIN / 1000 - 1) {
+    throw Exception(Exception::NumberOutOfRange);
+  }
+  int64_t const milliseconds = static_cast<int64_t>(nanoseconds / 1000000);
+  int64_t value;
+  if (seconds >= 0) {
+    int64_t const base = seconds * 1000;
+    if (base > INT64_MAX - milliseconds) {
+      throw Exception(Exception::NumberOutOfRange);
+    }
+    value = base + milliseconds;
+  } else {
+    int64_t const base = (seconds + 1) * 1000;
+    if (base < INT64_MIN + 1000 - milliseconds) {
+      throw Exception(Exception::NumberOutOfRange);
+    }
+    value = base - 1000 + milliseconds;
+  }
+  add(Value(value, ValueType::UTCDate));
+}
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/OffsetIndex.h"
+
+using namespace arangodb::velocypack;
+
+OffsetIndex::OffsetIndex(Slice slice)
+    : _slice(slice), _length(0), _compact(false), _built(false) {
+  if (VELOCYPACK_UNLIKELY(!slice.isArray() && !slice.isObject())) {
+    throw Exception(Exception::InvalidValueType,
+                    "Expecting type Array or Object");
+  }
+  _length = slice.length();
+  uint8_t const h = slice.head();
+  _compact = (h == 0x13 || h == 0x14);
+  // other types do not need a side table
+  _built = !_compact;
+}
+
+// collect the offsets of all members in a single pass
+void OffsetIndex::buildOffsets() const {
+  VELOCYPACK_ASSERT(_compact);
+
+  std::vector<ValueLength> offsets;
+  offsets.reserve(checkOverflow(_length));
+
+  if (_length > 0) {
+    bool const isObject = (_slice.head() == 0x14);
+    uint8_t const* start = _slice.start();
+    ValueLength end = readVariableValueLength<false>(start + 1);
+    ValueLength offset = 1 + getVariableValueLength(end);
+
+    for (ValueLength i = 0; i < _length; ++i) {
+      offsets.push_back(offset);
+      offset += Slice(start + offset).byteSize();
+      if (isObject) {
+        // skip over value
+        offset += Slice(start + offset).byteSize();
+      }
+    }
+  }
+
+  _offsets = std::move(offsets);
+  _built = true;
+}
@@ -0,0 +1,301 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <memory>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/ParallelDumper.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+
+using namespace arangodb::velocypack;
+
+ParallelDumper::ParallelDumper(Options const* options, std::size_t threads,
+                               ValueLength chunkSize)
+    : options(options), _chunkSize(chunkSize), _stopping(false) {
+  if (VELOCYPACK_UNLIKELY(options == nullptr)) {
+    throw Exception(Exception::InternalError, "Options cannot be a nullptr");
+  }
+  if (VELOCYPACK_UNLIKELY(chunkSize == 0)) {
+    throw Exception(Exception::InternalError, "chunkSize must not be 0");
+  }
+  if (threads == 0) {
+    threads = std::thread::hardware_concurrency();
+    if (threads == 0) {
+      threads = 1;
+    }
+  }
+  _workers.reserve(threads);
+  try {
+    for (std::size_t i = 0; i < threads; ++i) {
+      _workers.emplace_back([this]() { work(); });
+    }
+  } catch (...) {
+    // the destructor is not called, but the threads already started
+    // must not outlive the object
+    stop();
+    throw;
+  }
+}
+
+ParallelDumper::~ParallelDumper() { stop(); }
+
+void ParallelDumper::stop() {
+  {
+    std::lock_guard<std::mutex> guard(_mutex);
+    _stopping = true;
+  }
+  _condition.notify_all();
+  for (auto& worker : _workers) {
+    worker.join();
+  }
+}
+
+void ParallelDumper::dump(Slice const& slice, Sink* sink) {
+  if (VELOCYPACK_UNLIKELY(sink == nullptr)) {
+    throw Exception(Exception::InternalError, "Sink cannot be a nullptr");
+  }
+  if ((!slice.isArray() && !slice.isObject()) ||
+      slice.byteSize() < _chunkSize || options->projection != nullptr ||
+      options->customTypeHandler != nullptr) {
+    // projections are applied by a single Dumper, and custom type
+    // handlers are not required to be thread-safe
+    Dumper::dump(slice, sink, options);
+    return;
+  }
+
+  std::deque<Segment> segments;
+
+  // scheduled ranges write into their segments, so they must have finished
+  // before the segments go away, even if splitting or writing fails
+  struct Waiter {
+    explicit Waiter(std::deque<Segment>& segments) : segments(segments) {}
+    ~Waiter() {
+      for (auto& segment : segments) {
+        if (segment.done.valid()) {
+          segment.done.wait();
+        }
+      }
+    }
+    std::deque<Segment>& segments;
+  };
+  Waiter waiter(segments);
+
+  // the literal text between the ranges (brackets, separators, keys and
+  // indentation of the containers that are split) is produced by a Dumper
+  // of its own
+  std::string literal;
+  StringSink literalSink(&literal);
+  Dumper planner(&literalSink, options);
+
+  split(planner, literal, &slice, segments);
+  addLiteral(planner, literal, segments);
+
+  sink->reserve(slice.byteSize());
+  for (auto& segment : segments) {
+    if (segment.done.valid()) {
+      // rethrows the exception of a failed range
+      segment.done.get();
+    }
+    sink->append(segment.output);
+    std::string().swap(segment.output);
+  }
+}
+
+void ParallelDumper::split(Dumper& planner, std::string& literal,
+                           Slice const* value,
+                           std::deque<Segment>& segments) {
+  bool const prettyPrint = options->prettyPrint;
+
+  // dumps a member that is split itself, with the separators and the
+  // indentation the Dumper would use for it
+  auto splitMember = [&](Slice const& member, Slice const* key, bool isFirst,
+                         bool isLast) {
+    if (prettyPrint) {
+      planner.indent();
+    } else if (!isFirst) {
+      planner.write(',');
+    }
+    if (key != nullptr) {
+      planner.dumpValue(key, value);
+      if (prettyPrint) {
+        planner.write(" : ", 3);
+      } else {
+        planner.write(':');
+      }
+    }
+    split(planner, literal, &member, segments);
+    if (prettyPrint) {
+      if (!isLast) {
+        planner.write(',');
+      }
+      planner.write('\n');
+    }
+  };
+
+  auto isSplit = [this](Slice const& member) {
+    return (member.isArray() || member.isObject()) &&
+           member.byteSize() >= _chunkSize;
+  };
+
+  if (value->isArray()) {
+    ArrayIterator it(*value);
+    ArrayIterator start(it);
+    ValueLength count = 0;
+    ValueLength bytes = 0;
+
+    planner.openContainer('[');
+    while (it.valid()) {
+      Slice const member = it.value();
+      if (isSplit(member)) {
+        if (count > 0) {
+          addRange(planner, literal, start, count, value, segments);
+        }
+        splitMember(member, nullptr, it.isFirst(), it.isLast());
+        it.next();
+        start = ArrayIterator(it);
+        count = 0;
+        bytes = 0;
+        continue;
+      }
+      ++count;
+      bytes += member.byteSize();
+      it.next();
+      if (bytes >= _chunkSize) {
+        addRange(planner, literal, start, count, value, segments);
+        start = ArrayIterator(it);
+        count = 0;
+        bytes = 0;
+      }
+    }
+    if (count > 0) {
+      addRange(planner, literal, start, count, value, segments);
+    }
+    planner.closeContainer(']');
+  } else {
+    ObjectIterator it(*value, !options->dumpAttributesInIndexOrder);
+    ObjectIterator start(it);
+    ValueLength count = 0;
+    ValueLength bytes = 0;
+
+    planner.openContainer('{');
+    while (it.valid()) {
+      auto current = (*it);
+      if (isSplit(current.value)) {
+        if (count > 0) {
+          addRange(planner, literal, start, count, value, segments);
+        }
+        splitMember(current.value, &current.key, it.isFirst(), it.isLast());
+        it.next();
+        start = ObjectIterator(it);
+        count = 0;
+        bytes = 0;
+        continue;
+      }
+      ++count;
+      bytes += current.key.byteSize() + current.value.byteSize();
+      it.next();
+      if (bytes >= _chunkSize) {
+        addRange(planner, literal, start, count, value, segments);
+        start = ObjectIterator(it);
+        count = 0;
+        bytes = 0;
+      }
+    }
+    if (count > 0) {
+      addRange(planner, literal, start, count, value, segments);
+    }
+    planner.closeContainer('}');
+  }
+}
+
+void ParallelDumper::addLiteral(Dumper& planner, std::string& literal,
+                                std::deque<Segment>& segments) {
+  planner.flush();
+  if (!literal.empty()) {
+    segments.emplace_back();
+    segments.back().output.swap(literal);
+  }
+}
+
+template <typename Iterator>
+void ParallelDumper::addRange(Dumper& planner, std::string& literal,
+                              Iterator const& it, ValueLength count,
+                              Slice const* base,
+                              std::deque<Segment>& segments) {
+  addLiteral(planner, literal, segments);
+
+  segments.emplace_back();
+  Segment& segment = segments.back();
+
+  auto task = std::make_shared<std::packaged_task<void()>>(
+      std::bind(static_cast<void (*)(Options const*, Iterator, ValueLength,
+                                     Slice, int, std::string*)>(&dumpRange),
+                options, it, count, *base, planner._indentation,
+                &segment.output));
+  segment.done = task->get_future();
+
+  {
+    std::lock_guard<std::mutex> guard(_mutex);
+    _queue.emplace_back([task]() { (*task)(); });
+  }
+  _condition.notify_one();
+}
+
+void ParallelDumper::dumpRange(Options const* options, ArrayIterator it,
+                               ValueLength count, Slice base, int indentation,
+                               std::string* output) {
+  StringSink sink(output);
+  Dumper dumper(&sink, options);
+  dumper._indentation = indentation;
+  dumper.dumpArrayMembers(it, count, &base);
+  dumper.flush();
+}
+
+void ParallelDumper::dumpRange(Options const* options, ObjectIterator it,
+                               ValueLength count, Slice base, int indentation,
+                               std::string* output) {
+  StringSink sink(output);
+  Dumper dumper(&sink, options);
+  dumper._indentation = indentation;
+  dumper.dumpObjectMembers(it, count, &base);
+  dumper.flush();
+}
+
+void ParallelDumper::work() {
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> guard(_mutex);
+      _condition.wait(guard, [this]() { return _stopping || !_queue.empty(); });
+      if (_queue.empty()) {
+        return;
+      }
+      job = std::move(_queue.front());
+      _queue.pop_front();
+    }
+    job();
+  }
+}
@@ -485,7 +485,7 @@ void Parser::parseObject() {
     auto const lastPos = _builderPtr->_pos;
     parseString();
 
-    if (options->attributeTranslator != nullptr) {
+    if (options->attributeTranslator != nullptr && !options->buildCanonical) {
       // check if a translation for the attribute name exists
       Slice key(_builderPtr->_start + lastPos);
 
@@ -0,0 +1,209 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <algorithm>
+#include <map>
+#include <memory>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Projection.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// the paths as a tree of steps. a JSON Pointer token made of digits is
+// added as an attribute and as an index, so a node can be reached on
+// more than one way
+struct TrieNode {
+  TrieNode() : selected(false), wildcard(nullptr) {}
+
+  bool selected;
+  std::map<std::string, TrieNode*> attributes;
+  std::map<ValueLength, TrieNode*> indexes;
+  TrieNode* wildcard;
+};
+
+// a set of trie nodes, which becomes one state of the state machine
+typedef std::vector<TrieNode const*> NodeSet;
+
+void normalize(NodeSet& nodes) {
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+}
+
+}  // namespace
+
+constexpr Projection::State Projection::noMatch;
+
+Projection::Projection(std::vector<CompiledPath> const& paths, Mode mode)
+    : _mode(mode) {
+  compile(paths);
+}
+
+Projection::Projection(std::vector<std::string> const& expressions,
+                       Mode mode)
+    : _mode(mode) {
+  std::vector<CompiledPath> paths;
+  paths.reserve(expressions.size());
+  for (auto const& expression : expressions) {
+    paths.emplace_back(expression);
+  }
+  compile(paths);
+}
+
+void Projection::compile(std::vector<CompiledPath> const& paths) {
+  std::vector<std::unique_ptr<TrieNode>> nodes;
+  auto child = [&nodes](TrieNode*& slot) -> TrieNode* {
+    if (slot == nullptr) {
+      nodes.emplace_back(new TrieNode());
+      slot = nodes.back().get();
+    }
+    return slot;
+  };
+
+  nodes.emplace_back(new TrieNode());
+  TrieNode* root = nodes.back().get();
+
+  for (auto const& path : paths) {
+    if (path.empty()) {
+      throw Exception(Exception::InvalidAttributePath,
+                      "Projection paths must not be empty");
+    }
+
+    std::vector<TrieNode*> current{root};
+    std::vector<TrieNode*> next;
+    for (auto const& step : path.steps()) {
+      if (step.type != CompiledPath::StepType::Attribute && step.index < 0) {
+        throw Exception(Exception::InvalidAttributePath,
+                        "Projection paths must not contain negative indexes");
+      }
+      next.clear();
+      for (TrieNode* node : current) {
+        switch (step.type) {
+          case CompiledPath::StepType::Attribute: {
+            next.push_back(child(node->attributes[step.name]));
+            break;
+          }
+          case CompiledPath::StepType::Index: {
+            next.push_back(child(node->indexes[step.index]));
+            break;
+          }
+          case CompiledPath::StepType::AttributeOrIndex: {
+            next.push_back(child(node->attributes[step.name]));
+            next.push_back(child(node->indexes[step.index]));
+            break;
+          }
+          case CompiledPath::StepType::Wildcard: {
+            next.push_back(child(node->wildcard));
+            break;
+          }
+        }
+      }
+      current.swap(next);
+    }
+
+    for (TrieNode* node : current) {
+      node->selected = true;
+    }
+  }
+
+  // subset construction: each state is the set of trie nodes that match
+  // a position in a value. a member matched by a named step is also
+  // matched by a wildcard step of the same node
+  std::map<NodeSet, State> known;
+  std::vector<NodeSet> pending;
+
+  auto addState = [&](NodeSet&& set) -> State {
+    if (set.empty()) {
+      return noMatch;
+    }
+    normalize(set);
+    auto it = known.find(set);
+    if (it != known.end()) {
+      return it->second;
+    }
+    State const state = static_cast<State>(_states.size());
+    _states.emplace_back();
+    known.emplace(set, state);
+    pending.emplace_back(std::move(set));
+    return state;
+  };
+
+  addState(NodeSet{root});
+
+  for (State state = 0; state < pending.size(); ++state) {
+    NodeSet const set = pending[state];
+
+    bool selected = false;
+    NodeSet wildcards;
+    std::map<std::string, NodeSet> attributes;
+    std::map<ValueLength, NodeSet> indexes;
+    for (TrieNode const* node : set) {
+      selected |= node->selected;
+      if (node->wildcard != nullptr) {
+        wildcards.push_back(node->wildcard);
+      }
+      for (auto const& it : node->attributes) {
+        attributes[it.first].push_back(it.second);
+      }
+      for (auto const& it : node->indexes) {
+        indexes[it.first].push_back(it.second);
+      }
+    }
+
+    _states[state].selected = selected;
+    if (selected) {
+      // everything below a selected position is selected as well
+      continue;
+    }
+
+    std::vector<std::pair<std::string, State>> attributeStates;
+    for (auto& it : attributes) {
+      it.second.insert(it.second.end(), wildcards.begin(), wildcards.end());
+      attributeStates.emplace_back(it.first, addState(std::move(it.second)));
+    }
+    std::sort(attributeStates.begin(), attributeStates.end(),
+              [](std::pair<std::string, State> const& lhs,
+                 std::pair<std::string, State> const& rhs) {
+                return StringRef(lhs.first).compare(rhs.first) < 0;
+              });
+
+    std::vector<std::pair<ValueLength, State>> indexStates;
+    for (auto& it : indexes) {
+      it.second.insert(it.second.end(), wildcards.begin(), wildcards.end());
+      indexStates.emplace_back(it.first, addState(std::move(it.second)));
+    }
+
+    State const other = addState(std::move(wildcards));
+
+    // _states may have grown in the meantime
+    StateInfo& info = _states[state];
+    info.attributes = std::move(attributeStates);
+    info.indexes = std::move(indexStates);
+    info.other = other;
+  }
+}
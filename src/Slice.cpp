@@ -38,6 +38,10 @@
 
 using namespace arangodb::velocypack;
 
+#if ASM_OPTIMIZATIONS == 1 && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace {
 
 // maximum values for integers of different byte sizes
@@ -45,6 +49,66 @@ int64_t const maxValues[] = {
   128, 32768, 8388608, 2147483648, 549755813888, 140737488355328, 36028797018963968
 };
 
+// prefilter for linear attribute lookups. short String keys can be
+// rejected by looking at their head byte (which encodes the length) and
+// their first character only, without calling memcmp. long String keys
+// and translated (integer) keys always need a full comparison
+struct KeyTag {
+  explicit KeyTag(StringRef const& attribute) noexcept
+      : head(attribute.size() <= 126
+                 ? static_cast<uint8_t>(0x40 + attribute.size())
+                 : static_cast<uint8_t>(0xbf)),
+        first(attribute.empty() ? 0 : static_cast<uint8_t>(attribute[0])),
+        checkFirst(!attribute.empty()) {}
+
+  // whether or not the key at p needs a full comparison
+  inline bool mayMatch(uint8_t const* p) const noexcept {
+    uint8_t const h = *p;
+    if (static_cast<uint8_t>(h - 0x40) > 0x7e) {
+      // not a short String
+      return true;
+    }
+    return (h == head && (!checkFirst || p[1] == first));
+  }
+
+  uint8_t const head;
+  uint8_t const first;
+  bool const checkFirst;
+};
+
+// number of keys that are prefiltered together in a linear lookup
+constexpr ValueLength KeyTagBatchSize = 16;
+
+#if ASM_OPTIMIZATIONS == 1 && defined(__SSE2__)
+// returns a bit mask of the keys in the batch that need a full comparison
+inline uint32_t matchKeyTags(uint8_t const* heads, uint8_t const* firsts,
+                             KeyTag const& tag) noexcept {
+  __m128i const h = _mm_loadu_si128(reinterpret_cast<__m128i const*>(heads));
+  __m128i eq = _mm_cmpeq_epi8(h, _mm_set1_epi8(static_cast<char>(tag.head)));
+  if (tag.checkFirst) {
+    __m128i const f = _mm_loadu_si128(reinterpret_cast<__m128i const*>(firsts));
+    eq = _mm_and_si128(eq, _mm_cmpeq_epi8(f, _mm_set1_epi8(static_cast<char>(tag.first))));
+  }
+  // head bytes outside of 0x40 - 0xbe are no short Strings. after
+  // subtracting 0x40 these are exactly the (unsigned) values >= 0x7f
+  __m128i const rel = _mm_sub_epi8(h, _mm_set1_epi8(0x40));
+  __m128i const other = _mm_cmpeq_epi8(_mm_max_epu8(rel, _mm_set1_epi8(0x7f)), rel);
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(eq, other)));
+}
+#else
+inline uint32_t matchKeyTags(uint8_t const* heads, uint8_t const* firsts,
+                             KeyTag const& tag) noexcept {
+  uint32_t mask = 0;
+  for (ValueLength i = 0; i < KeyTagBatchSize; ++i) {
+    uint8_t const key[2] = { heads[i], firsts[i] };
+    if (tag.mayMatch(&key[0])) {
+      mask |= (1U << i);
+    }
+  }
+  return mask;
+}
+#endif
+
 } // namespace
   
 uint8_t const Slice::noneSliceData[] = { 0x00 };
@@ -422,14 +486,24 @@ bool Slice::isEqualStringUnchecked(StringRef const& attribute) const noexcept {
 }
 
 Slice Slice::getFromCompactObject(StringRef const& attribute) const {
-  ObjectIterator it(*this);
-  while (it.valid()) {
-    Slice key = it.key(false);
-    if (key.makeKey().isEqualString(attribute)) {
-      return Slice(key.start() + key.byteSize());
-    }
+  VELOCYPACK_ASSERT(head() == 0x14);
 
-    it.next();
+  ValueLength const end = readVariableValueLength<false>(_start + 1);
+  ValueLength const n = readVariableValueLength<true>(_start + end - 1);
+  if (n == 0) {
+    return Slice();
+  }
+
+  KeyTag const tag(attribute);
+  uint8_t const* p = _start + getStartOffsetFromCompact();
+  for (ValueLength i = 0; i < n; ++i) {
+    Slice key(p);
+    p += key.byteSize();
+    if (tag.mayMatch(key.start()) && key.makeKey().isEqualString(attribute)) {
+      return Slice(p);
+    }
+    // skip over value
+    p += Slice(p).byteSize();
   }
   // not found
   return Slice();
@@ -559,31 +633,59 @@ Slice Slice::searchObjectKeyLinear(StringRef const& attribute,
                                    ValueLength ieBase, ValueLength offsetSize,
                                    ValueLength n) const {
   bool const useTranslator = (Options::Defaults.attributeTranslator != nullptr);
+  KeyTag const tag(attribute);
+
+  // the keys are prefiltered in batches, and only the candidates are
+  // compared in full
+  alignas(16) uint8_t heads[::KeyTagBatchSize];
+  alignas(16) uint8_t firsts[::KeyTagBatchSize];
+  uint8_t const* keys[::KeyTagBatchSize];
+
+  for (ValueLength base = 0; base < n; base += ::KeyTagBatchSize) {
+    ValueLength const count = (std::min)(::KeyTagBatchSize, n - base);
+    for (ValueLength i = 0; i < count; ++i) {
+      ValueLength offset = ieBase + (base + i) * offsetSize;
+      uint8_t const* key = _start + readIntegerNonEmpty<ValueLength>(_start + offset, offsetSize);
+      keys[i] = key;
+      heads[i] = key[0];
+      // a key is always followed by a value, so this is safe to read
+      firsts[i] = key[1];
+    }
+    for (ValueLength i = count; i < ::KeyTagBatchSize; ++i) {
+      heads[i] = 0x40;
+      firsts[i] = 0;
+    }
 
-  for (ValueLength index = 0; index < n; ++index) {
-    ValueLength offset = ieBase + index * offsetSize;
-    Slice key(_start + readIntegerNonEmpty<ValueLength>(_start + offset, offsetSize));
+    uint32_t mask = ::matchKeyTags(&heads[0], &firsts[0], tag);
+    mask &= ((1U << count) - 1);
 
-    if (key.isString()) {
-      if (!key.isEqualStringUnchecked(attribute)) {
+    for (ValueLength i = 0; mask != 0; ++i, mask >>= 1) {
+      if ((mask & 1U) == 0) {
         continue;
-      } 
-    } else if (key.isSmallInt() || key.isUInt()) {
-      // translate key
-      if (VELOCYPACK_UNLIKELY(!useTranslator)) {
-        // no attribute translator
-        throw Exception(Exception::NeedAttributeTranslator);
       }
-      if (!key.translateUnchecked().isEqualString(attribute)) {
-        continue;
+      Slice key(keys[i]);
+
+      if (key.isString()) {
+        if (!key.isEqualStringUnchecked(attribute)) {
+          continue;
+        } 
+      } else if (key.isSmallInt() || key.isUInt()) {
+        // translate key
+        if (VELOCYPACK_UNLIKELY(!useTranslator)) {
+          // no attribute translator
+          throw Exception(Exception::NeedAttributeTranslator);
+        }
+        if (!key.translateUnchecked().isEqualString(attribute)) {
+          continue;
+        }
+      } else {
+        // invalid key type
+        return Slice();
       }
-    } else {
-      // invalid key type
-      return Slice();
-    }
 
-    // key is identical. now return value
-    return Slice(key.start() + key.byteSize());
+      // key is identical. now return value
+      return Slice(key.start() + key.byteSize());
+    }
   }
 
   // nothing found
@@ -73,6 +73,32 @@ inline std::size_t JSONSkipWhiteSpaceC(uint8_t const* src, std::size_t limit) {
   return limit - (end - src);
 }
 
+inline std::size_t JSONStringScanC(uint8_t const* src, std::size_t limit,
+                                   bool stopAtSlash, bool stopAtHighBit) {
+  // Count the bytes from src that can be written into a JSON string
+  // without escaping, up to limit. Stop at the first control character,
+  // backslash or double quote, and optionally at the first forward slash
+  // or byte with high bit set.
+  uint8_t const* end = src + limit;
+  while (src < end && *src >= 32 && *src != '\\' && *src != '"' &&
+         (!stopAtSlash || *src != '/') && (!stopAtHighBit || *src < 0x80)) {
+    src++;
+  }
+  return limit - (end - src);
+}
+
+inline std::size_t CSVFieldScanC(uint8_t const* src, std::size_t limit,
+                                 uint8_t delimiter, uint8_t quote) {
+  // Count the bytes from src up to limit that belong to a CSV field, i.e.
+  // stop at the first delimiter, quote, carriage return or line feed.
+  uint8_t const* end = src + limit;
+  while (src < end && *src != delimiter && *src != quote && *src != '\r' &&
+         *src != '\n') {
+    src++;
+  }
+  return limit - (end - src);
+}
+
 inline bool ValidateUtf8StringC(uint8_t const* src, std::size_t limit) {
   return Utf8Helper::isValidUtf8(src, static_cast<ValueLength>(limit));
 }
@@ -245,6 +271,147 @@ std::size_t doInitSkip(uint8_t const* src, std::size_t limit) {
   return (*JSONSkipWhiteSpace)(src, limit);
 }
 
+std::size_t JSONStringScanSSE42(uint8_t const* src, std::size_t limit,
+                                bool stopAtSlash, bool stopAtHighBit) {
+  // ranges of bytes that do not need escaping, for all combinations of
+  // stopAtSlash and stopAtHighBit
+  static char const ranges[4][17] = {
+      "\x20\x21\x23\x5b\x5d\xff          ",
+      "\x20\x21\x23\x5b\x5d\x7f          ",
+      "\x20\x21\x23\x2e\x30\x5b\x5d\xff    ",
+      "\x20\x21\x23\x2e\x30\x5b\x5d\x7f    "};
+
+  __m128i const r = _mm_loadu_si128(reinterpret_cast<__m128i const*>(
+      ranges[(stopAtSlash ? 2 : 0) + (stopAtHighBit ? 1 : 0)]));
+  int const n = stopAtSlash ? 8 : 6;
+  std::size_t count = 0;
+  while (limit >= 16) {
+    __m128i const s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src));
+    int const x = _mm_cmpestri(r, n, s, 16,
+                               _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES |
+                                   _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT);
+    if (x < 16) {
+      return count + x;
+    }
+    src += 16;
+    limit -= 16;
+    count += 16;
+  }
+  // no overlong reads for the remainder, as the string may end right
+  // before a page boundary
+  return count + JSONStringScanC(src, limit, stopAtSlash, stopAtHighBit);
+}
+
+#ifdef __AVX2__
+std::size_t JSONStringScanAVX2(uint8_t const* src, std::size_t limit,
+                               bool stopAtSlash, bool stopAtHighBit) {
+  __m256i const controlMax = _mm256_set1_epi8(0x1f);
+  __m256i const quote = _mm256_set1_epi8('"');
+  __m256i const backslash = _mm256_set1_epi8('\\');
+  __m256i const slash = _mm256_set1_epi8(stopAtSlash ? '/' : '"');
+  std::size_t count = 0;
+  while (limit >= 32) {
+    __m256i const s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src));
+    __m256i m = _mm256_cmpeq_epi8(_mm256_max_epu8(s, controlMax), controlMax);
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(s, quote));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(s, backslash));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(s, slash));
+    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(m));
+    if (stopAtHighBit) {
+      mask |= static_cast<uint32_t>(_mm256_movemask_epi8(s));
+    }
+    if (mask != 0) {
+      return count + __builtin_ctz(mask);
+    }
+    src += 32;
+    limit -= 32;
+    count += 32;
+  }
+  return count + JSONStringScanSSE42(src, limit, stopAtSlash, stopAtHighBit);
+}
+#endif
+
+std::size_t doInitScan(uint8_t const* src, std::size_t limit,
+                       bool stopAtSlash, bool stopAtHighBit) {
+#ifdef __AVX2__
+  if (assemblerFunctionsEnabled() && ::hasAVX2()) {
+    JSONStringScan = ::JSONStringScanAVX2;
+    return (*JSONStringScan)(src, limit, stopAtSlash, stopAtHighBit);
+  }
+#endif
+  if (assemblerFunctionsEnabled() && ::hasSSE42()) {
+    JSONStringScan = ::JSONStringScanSSE42;
+  } else {
+    JSONStringScan = ::JSONStringScanC;
+  }
+  return (*JSONStringScan)(src, limit, stopAtSlash, stopAtHighBit);
+}
+
+std::size_t CSVFieldScanSSE42(uint8_t const* src, std::size_t limit,
+                              uint8_t delimiter, uint8_t quote) {
+  __m128i const stops = _mm_setr_epi8(static_cast<char>(delimiter),
+                                      static_cast<char>(quote), '\r', '\n',
+                                      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  std::size_t count = 0;
+  while (limit >= 16) {
+    __m128i const s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src));
+    // explicit lengths, so that NUL bytes in the input are not special
+    int const x = _mm_cmpestri(stops, 4, s, 16,
+                               _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY |
+                                   _SIDD_LEAST_SIGNIFICANT);
+    if (x < 16) {
+      return count + x;
+    }
+    src += 16;
+    limit -= 16;
+    count += 16;
+  }
+  // no overlong reads for the remainder, as the input may end right
+  // before a page boundary
+  return count + CSVFieldScanC(src, limit, delimiter, quote);
+}
+
+#ifdef __AVX2__
+std::size_t CSVFieldScanAVX2(uint8_t const* src, std::size_t limit,
+                             uint8_t delimiter, uint8_t quote) {
+  __m256i const d = _mm256_set1_epi8(static_cast<char>(delimiter));
+  __m256i const q = _mm256_set1_epi8(static_cast<char>(quote));
+  __m256i const cr = _mm256_set1_epi8('\r');
+  __m256i const lf = _mm256_set1_epi8('\n');
+  std::size_t count = 0;
+  while (limit >= 32) {
+    __m256i const s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src));
+    __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(s, d), _mm256_cmpeq_epi8(s, q));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(s, cr));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(s, lf));
+    uint32_t const mask = static_cast<uint32_t>(_mm256_movemask_epi8(m));
+    if (mask != 0) {
+      return count + __builtin_ctz(mask);
+    }
+    src += 32;
+    limit -= 32;
+    count += 32;
+  }
+  return count + CSVFieldScanSSE42(src, limit, delimiter, quote);
+}
+#endif
+
+std::size_t doInitCSVFieldScan(uint8_t const* src, std::size_t limit,
+                               uint8_t delimiter, uint8_t quote) {
+#ifdef __AVX2__
+  if (assemblerFunctionsEnabled() && ::hasAVX2()) {
+    CSVFieldScan = ::CSVFieldScanAVX2;
+    return (*CSVFieldScan)(src, limit, delimiter, quote);
+  }
+#endif
+  if (assemblerFunctionsEnabled() && ::hasSSE42()) {
+    CSVFieldScan = ::CSVFieldScanSSE42;
+  } else {
+    CSVFieldScan = ::CSVFieldScanC;
+  }
+  return (*CSVFieldScan)(src, limit, delimiter, quote);
+}
+
 #ifdef __AVX2__
 bool ValidateUtf8StringAVX(uint8_t const* src, std::size_t len) {
   if (len >= 32) {
@@ -295,6 +462,18 @@ std::size_t doInitSkip(uint8_t const* src, std::size_t limit) {
   JSONSkipWhiteSpace = ::JSONSkipWhiteSpaceC;
   return JSONSkipWhiteSpace(src, limit);
 }
+
+std::size_t doInitScan(uint8_t const* src, std::size_t limit,
+                       bool stopAtSlash, bool stopAtHighBit) {
+  JSONStringScan = ::JSONStringScanC;
+  return JSONStringScanC(src, limit, stopAtSlash, stopAtHighBit);
+}
+
+std::size_t doInitCSVFieldScan(uint8_t const* src, std::size_t limit,
+                               uint8_t delimiter, uint8_t quote) {
+  CSVFieldScan = ::CSVFieldScanC;
+  return CSVFieldScanC(src, limit, delimiter, quote);
+}
   
 bool doInitValidateUtf8String(uint8_t const* src, std::size_t limit) {
   ValidateUtf8String = ::ValidateUtf8StringC;
@@ -308,18 +487,24 @@ bool doInitValidateUtf8String(uint8_t const* src, std::size_t limit) {
 std::size_t (*JSONStringCopy)(uint8_t*, uint8_t const*, std::size_t) = ::doInitCopy;
 std::size_t (*JSONStringCopyCheckUtf8)(uint8_t*, uint8_t const*, std::size_t) = ::doInitCopyCheckUtf8;
 std::size_t (*JSONSkipWhiteSpace)(uint8_t const*, std::size_t) = ::doInitSkip;
+std::size_t (*JSONStringScan)(uint8_t const*, std::size_t, bool, bool) = ::doInitScan;
+std::size_t (*CSVFieldScan)(uint8_t const*, std::size_t, uint8_t, uint8_t) = ::doInitCSVFieldScan;
 bool (*ValidateUtf8String)(uint8_t const*, std::size_t) = ::doInitValidateUtf8String;
 
 void arangodb::velocypack::enableNativeStringFunctions() {
   JSONStringCopy = ::doInitCopy;
   JSONStringCopyCheckUtf8 = ::doInitCopyCheckUtf8;
   JSONSkipWhiteSpace = ::doInitSkip;
+  JSONStringScan = ::doInitScan;
+  CSVFieldScan = ::doInitCSVFieldScan;
 }
 
 void arangodb::velocypack::enableBuiltinStringFunctions() {
   JSONStringCopy = ::JSONStringCopyC;
   JSONStringCopyCheckUtf8 = ::JSONStringCopyCheckUtf8C;
   JSONSkipWhiteSpace = ::JSONSkipWhiteSpaceC;
+  JSONStringScan = ::JSONStringScanC;
+  CSVFieldScan = ::CSVFieldScanC;
 }
 
 
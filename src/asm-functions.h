@@ -37,6 +37,15 @@ extern std::size_t (*JSONStringCopyCheckUtf8)(uint8_t*, uint8_t const*, std::siz
 // White space skipping:
 extern std::size_t (*JSONSkipWhiteSpace)(uint8_t const*, std::size_t);
 
+// Length of the prefix of a string that can be written into JSON as is.
+// Stops at control characters, double quotes and backslashes, and also at
+// forward slashes and bytes with the high bit set if requested:
+extern std::size_t (*JSONStringScan)(uint8_t const*, std::size_t, bool, bool);
+
+// Length of the prefix of a CSV field that contains no delimiter, quote,
+// carriage return or line feed:
+extern std::size_t (*CSVFieldScan)(uint8_t const*, std::size_t, uint8_t, uint8_t);
+
 // check string for invalid utf-8 sequences
 extern bool (*ValidateUtf8String)(uint8_t const*, std::size_t);
 
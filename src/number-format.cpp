@@ -0,0 +1,504 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <cstring>
+
+#include "velocypack/velocypack-common.h"
+#include "number-format.h"
+#include "ryu-tables.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// the decimal representations of 0 to 99, two characters each
+char const DigitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// returns the number of decimal digits of the value
+inline std::size_t decimalLength(uint64_t v) {
+  std::size_t length = 1;
+  for (;;) {
+    if (v < 10) {
+      return length;
+    }
+    if (v < 100) {
+      return length + 1;
+    }
+    if (v < 1000) {
+      return length + 2;
+    }
+    if (v < 10000) {
+      return length + 3;
+    }
+    v /= 10000U;
+    length += 4;
+  }
+}
+
+// writes the length decimal digits of the value backwards from dest + length,
+// two digits at a time
+inline void writeDigits(uint64_t v, char* dest, std::size_t length) {
+  char* p = dest + length;
+  while (v >= 100) {
+    std::size_t const i = static_cast<std::size_t>(v % 100) * 2;
+    v /= 100;
+    p -= 2;
+    std::memcpy(p, &DigitPairs[i], 2);
+  }
+  if (v >= 10) {
+    std::memcpy(p - 2, &DigitPairs[v * 2], 2);
+  } else {
+    *(p - 1) = static_cast<char>('0' + v);
+  }
+}
+
+// Ryu, see Ulf Adams: "Ryu: fast float-to-string conversion", PLDI 2018.
+// computes the shortest decimal mantissa and exponent that round-trip to
+// the given finite, non-zero double
+
+int const mantissaBits = 52;
+int const exponentBits = 11;
+int const exponentBias = 1023;
+
+// ceil(log2(5^e)) for 0 < e <= 3528, and 1 for e == 0
+inline int pow5Bits(int e) {
+  return static_cast<int>((static_cast<uint32_t>(e) * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e)) for 0 <= e <= 1650
+inline uint32_t log10Pow2(int e) {
+  return (static_cast<uint32_t>(e) * 78913) >> 18;
+}
+
+// floor(log10(5^e)) for 0 <= e <= 2620
+inline uint32_t log10Pow5(int e) {
+  return (static_cast<uint32_t>(e) * 732923) >> 20;
+}
+
+inline uint32_t pow5Factor(uint64_t value) {
+  uint32_t count = 0;
+  while (value % 5 == 0) {
+    value /= 5;
+    ++count;
+  }
+  return count;
+}
+
+inline bool multipleOfPowerOf5(uint64_t value, uint32_t p) {
+  return pow5Factor(value) >= p;
+}
+
+inline bool multipleOfPowerOf2(uint64_t value, uint32_t p) {
+  return (value & ((uint64_t(1) << p) - 1)) == 0;
+}
+
+// returns the bits j to j + 63 of the 192 bit product of m and the
+// 128 bit value mul, with 64 < j < 128
+inline uint64_t mulShift64(uint64_t m, uint64_t const* mul, int j) {
+#ifdef __SIZEOF_INT128__
+  typedef unsigned __int128 uint128_t;
+  uint128_t const b0 = static_cast<uint128_t>(m) * mul[0];
+  uint128_t const b2 = static_cast<uint128_t>(m) * mul[1];
+  return static_cast<uint64_t>(((b0 >> 64) + b2) >> (j - 64));
+#else
+  // portable 64x64 to 128 bit multiplication
+  auto umul128 = [](uint64_t a, uint64_t b, uint64_t& high) -> uint64_t {
+    uint64_t const aLo = static_cast<uint32_t>(a);
+    uint64_t const aHi = a >> 32;
+    uint64_t const bLo = static_cast<uint32_t>(b);
+    uint64_t const bHi = b >> 32;
+    uint64_t const b00 = aLo * bLo;
+    uint64_t const b01 = aLo * bHi;
+    uint64_t const b10 = aHi * bLo;
+    uint64_t const b11 = aHi * bHi;
+    uint64_t const mid1 = b10 + (b00 >> 32);
+    uint64_t const mid2 = b01 + static_cast<uint32_t>(mid1);
+    high = b11 + (mid1 >> 32) + (mid2 >> 32);
+    return (mid2 << 32) | static_cast<uint32_t>(b00);
+  };
+  uint64_t high0;
+  umul128(m, mul[0], high0);
+  uint64_t high1;
+  uint64_t const low1 = umul128(m, mul[1], high1);
+  uint64_t const sum = high0 + low1;
+  if (sum < high0) {
+    ++high1;
+  }
+  int const shift = j - 64;
+  return (high1 << (64 - shift)) | (sum >> shift);
+#endif
+}
+
+// returns the shortest decimal mantissa in mantissa and the decimal
+// exponent of its last digit in exponent
+void shortest(uint64_t ieeeMantissa, uint32_t ieeeExponent,
+              uint64_t& mantissa, int& exponent) {
+  int e2;
+  uint64_t m2;
+  if (ieeeExponent == 0) {
+    // subnormal. subtract 2 so that the bounds computation has 2
+    // additional bits
+    e2 = 1 - exponentBias - mantissaBits - 2;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = static_cast<int>(ieeeExponent) - exponentBias - mantissaBits - 2;
+    m2 = (uint64_t(1) << mantissaBits) | ieeeMantissa;
+  }
+  bool const acceptBounds = (m2 & 1) == 0;
+
+  // the interval of decimal values that round to the double, scaled by 4
+  uint64_t const mv = 4 * m2;
+  uint32_t const mmShift = (ieeeMantissa != 0 || ieeeExponent <= 1) ? 1 : 0;
+
+  uint64_t vr, vp, vm;
+  int e10;
+  bool vmIsTrailingZeros = false;
+  bool vrIsTrailingZeros = false;
+  if (e2 >= 0) {
+    uint32_t const q = log10Pow2(e2) - (e2 > 3 ? 1 : 0);
+    e10 = static_cast<int>(q);
+    int const k = pow5InvBitCount + pow5Bits(static_cast<int>(q)) - 1;
+    int const i = -e2 + static_cast<int>(q) + k;
+    uint64_t const* mul = Pow5InvSplit[q];
+    vr = mulShift64(4 * m2, mul, i);
+    vp = mulShift64(4 * m2 + 2, mul, i);
+    vm = mulShift64(4 * m2 - 1 - mmShift, mul, i);
+    if (q <= 21) {
+      // only one of mp, mv and mm can be a multiple of 5, if any
+      if (mv % 5 == 0) {
+        vrIsTrailingZeros = multipleOfPowerOf5(mv, q);
+      } else if (acceptBounds) {
+        vmIsTrailingZeros = multipleOfPowerOf5(mv - 1 - mmShift, q);
+      } else {
+        vp -= multipleOfPowerOf5(mv + 2, q) ? 1 : 0;
+      }
+    }
+  } else {
+    uint32_t const q = log10Pow5(-e2) - (-e2 > 1 ? 1 : 0);
+    e10 = static_cast<int>(q) + e2;
+    int const i = -e2 - static_cast<int>(q);
+    int const k = pow5Bits(i) - pow5BitCount;
+    int const j = static_cast<int>(q) - k;
+    uint64_t const* mul = Pow5Split[i];
+    vr = mulShift64(4 * m2, mul, j);
+    vp = mulShift64(4 * m2 + 2, mul, j);
+    vm = mulShift64(4 * m2 - 1 - mmShift, mul, j);
+    if (q <= 1) {
+      // mv has at least q trailing 0 bits, so vr has at least q
+      // trailing decimal zeros
+      vrIsTrailingZeros = true;
+      if (acceptBounds) {
+        vmIsTrailingZeros = mmShift == 1;
+      } else {
+        --vp;
+      }
+    } else if (q < 63) {
+      vrIsTrailingZeros = multipleOfPowerOf2(mv, q);
+    }
+  }
+
+  // remove as many digits as possible while staying inside the interval
+  int removed = 0;
+  uint8_t lastRemovedDigit = 0;
+  uint64_t output;
+  if (vmIsTrailingZeros || vrIsTrailingZeros) {
+    // rare general case
+    for (;;) {
+      uint64_t const vpDiv10 = vp / 10;
+      uint64_t const vmDiv10 = vm / 10;
+      if (vpDiv10 <= vmDiv10) {
+        break;
+      }
+      uint32_t const vmMod10 = static_cast<uint32_t>(vm % 10);
+      uint64_t const vrDiv10 = vr / 10;
+      uint32_t const vrMod10 = static_cast<uint32_t>(vr % 10);
+      vmIsTrailingZeros &= vmMod10 == 0;
+      vrIsTrailingZeros &= lastRemovedDigit == 0;
+      lastRemovedDigit = static_cast<uint8_t>(vrMod10);
+      vr = vrDiv10;
+      vp = vpDiv10;
+      vm = vmDiv10;
+      ++removed;
+    }
+    if (vmIsTrailingZeros) {
+      for (;;) {
+        uint64_t const vmDiv10 = vm / 10;
+        uint32_t const vmMod10 = static_cast<uint32_t>(vm % 10);
+        if (vmMod10 != 0) {
+          break;
+        }
+        uint64_t const vpDiv10 = vp / 10;
+        uint64_t const vrDiv10 = vr / 10;
+        uint32_t const vrMod10 = static_cast<uint32_t>(vr % 10);
+        vrIsTrailingZeros &= lastRemovedDigit == 0;
+        lastRemovedDigit = static_cast<uint8_t>(vrMod10);
+        vr = vrDiv10;
+        vp = vpDiv10;
+        vm = vmDiv10;
+        ++removed;
+      }
+    }
+    if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) {
+      // exactly in the middle: round to even
+      lastRemovedDigit = 4;
+    }
+    output = vr + (((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) ||
+                    lastRemovedDigit >= 5)
+                       ? 1
+                       : 0);
+  } else {
+    // common case
+    bool roundUp = false;
+    uint64_t const vpDiv100 = vp / 100;
+    uint64_t const vmDiv100 = vm / 100;
+    if (vpDiv100 > vmDiv100) {
+      uint64_t const vrDiv100 = vr / 100;
+      uint32_t const vrMod100 = static_cast<uint32_t>(vr % 100);
+      roundUp = vrMod100 >= 50;
+      vr = vrDiv100;
+      vp = vpDiv100;
+      vm = vmDiv100;
+      removed += 2;
+    }
+    for (;;) {
+      uint64_t const vpDiv10 = vp / 10;
+      uint64_t const vmDiv10 = vm / 10;
+      if (vpDiv10 <= vmDiv10) {
+        break;
+      }
+      uint64_t const vrDiv10 = vr / 10;
+      uint32_t const vrMod10 = static_cast<uint32_t>(vr % 10);
+      roundUp = vrMod10 >= 5;
+      vr = vrDiv10;
+      vp = vpDiv10;
+      vm = vmDiv10;
+      ++removed;
+    }
+    output = vr + ((vr == vm || roundUp) ? 1 : 0);
+  }
+
+  mantissa = output;
+  exponent = e10 + removed;
+}
+
+// fast path for doubles that are integers in the range [1, 2^53]. returns
+// false for all other values
+inline bool smallInteger(uint64_t ieeeMantissa, uint32_t ieeeExponent,
+                         uint64_t& mantissa, int& exponent) {
+  int const e2 = static_cast<int>(ieeeExponent) - exponentBias - mantissaBits;
+  if (e2 > 0 || e2 < -mantissaBits) {
+    return false;
+  }
+  uint64_t const m2 = (uint64_t(1) << mantissaBits) | ieeeMantissa;
+  uint64_t const mask = (uint64_t(1) << -e2) - 1;
+  if ((m2 & mask) != 0) {
+    return false;
+  }
+  mantissa = m2 >> -e2;
+  exponent = 0;
+  while (mantissa % 10 == 0) {
+    mantissa /= 10;
+    ++exponent;
+  }
+  return true;
+}
+
+// returns the number of characters emitDigits writes
+std::size_t emitLength(uint64_t mantissa, int K) {
+  int const ndigits = static_cast<int>(decimalLength(mantissa));
+  int exp = K + ndigits - 1;
+  if (exp < 0) {
+    exp = -exp;
+  }
+
+  if (K >= 0 && exp < ndigits + 7) {
+    return static_cast<std::size_t>(ndigits + K);
+  }
+  if (K < 0 && (K > -7 || exp < 4)) {
+    int const offset = ndigits + K;
+    if (offset <= 0) {
+      return static_cast<std::size_t>(ndigits + 2 - offset);
+    }
+    return static_cast<std::size_t>(ndigits + 1);
+  }
+  return (ndigits > 1 ? ndigits + 1 : 1) + 2 +
+         (exp >= 100 ? 3 : (exp >= 10 ? 2 : 1));
+}
+
+// writes the ndigits digits of the decimal mantissa, with the decimal
+// exponent K of the last digit. plain notation is used for moderately
+// sized values, scientific notation otherwise
+std::size_t emitDigits(uint64_t mantissa, int K, char* dest) {
+  char digits[17];
+  int const ndigits = static_cast<int>(decimalLength(mantissa));
+  writeDigits(mantissa, &digits[0], static_cast<std::size_t>(ndigits));
+
+  int exp = K + ndigits - 1;
+  if (exp < 0) {
+    exp = -exp;
+  }
+
+  // plain integer
+  if (K >= 0 && exp < ndigits + 7) {
+    std::memcpy(dest, &digits[0], ndigits);
+    std::memset(dest + ndigits, '0', K);
+    return static_cast<std::size_t>(ndigits + K);
+  }
+
+  // decimal without exponent
+  if (K < 0 && (K > -7 || exp < 4)) {
+    int offset = ndigits + K;
+    if (offset <= 0) {
+      // value < 1.0, write leading zeros
+      offset = -offset;
+      dest[0] = '0';
+      dest[1] = '.';
+      std::memset(dest + 2, '0', offset);
+      std::memcpy(dest + offset + 2, &digits[0], ndigits);
+      return static_cast<std::size_t>(ndigits + 2 + offset);
+    }
+    std::memcpy(dest, &digits[0], offset);
+    dest[offset] = '.';
+    std::memcpy(dest + offset + 1, &digits[offset], ndigits - offset);
+    return static_cast<std::size_t>(ndigits + 1);
+  }
+
+  // scientific notation
+  std::size_t idx = 0;
+  dest[idx++] = digits[0];
+  if (ndigits > 1) {
+    dest[idx++] = '.';
+    std::memcpy(dest + idx, &digits[1], ndigits - 1);
+    idx += ndigits - 1;
+  }
+  dest[idx++] = 'e';
+  dest[idx++] = (K + ndigits - 1 < 0) ? '-' : '+';
+  if (exp >= 100) {
+    dest[idx++] = static_cast<char>('0' + exp / 100);
+    exp %= 100;
+    std::memcpy(dest + idx, &DigitPairs[exp * 2], 2);
+    idx += 2;
+  } else if (exp >= 10) {
+    std::memcpy(dest + idx, &DigitPairs[exp * 2], 2);
+    idx += 2;
+  } else {
+    dest[idx++] = static_cast<char>('0' + exp);
+  }
+  return idx;
+}
+
+// splits a double into sign, mantissa and decimal exponent of the shortest
+// representation. returns the characters to write instead for zero, NaN
+// and infinity, or nullptr for all other values
+char const* decompose(double value, bool& negative, uint64_t& mantissa,
+                      int& exponent) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  uint64_t const ieeeMantissa = bits & ((uint64_t(1) << mantissaBits) - 1);
+  uint32_t const ieeeExponent = static_cast<uint32_t>(
+      (bits >> mantissaBits) & ((1U << exponentBits) - 1));
+
+  negative = (bits >> 63) != 0;
+  if (ieeeExponent == ((1U << exponentBits) - 1)) {
+    return (ieeeMantissa != 0) ? "NaN" : "inf";
+  }
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    return "0";
+  }
+  if (!smallInteger(ieeeMantissa, ieeeExponent, mantissa, exponent)) {
+    shortest(ieeeMantissa, ieeeExponent, mantissa, exponent);
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+std::size_t arangodb::velocypack::formatUInt(uint64_t value, char* dest) {
+  std::size_t const length = decimalLength(value);
+  writeDigits(value, dest, length);
+  return length;
+}
+
+std::size_t arangodb::velocypack::uintLength(uint64_t value) {
+  return decimalLength(value);
+}
+
+std::size_t arangodb::velocypack::formatInt(int64_t value, char* dest) {
+  if (value >= 0) {
+    return formatUInt(static_cast<uint64_t>(value), dest);
+  }
+  // negate in unsigned arithmetic, which also works for INT64_MIN
+  *dest = '-';
+  return 1 + formatUInt(uint64_t(0) - static_cast<uint64_t>(value), dest + 1);
+}
+
+std::size_t arangodb::velocypack::intLength(int64_t value) {
+  if (value >= 0) {
+    return decimalLength(static_cast<uint64_t>(value));
+  }
+  return 1 + decimalLength(uint64_t(0) - static_cast<uint64_t>(value));
+}
+
+std::size_t arangodb::velocypack::formatDouble(double value, char* dest) {
+  bool negative;
+  uint64_t mantissa;
+  int exponent;
+  char const* special = decompose(value, negative, mantissa, exponent);
+
+  std::size_t length = 0;
+  if (negative) {
+    dest[length++] = '-';
+  }
+  if (special != nullptr) {
+    std::size_t const n = std::strlen(special);
+    std::memcpy(dest + length, special, n);
+    return length + n;
+  }
+  return length + emitDigits(mantissa, exponent, dest + length);
+}
+
+std::size_t arangodb::velocypack::doubleLength(double value) {
+  bool negative;
+  uint64_t mantissa;
+  int exponent;
+  char const* special = decompose(value, negative, mantissa, exponent);
+
+  std::size_t const length = negative ? 1 : 0;
+  if (special != nullptr) {
+    return length + std::strlen(special);
+  }
+  return length + emitLength(mantissa, exponent);
+}
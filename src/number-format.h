@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#ifndef VELOCYPACK_NUMBER_FORMAT_H
+#define VELOCYPACK_NUMBER_FORMAT_H 1
+
+#include <cstddef>
+#include <cstdint>
+
+namespace arangodb {
+namespace velocypack {
+
+// maximum number of characters written by formatUInt and formatInt
+static constexpr std::size_t maxIntegerLength = 20;
+
+// maximum number of characters written by formatDouble
+static constexpr std::size_t maxDoubleLength = 25;
+
+// writes the decimal representation of the value into dest and returns
+// the number of characters written. dest must have room for at least
+// maxIntegerLength characters. the output is not NUL-terminated
+std::size_t formatUInt(uint64_t value, char* dest);
+
+// writes the decimal representation of the value into dest and returns
+// the number of characters written. dest must have room for at least
+// maxIntegerLength characters. the output is not NUL-terminated
+std::size_t formatInt(int64_t value, char* dest);
+
+// writes the shortest decimal representation of the value that parses
+// back into the same double into dest and returns the number of characters
+// written. dest must have room for at least maxDoubleLength characters.
+// the output is not NUL-terminated. NaN and infinity are written as "NaN"
+// and "inf" (with a leading "-" if the sign bit is set), which is not valid
+// JSON, so callers should handle them beforehand
+std::size_t formatDouble(double value, char* dest);
+
+// return the number of characters formatUInt, formatInt and formatDouble
+// write for the value, without writing them
+std::size_t uintLength(uint64_t value);
+
+std::size_t intLength(int64_t value);
+
+std::size_t doubleLength(double value);
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
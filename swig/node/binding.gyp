@@ -9,9 +9,9 @@
                    "../../src/Dumper.cpp",
                    "../../src/Exception.cpp",
                    "../../src/fasthash.cpp",
-                   "../../src/fpconv.cpp",
                    "../../src/HexDump.cpp",
                    "../../src/Iterator.cpp",
+                   "../../src/number-format.cpp",
                    "../../src/Options.cpp",
                    "../../src/Parser.cpp",
                    "../../src/Slice.cpp",
@@ -1,25 +1,44 @@
 
+#include <fstream>
+#include <initializer_list>
+#include <string>
+
 #include "velocypack/velocypack-common.h"
 #include "velocypack/AttributeTranslator.h"
 #include "velocypack/Basics.h"
+#include "velocypack/BsonDumper.h"
+#include "velocypack/BsonParser.h"
 #include "velocypack/Buffer.h"
 #include "velocypack/Builder.h"
 #include "velocypack/Collection.h"
+#include "velocypack/ColumnDecoder.h"
 #include "velocypack/Compare.h"
+#include "velocypack/CompiledFilter.h"
+#include "velocypack/CompiledPath.h"
+#include "velocypack/CsvParser.h"
 #include "velocypack/Dumper.h"
 #include "velocypack/Exception.h"
+#include "velocypack/FileDescriptorSink.h"
+#include "velocypack/HashIndex.h"
 #include "velocypack/HexDump.h"
 #include "velocypack/Iterator.h"
+#include "velocypack/MessagePackDumper.h"
+#include "velocypack/MessagePackParser.h"
+#include "velocypack/OffsetIndex.h"
 #include "velocypack/Options.h"
+#include "velocypack/ParallelDumper.h"
 #include "velocypack/Parser.h"
+#include "velocypack/Projection.h"
 #include "velocypack/Sink.h"
 #include "velocypack/Slice.h"
 #include "velocypack/SliceContainer.h"
 #include "velocypack/StringRef.h"
+#include "velocypack/Traversal.h"
 #include "velocypack/Validator.h"
 #include "velocypack/Value.h"
 #include "velocypack/ValueType.h"
 #include "velocypack/Version.h"
+#include "velocypack/View.h"
 
 #include "gtest/gtest.h"
 
@@ -36,6 +55,60 @@ using namespace arangodb::velocypack;
     ASSERT_FALSE(true);                              \
   }
 
+// don't complain if these functions are not called
+static std::string tryReadFile(std::string const&) VELOCYPACK_UNUSED;
+static std::string readFile(std::string) VELOCYPACK_UNUSED;
+
+static std::string tryReadFile(std::string const& filename) {
+  std::string s;
+  std::ifstream ifs(filename.c_str(), std::ifstream::in);
+
+  if (!ifs.is_open()) {
+    throw "cannot open input file";
+  }
+
+  char buffer[4096];
+  while (ifs.good()) {
+    ifs.read(&buffer[0], sizeof(buffer));
+    s.append(buffer, ifs.gcount());
+  }
+  ifs.close();
+
+  return s;
+}
+
+// reads a file from tests/jsonSample, looking for it relative to the
+// current directory and up to two of its parents
+static std::string readFile(std::string filename) {
+#ifdef _WIN32
+  std::string const separator("\\");
+#else
+  std::string const separator("/");
+#endif
+  filename = "tests" + separator + "jsonSample" + separator + filename;
+
+  for (std::size_t i = 0; i < 3; ++i) {
+    try {
+      return tryReadFile(filename);
+    } catch (...) {
+      filename = ".." + separator + filename;
+    }
+  }
+  throw "cannot open input file";
+}
+
+// don't complain if this function is not called
+static std::string bytes(std::initializer_list<uint8_t>) VELOCYPACK_UNUSED;
+
+// builds a binary string from a list of byte values
+static std::string bytes(std::initializer_list<uint8_t> values) {
+  std::string result;
+  for (uint8_t v : values) {
+    result.push_back(static_cast<char>(v));
+  }
+  return result;
+}
+
 // don't complain if this function is not called
 static void dumpDouble(double, uint8_t*) VELOCYPACK_UNUSED;
 
@@ -0,0 +1,375 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+// returns a BSON document with the given elements
+static std::string document(std::string const& elements) {
+  uint32_t const size = static_cast<uint32_t>(4 + elements.size() + 1);
+  return bytes({static_cast<uint8_t>(size), static_cast<uint8_t>(size >> 8),
+                static_cast<uint8_t>(size >> 16),
+                static_cast<uint8_t>(size >> 24)}) +
+         elements + bytes({0x00});
+}
+
+// returns the BSON element for the value in {"a": value}
+static std::string toBsonElement(Value const& value) {
+  Builder b;
+  b.openObject();
+  b.add("a", value);
+  b.close();
+  std::string const encoded = BsonDumper::toString(b.slice());
+  return encoded.substr(4, encoded.size() - 5);
+}
+
+// converts the JSON into VPack, the VPack into BSON and back, and checks
+// that the result dumps to the same JSON. The value is wrapped into an
+// Object, as BSON has no other top-level values
+static void checkRoundTrip(std::string const& json) {
+  std::shared_ptr<Builder> value = Parser::fromJson(json);
+  Builder original;
+  original.openObject();
+  original.add("value", value->slice());
+  original.close();
+
+  std::string const encoded = BsonDumper::toString(original.slice());
+  std::shared_ptr<Builder> decoded = BsonParser::fromBson(encoded);
+
+  ASSERT_EQ(Dumper::toString(original.slice()),
+            Dumper::toString(decoded->slice()));
+}
+
+TEST(BsonTest, DumpDocument) {
+  std::shared_ptr<Builder> b = Parser::fromJson("{\"hello\":\"world\"}");
+  ASSERT_EQ(bytes({0x16, 0x00, 0x00, 0x00, 0x02, 'h', 'e', 'l', 'l', 'o',
+                   0x00, 0x06, 0x00, 0x00, 0x00, 'w', 'o', 'r', 'l', 'd',
+                   0x00, 0x00}),
+            BsonDumper::toString(b->slice()));
+
+  b = Parser::fromJson("{}");
+  ASSERT_EQ(bytes({0x05, 0x00, 0x00, 0x00, 0x00}),
+            BsonDumper::toString(b->slice()));
+}
+
+TEST(BsonTest, DumpScalars) {
+  ASSERT_EQ(bytes({0x0a, 'a', 0x00}), toBsonElement(Value(ValueType::Null)));
+  ASSERT_EQ(bytes({0x08, 'a', 0x00, 0x00}), toBsonElement(Value(false)));
+  ASSERT_EQ(bytes({0x08, 'a', 0x00, 0x01}), toBsonElement(Value(true)));
+  ASSERT_EQ(bytes({0x01, 'a', 0x00, 0, 0, 0, 0, 0, 0, 0xf8, 0x3f}),
+            toBsonElement(Value(1.5)));
+  ASSERT_EQ(bytes({0x02, 'a', 0x00, 0x04, 0, 0, 0, 'f', 'o', 'o', 0x00}),
+            toBsonElement(Value("foo")));
+  ASSERT_EQ(bytes({0x05, 'a', 0x00, 0x02, 0, 0, 0, 0x00, 0x01, 0x02}),
+            toBsonElement(Value(std::string("\x01\x02"), ValueType::Binary)));
+  ASSERT_EQ(bytes({0x09, 'a', 0x00, 0xe8, 0x03, 0, 0, 0, 0, 0, 0}),
+            toBsonElement(Value(1000, ValueType::UTCDate)));
+  ASSERT_EQ(bytes({0x09, 'a', 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                   0xff}),
+            toBsonElement(Value(-1, ValueType::UTCDate)));
+  ASSERT_EQ(bytes({0xff, 'a', 0x00}), toBsonElement(Value(ValueType::MinKey)));
+  ASSERT_EQ(bytes({0x7f, 'a', 0x00}), toBsonElement(Value(ValueType::MaxKey)));
+}
+
+TEST(BsonTest, DumpIntegers) {
+  ASSERT_EQ(bytes({0x10, 'a', 0x00, 0, 0, 0, 0}), toBsonElement(Value(0)));
+  ASSERT_EQ(bytes({0x10, 'a', 0x00, 0xff, 0xff, 0xff, 0xff}),
+            toBsonElement(Value(-1)));
+  ASSERT_EQ(bytes({0x10, 'a', 0x00, 0xff, 0xff, 0xff, 0x7f}),
+            toBsonElement(Value(static_cast<int64_t>(INT32_MAX))));
+  ASSERT_EQ(bytes({0x10, 'a', 0x00, 0x00, 0x00, 0x00, 0x80}),
+            toBsonElement(Value(static_cast<int64_t>(INT32_MIN))));
+  ASSERT_EQ(bytes({0x12, 'a', 0x00, 0x00, 0x00, 0x00, 0x80, 0, 0, 0, 0}),
+            toBsonElement(Value(static_cast<int64_t>(INT32_MAX) + 1)));
+  ASSERT_EQ(bytes({0x12, 'a', 0x00, 0xff, 0xff, 0xff, 0x7f, 0xff, 0xff, 0xff,
+                   0xff}),
+            toBsonElement(Value(static_cast<int64_t>(INT32_MIN) - 1)));
+  ASSERT_EQ(bytes({0x10, 'a', 0x00, 0xff, 0xff, 0xff, 0x7f}),
+            toBsonElement(Value(static_cast<uint64_t>(INT32_MAX))));
+  ASSERT_EQ(bytes({0x12, 'a', 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                   0x7f}),
+            toBsonElement(Value(static_cast<uint64_t>(INT64_MAX))));
+  ASSERT_EQ(bytes({0x12, 'a', 0x00, 0, 0, 0, 0, 0, 0, 0, 0x80}),
+            toBsonElement(Value(INT64_MIN)));
+
+  ASSERT_VELOCYPACK_EXCEPTION(toBsonElement(Value(UINT64_MAX)),
+                              Exception::NumberOutOfRange);
+}
+
+TEST(BsonTest, DumpArrays) {
+  std::shared_ptr<Builder> b =
+      Parser::fromJson("[1,[true],0,0,0,0,0,0,0,0,null]");
+  std::string const encoded = BsonDumper::toString(b->slice());
+
+  std::string const expected = document(
+      bytes({0x10, '0', 0x00, 0x01, 0, 0, 0}) +
+      bytes({0x04, '1', 0x00}) + document(bytes({0x08, '0', 0x00, 0x01})) +
+      bytes({0x10, '2', 0x00, 0, 0, 0, 0, 0x10, '3', 0x00, 0, 0, 0, 0,
+             0x10, '4', 0x00, 0, 0, 0, 0, 0x10, '5', 0x00, 0, 0, 0, 0,
+             0x10, '6', 0x00, 0, 0, 0, 0, 0x10, '7', 0x00, 0, 0, 0, 0,
+             0x10, '8', 0x00, 0, 0, 0, 0, 0x10, '9', 0x00, 0, 0, 0, 0,
+             0x0a, '1', '0', 0x00}));
+  ASSERT_EQ(expected, encoded);
+}
+
+TEST(BsonTest, DumpInvalidDocuments) {
+  std::shared_ptr<Builder> b = Parser::fromJson("\"foo\"");
+  ASSERT_VELOCYPACK_EXCEPTION(BsonDumper::toString(b->slice()),
+                              Exception::InvalidValueType);
+
+  b = Parser::fromJson("{\"a\\u0000b\":1}");
+  ASSERT_VELOCYPACK_EXCEPTION(BsonDumper::toString(b->slice()),
+                              Exception::InvalidValueType);
+
+  // errors are detected before anything is written
+  b = Parser::fromJson("{\"a\":[1,2,{\"b\":18446744073709551615}]}");
+  std::string output;
+  StringSink sink(&output);
+  BsonDumper dumper(&sink);
+  ASSERT_VELOCYPACK_EXCEPTION(dumper.dump(b->slice()),
+                              Exception::NumberOutOfRange);
+  ASSERT_TRUE(output.empty());
+}
+
+TEST(BsonTest, DumpUnsupportedTypes) {
+  Builder b;
+  b.openObject();
+  b.add("a", Value(ValueType::Illegal));
+  b.close();
+
+  ASSERT_VELOCYPACK_EXCEPTION(BsonDumper::toString(b.slice()),
+                              Exception::InvalidValueType);
+
+  Options options;
+  options.unsupportedTypeBehavior = Options::NullifyUnsupportedType;
+  ASSERT_EQ(document(bytes({0x0a, 'a', 0x00})),
+            BsonDumper::toString(b.slice(), &options));
+
+  options.unsupportedTypeBehavior = Options::ConvertUnsupportedType;
+  std::string const expected("(non-representable type illegal)");
+  ASSERT_EQ(document(bytes({0x02, 'a', 0x00,
+                            static_cast<uint8_t>(expected.size() + 1), 0, 0,
+                            0}) +
+                     expected + bytes({0x00})),
+            BsonDumper::toString(b.slice(), &options));
+}
+
+TEST(BsonTest, DumpExternal) {
+  Builder inner;
+  inner.add(Value("foo"));
+
+  Builder b;
+  b.openArray();
+  b.add(Value(static_cast<void const*>(inner.slice().start()),
+              ValueType::External));
+  b.close();
+
+  Builder outer;
+  outer.add(Value(static_cast<void const*>(b.slice().start()),
+                  ValueType::External));
+
+  ASSERT_EQ(document(bytes({0x02, '0', 0x00, 0x04, 0, 0, 0, 'f', 'o', 'o',
+                            0x00})),
+            BsonDumper::toString(outer.slice()));
+}
+
+TEST(BsonTest, ParseTypes) {
+  std::string const data = document(
+      bytes({0x10, 'a', 0x00, 0xfe, 0xff, 0xff, 0xff}) +          // int32 -2
+      bytes({0x12, 'b', 0x00, 5, 0, 0, 0, 0, 0, 0, 0}) +          // int64 5
+      bytes({0x11, 'c', 0x00, 1, 0, 0, 0, 2, 0, 0, 0}) +          // timestamp
+      bytes({0x06, 'd', 0x00}) +                                  // undefined
+      bytes({0x07, 'e', 0x00, 0x50, 0x7f, 0x1f, 0x77, 0xbc, 0xf8,
+             0x6c, 0xd7, 0x99, 0x43, 0x90, 0x11}) +               // ObjectId
+      bytes({0x0e, 'f', 0x00, 2, 0, 0, 0, 'x', 0x00}) +           // symbol
+      bytes({0x0d, 'g', 0x00, 3, 0, 0, 0, 'f', '(', 0x00}) +      // code
+      bytes({0x04, 'h', 0x00}) +
+      document(bytes({0x01, '0', 0x00, 0, 0, 0, 0, 0, 0, 0xf8, 0x3f,
+                      0x08, '1', 0x00, 0x00})) +                  // array
+      bytes({0x03, 'i', 0x00}) + document(""));                   // {}
+
+  std::shared_ptr<Builder> b = BsonParser::fromBson(data);
+  ASSERT_EQ("{\"a\":-2,\"b\":5,\"c\":8589934593,\"d\":null,"
+            "\"e\":\"507f1f77bcf86cd799439011\",\"f\":\"x\",\"g\":\"f(\","
+            "\"h\":[1.5,false],\"i\":{}}",
+            Dumper::toString(b->slice()));
+  ASSERT_TRUE(b->slice().get("c").isUInt());
+}
+
+TEST(BsonTest, ParseNativeTypes) {
+  std::string const data = document(
+      bytes({0x09, 'a', 0x00, 0x18, 0xfc, 0xff, 0xff, 0xff, 0xff, 0xff,
+             0xff}) +                                              // -1000
+      bytes({0x05, 'b', 0x00, 0x02, 0, 0, 0, 0x80, 0x01, 0xff}) + // binary
+      bytes({0x05, 'c', 0x00, 0x06, 0, 0, 0, 0x02, 0x02, 0, 0, 0, 0x01,
+             0x02}) +                                              // old binary
+      bytes({0xff, 'd', 0x00, 0x7f, 'e', 0x00}));
+
+  std::shared_ptr<Builder> b = BsonParser::fromBson(data);
+  Slice s = b->slice();
+  ASSERT_TRUE(s.get("a").isUTCDate());
+  ASSERT_EQ(-1000, s.get("a").getUTCDate());
+  ASSERT_EQ((std::vector<uint8_t>{0x01, 0xff}), s.get("b").copyBinary());
+  ASSERT_EQ((std::vector<uint8_t>{0x01, 0x02}), s.get("c").copyBinary());
+  ASSERT_TRUE(s.get("d").isMinKey());
+  ASSERT_TRUE(s.get("e").isMaxKey());
+}
+
+TEST(BsonTest, ParseErrors) {
+  auto fails = [](std::string const& data) {
+    ASSERT_VELOCYPACK_EXCEPTION(BsonParser::fromBson(data),
+                                Exception::ParseError);
+  };
+
+  fails("");
+  fails(bytes({0x05, 0x00, 0x00}));
+  fails(bytes({0x04, 0x00, 0x00, 0x00, 0x00}));
+  fails(bytes({0x06, 0x00, 0x00, 0x00, 0x00}));
+  fails(bytes({0x05, 0x00, 0x00, 0x00, 0x01}));
+  fails(bytes({0xff, 0xff, 0xff, 0xff, 0x00}));
+  fails(document(bytes({0x0a, 'a'})));
+  fails(document(bytes({0x10, 'a', 0x00, 0x01})));
+  fails(document(bytes({0x08, 'a', 0x00, 0x02})));
+  fails(document(bytes({0x02, 'a', 0x00, 0x00, 0, 0, 0})));
+  fails(document(bytes({0x02, 'a', 0x00, 0x02, 0, 0, 0, 'x', 'y'})));
+  fails(document(bytes({0x02, 'a', 0x00, 0x10, 0, 0, 0, 'x', 0x00})));
+  fails(document(bytes({0x05, 'a', 0x00, 0x02, 0, 0, 0, 0x02, 0x00, 0x00})));
+  fails(document(bytes({0x13, 'a', 0x00})));
+  fails(document(bytes({0x0b, 'a', 0x00, 'x', 0x00, 0x00})));
+  // the embedded document exceeds its parent
+  fails(document(bytes({0x03, 'a', 0x00, 0x0a, 0, 0, 0, 0x0a, 'b', 0x00,
+                        0x00})));
+  fails(document("") + bytes({0x00}));
+
+  BsonParser parser;
+  try {
+    parser.parse(document(bytes({0x0a, 'a', 0x00, 0x13, 'b', 0x00})));
+    ASSERT_TRUE(false);
+  } catch (Exception const& ex) {
+    ASSERT_EQ(Exception::ParseError, ex.errorCode());
+    ASSERT_EQ(7UL, parser.errorPos());
+  }
+}
+
+TEST(BsonTest, ParseInvalidUtf8) {
+  std::string const data =
+      document(bytes({0x02, 'a', 0x00, 0x03, 0, 0, 0, 0xc3, 0x28, 0x00}));
+
+  ASSERT_EQ(2UL,
+            BsonParser::fromBson(data)->slice().get("a").getStringLength());
+
+  Options options;
+  options.validateUtf8Strings = true;
+  ASSERT_VELOCYPACK_EXCEPTION(BsonParser::fromBson(data, &options),
+                              Exception::InvalidUtf8Sequence);
+  ASSERT_VELOCYPACK_EXCEPTION(
+      BsonParser::fromBson(document(bytes({0x0a, 0xc3, 0x28, 0x00})),
+                           &options),
+      Exception::InvalidUtf8Sequence);
+}
+
+TEST(BsonTest, ParseMulti) {
+  std::string const data = document(bytes({0x10, 'a', 0x00, 1, 0, 0, 0})) +
+                           document("") +
+                           document(bytes({0x0a, 'b', 0x00}));
+
+  BsonParser parser;
+  ASSERT_EQ(3UL, parser.parse(data, true));
+
+  std::vector<std::string> values;
+  Slice s = parser.builder().slice();
+  for (std::size_t i = 0; i < 3; ++i) {
+    values.push_back(Dumper::toString(s));
+    s = Slice(s.start() + s.byteSize());
+  }
+  ASSERT_EQ((std::vector<std::string>{"{\"a\":1}", "{}", "{\"b\":null}"}),
+            values);
+
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse(data), Exception::ParseError);
+}
+
+TEST(BsonTest, ParseIntoOpenBuilder) {
+  Builder b;
+  b.openArray();
+  b.add(Value(1));
+
+  Options options;
+  options.clearBuilderBeforeParse = false;
+  BsonParser parser(b, &options);
+  parser.parse(document(bytes({0x02, 'x', 0x00, 2, 0, 0, 0, 'y', 0x00})));
+
+  b.add(Value(2));
+  b.close();
+
+  ASSERT_EQ("[1,{\"x\":\"y\"},2]", Dumper::toString(b.slice()));
+}
+
+TEST(BsonTest, RoundTripNativeTypes) {
+  Builder original;
+  original.openObject();
+  original.add("binary", Value(std::string("\x00\xff", 2), ValueType::Binary));
+  original.add("date", Value(INT64_MIN, ValueType::UTCDate));
+  original.add("max", Value(ValueType::MaxKey));
+  original.add("min", Value(ValueType::MinKey));
+  original.close();
+
+  std::shared_ptr<Builder> decoded =
+      BsonParser::fromBson(BsonDumper::toString(original.slice()));
+  ASSERT_TRUE(original.slice().binaryEquals(decoded->slice()));
+}
+
+TEST(BsonTest, RoundTripValues) {
+  checkRoundTrip("null");
+  checkRoundTrip("[]");
+  checkRoundTrip("{}");
+  checkRoundTrip("[1,-1,0,2147483647,2147483648,-2147483648,-2147483649,"
+                 "9223372036854775807,-9223372036854775808]");
+  checkRoundTrip("[1.5,-0.0,1e300,5e-324,0.1]");
+  checkRoundTrip("{\"a\":{\"b\":[{\"c\":\"d\"},[],{}]},\"\":\"\"}");
+  checkRoundTrip("\"a\\u0000b\"");
+}
+
+TEST(BsonTest, RoundTripSampleFiles) {
+  for (char const* file :
+       {"api-docs.json", "commits.json", "countries.json",
+        "directory-tree.json", "doubles-small.json", "file-list.json",
+        "object.json", "pass1.json", "pass2.json", "pass3.json",
+        "random1.json", "random2.json", "random3.json", "small.json"}) {
+    checkRoundTrip(readFile(file));
+  }
+
+  // sample.json has keys with NUL bytes, which BSON cannot store
+  std::shared_ptr<Builder> b = Parser::fromJson(readFile("sample.json"));
+  ASSERT_VELOCYPACK_EXCEPTION(BsonDumper::toString(b->slice()),
+                              Exception::InvalidValueType);
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -1138,6 +1138,197 @@ TEST(BuilderTest, ObjectSorted) {
   ASSERT_EQ(0, memcmp(result, correctResult, len));
 }
 
+TEST(BuilderTest, ObjectCloseSorted) {
+  Builder sorted;
+  sorted.openObject();
+  sorted.add("a", Value(true));
+  sorted.add("b", Value("abc"));
+  sorted.add("bb", Value(uint64_t(1200)));
+  sorted.add("c", Value(2.3));
+  sorted.closeSorted();
+
+  Builder b;
+  b.openObject();
+  b.add("c", Value(2.3));
+  b.add("bb", Value(uint64_t(1200)));
+  b.add("a", Value(true));
+  b.add("b", Value("abc"));
+  b.close();
+
+  // same index table, although the keys are stored in different orders
+  Slice s = sorted.slice();
+  ASSERT_EQ(b.size(), sorted.size());
+  ASSERT_EQ(4UL, s.length());
+  ASSERT_EQ("a", s.keyAt(0).copyString());
+  ASSERT_EQ("b", s.keyAt(1).copyString());
+  ASSERT_EQ("bb", s.keyAt(2).copyString());
+  ASSERT_EQ("c", s.keyAt(3).copyString());
+  ASSERT_EQ(1200UL, s.get("bb").getUInt());
+  ASSERT_TRUE(s.get("a").getBool());
+
+  // Arrays are closed as by close()
+  Builder array;
+  array.openArray();
+  array.add(Value(1));
+  array.add(Value(2));
+  array.closeSorted();
+  ASSERT_EQ("[1,2]", array.slice().toJson());
+}
+
+TEST(BuilderTest, Canonical) {
+  Options options;
+  options.buildCanonical = true;
+
+  Builder b(&options);
+  b.openArray(true);
+  b.add(Value(1.0));
+  b.add(Value(-0.0));
+  b.add(Value(100.0));
+  b.add(Value(-100.0));
+  b.add(Value(int64_t(100)));
+  b.add(Value(1.5));
+  b.add(Value(18446744073709551616.0));
+  b.add(Value(std::nan("1")));
+  b.close();
+
+  Slice s = b.slice();
+  ASSERT_EQ(0x06, s.head());
+  ASSERT_TRUE(s.at(0).isSmallInt());
+  ASSERT_EQ(1, s.at(0).getInt());
+  ASSERT_TRUE(s.at(1).isSmallInt());
+  ASSERT_EQ(0, s.at(1).getInt());
+  ASSERT_TRUE(s.at(2).isUInt());
+  ASSERT_EQ(100UL, s.at(2).getUInt());
+  ASSERT_TRUE(s.at(3).isInt());
+  ASSERT_EQ(-100, s.at(3).getInt());
+  ASSERT_TRUE(s.at(4).isUInt());
+  ASSERT_EQ(100UL, s.at(4).getUInt());
+  ASSERT_TRUE(s.at(5).isDouble());
+  ASSERT_TRUE(s.at(6).isDouble());
+  ASSERT_TRUE(s.at(7).isDouble());
+  ASSERT_TRUE(s.at(7).binaryEquals(
+      Builder::canonicalize(Builder::clone(s.at(7)).slice()).slice()));
+}
+
+TEST(BuilderTest, CanonicalObject) {
+  Options options;
+  options.buildCanonical = true;
+  options.buildUnindexedObjects = true;
+
+  Builder b(&options);
+  b.openObject();
+  b.add("c", Value(3));
+  b.add("bb", Value("x"));
+  b.add("a", Value(1));
+  b.add("b", Value(2));
+  b.close();
+
+  Builder expected(&options);
+  expected.openObject();
+  expected.add("a", Value(1));
+  expected.add("b", Value(2));
+  expected.add("bb", Value("x"));
+  expected.add("c", Value(3));
+  expected.close();
+
+  ASSERT_EQ(0x0b, b.slice().head());
+  ASSERT_EQ(expected.size(), b.size());
+  ASSERT_EQ(0, memcmp(expected.start(), b.start(), b.size()));
+  ASSERT_EQ("{\"a\":1,\"b\":2,\"bb\":\"x\",\"c\":3}", b.slice().toJson());
+  ASSERT_EQ(2, b.slice().get("b").getInt());
+
+  // members are stored in key order
+  ObjectIterator it(b.slice(), true);
+  ASSERT_EQ("a", it.key().copyString());
+
+  Builder dup(&options);
+  dup.openObject();
+  dup.add("a", Value(1));
+  dup.add("a", Value(2));
+  ASSERT_VELOCYPACK_EXCEPTION(dup.close(), Exception::DuplicateAttributeName);
+}
+
+TEST(BuilderTest, CanonicalNested) {
+  Options options;
+  options.buildCanonical = true;
+
+  Builder inner;
+  inner.openObject(true);
+  inner.add("z", Value(1.0));
+  inner.add("y", Value(int64_t(5000)));
+  inner.close();
+
+  Builder b(&options);
+  b.openObject();
+  b.add("q", inner.slice());
+  b.add("p", Value(static_cast<void const*>(inner.start()),
+                   ValueType::External));
+  b.close();
+
+  Slice s = b.slice();
+  ASSERT_TRUE(s.get("p").isObject());
+  ASSERT_TRUE(s.get("p").binaryEquals(s.get("q")));
+  ASSERT_EQ(0x0b, s.get("q").head());
+  ASSERT_TRUE(s.get("q").get("y").isUInt());
+  ASSERT_TRUE(s.get("q").get("z").isSmallInt());
+}
+
+TEST(BuilderTest, CanonicalAddExternal) {
+  Options options;
+  options.buildCanonical = true;
+
+  Builder value;
+  value.add(Value(int64_t(42)));
+
+  Builder b(&options);
+  b.openArray();
+  b.addExternal(value.start());
+  b.close();
+
+  Builder expected(&options);
+  expected.openArray();
+  expected.add(Value(42));
+  expected.close();
+
+  ASSERT_EQ(42UL, b.slice().at(0).getUInt());
+  ASSERT_TRUE(b.slice().binaryEquals(expected.slice()));
+
+  options.disallowExternals = true;
+  Builder disallowed(&options);
+  disallowed.openArray();
+  ASSERT_VELOCYPACK_EXCEPTION(disallowed.addExternal(value.start()),
+                              Exception::BuilderExternalsDisallowed);
+}
+
+TEST(BuilderTest, CanonicalIgnoresTranslator) {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+  translator->add("foo", 1);
+  translator->add("bar", 2);
+  translator->seal();
+
+  AttributeTranslatorScope scope(translator.get());
+
+  Options options;
+  options.attributeTranslator = translator.get();
+  Builder translated(&options);
+  translated.openObject();
+  translated.add("foo", Value(1));
+  translated.add("bar", Value(2));
+  translated.close();
+  ASSERT_TRUE(translated.slice().keyAt(0, false).isInteger());
+
+  options.buildCanonical = true;
+  Builder b(&options);
+  b.openObject();
+  b.add("foo", Value(1));
+  b.add("bar", Value(2));
+  b.close();
+  ASSERT_TRUE(b.slice().keyAt(0, false).isString());
+
+  Builder c = Builder::canonicalize(translated.slice());
+  ASSERT_TRUE(c.slice().binaryEquals(b.slice()));
+}
+
 TEST(BuilderTest, ObjectCompact) {
   double value = 2.3;
   Builder b;
@@ -24,6 +24,7 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <cmath>
 #include <set>
 #include <string>
 #include <unordered_set>
@@ -1692,6 +1693,80 @@ TEST(CollectionTest, MergeNullMeansRemoveRecursive) {
   ASSERT_FALSE(s.hasKey("baz"));
 }
 
+TEST(CollectionTest, MergeSortedAndUnsorted) {
+  // the sorted merge path must produce the same results as the
+  // hash-based path
+  std::string const l(
+      "{\"a\":1,\"c\":{\"x\":1,\"y\":{\"p\":1}},\"d\":null,\"f\":5,"
+      "\"h\":[1,2],\"zz\":\"left\"}");
+  std::string const r(
+      "{\"b\":2,\"c\":{\"y\":{\"q\":2},\"z\":null},\"d\":4,\"f\":null,"
+      "\"g\":null,\"h\":{\"k\":1},\"zzz\":\"right\"}");
+
+  Options compact;
+  compact.buildUnindexedObjects = true;
+
+  std::shared_ptr<Builder> sortedLeft = Parser::fromJson(l);
+  std::shared_ptr<Builder> sortedRight = Parser::fromJson(r);
+  std::shared_ptr<Builder> compactLeft = Parser::fromJson(l, &compact);
+  std::shared_ptr<Builder> compactRight = Parser::fromJson(r, &compact);
+  ASSERT_TRUE(sortedLeft->slice().isSorted());
+  ASSERT_TRUE(sortedRight->slice().isSorted());
+  ASSERT_FALSE(compactLeft->slice().isSorted());
+
+  for (bool mergeValues : { false, true }) {
+    for (bool nullMeansRemove : { false, true }) {
+      Builder expected = Collection::merge(compactLeft->slice(), compactRight->slice(),
+                                           mergeValues, nullMeansRemove);
+      Builder actual = Collection::merge(sortedLeft->slice(), sortedRight->slice(),
+                                         mergeValues, nullMeansRemove);
+      Builder mixed = Collection::merge(sortedLeft->slice(), compactRight->slice(),
+                                        mergeValues, nullMeansRemove);
+      ASSERT_EQ(expected.slice().toJson(), actual.slice().toJson());
+      ASSERT_EQ(expected.slice().toJson(), mixed.slice().toJson());
+    }
+  }
+
+  Builder b = Collection::merge(sortedLeft->slice(), sortedRight->slice(), true, true);
+  ASSERT_EQ(
+      "{\"a\":1,\"b\":2,\"c\":{\"x\":1,\"y\":{\"p\":1,\"q\":2}},\"d\":4,"
+      "\"h\":{\"k\":1},\"zz\":\"left\",\"zzz\":\"right\"}",
+      b.slice().toJson());
+}
+
+TEST(CollectionTest, MergeSortedLarge) {
+  Builder left;
+  left.openObject();
+  for (int i = 0; i < 1000; i += 2) {
+    left.add("key" + std::to_string(i), Value(i));
+  }
+  left.close();
+
+  Builder right;
+  right.openObject();
+  for (int i = 0; i < 1000; i += 3) {
+    right.add("key" + std::to_string(i), Value(-i));
+  }
+  right.close();
+
+  Builder b = Collection::merge(left.slice(), right.slice(), false);
+  Slice s = b.slice();
+  int expected = 0;
+  for (int i = 0; i < 1000; ++i) {
+    Slice v = s.get("key" + std::to_string(i));
+    if (i % 3 == 0) {
+      ASSERT_EQ(-i, v.getInt());
+      ++expected;
+    } else if (i % 2 == 0) {
+      ASSERT_EQ(i, v.getInt());
+      ++expected;
+    } else {
+      ASSERT_TRUE(v.isNone());
+    }
+  }
+  ASSERT_EQ(static_cast<ValueLength>(expected), s.length());
+}
+
 TEST(CollectionTest, VisitRecursiveNonCompound) {
   std::string const value("[1,null,true,\"foo\"]");
 
@@ -2066,6 +2141,542 @@ TEST(CollectionTest, VisitRecursiveObjectPostOrder) {
   ASSERT_EQ(7, seen);
 }
 
+TEST(CollectionTest, ObjectKeysStringRef) {
+  std::string const value(
+      "{\"1foo\":\"bar\",\"2baz\":\"quux\",\"3number\":1}");
+
+  Parser parser;
+  parser.parse(value);
+  Slice s(parser.start());
+
+  std::vector<StringRef> keys;
+  Collection::keys(s, keys);
+  ASSERT_EQ(3U, keys.size());
+  ASSERT_EQ("1foo", keys[0].toString());
+  ASSERT_EQ("2baz", keys[1].toString());
+  ASSERT_EQ("3number", keys[2].toString());
+  // keys point into the object
+  ASSERT_TRUE(keys[0].data() > reinterpret_cast<char const*>(s.start()));
+  ASSERT_TRUE(keys[0].data() < reinterpret_cast<char const*>(s.start() + s.byteSize()));
+
+  std::unordered_set<StringRef> set;
+  Collection::keys(s, set);
+  ASSERT_EQ(3U, set.size());
+  ASSERT_TRUE(set.find(StringRef("2baz")) != set.end());
+}
+
+struct CountingPredicate {
+  bool operator()(Slice const& slice, ValueLength) {
+    ++calls;
+    return slice.getUInt() % 2 == 0;
+  }
+  int calls = 0;
+};
+
+TEST(CollectionTest, TemplatedCallables) {
+  Builder b;
+  b.openArray();
+  for (uint64_t i = 1; i <= 10; ++i) {
+    b.add(Value(i));
+  }
+  b.close();
+  Slice s = b.slice();
+
+  uint64_t sum = 0;
+  Collection::forEach(s, [&sum](Slice const& value, ValueLength) {
+    sum += value.getUInt();
+    return true;
+  });
+  ASSERT_EQ(55ULL, sum);
+
+  CountingPredicate even;
+  Builder filtered = Collection::filter(s, even);
+  ASSERT_EQ(10, even.calls);
+  ASSERT_EQ("[2,4,6,8,10]", filtered.slice().toJson());
+
+  ASSERT_EQ(6ULL, Collection::find(&s, [](Slice const& value, ValueLength index) {
+    return index > 4 && value.getUInt() > 5;
+  }).getUInt());
+  ASSERT_TRUE(Collection::contains(s, [](Slice const& value, ValueLength) {
+    return value.getUInt() == 10;
+  }));
+  ASSERT_TRUE(Collection::all(s, [](Slice const& value, ValueLength) {
+    return value.getUInt() > 0;
+  }));
+  ASSERT_FALSE(Collection::any(s, [](Slice const& value, ValueLength) {
+    return value.getUInt() > 10;
+  }));
+
+  // std::function arguments still use the non-template overloads
+  Collection::Predicate predicate = [](Slice const& value, ValueLength) {
+    return value.getUInt() == 3;
+  };
+  ASSERT_EQ(3ULL, Collection::find(s, predicate).getUInt());
+  ASSERT_TRUE(Collection::contains(s, predicate));
+
+  // Slice arguments are not mistaken for predicates
+  Slice needle = s.at(4);
+  ASSERT_TRUE(Collection::contains(s, needle));
+}
+
+TEST(CollectionTest, VisitRecursiveTemplated) {
+  std::string const value("{\"a\":[1,{\"b\":2}],\"c\":3}");
+  Parser parser;
+  parser.parse(value);
+  Slice s(parser.start());
+
+  std::vector<std::string> seen;
+  Collection::visitRecursive(s, Collection::PreOrder,
+                             [&seen](Slice const& key, Slice const& value) {
+    if (key.isString()) {
+      seen.emplace_back(key.copyString());
+    } else if (value.isNumber()) {
+      seen.emplace_back(std::to_string(value.getUInt()));
+    }
+    return true;
+  });
+
+  std::vector<std::string> expected{"1", "b", "a", "c"};
+  ASSERT_EQ(expected, seen);
+}
+
+TEST(CollectionTest, UniqueNonArray) {
+  Builder b;
+  b.add(Value("foo"));
+
+  ASSERT_VELOCYPACK_EXCEPTION(Collection::unique(b.slice()), Exception::InvalidValueType);
+  ASSERT_VELOCYPACK_EXCEPTION(Collection::setUnion(b.slice(), b.slice()), Exception::InvalidValueType);
+  ASSERT_VELOCYPACK_EXCEPTION(Collection::setIntersection(b.slice(), b.slice()), Exception::InvalidValueType);
+  ASSERT_VELOCYPACK_EXCEPTION(Collection::setDifference(b.slice(), b.slice()), Exception::InvalidValueType);
+}
+
+TEST(CollectionTest, Unique) {
+  std::shared_ptr<Builder> p = Parser::fromJson(
+      "[1,\"a\",2,1.0,null,\"a\",[1,2],{\"x\":1},[1,2.0],null,{\"x\":1.0},3,2]");
+
+  Builder b = Collection::unique(p->slice());
+  ASSERT_EQ("[1,\"a\",2,null,[1,2],{\"x\":1},3]", b.slice().toJson());
+
+  std::shared_ptr<Builder> empty = Parser::fromJson("[]");
+  ASSERT_EQ("[]", Collection::unique(empty->slice()).slice().toJson());
+}
+
+TEST(CollectionTest, UniqueLarge) {
+  Builder input;
+  input.openArray();
+  for (int i = 0; i < 100000; ++i) {
+    input.add(Value("id" + std::to_string((i * 7) % 1000)));
+  }
+  input.close();
+
+  Builder b = Collection::unique(input.slice());
+  Slice s = b.slice();
+  ASSERT_EQ(1000ULL, s.length());
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ("id" + std::to_string((i * 7) % 1000), s.at(i).copyString());
+  }
+}
+
+TEST(CollectionTest, SetOperations) {
+  std::shared_ptr<Builder> left = Parser::fromJson("[5,1,\"x\",3,1,[1],2]");
+  std::shared_ptr<Builder> right = Parser::fromJson("[2,4,[1.0],2,\"y\",1.0]");
+
+  ASSERT_EQ("[5,1,\"x\",3,[1],2,4,\"y\"]",
+            Collection::setUnion(left->slice(), right->slice()).slice().toJson());
+  ASSERT_EQ("[1,[1],2]",
+            Collection::setIntersection(left->slice(), right->slice()).slice().toJson());
+  ASSERT_EQ("[5,\"x\",3]",
+            Collection::setDifference(left->slice(), right->slice()).slice().toJson());
+  ASSERT_EQ("[4,\"y\"]",
+            Collection::setDifference(right->slice(), left->slice()).slice().toJson());
+}
+
+TEST(CollectionTest, SetOperationsDatesAndBinaries) {
+  Builder left;
+  left.openArray();
+  left.add(Value(5, ValueType::UTCDate));
+  left.add(ValuePair("ab", 2, ValueType::Binary));
+  left.add(Value(5, ValueType::UTCDate));
+  left.add(Value(6, ValueType::UTCDate));
+  left.add(ValuePair("ab", 2, ValueType::Binary));
+  left.add(Value(5));
+  left.close();
+
+  Builder right;
+  right.openArray();
+  right.add(ValuePair("ab", 2, ValueType::Binary));
+  right.add(Value(5, ValueType::UTCDate));
+  right.add(ValuePair("cd", 2, ValueType::Binary));
+  right.close();
+
+  Builder b = Collection::unique(left.slice());
+  ASSERT_EQ(4ULL, b.slice().length());
+  ASSERT_EQ(5, b.slice().at(0).getUTCDate());
+  ASSERT_TRUE(b.slice().at(1).binaryEquals(right.slice().at(0)));
+  ASSERT_EQ(6, b.slice().at(2).getUTCDate());
+  ASSERT_EQ(5, b.slice().at(3).getInt());
+
+  b = Collection::setUnion(left.slice(), right.slice());
+  ASSERT_EQ(5ULL, b.slice().length());
+  ASSERT_TRUE(b.slice().at(4).binaryEquals(right.slice().at(2)));
+
+  b = Collection::setIntersection(left.slice(), right.slice());
+  ASSERT_EQ(2ULL, b.slice().length());
+  ASSERT_EQ(5, b.slice().at(0).getUTCDate());
+  ASSERT_TRUE(b.slice().at(1).binaryEquals(right.slice().at(0)));
+
+  b = Collection::setDifference(left.slice(), right.slice());
+  ASSERT_EQ(2ULL, b.slice().length());
+  ASSERT_EQ(6, b.slice().at(0).getUTCDate());
+  ASSERT_EQ(5, b.slice().at(1).getInt());
+}
+
+TEST(CollectionTest, SetOperationsIntoBuilder) {
+  std::shared_ptr<Builder> left = Parser::fromJson("[1,2,3]");
+  std::shared_ptr<Builder> right = Parser::fromJson("[3,4]");
+
+  Builder b;
+  b.openObject();
+  b.add(Value("union"));
+  Collection::setUnion(b, left->slice(), right->slice());
+  b.add(Value("intersection"));
+  Collection::setIntersection(b, left->slice(), right->slice());
+  b.close();
+
+  ASSERT_EQ("{\"intersection\":[3],\"union\":[1,2,3,4]}", b.slice().toJson());
+}
+
+static NumericAggregate referenceAggregate(Slice array) {
+  NumericAggregate result;
+  for (auto const& it : ArrayIterator(array)) {
+    if (!it.isNumber()) {
+      continue;
+    }
+    double v = it.getNumber<double>();
+    if (result.count == 0 || v < result.min) {
+      result.min = v;
+    }
+    if (result.count == 0 || v > result.max) {
+      result.max = v;
+    }
+    result.sum += v;
+    ++result.count;
+  }
+  return result;
+}
+
+static void checkAggregate(Slice array) {
+  NumericAggregate expected = referenceAggregate(array);
+  NumericAggregate actual = Collection::aggregate(array);
+  ASSERT_EQ(expected.count, actual.count);
+  ASSERT_DOUBLE_EQ(expected.sum, actual.sum);
+  ASSERT_DOUBLE_EQ(expected.min, actual.min);
+  ASSERT_DOUBLE_EQ(expected.max, actual.max);
+  ASSERT_DOUBLE_EQ(expected.average(), actual.average());
+}
+
+TEST(CollectionTest, AggregateNonArray) {
+  Builder b;
+  b.add(Value("foo"));
+
+  ASSERT_VELOCYPACK_EXCEPTION(Collection::aggregate(b.slice()), Exception::InvalidValueType);
+}
+
+TEST(CollectionTest, AggregateEmpty) {
+  std::shared_ptr<Builder> p = Parser::fromJson("[]");
+  NumericAggregate result = Collection::aggregate(p->slice());
+  ASSERT_EQ(0ULL, result.count);
+  ASSERT_EQ(0.0, result.sum);
+  ASSERT_TRUE(std::isnan(result.min));
+  ASSERT_TRUE(std::isnan(result.max));
+  ASSERT_TRUE(std::isnan(result.average()));
+
+  p = Parser::fromJson("[\"a\",null,true]");
+  result = Collection::aggregate(p->slice());
+  ASSERT_EQ(0ULL, result.count);
+}
+
+TEST(CollectionTest, AggregateSmallInts) {
+  for (int n : { 1, 15, 16, 17, 100, 1000 }) {
+    Builder b;
+    b.openArray();
+    for (int i = 0; i < n; ++i) {
+      b.add(Value((i * 7) % 16 - 6));
+    }
+    b.close();
+    ASSERT_TRUE(b.slice().head() >= 0x02 && b.slice().head() <= 0x05);
+    checkAggregate(b.slice());
+  }
+
+  std::shared_ptr<Builder> p = Parser::fromJson("[-6,-6,-6]");
+  NumericAggregate result = Collection::aggregate(p->slice());
+  ASSERT_EQ(3ULL, result.count);
+  ASSERT_EQ(-18.0, result.sum);
+  ASSERT_EQ(-6.0, result.min);
+  ASSERT_EQ(-6.0, result.max);
+  ASSERT_EQ(-6.0, result.average());
+}
+
+TEST(CollectionTest, AggregateDoubles) {
+  for (int n : { 1, 2, 3, 101 }) {
+    Builder b;
+    b.openArray();
+    for (int i = 0; i < n; ++i) {
+      b.add(Value((i % 2 == 0 ? -1.0 : 1.0) * i * 1.25));
+    }
+    b.close();
+    checkAggregate(b.slice());
+  }
+}
+
+TEST(CollectionTest, AggregateNaN) {
+  Options options;
+  for (bool compact : {false, true}) {
+    options.buildUnindexedArrays = compact;
+    for (ValueLength n : { 1, 2, 3, 4, 101 }) {
+      for (ValueLength position : { ValueLength(0), n / 2, n - 1 }) {
+        Builder b(&options);
+        b.openArray();
+        for (ValueLength i = 0; i < n; ++i) {
+          if (i == position) {
+            b.add(Value(std::numeric_limits<double>::quiet_NaN()));
+          } else {
+            b.add(Value(1.5 * static_cast<double>(i)));
+          }
+        }
+        b.close();
+
+        NumericAggregate result = Collection::aggregate(b.slice());
+        ASSERT_EQ(n, result.count);
+        ASSERT_TRUE(std::isnan(result.sum));
+        ASSERT_TRUE(std::isnan(result.min));
+        ASSERT_TRUE(std::isnan(result.max));
+      }
+    }
+  }
+
+  // members of mixed types take the generic path
+  for (int position = 0; position < 3; ++position) {
+    Builder b;
+    b.openArray();
+    for (int i = 0; i < 3; ++i) {
+      if (i == position) {
+        b.add(Value(std::numeric_limits<double>::quiet_NaN()));
+      } else {
+        b.add(Value(i));
+      }
+    }
+    b.close();
+
+    NumericAggregate result = Collection::aggregate(b.slice());
+    ASSERT_EQ(3ULL, result.count);
+    ASSERT_TRUE(std::isnan(result.min));
+    ASSERT_TRUE(std::isnan(result.max));
+  }
+}
+
+TEST(CollectionTest, AggregateIntegers) {
+  // signed and unsigned integers of all byte lengths
+  int64_t const bases[] = { 100, 1000, 100000, 10000000, 1000000000, 100000000000LL,
+                            10000000000000LL, 1000000000000000LL };
+  for (int64_t base : bases) {
+    Builder b;
+    b.openArray();
+    for (int i = 0; i < 20; ++i) {
+      b.add(Value(-base - i));
+    }
+    b.close();
+    ASSERT_TRUE(b.slice().head() >= 0x02 && b.slice().head() <= 0x05);
+    checkAggregate(b.slice());
+
+    Builder u;
+    u.openArray();
+    for (int i = 0; i < 20; ++i) {
+      u.add(Value(static_cast<uint64_t>(base + i)));
+    }
+    u.close();
+    ASSERT_TRUE(u.slice().head() >= 0x02 && u.slice().head() <= 0x05);
+    checkAggregate(u.slice());
+  }
+
+  Builder b;
+  b.openArray();
+  b.add(Value(UINT64_MAX));
+  b.add(Value(UINT64_MAX - 1));
+  b.close();
+  checkAggregate(b.slice());
+}
+
+TEST(CollectionTest, AggregateMixed) {
+  // equally sized members of different types
+  Builder b;
+  b.openArray();
+  for (int i = 0; i < 20; ++i) {
+    if (i % 3 == 0) {
+      b.add(Value(INT64_MIN + i));
+    } else if (i % 3 == 1) {
+      b.add(Value(i + 0.5));
+    } else {
+      b.add(Value(static_cast<uint64_t>(UINT64_MAX - i)));
+    }
+  }
+  b.close();
+  ASSERT_TRUE(b.slice().head() >= 0x02 && b.slice().head() <= 0x05);
+  checkAggregate(b.slice());
+
+  std::shared_ptr<Builder> p = Parser::fromJson("[1,2.5,\"foo\",null,-1000,[1],100000000000]");
+  checkAggregate(p->slice());
+
+  Options options;
+  options.buildUnindexedArrays = true;
+  p = Parser::fromJson("[1,2.5,\"foo\",null,-1000,[1],100000000000]", &options);
+  ASSERT_EQ(0x13, p->slice().head());
+  checkAggregate(p->slice());
+
+  // single-byte members that are not all SmallInts
+  p = Parser::fromJson("[1,2,null,3,true]");
+  ASSERT_EQ(0x02, p->slice().head());
+  checkAggregate(p->slice());
+}
+
+TEST(CollectionTest, GroupByNonArray) {
+  std::shared_ptr<Builder> p = Parser::fromJson("{\"a\":1}");
+  ASSERT_VELOCYPACK_EXCEPTION(Collection::groupBy(p->slice(), CompiledPath("a"), {}),
+                              Exception::InvalidValueType);
+}
+
+TEST(CollectionTest, GroupByEmpty) {
+  Builder b = Collection::groupBy(Slice::emptyArraySlice(), CompiledPath("a"),
+                                  {GroupAggregation("count", GroupAggregation::Count)});
+  ASSERT_EQ("[]", b.slice().toJson());
+}
+
+TEST(CollectionTest, GroupByAggregations) {
+  std::shared_ptr<Builder> p = Parser::fromJson(
+      "[{\"city\":\"Cologne\",\"price\":10,\"item\":\"a\"},"
+      "{\"city\":\"Berlin\",\"price\":2.5,\"item\":\"b\"},"
+      "{\"city\":\"Cologne\",\"price\":-4,\"item\":\"c\"},"
+      "{\"price\":7},"
+      "{\"city\":\"Berlin\",\"price\":\"n/a\",\"item\":null},"
+      "{\"city\":null,\"price\":1,\"item\":\"d\"}]");
+
+  Builder b = Collection::groupBy(p->slice(), CompiledPath("city"), {
+      GroupAggregation("count", GroupAggregation::Count),
+      GroupAggregation("items", GroupAggregation::Count, CompiledPath("item")),
+      GroupAggregation("sum", GroupAggregation::Sum, CompiledPath("price")),
+      GroupAggregation("min", GroupAggregation::Min, CompiledPath("price")),
+      GroupAggregation("max", GroupAggregation::Max, CompiledPath("price")),
+      GroupAggregation("all", GroupAggregation::Collect, CompiledPath("item"))});
+
+  Slice s = b.slice();
+  ASSERT_TRUE(s.isArray());
+  ASSERT_EQ(3UL, s.length());
+
+  // groups are in the order of first appearance
+  Slice g = s.at(0);
+  ASSERT_EQ("Cologne", g.get("key").copyString());
+  ASSERT_EQ(2UL, g.get("count").getUInt());
+  ASSERT_EQ(2UL, g.get("items").getUInt());
+  ASSERT_DOUBLE_EQ(6.0, g.get("sum").getNumber<double>());
+  ASSERT_DOUBLE_EQ(-4.0, g.get("min").getNumber<double>());
+  ASSERT_DOUBLE_EQ(10.0, g.get("max").getNumber<double>());
+  ASSERT_EQ("[\"a\",\"c\"]", g.get("all").toJson());
+
+  g = s.at(1);
+  ASSERT_EQ("Berlin", g.get("key").copyString());
+  ASSERT_EQ(2UL, g.get("count").getUInt());
+  ASSERT_EQ(1UL, g.get("items").getUInt());
+  ASSERT_DOUBLE_EQ(2.5, g.get("sum").getNumber<double>());
+  ASSERT_DOUBLE_EQ(2.5, g.get("min").getNumber<double>());
+  ASSERT_DOUBLE_EQ(2.5, g.get("max").getNumber<double>());
+  ASSERT_EQ("[\"b\",null]", g.get("all").toJson());
+
+  // missing keys and null keys form one group
+  g = s.at(2);
+  ASSERT_TRUE(g.get("key").isNull());
+  ASSERT_EQ(2UL, g.get("count").getUInt());
+  ASSERT_EQ(1UL, g.get("items").getUInt());
+  ASSERT_DOUBLE_EQ(8.0, g.get("sum").getNumber<double>());
+  ASSERT_EQ("[\"d\"]", g.get("all").toJson());
+}
+
+TEST(CollectionTest, GroupByNormalizedKeys) {
+  std::shared_ptr<Builder> p = Parser::fromJson(
+      "[{\"k\":1,\"v\":\"x\"},{\"k\":1.0,\"v\":\"y\"},{\"k\":[1,2]},{\"k\":\"1\"},{\"k\":[1,2]},{\"v\":\"z\"}]");
+
+  Builder b = Collection::groupBy(p->slice(), CompiledPath("k"), {
+      GroupAggregation("n", GroupAggregation::Count),
+      GroupAggregation("min", GroupAggregation::Min, CompiledPath("nope"))}, "group");
+  ASSERT_EQ("[{\"group\":1,\"min\":null,\"n\":2},{\"group\":[1,2],\"min\":null,\"n\":2},"
+            "{\"group\":\"1\",\"min\":null,\"n\":1},{\"group\":null,\"min\":null,\"n\":1}]",
+            b.slice().toJson());
+}
+
+TEST(CollectionTest, GroupByDateKeys) {
+  Builder input;
+  input.openArray();
+  for (int i = 0; i < 30; ++i) {
+    input.openObject();
+    input.add("day", Value(1500000000000 + (i % 3) * 86400000, ValueType::UTCDate));
+    input.add("v", Value(i));
+    input.close();
+  }
+  input.close();
+
+  Builder b = Collection::groupBy(input.slice(), CompiledPath("day"), {
+      GroupAggregation("n", GroupAggregation::Count),
+      GroupAggregation("sum", GroupAggregation::Sum, CompiledPath("v"))});
+  Slice s = b.slice();
+  ASSERT_EQ(3UL, s.length());
+  for (int i = 0; i < 3; ++i) {
+    Slice g = s.at(i);
+    ASSERT_TRUE(g.get("key").isUTCDate());
+    ASSERT_EQ(1500000000000 + i * 86400000, g.get("key").getUTCDate());
+    ASSERT_EQ(10UL, g.get("n").getUInt());
+    ASSERT_DOUBLE_EQ(135.0 + i * 10, g.get("sum").getNumber<double>());
+  }
+}
+
+TEST(CollectionTest, GroupByManyGroups) {
+  Builder input;
+  input.openArray();
+  for (int i = 0; i < 10000; ++i) {
+    input.openObject();
+    input.add("group", Value("g" + std::to_string(i % 997)));
+    input.add("value", Value(i));
+    input.close();
+  }
+  input.close();
+
+  Builder out;
+  out.openObject();
+  out.add(Value("groups"));
+  Collection::groupBy(out, input.slice(), CompiledPath("group"), {
+      GroupAggregation("count", GroupAggregation::Count),
+      GroupAggregation("sum", GroupAggregation::Sum, CompiledPath("value")),
+      GroupAggregation("values", GroupAggregation::Collect, CompiledPath("value"))});
+  out.close();
+
+  Slice groups = out.slice().get("groups");
+  ASSERT_EQ(997UL, groups.length());
+  ValueLength total = 0;
+  for (int g = 0; g < 997; ++g) {
+    Slice group = groups.at(g);
+    ASSERT_EQ("g" + std::to_string(g), group.get("key").copyString());
+    ValueLength count = group.get("count").getUInt();
+    total += count;
+    Slice values = group.get("values");
+    ASSERT_EQ(count, values.length());
+    double sum = 0.0;
+    for (ValueLength i = 0; i < count; ++i) {
+      ASSERT_EQ(g + 997 * static_cast<int>(i), values.at(i).getInt());
+      sum += values.at(i).getInt();
+    }
+    ASSERT_DOUBLE_EQ(sum, group.get("sum").getNumber<double>());
+  }
+  ASSERT_EQ(10000UL, total);
+}
+
 static bool lt(Slice const a, Slice const b) {
   if (! a.isInteger() || ! b.isInteger()) {
     return false;
@@ -2099,6 +2710,186 @@ TEST(CollectionTest, SortNonArray) {
   ASSERT_VELOCYPACK_EXCEPTION(Collection::sort(b.slice(), &lt), Exception::InvalidValueType);
 }
 
+TEST(CollectionTest, SortByNonArray) {
+  Builder b;
+  b.add(Value("foo"));
+
+  ASSERT_VELOCYPACK_EXCEPTION(Collection::sortBy(b.slice(), CompiledPath("a")), Exception::InvalidValueType);
+}
+
+TEST(CollectionTest, SortByExtractedKey) {
+  std::shared_ptr<Builder> p = Parser::fromJson("[\"ccc\",\"a\",\"bb\",\"dddd\",\"\"]");
+  auto length = [](Slice const& value) { return value.getStringLength(); };
+
+  ASSERT_EQ("[\"\",\"a\",\"bb\",\"ccc\",\"dddd\"]",
+            Collection::sortBy(p->slice(), length).slice().toJson());
+
+  SortOptions options;
+  options.descending = true;
+  ASSERT_EQ("[\"dddd\",\"ccc\",\"bb\",\"a\",\"\"]",
+            Collection::sortBy(p->slice(), length, options).slice().toJson());
+
+  options.limit = 2;
+  ASSERT_EQ("[\"dddd\",\"ccc\"]",
+            Collection::sortBy(p->slice(), length, options).slice().toJson());
+
+  // custom comparator
+  ASSERT_EQ("[\"dddd\",\"ccc\",\"bb\",\"a\",\"\"]",
+            Collection::sortBy(p->slice(), length, std::greater<ValueLength>()).slice().toJson());
+}
+
+TEST(CollectionTest, SortByStable) {
+  std::shared_ptr<Builder> p = Parser::fromJson(
+      "[{\"k\":2,\"v\":0},{\"k\":1,\"v\":1},{\"k\":2,\"v\":2},{\"k\":1,\"v\":3},"
+      "{\"k\":2,\"v\":4},{\"k\":1,\"v\":5}]");
+  CompiledPath value("v");
+
+  SortOptions options;
+  options.stable = true;
+  Builder b = Collection::sortBy(p->slice(), CompiledPath("k"), options);
+  std::vector<int64_t> order;
+  for (auto const& it : ArrayIterator(b.slice())) {
+    order.push_back(value.get(it).getInt());
+  }
+  ASSERT_EQ(std::vector<int64_t>({1, 3, 5, 0, 2, 4}), order);
+
+  options.descending = true;
+  b = Collection::sortBy(p->slice(), CompiledPath("k"), options);
+  order.clear();
+  for (auto const& it : ArrayIterator(b.slice())) {
+    order.push_back(value.get(it).getInt());
+  }
+  ASSERT_EQ(std::vector<int64_t>({0, 2, 4, 1, 3, 5}), order);
+
+  // stable top-k
+  options.limit = 4;
+  b = Collection::sortBy(p->slice(), CompiledPath("k"), options);
+  order.clear();
+  for (auto const& it : ArrayIterator(b.slice())) {
+    order.push_back(value.get(it).getInt());
+  }
+  ASSERT_EQ(std::vector<int64_t>({0, 2, 4, 1}), order);
+}
+
+TEST(CollectionTest, SortByPathMixedTypes) {
+  std::shared_ptr<Builder> p = Parser::fromJson(
+      "[{\"a\":{\"b\":\"x\"}},{\"a\":{\"b\":2.5}},{\"a\":{\"b\":[1]}},{\"a\":1},"
+      "{\"a\":{\"b\":true}},{\"a\":{\"b\":-3}},{\"a\":{\"b\":{}}},{\"a\":{\"b\":\"abc\"}},"
+      "{\"a\":{\"b\":false}},{\"a\":{\"b\":10}}]");
+
+  SortOptions options;
+  options.stable = true;
+  Builder b = Collection::sortBy(p->slice(), CompiledPath("a.b"), options);
+
+  std::vector<std::string> sorted;
+  CompiledPath path("a.b");
+  for (auto const& it : ArrayIterator(b.slice())) {
+    Slice v = path.get(it);
+    sorted.push_back(v.isNone() ? "missing" : v.toJson());
+  }
+  ASSERT_EQ(std::vector<std::string>({"missing", "false", "true", "-3", "2.5", "10",
+                                      "\"abc\"", "\"x\"", "[1]", "{}"}),
+            sorted);
+}
+
+TEST(CollectionTest, SortByPathNaN) {
+  Builder input;
+  input.openArray();
+  for (int i = 0; i < 100; ++i) {
+    input.openObject();
+    input.add("k", Value(i % 7 == 3 ? std::nan("1") : static_cast<double>((i * 37) % 50)));
+    input.add("i", Value(i));
+    input.close();
+  }
+  input.close();
+
+  for (bool descending : {false, true}) {
+    SortOptions options;
+    options.descending = descending;
+    Builder b = Collection::sortBy(input.slice(), CompiledPath("k"), options);
+    ASSERT_EQ(100UL, b.slice().length());
+
+    // NaN is ordered after all other numbers
+    std::size_t nans = 0;
+    double last = descending ? 1000.0 : -1.0;
+    for (auto const& it : ArrayIterator(b.slice())) {
+      double k = it.get("k").getDouble();
+      if (std::isnan(k)) {
+        ++nans;
+        continue;
+      }
+      if (descending) {
+        ASSERT_EQ(14UL, nans);
+        ASSERT_LE(k, last);
+      } else {
+        ASSERT_EQ(0UL, nans);
+        ASSERT_GE(k, last);
+      }
+      last = k;
+    }
+    ASSERT_EQ(14UL, nans);
+  }
+}
+
+TEST(CollectionTest, SortByParallel) {
+  Builder input;
+  input.openArray();
+  uint64_t x = 12345;
+  for (int i = 0; i < 10000; ++i) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    input.openObject();
+    input.add("k", Value((x >> 33) % 500));
+    input.add("i", Value(i));
+    input.close();
+  }
+  input.close();
+
+  CompiledPath key("k");
+  SortOptions options;
+  options.stable = true;
+  Builder expected = Collection::sortBy(input.slice(), key, options);
+
+  for (unsigned threads : { 2, 3, 4, 7 }) {
+    options.threads = threads;
+    options.parallelThreshold = 100;
+    Builder actual = Collection::sortBy(input.slice(), key, options);
+    ASSERT_TRUE(expected.slice().binaryEquals(actual.slice()));
+  }
+
+  // check the order
+  int64_t lastKey = -1;
+  int64_t lastIndex = -1;
+  for (auto const& it : ArrayIterator(expected.slice())) {
+    int64_t k = it.get("k").getInt();
+    int64_t i = it.get("i").getInt();
+    ASSERT_TRUE(k > lastKey || (k == lastKey && i > lastIndex));
+    lastKey = k;
+    lastIndex = i;
+  }
+}
+
+TEST(CollectionTest, SortByParallelException) {
+  Builder input;
+  input.openArray();
+  for (int i = 0; i < 1000; ++i) {
+    input.add(Value(i));
+  }
+  input.close();
+
+  SortOptions options;
+  options.threads = 4;
+  options.parallelThreshold = 10;
+  auto throwingLess = [](int64_t a, int64_t b) -> bool {
+    if (a == 999 || b == 999) {
+      throw Exception(Exception::InternalError);
+    }
+    return a < b;
+  };
+  auto extract = [](Slice const& value) { return value.getInt(); };
+  ASSERT_VELOCYPACK_EXCEPTION(Collection::sortBy(input.slice(), extract, throwingLess, options),
+                              Exception::InternalError);
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -0,0 +1,259 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <string>
+
+#include "tests-common.h"
+
+static Builder parseJson(std::string const& json, Options const* options = &Options::Defaults) {
+  Parser parser(options);
+  parser.parse(json);
+  return *parser.steal();
+}
+
+TEST(ColumnDecoderTest, NoArray) {
+  Builder b = parseJson("{\"foo\":1}");
+
+  DoubleColumn column;
+  ASSERT_VELOCYPACK_EXCEPTION(ColumnDecoder::decode(b.slice(), column), Exception::InvalidValueType);
+  ASSERT_VELOCYPACK_EXCEPTION(ColumnDecoder::decode(b.slice(), StringRef("foo"), column), Exception::InvalidValueType);
+}
+
+TEST(ColumnDecoderTest, EmptyArray) {
+  Builder b = parseJson("[]");
+
+  IntColumn column;
+  ColumnDecoder::decode(b.slice(), column);
+  ASSERT_TRUE(column.empty());
+  ASSERT_EQ(0UL, column.nullCount);
+}
+
+TEST(ColumnDecoderTest, Doubles) {
+  Builder b = parseJson("[1.5,-2.25,3,null,\"foo\",-7,1000000,true,4.75]");
+
+  DoubleColumn column;
+  ColumnDecoder::decode(b.slice(), column);
+  ASSERT_EQ(9UL, column.size());
+  ASSERT_EQ(9UL, column.nulls.size());
+  ASSERT_EQ(3UL, column.nullCount);
+
+  ASSERT_DOUBLE_EQ(1.5, column.values[0]);
+  ASSERT_DOUBLE_EQ(-2.25, column.values[1]);
+  ASSERT_DOUBLE_EQ(3.0, column.values[2]);
+  ASSERT_TRUE(column.isNull(3));
+  ASSERT_TRUE(column.isNull(4));
+  ASSERT_DOUBLE_EQ(-7.0, column.values[5]);
+  ASSERT_DOUBLE_EQ(1000000.0, column.values[6]);
+  ASSERT_TRUE(column.isNull(7));
+  ASSERT_DOUBLE_EQ(4.75, column.values[8]);
+  ASSERT_FALSE(column.isNull(8));
+}
+
+TEST(ColumnDecoderTest, FixedWidthDoubles) {
+  Builder b;
+  b.openArray();
+  for (int i = 0; i < 100; ++i) {
+    if (i == 50) {
+      // same byte size as a Double
+      b.add(Value(INT64_MIN));
+    } else {
+      b.add(Value(i + 0.5));
+    }
+  }
+  b.close();
+  ASSERT_TRUE(b.slice().head() >= 0x02 && b.slice().head() <= 0x05);
+
+  DoubleColumn column;
+  ColumnDecoder::decode(b.slice(), column);
+  ASSERT_EQ(100UL, column.size());
+  ASSERT_EQ(0UL, column.nullCount);
+  for (int i = 0; i < 100; ++i) {
+    if (i == 50) {
+      ASSERT_DOUBLE_EQ(static_cast<double>(INT64_MIN), column.values[i]);
+    } else {
+      ASSERT_DOUBLE_EQ(i + 0.5, column.values[i]);
+    }
+  }
+}
+
+TEST(ColumnDecoderTest, FixedWidthSmallInts) {
+  Builder b;
+  b.openArray();
+  for (int i = 0; i < 100; ++i) {
+    if (i == 70) {
+      b.add(Value(ValueType::Null));
+    } else {
+      b.add(Value((i % 16) - 6));
+    }
+  }
+  b.close();
+  ASSERT_EQ(0x02, b.slice().head());
+
+  IntColumn ints;
+  ColumnDecoder::decode(b.slice(), ints);
+  DoubleColumn doubles;
+  ColumnDecoder::decode(b.slice(), doubles);
+
+  ASSERT_EQ(100UL, ints.size());
+  ASSERT_EQ(100UL, doubles.size());
+  ASSERT_EQ(1UL, ints.nullCount);
+  ASSERT_EQ(1UL, doubles.nullCount);
+  for (int i = 0; i < 100; ++i) {
+    if (i == 70) {
+      ASSERT_TRUE(ints.isNull(i));
+      ASSERT_TRUE(doubles.isNull(i));
+    } else {
+      ASSERT_FALSE(ints.isNull(i));
+      ASSERT_EQ((i % 16) - 6, ints.values[i]);
+      ASSERT_DOUBLE_EQ((i % 16) - 6, doubles.values[i]);
+    }
+  }
+}
+
+TEST(ColumnDecoderTest, Ints) {
+  Builder b = parseJson("[1,-1,1234567890123,-1234567890123,18446744073709551615,2.5,null,9223372036854775807]");
+
+  IntColumn column;
+  ColumnDecoder::decode(b.slice(), column);
+  ASSERT_EQ(8UL, column.size());
+  ASSERT_EQ(3UL, column.nullCount);
+  ASSERT_EQ(1, column.values[0]);
+  ASSERT_EQ(-1, column.values[1]);
+  ASSERT_EQ(1234567890123LL, column.values[2]);
+  ASSERT_EQ(-1234567890123LL, column.values[3]);
+  ASSERT_TRUE(column.isNull(4));
+  ASSERT_TRUE(column.isNull(5));
+  ASSERT_TRUE(column.isNull(6));
+  ASSERT_EQ(INT64_MAX, column.values[7]);
+}
+
+TEST(ColumnDecoderTest, Bools) {
+  Builder b;
+  b.openArray();
+  for (int i = 0; i < 50; ++i) {
+    b.add(Value(i % 3 == 0));
+  }
+  b.add(Value(ValueType::Null));
+  b.close();
+  ASSERT_EQ(0x02, b.slice().head());
+
+  BoolColumn column;
+  ColumnDecoder::decode(b.slice(), column);
+  ASSERT_EQ(51UL, column.size());
+  ASSERT_EQ(1UL, column.nullCount);
+  for (int i = 0; i < 50; ++i) {
+    ASSERT_EQ(i % 3 == 0 ? 1 : 0, column.values[i]);
+  }
+  ASSERT_TRUE(column.isNull(50));
+}
+
+TEST(ColumnDecoderTest, Strings) {
+  Builder b = parseJson("[\"foo\",\"\",1,\"a somewhat longer string value\"]");
+
+  StringColumn column;
+  ColumnDecoder::decode(b.slice(), column);
+  ASSERT_EQ(4UL, column.size());
+  ASSERT_EQ(1UL, column.nullCount);
+  ASSERT_EQ("foo", column.values[0].toString());
+  ASSERT_EQ("", column.values[1].toString());
+  ASSERT_TRUE(column.isNull(2));
+  ASSERT_EQ("a somewhat longer string value", column.values[3].toString());
+}
+
+TEST(ColumnDecoderTest, CompactArray) {
+  Options options;
+  options.buildUnindexedArrays = true;
+  Builder b = parseJson("[1,2.5,\"foo\",-3,[1,2],4]", &options);
+  ASSERT_EQ(0x13, b.slice().head());
+
+  DoubleColumn column;
+  ColumnDecoder::decode(b.slice(), column);
+  ASSERT_EQ(6UL, column.size());
+  ASSERT_EQ(2UL, column.nullCount);
+  ASSERT_DOUBLE_EQ(1.0, column.values[0]);
+  ASSERT_DOUBLE_EQ(2.5, column.values[1]);
+  ASSERT_DOUBLE_EQ(-3.0, column.values[3]);
+  ASSERT_DOUBLE_EQ(4.0, column.values[5]);
+}
+
+TEST(ColumnDecoderTest, AppendToColumn) {
+  Builder b1 = parseJson("[1,2]");
+  Builder b2 = parseJson("[3,null]");
+
+  IntColumn column;
+  ColumnDecoder::decode(b1.slice(), column);
+  ColumnDecoder::decode(b2.slice(), column);
+  ASSERT_EQ(4UL, column.size());
+  ASSERT_EQ(1UL, column.nullCount);
+  ASSERT_EQ(3, column.values[2]);
+
+  column.clear();
+  ASSERT_TRUE(column.empty());
+  ASSERT_EQ(0UL, column.nullCount);
+}
+
+TEST(ColumnDecoderTest, Attribute) {
+  Builder b = parseJson("[{\"a\":1,\"b\":\"x\"},{\"b\":\"y\"},5,{\"a\":2.5},{\"a\":null,\"b\":true}]");
+
+  DoubleColumn a;
+  ColumnDecoder::decode(b.slice(), StringRef("a"), a);
+  ASSERT_EQ(5UL, a.size());
+  ASSERT_EQ(3UL, a.nullCount);
+  ASSERT_DOUBLE_EQ(1.0, a.values[0]);
+  ASSERT_TRUE(a.isNull(1));
+  ASSERT_TRUE(a.isNull(2));
+  ASSERT_DOUBLE_EQ(2.5, a.values[3]);
+  ASSERT_TRUE(a.isNull(4));
+
+  StringColumn s;
+  ColumnDecoder::decode(b.slice(), StringRef("b"), s);
+  ASSERT_EQ(5UL, s.size());
+  ASSERT_EQ(3UL, s.nullCount);
+  ASSERT_EQ("x", s.values[0].toString());
+  ASSERT_EQ("y", s.values[1].toString());
+
+  BoolColumn bools;
+  ColumnDecoder::decode(b.slice(), StringRef("b"), bools);
+  ASSERT_EQ(4UL, bools.nullCount);
+  ASSERT_EQ(1, bools.values[4]);
+}
+
+TEST(ColumnDecoderTest, Path) {
+  Builder b = parseJson("[{\"a\":{\"b\":[1,2]}},{\"a\":{\"b\":[3]}},{\"a\":1}]");
+
+  IntColumn column;
+  ColumnDecoder::decode(b.slice(), CompiledPath("a.b[-1]"), column);
+  ASSERT_EQ(3UL, column.size());
+  ASSERT_EQ(1UL, column.nullCount);
+  ASSERT_EQ(2, column.values[0]);
+  ASSERT_EQ(3, column.values[1]);
+  ASSERT_TRUE(column.isNull(2));
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -411,6 +411,140 @@ TEST(NormalizedCompareTest, Custom) {
   ASSERT_VELOCYPACK_EXCEPTION(NormalizedCompare::equals(b.slice(), b.slice()), Exception::NotImplemented);
 }
 
+TEST(NormalizedCompareTest, AnyType) {
+  Builder b;
+  b.openArray();
+  b.add(Value(5, ValueType::UTCDate));
+  b.add(Value(5, ValueType::UTCDate));
+  b.add(Value(6, ValueType::UTCDate));
+  b.add(ValuePair("ab", 2, ValueType::Binary));
+  b.add(ValuePair("ab", 2, ValueType::Binary));
+  b.add(ValuePair("ac", 2, ValueType::Binary));
+  b.add(Value(5));
+  b.openArray();
+  b.add(Value(1.0));
+  b.add(Value(5, ValueType::UTCDate));
+  b.close();
+  b.openArray();
+  b.add(Value(1));
+  b.add(Value(5, ValueType::UTCDate));
+  b.close();
+  b.close();
+  Slice s = b.slice();
+
+  ASSERT_VELOCYPACK_EXCEPTION(NormalizedCompare::equals(s.at(0), s.at(1)), Exception::InternalError);
+  ASSERT_VELOCYPACK_EXCEPTION(NormalizedCompare::equals(s.at(3), s.at(4)), Exception::InternalError);
+
+  ASSERT_TRUE(NormalizedCompare::equalsAnyType(s.at(0), s.at(1)));
+  ASSERT_FALSE(NormalizedCompare::equalsAnyType(s.at(0), s.at(2)));
+  ASSERT_TRUE(NormalizedCompare::equalsAnyType(s.at(3), s.at(4)));
+  ASSERT_FALSE(NormalizedCompare::equalsAnyType(s.at(3), s.at(5)));
+  ASSERT_FALSE(NormalizedCompare::equalsAnyType(s.at(0), s.at(6)));
+  ASSERT_FALSE(NormalizedCompare::equalsAnyType(s.at(0), s.at(3)));
+  // nested values are compared in the same way
+  ASSERT_TRUE(NormalizedCompare::equalsAnyType(s.at(7), s.at(8)));
+  ASSERT_EQ(s.at(7).normalizedHash(), s.at(8).normalizedHash());
+
+  Builder custom;
+  uint8_t* p = custom.add(ValuePair(2ULL, ValueType::Custom));
+  *p++ = 0xf0;
+  *p++ = 0xaa;
+  ASSERT_TRUE(NormalizedCompare::equalsAnyType(custom.slice(), custom.slice()));
+}
+
+static Builder buildWith(std::string const& json, bool compact) {
+  Options options;
+  options.buildUnindexedArrays = compact;
+  options.buildUnindexedObjects = compact;
+  Parser parser(&options);
+  parser.parse(json);
+  return Builder::clone(parser.builder().slice());
+}
+
+TEST(CanonicalCompareTest, EqualValues) {
+  std::vector<std::pair<std::string, std::string>> const pairs{
+      {"null", "null"},
+      {"1", "1.0"},
+      {"-1", "-1.0"},
+      {"0", "-0.0"},
+      {"100", "1e2"},
+      {"-1000", "-1000.0"},
+      {"18446744073709551615", "18446744073709551615"},
+      {"1.5", "1.5"},
+      {"\"abc\"", "\"abc\""},
+      {"[]", "[]"},
+      {"[1,2,3]", "[1.0,2,3e0]"},
+      {"[1,\"a\",[2,3]]", "[1,\"a\",[2.0,3]]"},
+      {"{}", "{}"},
+      {"{\"a\":1}", "{\"a\":1.0}"},
+      {"{\"a\":1,\"b\":2}", "{\"b\":2,\"a\":1}"},
+      {"{\"c\":3,\"b\":2,\"a\":1}", "{\"a\":1,\"c\":3,\"b\":2}"},
+      {"{\"one\":{\"x\":1,\"y\":[1,2]},\"two\":{\"z\":\"z\"}}",
+       "{\"two\":{\"z\":\"z\"},\"one\":{\"y\":[1.0,2],\"x\":1}}"},
+  };
+
+  for (auto const& it : pairs) {
+    for (bool compact : {false, true}) {
+      Builder lhs = buildWith(it.first, compact);
+      Builder rhs = buildWith(it.second, !compact);
+      ASSERT_TRUE(NormalizedCompare::equals(lhs.slice(), rhs.slice()));
+
+      Builder l = Builder::canonicalize(lhs.slice());
+      Builder r = Builder::canonicalize(rhs.slice());
+      ASSERT_EQ(l.size(), r.size());
+      ASSERT_EQ(0, memcmp(l.start(), r.start(), l.size()));
+      ASSERT_TRUE(CanonicalCompare::equals(l.slice(), r.slice()));
+      ASSERT_TRUE(CanonicalCompare::Equal()(l.slice(), r.slice()));
+      ASSERT_EQ(CanonicalCompare::Hash()(l.slice()),
+                CanonicalCompare::Hash()(r.slice()));
+      ASSERT_TRUE(NormalizedCompare::equals(l.slice(), lhs.slice()));
+
+      // canonical values stay the same when canonicalized again
+      Builder again = Builder::canonicalize(l.slice());
+      ASSERT_TRUE(CanonicalCompare::equals(l.slice(), again.slice()));
+    }
+  }
+}
+
+TEST(CanonicalCompareTest, UnequalValues) {
+  std::vector<std::pair<std::string, std::string>> const pairs{
+      {"null", "false"},
+      {"1", "2"},
+      {"1", "-1"},
+      {"1", "1.5"},
+      {"1", "\"1\""},
+      {"\"abc\"", "\"abd\""},
+      {"[1,2]", "[2,1]"},
+      {"[1,2]", "[1,2,3]"},
+      {"{\"a\":1}", "{\"b\":1}"},
+      {"{\"a\":1,\"b\":2}", "{\"a\":2,\"b\":1}"},
+      {"{\"a\":[1]}", "{\"a\":1}"},
+  };
+
+  for (auto const& it : pairs) {
+    Builder l = Builder::canonicalize(buildWith(it.first, false).slice());
+    Builder r = Builder::canonicalize(buildWith(it.second, true).slice());
+    ASSERT_FALSE(NormalizedCompare::equals(l.slice(), r.slice()));
+    ASSERT_FALSE(CanonicalCompare::equals(l.slice(), r.slice()));
+  }
+}
+
+TEST(CanonicalCompareTest, ParserBuildsCanonical) {
+  Options options;
+  options.buildCanonical = true;
+  options.buildUnindexedArrays = true;
+  options.buildUnindexedObjects = true;
+
+  std::string const json(
+      "{\"z\":[3.0,-2,1e1],\"a\":{\"y\":true,\"x\":null},\"m\":\"text\"}");
+  Parser parser(&options);
+  parser.parse(json);
+
+  Builder canonical = Builder::canonicalize(Parser::fromJson(json)->slice());
+  ASSERT_TRUE(
+      CanonicalCompare::equals(parser.builder().slice(), canonical.slice()));
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -0,0 +1,275 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+static bool matches(std::string const& expression, std::string const& document) {
+  std::shared_ptr<Builder> e = Parser::fromJson(expression);
+  std::shared_ptr<Builder> d = Parser::fromJson(document);
+  CompiledFilter filter(e->slice());
+  return filter.matches(d->slice());
+}
+
+TEST(CompiledFilterTest, InvalidExpressions) {
+  std::vector<std::string> const invalid{
+      "null", "[]", "[1]", "{\"==\":1}", "[\"foo\",\"a\",1]", "[\"==\",\"a\"]",
+      "[\"==\",\"a\",1,2]", "[\"==\",1,1]", "[\"not\"]", "[\"not\",[\"exists\",\"a\"],1]",
+      "[\"exists\"]", "[\"in\",\"a\",1]", "[\"and\",1]", "[\"or\",[\"exists\",\"a\"],\"b\"]"};
+
+  for (auto const& expression : invalid) {
+    std::shared_ptr<Builder> e = Parser::fromJson(expression);
+    ASSERT_VELOCYPACK_EXCEPTION(CompiledFilter(e->slice()), Exception::InvalidValueType);
+  }
+
+  std::shared_ptr<Builder> e = Parser::fromJson("[\"==\",\"a[\",1]");
+  ASSERT_VELOCYPACK_EXCEPTION(CompiledFilter(e->slice()), Exception::InvalidAttributePath);
+}
+
+TEST(CompiledFilterTest, Equality) {
+  std::string const doc("{\"a\":1,\"b\":\"foo\",\"c\":{\"d\":[1,2]},\"e\":null,\"f\":true}");
+
+  ASSERT_TRUE(matches("[\"==\",\"a\",1]", doc));
+  ASSERT_TRUE(matches("[\"==\",\"a\",1.0]", doc));
+  ASSERT_FALSE(matches("[\"==\",\"a\",2]", doc));
+  ASSERT_FALSE(matches("[\"==\",\"a\",\"1\"]", doc));
+  ASSERT_TRUE(matches("[\"==\",\"b\",\"foo\"]", doc));
+  ASSERT_FALSE(matches("[\"==\",\"b\",\"fo\"]", doc));
+  ASSERT_TRUE(matches("[\"==\",\"c.d\",[1,2]]", doc));
+  ASSERT_TRUE(matches("[\"==\",\"/c/d/1\",2]", doc));
+  ASSERT_TRUE(matches("[\"==\",\"c.d[-1]\",2]", doc));
+  ASSERT_TRUE(matches("[\"==\",\"e\",null]", doc));
+  ASSERT_FALSE(matches("[\"==\",\"missing\",null]", doc));
+  ASSERT_TRUE(matches("[\"==\",\"f\",true]", doc));
+
+  ASSERT_FALSE(matches("[\"!=\",\"a\",1]", doc));
+  ASSERT_TRUE(matches("[\"!=\",\"a\",2]", doc));
+  ASSERT_TRUE(matches("[\"!=\",\"missing\",2]", doc));
+}
+
+TEST(CompiledFilterTest, Ordering) {
+  std::string const doc("{\"i\":-5,\"u\":18446744073709551615,\"d\":2.5,\"s\":\"bar\",\"b\":false,\"n\":null}");
+
+  ASSERT_TRUE(matches("[\"<\",\"i\",0]", doc));
+  ASSERT_TRUE(matches("[\"<=\",\"i\",-5]", doc));
+  ASSERT_FALSE(matches("[\"<\",\"i\",-5]", doc));
+  ASSERT_TRUE(matches("[\">\",\"i\",-6.5]", doc));
+  ASSERT_TRUE(matches("[\">\",\"u\",18446744073709551614]", doc));
+  ASSERT_FALSE(matches("[\">\",\"u\",18446744073709551615]", doc));
+  ASSERT_TRUE(matches("[\">=\",\"u\",1]", doc));
+  ASSERT_TRUE(matches("[\">\",\"d\",2]", doc));
+  ASSERT_TRUE(matches("[\"<\",\"d\",3]", doc));
+  ASSERT_TRUE(matches("[\"<\",\"s\",\"baz\"]", doc));
+  ASSERT_TRUE(matches("[\">\",\"s\",\"ba\"]", doc));
+  ASSERT_TRUE(matches("[\">=\",\"s\",\"bar\"]", doc));
+  ASSERT_TRUE(matches("[\"<\",\"b\",true]", doc));
+
+  // values of different types and missing values are not ordered
+  ASSERT_FALSE(matches("[\"<\",\"s\",1]", doc));
+  ASSERT_FALSE(matches("[\">=\",\"s\",1]", doc));
+  ASSERT_FALSE(matches("[\"<\",\"n\",1]", doc));
+  ASSERT_FALSE(matches("[\"<\",\"missing\",1]", doc));
+  ASSERT_FALSE(matches("[\">=\",\"missing\",1]", doc));
+}
+
+TEST(CompiledFilterTest, ExistsAndIn) {
+  std::string const doc("{\"a\":{\"b\":null},\"c\":3,\"s\":\"x\"}");
+
+  ASSERT_TRUE(matches("[\"exists\",\"a.b\"]", doc));
+  ASSERT_FALSE(matches("[\"exists\",\"a.c\"]", doc));
+  ASSERT_TRUE(matches("[\"in\",\"c\",[1,2,3]]", doc));
+  ASSERT_TRUE(matches("[\"in\",\"c\",[3.0]]", doc));
+  ASSERT_FALSE(matches("[\"in\",\"c\",[]]", doc));
+  ASSERT_FALSE(matches("[\"in\",\"c\",[\"3\",4]]", doc));
+  ASSERT_TRUE(matches("[\"in\",\"s\",[\"y\",\"x\"]]", doc));
+  ASSERT_TRUE(matches("[\"in\",\"a.b\",[null]]", doc));
+  ASSERT_FALSE(matches("[\"in\",\"missing\",[null]]", doc));
+
+  // a large list
+  std::string list("[");
+  for (int i = 0; i < 1000; ++i) {
+    list += std::to_string(i * 7) + ",\"v" + std::to_string(i) + "\",";
+  }
+  list += "null]";
+  for (int i = 0; i < 2000; ++i) {
+    std::string d("{\"c\":" + std::to_string(i) + ",\"s\":\"v" + std::to_string(i) + "\"}");
+    ASSERT_EQ(i % 7 == 0, matches("[\"in\",\"c\"," + list + "]", d));
+    ASSERT_EQ(i < 1000, matches("[\"in\",\"s\"," + list + "]", d));
+  }
+}
+
+TEST(CompiledFilterTest, DatesAndBinaries) {
+  Builder d;
+  d.openObject();
+  d.add("d", Value(1000, ValueType::UTCDate));
+  d.add("b", ValuePair("ab", 2, ValueType::Binary));
+  d.close();
+
+  Builder v;
+  v.openArray();
+  v.add(Value(1000, ValueType::UTCDate));
+  v.add(Value(1001, ValueType::UTCDate));
+  v.add(Value(1000));
+  v.add(ValuePair("ab", 2, ValueType::Binary));
+  v.add(ValuePair("ac", 2, ValueType::Binary));
+  v.close();
+
+  auto matchesValue = [&d](std::string const& op, std::string const& path, Slice value) {
+    Builder e;
+    e.openArray();
+    e.add(Value(op));
+    e.add(Value(path));
+    e.add(value);
+    e.close();
+    return CompiledFilter(e.slice()).matches(d.slice());
+  };
+
+  ASSERT_TRUE(matchesValue("==", "d", v.slice().at(0)));
+  ASSERT_FALSE(matchesValue("==", "d", v.slice().at(1)));
+  ASSERT_FALSE(matchesValue("==", "d", v.slice().at(2)));
+  ASSERT_FALSE(matchesValue("!=", "d", v.slice().at(0)));
+  ASSERT_TRUE(matchesValue("!=", "d", v.slice().at(1)));
+  ASSERT_TRUE(matchesValue("==", "b", v.slice().at(3)));
+  ASSERT_FALSE(matchesValue("==", "b", v.slice().at(4)));
+  ASSERT_TRUE(matchesValue("in", "d", v.slice()));
+  ASSERT_FALSE(matchesValue("in", "b", Slice::emptyArraySlice()));
+
+  // dates and binaries are not ordered
+  ASSERT_FALSE(matchesValue("<", "d", v.slice().at(1)));
+  ASSERT_FALSE(matchesValue(">=", "d", v.slice().at(0)));
+  ASSERT_FALSE(matchesValue("<=", "b", v.slice().at(3)));
+}
+
+TEST(CompiledFilterTest, BooleanLogic) {
+  std::string const doc("{\"a\":1,\"b\":2}");
+
+  ASSERT_TRUE(matches("[\"and\"]", doc));
+  ASSERT_FALSE(matches("[\"or\"]", doc));
+  ASSERT_TRUE(matches("[\"and\",[\"==\",\"a\",1],[\"==\",\"b\",2]]", doc));
+  ASSERT_FALSE(matches("[\"and\",[\"==\",\"a\",1],[\"==\",\"b\",3]]", doc));
+  ASSERT_FALSE(matches("[\"and\",[\"==\",\"a\",0],[\"==\",\"b\",2]]", doc));
+  ASSERT_TRUE(matches("[\"or\",[\"==\",\"a\",0],[\"==\",\"b\",2]]", doc));
+  ASSERT_TRUE(matches("[\"or\",[\"==\",\"a\",1],[\"==\",\"b\",0]]", doc));
+  ASSERT_FALSE(matches("[\"or\",[\"==\",\"a\",0],[\"==\",\"b\",0],[\"exists\",\"c\"]]", doc));
+  ASSERT_TRUE(matches("[\"not\",[\"exists\",\"c\"]]", doc));
+  ASSERT_FALSE(matches("[\"not\",[\"and\"]]", doc));
+
+  // nesting, with short-circuiting jumps to the end of the inner expression
+  ASSERT_TRUE(matches("[\"and\",[\"or\",[\"==\",\"a\",0],[\"==\",\"a\",1]],[\"not\",[\"==\",\"b\",1]]]", doc));
+  ASSERT_TRUE(matches("[\"or\",[\"and\",[\"==\",\"a\",0],[\"==\",\"b\",2]],[\"and\",[\"==\",\"a\",1],[\"==\",\"b\",2]]]", doc));
+  ASSERT_FALSE(matches("[\"or\",[\"and\",[\"==\",\"a\",1],[\"==\",\"b\",0]],[\"and\",[\"==\",\"a\",0],[\"==\",\"b\",2]]]", doc));
+  ASSERT_TRUE(matches("[\"and\",[\"or\",[\"==\",\"a\",1],[\"==\",\"a\",0]],[\"or\",[\"==\",\"b\",0],[\"==\",\"b\",2]]]", doc));
+}
+
+TEST(CompiledFilterTest, SharedPaths) {
+  std::shared_ptr<Builder> e = Parser::fromJson(
+      "[\"and\",[\">\",\"a.b\",1],[\"<\",\"a.b\",5],[\"!=\",\"a.b\",3]]");
+  CompiledFilter filter(e->slice());
+  ASSERT_EQ(5UL, filter.size());
+
+  for (int i = 0; i < 7; ++i) {
+    Builder b;
+    b.openObject();
+    b.add(Value("a"));
+    b.openObject();
+    b.add("b", Value(i));
+    b.close();
+    b.close();
+    ASSERT_EQ(i == 2 || i == 4, filter.matches(b.slice()));
+  }
+}
+
+TEST(CompiledFilterTest, ManyPaths) {
+  // more distinct paths than are kept on the stack
+  std::string expression("[\"and\"");
+  std::string document("{");
+  for (int i = 0; i < 40; ++i) {
+    expression += ",[\"==\",\"a" + std::to_string(i) + "\"," + std::to_string(i) + "]";
+    document += std::string(i > 0 ? "," : "") + "\"a" + std::to_string(i) + "\":" + std::to_string(i);
+  }
+  expression += "]";
+  document += "}";
+  ASSERT_TRUE(matches(expression, document));
+  ASSERT_FALSE(matches(expression, "{\"a0\":0}"));
+}
+
+TEST(CompiledFilterTest, Batch) {
+  std::shared_ptr<Builder> e = Parser::fromJson(
+      "[\"and\",[\"==\",\"type\",\"order\"],[\">=\",\"total\",100]]");
+  CompiledFilter filter(e->slice());
+
+  Options options;
+  for (bool compact : {false, true}) {
+    options.buildUnindexedArrays = compact;
+    Builder b(&options);
+    b.openArray();
+    for (int i = 0; i < 1000; ++i) {
+      b.openObject();
+      b.add("type", Value(i % 3 == 0 ? "order" : "refund"));
+      b.add("total", Value(i));
+      b.close();
+    }
+    b.close();
+
+    std::vector<ValueLength> positions;
+    filter.select(b.slice(), positions);
+    std::vector<ValueLength> expected;
+    for (ValueLength i = 100; i < 1000; ++i) {
+      if (i % 3 == 0) {
+        expected.push_back(i);
+      }
+    }
+    ASSERT_EQ(expected, positions);
+    ASSERT_EQ(expected.size(), filter.count(b.slice()));
+
+    Builder result = filter.filter(b.slice());
+    ASSERT_EQ(expected.size(), result.slice().length());
+    for (ValueLength i = 0; i < expected.size(); ++i) {
+      ASSERT_TRUE(result.slice().at(i).binaryEquals(b.slice().at(expected[i])));
+    }
+
+    std::vector<Slice> documents;
+    for (ValueLength i = 0; i < 1000; i += 2) {
+      documents.push_back(b.slice().at(i));
+    }
+    positions.clear();
+    filter.select(documents, positions);
+    ASSERT_EQ(150UL, positions.size());
+    for (auto const& p : positions) {
+      ASSERT_TRUE(filter.matches(documents[p]));
+      ASSERT_EQ(0UL, (p * 2) % 3);
+    }
+  }
+
+  ASSERT_VELOCYPACK_EXCEPTION(filter.count(Slice::emptyObjectSlice()), Exception::InvalidValueType);
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,283 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+static Builder parseJson(std::string const& json, Options const* options = &Options::Defaults) {
+  Parser parser(options);
+  parser.parse(json);
+  return *parser.steal();
+}
+
+static std::vector<std::string> collect(CompiledPath const& path, Slice s) {
+  std::vector<std::string> result;
+  path.forEach(s, [&result](Slice const& value) {
+    result.emplace_back(value.toJson());
+    return true;
+  });
+  return result;
+}
+
+TEST(CompiledPathTest, EmptyPath) {
+  Builder b = parseJson("{\"foo\":1}");
+
+  CompiledPath path("");
+  ASSERT_TRUE(path.empty());
+  ASSERT_FALSE(path.hasWildcard());
+  ASSERT_EQ(b.slice().start(), path.get(b.slice()).start());
+
+  CompiledPath root("$");
+  ASSERT_TRUE(root.empty());
+}
+
+TEST(CompiledPathTest, JsonPointer) {
+  CompiledPath path("/foo/bar~1baz/0/qux~0");
+  ASSERT_EQ(4UL, path.size());
+  ASSERT_FALSE(path.hasWildcard());
+
+  auto const& steps = path.steps();
+  ASSERT_EQ(CompiledPath::StepType::Attribute, steps[0].type);
+  ASSERT_EQ("foo", steps[0].name);
+  ASSERT_EQ(CompiledPath::StepType::Attribute, steps[1].type);
+  ASSERT_EQ("bar/baz", steps[1].name);
+  ASSERT_EQ(CompiledPath::StepType::AttributeOrIndex, steps[2].type);
+  ASSERT_EQ(0, steps[2].index);
+  ASSERT_EQ(CompiledPath::StepType::Attribute, steps[3].type);
+  ASSERT_EQ("qux~", steps[3].name);
+
+  ASSERT_EQ("/foo/bar~1baz/0/qux~0", path.toString());
+}
+
+TEST(CompiledPathTest, JsonPointerInvalidEscape) {
+  ASSERT_VELOCYPACK_EXCEPTION(CompiledPath("/foo~2"), Exception::InvalidAttributePath);
+  ASSERT_VELOCYPACK_EXCEPTION(CompiledPath("/foo~"), Exception::InvalidAttributePath);
+}
+
+TEST(CompiledPathTest, JsonPath) {
+  CompiledPath path("$.foo['b.a.r'][3][-1].*[*]");
+  ASSERT_EQ(6UL, path.size());
+  ASSERT_TRUE(path.hasWildcard());
+
+  auto const& steps = path.steps();
+  ASSERT_EQ(CompiledPath::StepType::Attribute, steps[0].type);
+  ASSERT_EQ("foo", steps[0].name);
+  ASSERT_EQ(CompiledPath::StepType::Attribute, steps[1].type);
+  ASSERT_EQ("b.a.r", steps[1].name);
+  ASSERT_EQ(CompiledPath::StepType::Index, steps[2].type);
+  ASSERT_EQ(3, steps[2].index);
+  ASSERT_EQ(CompiledPath::StepType::Index, steps[3].type);
+  ASSERT_EQ(-1, steps[3].index);
+  ASSERT_EQ(CompiledPath::StepType::Wildcard, steps[4].type);
+  ASSERT_EQ(CompiledPath::StepType::Wildcard, steps[5].type);
+}
+
+TEST(CompiledPathTest, JsonPathBareName) {
+  CompiledPath path("foo.bar");
+  ASSERT_EQ(2UL, path.size());
+  ASSERT_EQ("/foo/bar", path.toString());
+}
+
+TEST(CompiledPathTest, JsonPathBareWildcard) {
+  CompiledPath path("*.b");
+  CompiledPath rooted("$.*.b");
+  ASSERT_TRUE(path.hasWildcard());
+  ASSERT_EQ(rooted.size(), path.size());
+  for (std::size_t i = 0; i < path.size(); ++i) {
+    ASSERT_EQ(rooted.steps()[i].type, path.steps()[i].type);
+    ASSERT_EQ(rooted.steps()[i].name, path.steps()[i].name);
+  }
+  ASSERT_EQ(CompiledPath::StepType::Wildcard, path.steps()[0].type);
+  ASSERT_EQ(rooted.toString(), path.toString());
+
+  Builder b = parseJson("{\"x\":{\"b\":1},\"*\":{\"b\":2}}");
+  ASSERT_EQ(1, path.get(b.slice()).getInt());
+  ASSERT_EQ(2, CompiledPath("$['*'].b").get(b.slice()).getInt());
+}
+
+TEST(CompiledPathTest, JsonPathInvalid) {
+  ASSERT_VELOCYPACK_EXCEPTION(CompiledPath("$."), Exception::InvalidAttributePath);
+  ASSERT_VELOCYPACK_EXCEPTION(CompiledPath("$.foo..bar"), Exception::InvalidAttributePath);
+  ASSERT_VELOCYPACK_EXCEPTION(CompiledPath("$.foo[1"), Exception::InvalidAttributePath);
+  ASSERT_VELOCYPACK_EXCEPTION(CompiledPath("$.foo[abc]"), Exception::InvalidAttributePath);
+  ASSERT_VELOCYPACK_EXCEPTION(CompiledPath("$['foo"), Exception::InvalidAttributePath);
+  ASSERT_VELOCYPACK_EXCEPTION(CompiledPath("$['foo'"), Exception::InvalidAttributePath);
+  ASSERT_VELOCYPACK_EXCEPTION(CompiledPath("$foo"), Exception::InvalidAttributePath);
+  ASSERT_VELOCYPACK_EXCEPTION(CompiledPath("$a.b"), Exception::InvalidAttributePath);
+}
+
+TEST(CompiledPathTest, ToStringRoundTrip) {
+  std::vector<std::pair<std::string, std::string>> const paths{
+      {"", ""},
+      {"/foo/bar", "/foo/bar"},
+      {"/foo/*/0/a~1b~0", "/foo/*/0/a~1b~0"},
+      {"/007/", "/007/"},
+      {"foo.bar", "/foo/bar"},
+      {"$.a[-1]", "$['a'][-1]"},
+      {"$.a[2]", "$['a'][2]"},
+      {"$['*']", "$['*']"},
+      {"$['*'].*", "$['*'][*]"},
+      {"$['0'].b", "$['0']['b']"},
+      {"$['it\\'s'][*]['a\\\\b']", "/it's/*/a\\b"},
+      {"$['it\\'s'][0]['a\\\\b']", "$['it\\'s'][0]['a\\\\b']"},
+  };
+
+  for (auto const& it : paths) {
+    CompiledPath path(it.first);
+    ASSERT_EQ(it.second, path.toString());
+
+    CompiledPath again(path.toString());
+    ASSERT_EQ(path.size(), again.size());
+    for (std::size_t i = 0; i < path.size(); ++i) {
+      ASSERT_EQ(path.steps()[i].type, again.steps()[i].type);
+      ASSERT_EQ(path.steps()[i].name, again.steps()[i].name);
+      ASSERT_EQ(path.steps()[i].index, again.steps()[i].index);
+    }
+  }
+
+  Builder b = parseJson("{\"a\":[10,20,30],\"*\":{\"x\":1},\"5\":2}");
+  ASSERT_EQ(30, CompiledPath(CompiledPath("$.a[-1]").toString()).get(b.slice()).getInt());
+  ASSERT_EQ(1, CompiledPath(CompiledPath("$['*'].x").toString()).get(b.slice()).getInt());
+  Builder arr = parseJson("[{\"5\":1}]");
+  ASSERT_TRUE(CompiledPath(CompiledPath("$[0]['5']").toString()).get(arr.slice()).isInteger());
+  Builder obj = parseJson("{\"0\":1}");
+  ASSERT_TRUE(CompiledPath(CompiledPath("$[0]").toString()).get(obj.slice()).isNone());
+}
+
+TEST(CompiledPathTest, FromVector) {
+  std::vector<std::string> attributes{"foo", "bar"};
+  CompiledPath path(attributes);
+  ASSERT_EQ(2UL, path.size());
+
+  Builder b = parseJson("{\"foo\":{\"bar\":42}}");
+  ASSERT_EQ(42, path.get(b.slice()).getInt());
+
+  std::vector<std::string> empty;
+  ASSERT_VELOCYPACK_EXCEPTION(CompiledPath(empty), Exception::InvalidAttributePath);
+}
+
+TEST(CompiledPathTest, GetAttributes) {
+  Builder b = parseJson("{\"foo\":{\"bar\":{\"baz\":\"qux\"},\"a\":1},\"b\":true}");
+  Slice s = b.slice();
+
+  ASSERT_EQ("qux", CompiledPath("$.foo.bar.baz").get(s).copyString());
+  ASSERT_EQ("qux", CompiledPath("/foo/bar/baz").get(s).copyString());
+  ASSERT_TRUE(CompiledPath("$.b").get(s).isTrue());
+  ASSERT_TRUE(CompiledPath("$.foo.bar").get(s).isObject());
+  ASSERT_TRUE(CompiledPath("$.foo.bar.baz.qux").get(s).isNone());
+  ASSERT_TRUE(CompiledPath("$.foo.nope").get(s).isNone());
+  ASSERT_TRUE(CompiledPath("$.b.nope").get(s).isNone());
+  ASSERT_TRUE(CompiledPath("$.foo[0]").get(s).isNone());
+  ASSERT_FALSE(CompiledPath("$.foo.a").exists(Slice::nullSlice()));
+}
+
+TEST(CompiledPathTest, GetIndexes) {
+  Builder b = parseJson("{\"foo\":[10,[20,21],{\"bar\":30}],\"1\":\"one\"}");
+  Slice s = b.slice();
+
+  ASSERT_EQ(10, CompiledPath("$.foo[0]").get(s).getInt());
+  ASSERT_EQ(21, CompiledPath("$.foo[1][1]").get(s).getInt());
+  ASSERT_EQ(30, CompiledPath("$.foo[2].bar").get(s).getInt());
+  ASSERT_EQ(30, CompiledPath("$.foo[-1].bar").get(s).getInt());
+  ASSERT_EQ(10, CompiledPath("$.foo[-3]").get(s).getInt());
+  ASSERT_TRUE(CompiledPath("$.foo[-4]").get(s).isNone());
+  ASSERT_TRUE(CompiledPath("$.foo[3]").get(s).isNone());
+
+  // JSON Pointer digits act as index or attribute name
+  ASSERT_EQ(21, CompiledPath("/foo/1/1").get(s).getInt());
+  ASSERT_EQ("one", CompiledPath("/1").get(s).copyString());
+}
+
+TEST(CompiledPathTest, GetCompact) {
+  Options options;
+  options.buildUnindexedArrays = true;
+  options.buildUnindexedObjects = true;
+
+  Builder b = parseJson("{\"foo\":[1,{\"bar\":\"baz\"},3],\"qux\":{\"a\":{\"b\":2}}}", &options);
+  Slice s = b.slice();
+  ASSERT_EQ(0x14, s.head());
+
+  ASSERT_EQ("baz", CompiledPath("$.foo[1].bar").get(s).copyString());
+  ASSERT_EQ(2, CompiledPath("/qux/a/b").get(s).getInt());
+}
+
+TEST(CompiledPathTest, Wildcards) {
+  Builder b = parseJson("{\"users\":[{\"name\":\"a\",\"tags\":[1,2]},{\"tags\":[]},{\"name\":\"c\",\"tags\":[3]}]}");
+  Slice s = b.slice();
+
+  auto names = collect(CompiledPath("$.users[*].name"), s);
+  ASSERT_EQ(2UL, names.size());
+  ASSERT_EQ("\"a\"", names[0]);
+  ASSERT_EQ("\"c\"", names[1]);
+
+  auto tags = collect(CompiledPath("/users/*/tags/*"), s);
+  ASSERT_EQ(3UL, tags.size());
+  ASSERT_EQ("1", tags[0]);
+  ASSERT_EQ("2", tags[1]);
+  ASSERT_EQ("3", tags[2]);
+
+  // get() returns the first match
+  ASSERT_EQ("a", CompiledPath("$.users[*].name").get(s).copyString());
+  ASSERT_TRUE(CompiledPath("$.users[*].nope").get(s).isNone());
+}
+
+TEST(CompiledPathTest, WildcardObjectValues) {
+  Builder b = parseJson("{\"a\":{\"x\":1},\"b\":{\"x\":2},\"c\":{\"y\":3}}");
+
+  auto values = collect(CompiledPath("$.*.x"), b.slice());
+  ASSERT_EQ(2UL, values.size());
+}
+
+TEST(CompiledPathTest, WildcardAbort) {
+  Builder b = parseJson("[1,2,3,4,5]");
+
+  CompiledPath path("$[*]");
+  int count = 0;
+  bool completed = path.forEach(b.slice(), [&count](Slice const&) {
+    return ++count < 2;
+  });
+  ASSERT_FALSE(completed);
+  ASSERT_EQ(2, count);
+}
+
+TEST(CompiledPathTest, Externals) {
+  Builder inner = parseJson("{\"bar\":[1,2]}");
+
+  Builder b;
+  b.openObject();
+  b.add("foo", Value(static_cast<void const*>(inner.slice().start()), ValueType::External));
+  b.close();
+
+  ASSERT_EQ(2, CompiledPath("$.foo.bar[1]").get(b.slice()).getInt());
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,359 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <string>
+
+#include "tests-common.h"
+
+namespace arangodb {
+namespace velocypack {
+
+extern void enableNativeStringFunctions();
+extern void enableBuiltinStringFunctions();
+
+}
+}
+
+static std::string toJson(std::string const& csv, bool header = true,
+                          bool detectTypes = true) {
+  CsvParser parser;
+  parser.header = header;
+  parser.detectTypes = detectTypes;
+  parser.parse(csv);
+  return parser.builder().slice().toJson();
+}
+
+TEST(CsvParserTest, CreateWithoutOptions) {
+  ASSERT_VELOCYPACK_EXCEPTION(new CsvParser(nullptr),
+                              Exception::InternalError);
+
+  Builder builder;
+  ASSERT_VELOCYPACK_EXCEPTION(new CsvParser(builder, nullptr),
+                              Exception::InternalError);
+}
+
+TEST(CsvParserTest, InvalidSettings) {
+  CsvParser parser;
+  parser.delimiter = '"';
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse("a,b"), Exception::InternalError);
+
+  parser.delimiter = '\n';
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse("a,b"), Exception::InternalError);
+
+  parser.delimiter = ',';
+  parser.quote = '\r';
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse("a,b"), Exception::InternalError);
+}
+
+TEST(CsvParserTest, Empty) {
+  ASSERT_EQ("[]", toJson(""));
+  ASSERT_EQ("[]", toJson("", false));
+  ASSERT_EQ("[]", toJson("\n\r\n"));
+
+  CsvParser parser;
+  ASSERT_EQ(0UL, parser.parse("a,b\n"));
+  ASSERT_EQ(2UL, parser.columns().size());
+  ASSERT_EQ("[]", parser.builder().slice().toJson());
+}
+
+TEST(CsvParserTest, HeaderRows) {
+  std::string const csv("name,age,active\nfoo,42,true\nbar,-7,false\n");
+  CsvParser parser;
+  ASSERT_EQ(2UL, parser.parse(csv));
+
+  std::vector<std::string> const columns{"name", "age", "active"};
+  ASSERT_EQ(columns, parser.columns());
+
+  Slice s = parser.builder().slice();
+  ASSERT_TRUE(s.isArray());
+  ASSERT_EQ(2UL, s.length());
+  ASSERT_EQ("{\"active\":true,\"age\":42,\"name\":\"foo\"}", s.at(0).toJson());
+  ASSERT_EQ("{\"active\":false,\"age\":-7,\"name\":\"bar\"}",
+            s.at(1).toJson());
+
+  // lookups rely on the index tables being sorted
+  for (auto const& row : ArrayIterator(s)) {
+    ASSERT_TRUE(row.get("name").isString());
+    ASSERT_TRUE(row.get("age").isInteger());
+    ASSERT_TRUE(row.get("active").isBool());
+    ASSERT_TRUE(row.get("foo").isNone());
+  }
+}
+
+TEST(CsvParserTest, HeaderRowsManyColumns) {
+  std::string header;
+  std::string row;
+  for (int i = 40; i > 0; --i) {
+    if (!header.empty()) {
+      header.push_back(',');
+      row.push_back(',');
+    }
+    header.append("c" + std::to_string(i));
+    row.append(std::to_string(i));
+  }
+  std::string const csv(header + "\n" + row + "\n" + row);
+
+  for (bool compact : {false, true}) {
+    Options options;
+    options.buildUnindexedObjects = compact;
+    CsvParser parser(&options);
+    ASSERT_EQ(2UL, parser.parse(csv));
+
+    for (auto const& r : ArrayIterator(parser.builder().slice())) {
+      ASSERT_EQ(40UL, r.length());
+      for (int i = 1; i <= 40; ++i) {
+        ASSERT_EQ(static_cast<uint64_t>(i),
+                  r.get("c" + std::to_string(i)).getUInt());
+      }
+    }
+  }
+}
+
+TEST(CsvParserTest, DuplicateColumnNames) {
+  CsvParser parser;
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse("a,b,a\n1,2,3\n"),
+                              Exception::ParseError);
+  ASSERT_EQ(0UL, parser.errorPos());
+}
+
+TEST(CsvParserTest, WrongNumberOfFields) {
+  CsvParser parser;
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse("a,b\n1,2\n1,2,3\n"),
+                              Exception::ParseError);
+  ASSERT_EQ(8UL, parser.errorPos());
+
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse("a,b\n1\n"), Exception::ParseError);
+  ASSERT_EQ(4UL, parser.errorPos());
+}
+
+TEST(CsvParserTest, WithoutHeader) {
+  ASSERT_EQ("[[\"a\",\"b\"],[1,2,3],[\"\"]]",
+            toJson("a,b\n1,2,3\n\"\"", false));
+  ASSERT_EQ("[[null,null,null]]", toJson(",,", false));
+}
+
+TEST(CsvParserTest, DetectTypes) {
+  ASSERT_EQ(
+      "[[null,true,false,null,0,-1,12345678901234567890,-9223372036854775808,"
+      "1.5,-0.25,1000,0.001]]",
+      toJson("null,true,false,,0,-1,12345678901234567890,"
+             "-9223372036854775808,1.5,-0.25,1e3,1E-3",
+             false));
+
+  // not quite JSON values
+  ASSERT_EQ(
+      "[[\"True\",\"nul\",\"01\",\"1.\",\".5\",\"1e\",\"0x10\",\"-\",\"1 \","
+      "\"+1\",\"1e999\"]]",
+      toJson("True,nul,01,1.,.5,1e,0x10,-,1 ,+1,1e999", false));
+
+  // quoted fields are always Strings
+  ASSERT_EQ("[[\"1\",\"true\",\"\",\"null\"]]",
+            toJson("\"1\",\"true\",\"\",\"null\"", false));
+}
+
+TEST(CsvParserTest, LargeIntegers) {
+  Builder b;
+  CsvParser parser(b);
+  parser.header = false;
+  parser.parse("18446744073709551615,18446744073709551616,"
+               "-9223372036854775809");
+  Slice row = b.slice().at(0);
+  ASSERT_TRUE(row.at(0).isUInt());
+  ASSERT_EQ(UINT64_MAX, row.at(0).getUInt());
+  ASSERT_TRUE(row.at(1).isDouble());
+  ASSERT_DOUBLE_EQ(18446744073709551616.0, row.at(1).getDouble());
+  ASSERT_TRUE(row.at(2).isDouble());
+  ASSERT_DOUBLE_EQ(-9223372036854775809.0, row.at(2).getDouble());
+}
+
+TEST(CsvParserTest, NoTypeDetection) {
+  ASSERT_EQ("[[\"1\",\"true\",\"\",\"null\",\"-1.5\"]]",
+            toJson("1,true,,null,-1.5", false, false));
+}
+
+TEST(CsvParserTest, Quotes) {
+  ASSERT_EQ("[[\"a,b\",\"say \\\"hi\\\"\",\"\\\"\",\"x\"]]",
+            toJson("\"a,b\",\"say \"\"hi\"\"\",\"\"\"\",x", false));
+
+  // quotes inside unquoted fields are kept
+  ASSERT_EQ("[[\"a\\\"b\",\"c\\\"\"]]", toJson("a\"b,c\"", false));
+
+  // several quoted fields with doubled quotes in one row
+  ASSERT_EQ("[{\"a\":\"1\\\"2\",\"b\":\"3\\\"\\\"4\",\"c\":\"x\"}]",
+            toJson("a,b,c\n\"1\"\"2\",\"3\"\"\"\"4\",\"x\""));
+}
+
+TEST(CsvParserTest, QuotedHeader) {
+  CsvParser parser;
+  parser.parse("\"a,b\",\"c\"\"d\"\n1,2\n");
+  std::vector<std::string> const columns{"a,b", "c\"d"};
+  ASSERT_EQ(columns, parser.columns());
+  ASSERT_EQ("[{\"a,b\":1,\"c\\\"d\":2}]", parser.builder().slice().toJson());
+}
+
+TEST(CsvParserTest, LineBreaks) {
+  std::string const expected("[[\"a\",1],[\"b\",2],[\"c\",3]]");
+  ASSERT_EQ(expected, toJson("a,1\nb,2\nc,3", false));
+  ASSERT_EQ(expected, toJson("a,1\r\nb,2\r\nc,3\r\n", false));
+  ASSERT_EQ(expected, toJson("a,1\rb,2\rc,3\r", false));
+  ASSERT_EQ(expected, toJson("\n\na,1\n\n\r\nb,2\r\rc,3\n\n", false));
+
+  // line breaks in quoted fields are part of the value
+  ASSERT_EQ("[[\"a\\nb\",\"c\\r\\nd\"],[1]]",
+            toJson("\"a\nb\",\"c\r\nd\"\n1", false));
+}
+
+TEST(CsvParserTest, ByteOrderMark) {
+  ASSERT_EQ("[{\"a\":1}]", toJson("\xef\xbb\xbf" "a\n1\n"));
+}
+
+TEST(CsvParserTest, Delimiter) {
+  CsvParser parser;
+  parser.delimiter = '\t';
+  parser.quote = '\'';
+  parser.parse("a\tb\n'x\ty'\t'it''s'\n");
+  ASSERT_EQ("[{\"a\":\"x\\ty\",\"b\":\"it's\"}]",
+            parser.builder().slice().toJson());
+}
+
+TEST(CsvParserTest, UnterminatedQuote) {
+  CsvParser parser;
+  parser.header = false;
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse("a\n\"b,c\nd"),
+                              Exception::ParseError);
+  ASSERT_EQ(2UL, parser.errorPos());
+
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse("\"b\"\""), Exception::ParseError);
+}
+
+TEST(CsvParserTest, CharactersAfterQuotedField) {
+  CsvParser parser;
+  parser.header = false;
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse("1,2\n\"a\"b,c"),
+                              Exception::ParseError);
+  ASSERT_EQ(4UL, parser.errorPos());
+}
+
+TEST(CsvParserTest, LongFields) {
+  for (bool native : {true, false}) {
+    // modify global function pointers!
+    if (native) {
+      enableNativeStringFunctions();
+    } else {
+      enableBuiltinStringFunctions();
+    }
+
+    for (std::size_t length :
+         {1, 15, 16, 17, 31, 32, 33, 47, 48, 63, 64, 65, 100}) {
+      std::string const value(length, 'x');
+      std::string const csv(value + "," + value + "\n\"" + value + "\"\"" +
+                            value + "\n" + value + "\"," + value);
+      CsvParser parser;
+      parser.header = false;
+      ASSERT_EQ(2UL, parser.parse(csv));
+
+      Slice s = parser.builder().slice();
+      ASSERT_EQ(value, s.at(0).at(0).copyString());
+      ASSERT_EQ(value, s.at(0).at(1).copyString());
+      ASSERT_EQ(value + "\"" + value + "\n" + value,
+                s.at(1).at(0).copyString());
+      ASSERT_EQ(value, s.at(1).at(1).copyString());
+    }
+  }
+  enableNativeStringFunctions();
+}
+
+TEST(CsvParserTest, Utf8) {
+  ASSERT_EQ("[{\"\xc3\xa4\":\"\xe2\x82\xac\"}]",
+            toJson("\xc3\xa4\n\xe2\x82\xac\n"));
+
+  Options options;
+  options.validateUtf8Strings = true;
+  CsvParser parser(&options);
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse("a\n\xff\n"),
+                              Exception::InvalidUtf8Sequence);
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse("\xff\n1\n"),
+                              Exception::InvalidUtf8Sequence);
+}
+
+TEST(CsvParserTest, IntoOpenBuilder) {
+  Options options;
+  options.clearBuilderBeforeParse = false;
+  Builder b(&options);
+  b.openObject();
+  b.add(Value("rows"));
+  CsvParser parser(b, &options);
+  ASSERT_EQ(1UL, parser.parse("a\n1\n"));
+  b.close();
+  ASSERT_EQ("{\"rows\":[{\"a\":1}]}", b.slice().toJson());
+}
+
+TEST(CsvParserTest, ClearBuilderBeforeParse) {
+  Options options;
+  options.clearBuilderBeforeParse = false;
+  Builder b(&options);
+  b.openArray();
+  CsvParser parser(b, &options);
+  parser.parse("a\n1\n");
+  parser.parse("b\n2\n");
+  b.close();
+  ASSERT_EQ("[[{\"a\":1}],[{\"b\":2}]]", b.slice().toJson());
+
+  CsvParser parser2(b);
+  parser2.parse("c\n3\n");
+  ASSERT_EQ("[{\"c\":3}]", b.slice().toJson());
+}
+
+TEST(CsvParserTest, AttributeTranslator) {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+  translator->add("b", 1);
+  translator->add("c", 2);
+  translator->seal();
+
+  AttributeTranslatorScope scope(translator.get());
+  Options options;
+  options.attributeTranslator = translator.get();
+  CsvParser parser(&options);
+  parser.parse("c,a,b\n1,2,3\n");
+
+  Slice row = parser.builder().slice().at(0);
+  ASSERT_EQ(2UL, row.get("a").getUInt());
+  ASSERT_EQ(3UL, row.get("b").getUInt());
+  ASSERT_EQ(1UL, row.get("c").getUInt());
+  ASSERT_EQ("a", row.keyAt(0).copyString());
+  ASSERT_EQ("b", row.keyAt(1).copyString());
+  ASSERT_EQ("c", row.keyAt(2).copyString());
+}
+
+TEST(CsvParserTest, FromCsv) {
+  std::shared_ptr<Builder> b = CsvParser::fromCsv("x,y\n1,\"2\"\n");
+  ASSERT_EQ("[{\"x\":1,\"y\":\"2\"}]", b->slice().toJson());
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -24,11 +24,26 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ostream>
+#include <random>
 #include <string>
 
 #include "tests-common.h"
 
+namespace arangodb {
+namespace velocypack {
+
+extern void enableNativeStringFunctions();
+extern void enableBuiltinStringFunctions();
+
+}
+}
+
 static unsigned char LocalBuffer[4096];
 
 TEST(DumperTest, CreateWithoutOptions) {
@@ -671,6 +686,115 @@ TEST(StringDumperTest, NumberDoubleScientific4) {
   ASSERT_EQ(std::string("3.4239493e+104"), buffer);
 }
 
+TEST(StringDumperTest, NumberDoubleShortest) {
+  auto dump = [](double value) {
+    Builder b;
+    b.add(Value(value));
+    return Dumper::toString(b.slice());
+  };
+
+  ASSERT_EQ("0.0199472", dump(0.0199472));
+  ASSERT_EQ("0.1", dump(0.1));
+  ASSERT_EQ("0.30000000000000004", dump(0.1 + 0.2));
+  ASSERT_EQ("-0", dump(-0.0));
+  ASSERT_EQ("1e+23", dump(1e23));
+  ASSERT_EQ("5e-324", dump(5e-324));
+  ASSERT_EQ("2.2250738585072014e-308", dump(2.2250738585072014e-308));
+  ASSERT_EQ("1.7976931348623157e+308", dump(1.7976931348623157e308));
+  ASSERT_EQ("9007199254740992", dump(9007199254740992.0));
+  ASSERT_EQ("-595051205496160830000000", dump(-5.9505120549616083e23));
+}
+
+TEST(StringDumperTest, NumberDoubleRoundTrip) {
+  std::mt19937_64 rng(1234);
+  for (int i = 0; i < 100000; ++i) {
+    uint64_t bits = rng();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    if (!std::isfinite(value)) {
+      continue;
+    }
+
+    Builder b;
+    b.add(Value(value));
+    std::string const json = Dumper::toString(b.slice());
+    ASSERT_EQ(value, std::strtod(json.c_str(), nullptr)) << json;
+
+    // no representation with fewer significant digits parses back into
+    // the same value
+    std::string digits = json.substr(0, json.find('e'));
+    digits.erase(std::remove_if(digits.begin(), digits.end(),
+                                [](char c) { return c < '0' || c > '9'; }),
+                 digits.end());
+    digits.erase(0, digits.find_first_not_of('0'));
+    digits.erase(digits.find_last_not_of('0') + 1);
+    ASSERT_FALSE(digits.empty());
+    if (digits.size() > 1) {
+      char shorter[32];
+      snprintf(shorter, sizeof(shorter), "%.*e",
+               static_cast<int>(digits.size()) - 2, value);
+      ASSERT_NE(value, std::strtod(shorter, nullptr)) << json;
+    }
+  }
+}
+
+TEST(StringDumperTest, NumberIntDigitBoundaries) {
+  uint64_t p = 1;
+  for (int i = 0; i < 20; ++i) {
+    for (uint64_t v : {p - 1, p, p + 1}) {
+      Builder b;
+      b.add(Value(v));
+      ASSERT_EQ(std::to_string(v), Dumper::toString(b.slice()));
+
+      int64_t const s = static_cast<int64_t>(v);
+      for (int64_t w : {s, -s}) {
+        Builder b2;
+        b2.add(Value(w));
+        ASSERT_EQ(std::to_string(w), Dumper::toString(b2.slice()));
+      }
+    }
+    p *= 10;
+  }
+
+  for (int64_t v : {INT64_MIN, INT64_MIN + 1, INT64_MAX}) {
+    Builder b;
+    b.add(Value(v));
+    ASSERT_EQ(std::to_string(v), Dumper::toString(b.slice()));
+  }
+  Builder b;
+  b.add(Value(UINT64_MAX));
+  ASSERT_EQ("18446744073709551615", Dumper::toString(b.slice()));
+}
+
+TEST(StringDumperTest, ArrayOfNumbers) {
+  Options options;
+  options.unsupportedTypeBehavior = Options::NullifyUnsupportedType;
+
+  for (bool compact : {false, true}) {
+    options.buildUnindexedArrays = compact;
+
+    Builder b(&options);
+    b.openArray();
+    b.add(Value(0));
+    b.add(Value(-6));
+    b.add(Value(9));
+    b.add(Value(1.25));
+    b.add(Value(-12345));
+    b.add(Value(UINT64_MAX));
+    b.add(Value(std::nan("1")));
+    b.add(Value("7"));
+    b.openArray();
+    b.add(Value(-0.5));
+    b.close();
+    b.add(Value(1e300));
+    b.close();
+
+    ASSERT_EQ(
+        R"([0,-6,9,1.25,-12345,18446744073709551615,null,"7",[-0.5],1e+300])",
+        Dumper::toString(b.slice(), &options));
+  }
+}
+
 TEST(StringDumperTest, NumberInt1) {
   Builder b;
   b.add(Value(static_cast<int64_t>(123456789)));
@@ -1028,6 +1152,133 @@ TEST(StringDumperTest, AppendStringTestTruncatedFourByteUtf8) {
                               Exception::InvalidUtf8Sequence);
 }
 
+TEST(StringDumperTest, AppendStringTestTruncatedUtf8AfterLongRun) {
+  std::string const prefix(100, 'x');
+  for (auto const& tail : {std::string("\xc2"), std::string("\xe2\x82"),
+                           std::string("\xf0\xa4\xad")}) {
+    for (bool escapeUnicode : {false, true}) {
+      Options options;
+      options.escapeUnicode = escapeUnicode;
+      std::string buffer;
+      StringSink sink(&buffer);
+      Dumper dumper(&sink, &options);
+      ASSERT_VELOCYPACK_EXCEPTION(dumper.appendString(prefix + tail),
+                                  Exception::InvalidUtf8Sequence);
+    }
+  }
+
+  // complete sequences at the end are fine
+  std::string buffer;
+  StringSink sink(&buffer);
+  Dumper dumper(&sink);
+  dumper.appendString(prefix + "\xc2\xa2\xe2\x82\xac\xf0\xa4\xad\xa2");
+  ASSERT_EQ("\"" + prefix + "\xc2\xa2\xe2\x82\xac\xf0\xa4\xad\xa2\"", buffer);
+}
+
+// straightforward escaping of valid UTF-8 strings, for comparison
+static std::string referenceEscape(std::string const& value, Options const& options) {
+  static char const hex[] = "0123456789ABCDEF";
+  auto unicode = [](std::string& out, uint32_t c) {
+    out.append("\\u");
+    for (int shift = 12; shift >= 0; shift -= 4) {
+      out.push_back(hex[(c >> shift) & 0xf]);
+    }
+  };
+
+  std::string result("\"");
+  for (std::size_t i = 0; i < value.size(); ++i) {
+    unsigned char c = static_cast<unsigned char>(value[i]);
+    if (c == '"' || c == '\\') {
+      result.push_back('\\');
+      result.push_back(static_cast<char>(c));
+    } else if (c == '/') {
+      result.append(options.escapeForwardSlashes ? "\\/" : "/");
+    } else if (c == '\b') {
+      result.append("\\b");
+    } else if (c == '\f') {
+      result.append("\\f");
+    } else if (c == '\n') {
+      result.append("\\n");
+    } else if (c == '\r') {
+      result.append("\\r");
+    } else if (c == '\t') {
+      result.append("\\t");
+    } else if (c < 0x20) {
+      unicode(result, c);
+    } else if (c >= 0x80 && options.escapeUnicode) {
+      uint32_t cp;
+      if ((c & 0xe0) == 0xc0) {
+        cp = ((c & 0x1f) << 6) | (value[i + 1] & 0x3f);
+        i += 1;
+      } else if ((c & 0xf0) == 0xe0) {
+        cp = ((c & 0x0f) << 12) | ((value[i + 1] & 0x3f) << 6) | (value[i + 2] & 0x3f);
+        i += 2;
+      } else {
+        cp = ((c & 0x07) << 18) | ((value[i + 1] & 0x3f) << 12) |
+             ((value[i + 2] & 0x3f) << 6) | (value[i + 3] & 0x3f);
+        i += 3;
+      }
+      if (cp >= 0x10000) {
+        cp -= 0x10000;
+        unicode(result, 0xd800 + (cp >> 10));
+        unicode(result, 0xdc00 + (cp & 0x3ff));
+      } else {
+        unicode(result, cp);
+      }
+    } else {
+      result.push_back(static_cast<char>(c));
+    }
+  }
+  result.push_back('"');
+  return result;
+}
+
+static void checkEscaping(std::string const& value) {
+  for (bool escapeForwardSlashes : {false, true}) {
+    for (bool escapeUnicode : {false, true}) {
+      Options options;
+      options.escapeForwardSlashes = escapeForwardSlashes;
+      options.escapeUnicode = escapeUnicode;
+
+      std::string buffer;
+      StringSink sink(&buffer);
+      Dumper dumper(&sink, &options);
+      dumper.appendString(value);
+      ASSERT_EQ(referenceEscape(value, options), buffer);
+    }
+  }
+}
+
+TEST(StringDumperTest, EscapeSpecialCharactersAtAllPositions) {
+  std::vector<std::string> const specials{"\"", "\\", "/", "\n", "\x01", "\x1f", "\x7f",
+                                          "\xc3\xa4", "\xe2\x82\xac", "\xf0\x9f\x98\x80"};
+
+  for (bool native : {true, false}) {
+    // modify global function pointers!
+    if (native) {
+      enableNativeStringFunctions();
+    } else {
+      enableBuiltinStringFunctions();
+    }
+
+    for (std::size_t length : {0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100}) {
+      std::string const base(length, 'a');
+      checkEscaping(base);
+      for (auto const& special : specials) {
+        for (std::size_t pos = 0; pos <= length; ++pos) {
+          std::string value(base);
+          value.insert(pos, special);
+          checkEscaping(value);
+        }
+        // many special characters in a row, and at the end
+        checkEscaping(base + special + special + special);
+        checkEscaping(special + base + special);
+      }
+    }
+  }
+  enableNativeStringFunctions();
+}
+
 TEST(StringDumperTest, AppendStringSlice1) {
   Options options;
   options.escapeForwardSlashes = true;
@@ -1522,6 +1773,201 @@ TEST(DumperTest, EmptyAttributeName) {
   ASSERT_EQ(std::string(R"({"":123,"a":"abc"})"), buffer);
 }
 
+TEST(DumperTest, OutputLargerThanStagingBuffer) {
+  // mix short values, strings of various lengths around the size of the
+  // Dumper's staging buffer and custom values written directly to the sink
+  struct MyCustomTypeHandler : public CustomTypeHandler {
+    void dump(Slice const&, Dumper* dumper, Slice const&) override {
+      dumper->sink()->append("\"custom\"", 8);
+    }
+  };
+
+  MyCustomTypeHandler handler;
+  Options options;
+  options.customTypeHandler = &handler;
+
+  std::string expected("[");
+  Builder b(&options);
+  b.openArray();
+  for (std::size_t i = 0; i < 2000; ++i) {
+    if (i > 0) {
+      expected.push_back(',');
+    }
+    if (i % 100 == 0) {
+      std::string value(4000 + i, 'x');
+      b.add(Value(value));
+      expected.append("\"" + value + "\"");
+    } else if (i % 7 == 0) {
+      uint8_t* p = b.add(ValuePair(2ULL, ValueType::Custom));
+      *p++ = 0xf0;
+      *p = 0x01;
+      expected.append("\"custom\"");
+    } else {
+      b.add(Value(i));
+      expected.append(std::to_string(i));
+    }
+  }
+  b.close();
+  expected.push_back(']');
+
+  std::string buffer;
+  StringSink sink(&buffer);
+  Dumper dumper(&sink, &options);
+  dumper.dump(b.slice());
+  ASSERT_EQ(expected, buffer);
+
+  // output must reach the sink between calls to the public methods
+  buffer.clear();
+  dumper.appendUInt(12345);
+  ASSERT_EQ("12345", buffer);
+  dumper.appendString("foo");
+  ASSERT_EQ("12345\"foo\"", buffer);
+}
+
+TEST(DumperTest, PartialOutputOnException) {
+  Builder b;
+  b.openArray();
+  b.add(Value("foobar"));
+  b.add(Value(ValueType::MinKey));
+  b.close();
+
+  std::string buffer;
+  StringSink sink(&buffer);
+  Dumper dumper(&sink);
+  ASSERT_VELOCYPACK_EXCEPTION(dumper.dump(b.slice()),
+                              Exception::NoJsonEquivalent);
+  ASSERT_EQ("[\"foobar\",", buffer);
+}
+
+TEST(DumperTest, OutputLength) {
+  std::string const json(
+      "{\"a\":[1,-2,300,-40000,1.5,1e300,-0.001,18446744073709551615,"
+      "-9223372036854775808,[],{},[[]],{\"x\":{}}],\"b\":\"a/b\\\\c\\\"d\\n"
+      "\\u0001\\u001f\\t\",\"c\":\"m\xc3\xb6t\xc3\xb6r \xe2\x82\xac "
+      "\xf0\x9f\x98\x80\",\"\":null,\"e\":[true,false,null],\"zz\":{\"y\":\"" +
+      std::string(5000, 'y') + "\",\"x\":\"/\"}}");
+
+  for (bool compact : {false, true}) {
+    Options parseOptions;
+    parseOptions.buildUnindexedArrays = compact;
+    parseOptions.buildUnindexedObjects = compact;
+    Parser parser(&parseOptions);
+    parser.parse(json);
+    std::shared_ptr<Builder> builder = parser.steal();
+    Slice slice = builder->slice();
+
+    for (int flags = 0; flags < 16; ++flags) {
+      Options options;
+      options.prettyPrint = (flags & 1) != 0;
+      options.escapeForwardSlashes = (flags & 2) != 0;
+      options.escapeUnicode = (flags & 4) != 0;
+      options.dumpAttributesInIndexOrder = (flags & 8) != 0;
+
+      ASSERT_EQ(Dumper::toString(slice, &options).size(),
+                Dumper::outputLength(slice, &options));
+      for (auto const& it : ObjectIterator(slice)) {
+        ASSERT_EQ(Dumper::toString(it.value, &options).size(),
+                  Dumper::outputLength(it.value, &options));
+      }
+    }
+  }
+}
+
+TEST(DumperTest, OutputLengthUnsupportedTypes) {
+  Builder b;
+  b.openArray();
+  b.add(Value(ValueType::MinKey));
+  b.add(Value(std::nan("1")));
+  b.add(Value(static_cast<int64_t>(12345), ValueType::UTCDate));
+  b.close();
+
+  Options options;
+  ASSERT_VELOCYPACK_EXCEPTION(Dumper::outputLength(b.slice(), &options),
+                              Exception::NoJsonEquivalent);
+
+  for (auto behavior : {Options::NullifyUnsupportedType,
+                        Options::ConvertUnsupportedType}) {
+    options.unsupportedTypeBehavior = behavior;
+    ASSERT_EQ(Dumper::toString(b.slice(), &options).size(),
+              Dumper::outputLength(b.slice(), &options));
+  }
+}
+
+TEST(DumperTest, OutputLengthInvalidUtf8) {
+  Builder b;
+  b.add(Value(std::string("abc\xc3")));
+
+  ASSERT_VELOCYPACK_EXCEPTION(Dumper::outputLength(b.slice()),
+                              Exception::InvalidUtf8Sequence);
+}
+
+TEST(DumperTest, OutputLengthCustomType) {
+  struct MyCustomTypeHandler : public CustomTypeHandler {
+    void dump(Slice const&, Dumper* dumper, Slice const& base) override {
+      dumper->sink()->push_back('"');
+      dumper->sink()->append(base.get("_key").copyString());
+      dumper->sink()->push_back('"');
+    }
+  };
+
+  MyCustomTypeHandler handler;
+  Options options;
+  options.customTypeHandler = &handler;
+  options.prettyPrint = true;
+
+  Builder b(&options);
+  b.openObject();
+  uint8_t* p = b.add("_id", ValuePair(2ULL, ValueType::Custom));
+  *p++ = 0xf0;
+  *p = 0x01;
+  b.add("_key", Value("some key"));
+  b.close();
+
+  ASSERT_EQ(Dumper::toString(b.slice(), &options).size(),
+            Dumper::outputLength(b.slice(), &options));
+
+  options.customTypeHandler = nullptr;
+  ASSERT_VELOCYPACK_EXCEPTION(Dumper::outputLength(b.slice(), &options),
+                              Exception::NeedCustomTypeHandler);
+}
+
+TEST(DumperTest, OutputLengthAttributeTranslations) {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+  translator->add("foo", 1);
+  translator->add("quetzalcoatl", 2);
+  translator->seal();
+
+  AttributeTranslatorScope scope(translator.get());
+
+  Options options;
+  options.attributeTranslator = translator.get();
+
+  Parser parser(&options);
+  parser.parse(R"({"foo":1,"quetzalcoatl":{"foo":[2],"bar":3}})");
+  std::shared_ptr<Builder> builder = parser.steal();
+
+  ASSERT_EQ(Dumper::toString(builder->slice(), &options).size(),
+            Dumper::outputLength(builder->slice(), &options));
+}
+
+TEST(DumperTest, DumpIntoExactlySizedMemory) {
+  std::shared_ptr<Builder> builder =
+      Parser::fromJson(R"({"a":[1,2,3],"b":"foo\nbar","c":{"d":1.25}})");
+  Slice slice = builder->slice();
+
+  ValueLength const length = Dumper::outputLength(slice);
+  std::string result(length, '\0');
+  CharArraySink sink(&result[0], length);
+  Dumper::dump(slice, &sink);
+  ASSERT_EQ(length, sink.length);
+  ASSERT_EQ(Dumper::toString(slice), result);
+
+  // one character less does not fit
+  CharArraySink small(&result[0], length - 1);
+  ASSERT_VELOCYPACK_EXCEPTION(Dumper::dump(slice, &small),
+                              Exception::IndexOutOfBounds);
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -30,6 +30,7 @@ TEST(ExceptionTest, TestMessages) {
   ASSERT_STREQ("Internal error", Exception::message(Exception::InternalError));
   ASSERT_STREQ("Not implemented",
                Exception::message(Exception::NotImplemented));
+  ASSERT_STREQ("I/O error", Exception::message(Exception::IoError));
   ASSERT_STREQ("Type has no equivalent in JSON",
                Exception::message(Exception::NoJsonEquivalent));
   ASSERT_STREQ("Parse error", Exception::message(Exception::ParseError));
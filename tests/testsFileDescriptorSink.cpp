@@ -0,0 +1,290 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+#include "tests-common.h"
+
+#ifndef _WIN32
+
+// a temporary file that is removed when the test ends
+struct TempFile {
+  TempFile() {
+    char name[] = "/tmp/vpack-fd-sink-XXXXXX";
+    fd = ::mkstemp(name);
+    path = name;
+  }
+
+  ~TempFile() {
+    ::close(fd);
+    ::unlink(path.c_str());
+  }
+
+  std::string content() const {
+    std::string result;
+    char buffer[4096];
+    off_t offset = 0;
+    while (true) {
+      ssize_t n = ::pread(fd, buffer, sizeof(buffer), offset);
+      if (n <= 0) {
+        break;
+      }
+      result.append(buffer, static_cast<std::size_t>(n));
+      offset += n;
+    }
+    return result;
+  }
+
+  int fd;
+  std::string path;
+};
+
+// reads everything from the read end of a pipe on a thread of its own
+struct PipeReader {
+  PipeReader() {
+    int fds[2];
+    EXPECT_EQ(0, ::pipe(fds));
+    readFd = fds[0];
+    writeFd = fds[1];
+    thread = std::thread([this]() {
+      char buffer[4096];
+      while (true) {
+        ssize_t n = ::read(readFd, buffer, sizeof(buffer));
+        if (n <= 0) {
+          break;
+        }
+        output.append(buffer, static_cast<std::size_t>(n));
+      }
+    });
+  }
+
+  ~PipeReader() {
+    closeWriteEnd();
+    ::close(readFd);
+  }
+
+  std::string const& finish() {
+    closeWriteEnd();
+    return output;
+  }
+
+  void closeWriteEnd() {
+    if (writeFd != -1) {
+      ::close(writeFd);
+      writeFd = -1;
+    }
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  int readFd;
+  int writeFd;
+  std::string output;
+  std::thread thread;
+};
+
+static Builder makeDocument() {
+  Builder b;
+  b.openArray();
+  for (std::size_t i = 0; i < 2000; ++i) {
+    b.openObject();
+    b.add("_key", Value("k" + std::to_string(i)));
+    b.add("value", Value(i * 0.25));
+    b.add("text", Value(std::string(i % 300, 'x') + "\"\\\n"));
+    b.close();
+  }
+  b.close();
+  return b;
+}
+
+TEST(FileDescriptorSinkTest, InvalidArguments) {
+  ASSERT_VELOCYPACK_EXCEPTION(FileDescriptorSink(-1),
+                              Exception::InternalError);
+  ASSERT_VELOCYPACK_EXCEPTION(FileDescriptorSink(1, 0),
+                              Exception::InternalError);
+}
+
+TEST(FileDescriptorSinkTest, Properties) {
+  FileDescriptorSink sink(1);
+  ASSERT_EQ(1, sink.fd());
+  ASSERT_EQ(FileDescriptorSink::defaultBufferSize, sink.bufferSize());
+  ASSERT_FALSE(sink.writeInBackground());
+  ASSERT_EQ(0UL, sink.length());
+
+  FileDescriptorSink background(1, 128, true);
+  ASSERT_EQ(128UL, background.bufferSize());
+  ASSERT_TRUE(background.writeInBackground());
+}
+
+TEST(FileDescriptorSinkTest, TempFile) {
+  for (bool background : {false, true}) {
+    TempFile file;
+    ASSERT_NE(-1, file.fd);
+
+    std::string expected;
+    FileDescriptorSink sink(file.fd, 64, background);
+    for (std::size_t i = 0; i < 100; ++i) {
+      std::string const s(i, static_cast<char>('a' + i % 26));
+      sink.push_back('[');
+      sink.append(s);
+      sink.append("]");
+      sink.append(s.data(), 1);
+      expected.push_back('[');
+      expected.append(s);
+      expected.append("]");
+      expected.append(s.data(), 1);
+      ASSERT_EQ(expected.size(), sink.length());
+    }
+    sink.flush();
+
+    ASSERT_EQ(expected, file.content());
+    ASSERT_EQ(expected.size(), sink.length());
+  }
+}
+
+TEST(FileDescriptorSinkTest, LargeAppendKeepsOrder) {
+  for (bool background : {false, true}) {
+    TempFile file;
+    ASSERT_NE(-1, file.fd);
+
+    std::string const large(100000, 'L');
+    std::string expected;
+    FileDescriptorSink sink(file.fd, 4096, background);
+    for (std::size_t i = 0; i < 5; ++i) {
+      sink.append("staged");
+      sink.append(large);
+      sink.append(large.data(), 3000);
+      expected.append("staged");
+      expected.append(large);
+      expected.append(large.data(), 3000);
+    }
+    sink.flush();
+
+    ASSERT_EQ(expected, file.content());
+  }
+}
+
+TEST(FileDescriptorSinkTest, DestructorFlushes) {
+  for (bool background : {false, true}) {
+    TempFile file;
+    ASSERT_NE(-1, file.fd);
+
+    {
+      FileDescriptorSink sink(file.fd, 16, background);
+      sink.append("the quick brown fox");
+      sink.push_back('!');
+    }
+
+    ASSERT_EQ("the quick brown fox!", file.content());
+  }
+}
+
+TEST(FileDescriptorSinkTest, DumpToPipe) {
+  Builder b = makeDocument();
+  std::string const expected = Dumper::toString(b.slice());
+
+  for (bool background : {false, true}) {
+    for (std::size_t bufferSize : {100UL, 1000UL, 1024UL * 1024UL}) {
+      PipeReader reader;
+
+      FileDescriptorSink sink(reader.writeFd, bufferSize, background);
+      Dumper dumper(&sink);
+      dumper.dump(b.slice());
+      sink.flush();
+
+      ASSERT_EQ(expected.size(), sink.length());
+      ASSERT_EQ(expected, reader.finish());
+    }
+  }
+}
+
+TEST(FileDescriptorSinkTest, DumpPrettyToTempFile) {
+  Builder b = makeDocument();
+  Options options;
+  options.prettyPrint = true;
+  std::string const expected = Dumper::toString(b.slice(), &options);
+
+  for (bool background : {false, true}) {
+    TempFile file;
+    ASSERT_NE(-1, file.fd);
+
+    FileDescriptorSink sink(file.fd, 8192, background);
+    Dumper dumper(&sink, &options);
+    dumper.dump(b.slice());
+    sink.flush();
+
+    ASSERT_EQ(expected, file.content());
+  }
+}
+
+TEST(FileDescriptorSinkTest, WriteError) {
+  int fd = ::open("/dev/null", O_RDONLY);
+  ASSERT_NE(-1, fd);
+
+  {
+    FileDescriptorSink sink(fd, 16);
+    sink.append("0123456789");
+    ASSERT_VELOCYPACK_EXCEPTION(sink.flush(), Exception::IoError);
+    // the sink stays failed
+    ASSERT_VELOCYPACK_EXCEPTION(sink.flush(), Exception::IoError);
+    ASSERT_VELOCYPACK_EXCEPTION(sink.append(std::string(100, 'x')),
+                                Exception::IoError);
+  }
+
+  {
+    FileDescriptorSink sink(fd, 16, true);
+    // the full buffer is written by the background thread. its error is
+    // reported by the next call that waits for it
+    for (std::size_t i = 0; i < 17; ++i) {
+      sink.push_back('x');
+    }
+    ASSERT_VELOCYPACK_EXCEPTION(sink.flush(), Exception::IoError);
+    ASSERT_VELOCYPACK_EXCEPTION(sink.flush(), Exception::IoError);
+  }
+
+  {
+    // the destructor does not throw
+    FileDescriptorSink sink(fd, 16, true);
+    sink.append("0123456789");
+  }
+
+  ::close(fd);
+}
+
+#endif
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
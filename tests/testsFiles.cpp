@@ -25,47 +25,10 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <ostream>
-#include <fstream>
 #include <string>
 
 #include "tests-common.h"
 
-static std::string tryReadFile(std::string const& filename) {
-  std::string s;
-  std::ifstream ifs(filename.c_str(), std::ifstream::in);
-
-  if (!ifs.is_open()) {
-    throw "cannot open input file";
-  }
-
-  char buffer[4096];
-  while (ifs.good()) {
-    ifs.read(&buffer[0], sizeof(buffer));
-    s.append(buffer, ifs.gcount());
-  }
-  ifs.close();
-
-  return s;
-}
-
-static std::string readFile(std::string filename) {
-#ifdef _WIN32
-  std::string const separator("\\");
-#else
-  std::string const separator("/");
-#endif
-  filename = "tests" + separator + "jsonSample" + separator + filename;
-
-  for (std::size_t i = 0; i < 3; ++i) {
-    try {
-      return tryReadFile(filename);
-    } catch (...) {
-      filename = ".." + separator + filename;
-    }
-  }
-  throw "cannot open input file";
-}
-
 static bool parseFile(std::string const& filename) {
   std::string const data = readFile(filename);
 
@@ -0,0 +1,324 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+static Builder makeDocuments(std::size_t n, Options const* options = &Options::Defaults) {
+  Builder b(options);
+  b.openArray();
+  for (std::size_t i = 0; i < n; ++i) {
+    b.openObject();
+    b.add("_key", Value("k" + std::to_string(i)));
+    b.add("group", Value(i % 10));
+    b.add("value", Value(i));
+    b.close();
+  }
+  b.close();
+  return b;
+}
+
+TEST(HashIndexTest, InvalidType) {
+  Builder b;
+  b.add(Value("foo"));
+
+  ASSERT_VELOCYPACK_EXCEPTION(HashIndex(b.slice(), CompiledPath("a")), Exception::InvalidValueType);
+  ASSERT_VELOCYPACK_EXCEPTION(HashIndex::fromBinary(b.slice()), Exception::InvalidValueType);
+}
+
+TEST(HashIndexTest, Empty) {
+  HashIndex index(Slice::emptyArraySlice(), CompiledPath("_key"));
+  ASSERT_EQ(0UL, index.size());
+  ASSERT_FALSE(index.isPositional());
+  ASSERT_TRUE(index.slice().isBinary());
+  ASSERT_TRUE(index.find(Slice::emptyArraySlice(), StringRef("k1")).isNone());
+}
+
+TEST(HashIndexTest, FindInArray) {
+  Options options;
+  for (bool compact : {false, true}) {
+    options.buildUnindexedArrays = compact;
+    options.buildUnindexedObjects = compact;
+    Builder b = makeDocuments(5000, &options);
+    Slice array = b.slice();
+
+    HashIndex index(array, CompiledPath("_key"));
+    ASSERT_EQ(5000UL, index.size());
+    ASSERT_FALSE(index.isPositional());
+    ASSERT_EQ("/_key", index.path().toString());
+
+    for (std::size_t i = 0; i < 5000; ++i) {
+      Slice found = index.find(array, StringRef("k" + std::to_string(i)));
+      ASSERT_TRUE(found.isObject());
+      ASSERT_EQ(i, found.get("value").getUInt());
+      // the result points into the Array
+      ASSERT_TRUE(found.start() > array.start() && found.start() < array.start() + array.byteSize());
+    }
+    ASSERT_TRUE(index.find(array, StringRef("k5000")).isNone());
+    ASSERT_TRUE(index.find(array, StringRef("")).isNone());
+    ASSERT_TRUE(index.find(array, Slice::nullSlice()).isNone());
+    ASSERT_TRUE(index.find(array, Slice()).isNone());
+  }
+}
+
+TEST(HashIndexTest, DuplicatesAndMissingKeys) {
+  std::shared_ptr<Builder> b = Parser::fromJson(
+      "[{\"a\":1,\"n\":0},{\"a\":1.0,\"n\":1},{\"b\":1,\"n\":2},{\"a\":\"1\",\"n\":3},"
+      "{\"a\":null,\"n\":4},{\"a\":1,\"n\":5},{\"a\":{\"x\":[1,2]},\"n\":6}]");
+  Slice array = b->slice();
+
+  HashIndex index(array, CompiledPath("a"));
+  // the member without the attribute is not indexed
+  ASSERT_EQ(6UL, index.size());
+
+  Builder key;
+  key.add(Value(1));
+  std::vector<Slice> found;
+  ASSERT_EQ(3UL, index.findAll(array, key.slice(), found));
+  ASSERT_EQ(3UL, found.size());
+  ASSERT_EQ(0UL, found[0].get("n").getUInt());
+  ASSERT_EQ(1UL, found[1].get("n").getUInt());
+  ASSERT_EQ(5UL, found[2].get("n").getUInt());
+  ASSERT_EQ(0UL, index.find(array, key.slice()).get("n").getUInt());
+
+  ASSERT_EQ(3UL, index.find(array, StringRef("1")).get("n").getUInt());
+  ASSERT_EQ(4UL, index.find(array, Slice::nullSlice()).get("n").getUInt());
+
+  std::shared_ptr<Builder> object = Parser::fromJson("{\"x\":[1.0,2]}");
+  ASSERT_EQ(6UL, index.find(array, object->slice()).get("n").getUInt());
+}
+
+TEST(HashIndexTest, DateKeys) {
+  Builder b;
+  b.openArray();
+  for (int64_t i = 0; i < 100; ++i) {
+    b.openObject();
+    b.add("d", Value(1500000000000 + (i % 10) * 86400000, ValueType::UTCDate));
+    b.add("n", Value(i));
+    b.close();
+  }
+  b.close();
+  Slice array = b.slice();
+
+  HashIndex index(array, CompiledPath("d"));
+  ASSERT_EQ(100UL, index.size());
+
+  Builder key;
+  key.add(Value(1500000000000 + 3 * 86400000, ValueType::UTCDate));
+  std::vector<Slice> found;
+  ASSERT_EQ(10UL, index.findAll(array, key.slice(), found));
+  for (std::size_t i = 0; i < found.size(); ++i) {
+    ASSERT_EQ(3 + i * 10, found[i].get("n").getUInt());
+  }
+  ASSERT_EQ(3UL, index.find(array, key.slice()).get("n").getUInt());
+
+  // a number with the same value is not a date
+  Builder number;
+  number.add(Value(1500000000000 + 3 * 86400000));
+  ASSERT_TRUE(index.find(array, number.slice()).isNone());
+}
+
+TEST(HashIndexTest, NestedPath) {
+  std::shared_ptr<Builder> b = Parser::fromJson(
+      "[{\"user\":{\"ids\":[7,8]}},{\"user\":{\"ids\":[9]}},{\"user\":{}}]");
+  HashIndex index(b->slice(), CompiledPath("$.user.ids[0]"));
+  ASSERT_EQ(2UL, index.size());
+
+  Builder key;
+  key.add(Value(9));
+  ASSERT_EQ("{\"user\":{\"ids\":[9]}}", index.find(b->slice(), key.slice()).toJson());
+}
+
+TEST(HashIndexTest, FindInVector) {
+  Builder b = makeDocuments(1000);
+  std::vector<Slice> documents;
+  for (ValueLength i = 0; i < 1000; i += 3) {
+    documents.push_back(b.slice().at(i));
+  }
+
+  HashIndex index(documents, CompiledPath("group"));
+  ASSERT_TRUE(index.isPositional());
+  ASSERT_EQ(documents.size(), index.size());
+
+  for (uint64_t g = 0; g < 10; ++g) {
+    Builder key;
+    key.add(Value(g));
+    std::vector<Slice> found;
+    index.findAll(documents, key.slice(), found);
+    ASSERT_FALSE(found.empty());
+    uint64_t last = 0;
+    for (auto const& s : found) {
+      ASSERT_EQ(g, s.get("group").getUInt());
+      ASSERT_EQ(0UL, s.get("value").getUInt() % 3);
+      ASSERT_TRUE(found.size() == 1 || s.get("value").getUInt() >= last);
+      last = s.get("value").getUInt();
+    }
+    ASSERT_TRUE(found[0].binaryEquals(index.find(documents, key.slice())));
+  }
+
+  // data of the wrong kind
+  ASSERT_VELOCYPACK_EXCEPTION(index.find(b.slice(), StringRef("k1")), Exception::InvalidValueType);
+  HashIndex arrayIndex(b.slice(), CompiledPath("_key"));
+  ASSERT_VELOCYPACK_EXCEPTION(arrayIndex.find(documents, StringRef("k1")), Exception::InvalidValueType);
+  // data of a different size
+  documents.pop_back();
+  ASSERT_VELOCYPACK_EXCEPTION(index.find(documents, StringRef("k1")), Exception::InvalidValueType);
+}
+
+TEST(HashIndexTest, Persistence) {
+  Builder data = makeDocuments(2000);
+
+  std::string stored;
+  {
+    HashIndex index(data.slice(), CompiledPath("_key"));
+    // store the index next to the data
+    Builder b;
+    b.openObject();
+    b.add("index", index.slice());
+    b.close();
+    stored.assign(reinterpret_cast<char const*>(b.slice().start()), b.slice().byteSize());
+  }
+
+  Slice persisted(reinterpret_cast<uint8_t const*>(stored.data()));
+  HashIndex index = HashIndex::fromBinary(persisted.get("index"));
+  ASSERT_EQ(2000UL, index.size());
+  ASSERT_EQ("/_key", index.path().toString());
+  // the index uses the persisted data in place
+  ASSERT_EQ(persisted.get("index").start(), index.slice().start());
+
+  for (std::size_t i = 0; i < 2000; i += 7) {
+    Slice found = index.find(data.slice(), StringRef("k" + std::to_string(i)));
+    ASSERT_EQ(i, found.get("value").getUInt());
+  }
+
+  // copies of an owning index are independent of the original
+  HashIndex original(data.slice(), CompiledPath("value"));
+  HashIndex copy(original);
+  original = HashIndex(Slice::emptyArraySlice(), CompiledPath("value"));
+  Builder key;
+  key.add(Value(17));
+  ASSERT_EQ("k17", copy.find(data.slice(), key.slice()).get("_key").copyString());
+  ASSERT_TRUE(copy.slice().binaryEquals(HashIndex(data.slice(), CompiledPath("value")).slice()));
+}
+
+TEST(HashIndexTest, InvalidBinary) {
+  Builder data = makeDocuments(10);
+  HashIndex index(data.slice(), CompiledPath("_key"));
+  ValueLength length;
+  uint8_t const* p = index.slice().getBinary(length);
+  std::string bytes(reinterpret_cast<char const*>(p), length);
+
+  auto check = [](std::string const& value) {
+    Builder b;
+    b.add(ValuePair(value.data(), value.size(), ValueType::Binary));
+    return HashIndex::fromBinary(b.slice()).size();
+  };
+  ASSERT_EQ(10UL, check(bytes));
+
+  ASSERT_VELOCYPACK_EXCEPTION(check(bytes.substr(0, 20)), Exception::InvalidValueType);
+  ASSERT_VELOCYPACK_EXCEPTION(check(bytes.substr(0, bytes.size() - 16)), Exception::InvalidValueType);
+  std::string corrupt(bytes);
+  corrupt[0] = 'X';
+  ASSERT_VELOCYPACK_EXCEPTION(check(corrupt), Exception::InvalidValueType);
+  corrupt = bytes;
+  corrupt[4] = 99;
+  ASSERT_VELOCYPACK_EXCEPTION(check(corrupt), Exception::InvalidValueType);
+  corrupt = bytes;
+  ASSERT_NE(0, corrupt[6]);
+  corrupt[6] = (corrupt[6] == 1) ? 2 : 1;  // built with the other hash function
+  ASSERT_VELOCYPACK_EXCEPTION(check(corrupt), Exception::InvalidValueType);
+  corrupt[6] = 0;
+  ASSERT_VELOCYPACK_EXCEPTION(check(corrupt), Exception::InvalidValueType);
+  corrupt = bytes;
+  corrupt[16] = 3;  // number of slots is not a power of two
+  ASSERT_VELOCYPACK_EXCEPTION(check(corrupt), Exception::InvalidValueType);
+
+  // the slots start behind the header and the padded path "/_key"
+  std::size_t const slotsStart = 40 + 8;
+  std::size_t const slotCount = (bytes.size() - slotsStart) / 16;
+  std::size_t firstUsed = 0;
+  while (readUInt64(reinterpret_cast<uint8_t const*>(&bytes[slotsStart + firstUsed * 16 + 8])) == 0) {
+    ++firstUsed;
+  }
+
+  // location beyond the data
+  corrupt = bytes;
+  storeUInt64(reinterpret_cast<uint8_t*>(&corrupt[slotsStart + firstUsed * 16 + 8]),
+              data.slice().byteSize());
+  ASSERT_VELOCYPACK_EXCEPTION(check(corrupt), Exception::InvalidValueType);
+
+  // no empty slot, which would make lookups probe forever
+  corrupt = bytes;
+  for (std::size_t i = 0; i < slotCount; ++i) {
+    if (readUInt64(reinterpret_cast<uint8_t const*>(&corrupt[slotsStart + i * 16 + 8])) == 0) {
+      storeUInt64(reinterpret_cast<uint8_t*>(&corrupt[slotsStart + i * 16 + 8]), 1);
+    }
+  }
+  storeUInt64(reinterpret_cast<uint8_t*>(&corrupt[8]), slotCount);
+  ASSERT_VELOCYPACK_EXCEPTION(check(corrupt), Exception::InvalidValueType);
+
+  // number of used slots differs from the stored size
+  corrupt = bytes;
+  storeUInt64(reinterpret_cast<uint8_t*>(&corrupt[8]), 11);
+  ASSERT_VELOCYPACK_EXCEPTION(check(corrupt), Exception::InvalidValueType);
+}
+
+TEST(HashIndexTest, PersistedPaths) {
+  std::shared_ptr<Builder> data = Parser::fromJson(
+      "[{\"a\":[1,2,30],\"*\":\"x\"},{\"a\":[4,5,60],\"*\":\"y\"}]");
+
+  for (char const* expression : {"$.a[-1]", "$['*']"}) {
+    HashIndex original(data->slice(), CompiledPath(expression));
+    Builder b;
+    b.add(original.slice());
+    HashIndex index = HashIndex::fromBinary(b.slice());
+
+    ASSERT_EQ(original.path().steps().size(), index.path().steps().size());
+    for (std::size_t i = 0; i < index.path().size(); ++i) {
+      ASSERT_EQ(original.path().steps()[i].type, index.path().steps()[i].type);
+      ASSERT_EQ(original.path().steps()[i].name, index.path().steps()[i].name);
+      ASSERT_EQ(original.path().steps()[i].index, index.path().steps()[i].index);
+    }
+  }
+
+  HashIndex byIndex = HashIndex::fromBinary(
+      Builder::clone(HashIndex(data->slice(), CompiledPath("$.a[-1]")).slice()).slice());
+  Builder key;
+  key.add(Value(60));
+  ASSERT_EQ("y", byIndex.find(data->slice(), key.slice()).get("*").copyString());
+
+  HashIndex byStar = HashIndex::fromBinary(
+      Builder::clone(HashIndex(data->slice(), CompiledPath("$['*']")).slice()).slice());
+  ASSERT_EQ(30UL, byStar.find(data->slice(), StringRef("x")).get("a").at(2).getUInt());
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -666,6 +666,86 @@ TEST(LookupTest, LookupLinear) {
   ASSERT_EQ(3ULL, v.getUInt());
 }
 
+TEST(LookupTest, LookupLinearSimilarKeys) {
+  // keys with identical lengths and identical first characters must
+  // all be compared in full
+  std::string value("{");
+  for (std::size_t i = 0; i < 40; ++i) {
+    if (i > 0) {
+      value.append(",");
+    }
+    value.append("\"k");
+    value.append(std::to_string(100 + i));
+    value.append("\":");
+    value.append(std::to_string(i));
+  }
+  value.append(",\"\":\"empty\"");
+  value.append(",\"");
+  value.append(std::string(200, 'k'));
+  value.append("\":\"long\"}");
+
+  Parser parser;
+  parser.parse(value);
+  std::shared_ptr<Builder> builder = parser.steal();
+
+  // turn the sorted object into an unsorted one, so lookups are linear
+  uint8_t* data = builder->buffer()->data();
+  ASSERT_TRUE(data[0] >= 0x0b && data[0] <= 0x0e);
+  data[0] += 4;
+  Slice s(data);
+  ASSERT_TRUE(s.isObject());
+  ASSERT_FALSE(s.isSorted());
+
+  for (std::size_t i = 0; i < 40; ++i) {
+    std::string key = "k";
+    key.append(std::to_string(100 + i));
+    Slice v = s.get(key);
+    ASSERT_TRUE(v.isNumber());
+    ASSERT_EQ(i, v.getUInt());
+  }
+
+  ASSERT_EQ("empty", s.get("").copyString());
+  ASSERT_EQ("long", s.get(std::string(200, 'k')).copyString());
+
+  ASSERT_TRUE(s.get("k99").isNone());
+  ASSERT_TRUE(s.get("k140").isNone());
+  ASSERT_TRUE(s.get("x100").isNone());
+  ASSERT_TRUE(s.get("k1000").isNone());
+  ASSERT_TRUE(s.get(std::string(199, 'k')).isNone());
+  ASSERT_TRUE(s.get(std::string(201, 'k')).isNone());
+}
+
+TEST(LookupTest, LookupCompactSimilarKeys) {
+  Options options;
+  options.buildUnindexedObjects = true;
+
+  Builder b(&options);
+  b.openObject();
+  for (std::size_t i = 0; i < 40; ++i) {
+    b.add("k" + std::to_string(100 + i), Value(i));
+  }
+  b.add("", Value("empty"));
+  b.add(std::string(200, 'k'), Value("long"));
+  b.close();
+
+  Slice s(b.start());
+  ASSERT_EQ(0x14, s.head());
+
+  for (std::size_t i = 0; i < 40; ++i) {
+    Slice v = s.get("k" + std::to_string(100 + i));
+    ASSERT_TRUE(v.isNumber());
+    ASSERT_EQ(i, v.getUInt());
+  }
+
+  ASSERT_EQ("empty", s.get("").copyString());
+  ASSERT_EQ("long", s.get(std::string(200, 'k')).copyString());
+
+  ASSERT_TRUE(s.get("k99").isNone());
+  ASSERT_TRUE(s.get("k140").isNone());
+  ASSERT_TRUE(s.get("x100").isNone());
+  ASSERT_TRUE(s.get(std::string(199, 'k')).isNone());
+}
+
 TEST(LookupTest, LookupBinary) {
   std::string value("{");
   for (std::size_t i = 0; i < 128; ++i) {
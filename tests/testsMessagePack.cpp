@@ -0,0 +1,341 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+static std::string toMessagePack(Value const& value) {
+  Builder b;
+  b.add(value);
+  return MessagePackDumper::toString(b.slice());
+}
+
+// converts the JSON into VPack, the VPack into MessagePack and back, and
+// checks that the result dumps to the same JSON
+static void checkRoundTrip(std::string const& json) {
+  std::shared_ptr<Builder> original = Parser::fromJson(json);
+  std::string const encoded = MessagePackDumper::toString(original->slice());
+  std::shared_ptr<Builder> decoded =
+      MessagePackParser::fromMessagePack(encoded);
+
+  ASSERT_EQ(Dumper::toString(original->slice()),
+            Dumper::toString(decoded->slice()));
+}
+
+TEST(MessagePackTest, DumpScalars) {
+  ASSERT_EQ(bytes({0xc0}), toMessagePack(Value(ValueType::Null)));
+  ASSERT_EQ(bytes({0xc2}), toMessagePack(Value(false)));
+  ASSERT_EQ(bytes({0xc3}), toMessagePack(Value(true)));
+  ASSERT_EQ(bytes({0xcb, 0x3f, 0xf8, 0, 0, 0, 0, 0, 0}),
+            toMessagePack(Value(1.5)));
+  ASSERT_EQ(bytes({0xa3, 'f', 'o', 'o'}), toMessagePack(Value("foo")));
+  ASSERT_EQ(bytes({0xc4, 0x02, 0x01, 0x02}),
+            toMessagePack(Value(std::string("\x01\x02"), ValueType::Binary)));
+}
+
+TEST(MessagePackTest, DumpIntegers) {
+  ASSERT_EQ(bytes({0x00}), toMessagePack(Value(0)));
+  ASSERT_EQ(bytes({0x7f}), toMessagePack(Value(127)));
+  ASSERT_EQ(bytes({0xcc, 0x80}), toMessagePack(Value(128)));
+  ASSERT_EQ(bytes({0xcc, 0xff}), toMessagePack(Value(255)));
+  ASSERT_EQ(bytes({0xcd, 0x01, 0x00}), toMessagePack(Value(256)));
+  ASSERT_EQ(bytes({0xcd, 0xff, 0xff}), toMessagePack(Value(65535)));
+  ASSERT_EQ(bytes({0xce, 0x00, 0x01, 0x00, 0x00}),
+            toMessagePack(Value(65536)));
+  ASSERT_EQ(bytes({0xce, 0xff, 0xff, 0xff, 0xff}),
+            toMessagePack(Value(UINT64_C(4294967295))));
+  ASSERT_EQ(bytes({0xcf, 0, 0, 0, 0x01, 0, 0, 0, 0}),
+            toMessagePack(Value(UINT64_C(4294967296))));
+  ASSERT_EQ(bytes({0xcf, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff}),
+            toMessagePack(Value(UINT64_MAX)));
+
+  ASSERT_EQ(bytes({0xff}), toMessagePack(Value(-1)));
+  ASSERT_EQ(bytes({0xe0}), toMessagePack(Value(-32)));
+  ASSERT_EQ(bytes({0xd0, 0xdf}), toMessagePack(Value(-33)));
+  ASSERT_EQ(bytes({0xd0, 0x80}), toMessagePack(Value(-128)));
+  ASSERT_EQ(bytes({0xd1, 0xff, 0x7f}), toMessagePack(Value(-129)));
+  ASSERT_EQ(bytes({0xd1, 0x80, 0x00}), toMessagePack(Value(-32768)));
+  ASSERT_EQ(bytes({0xd2, 0xff, 0xff, 0x7f, 0xff}),
+            toMessagePack(Value(-32769)));
+  ASSERT_EQ(bytes({0xd2, 0x80, 0, 0, 0}),
+            toMessagePack(Value(static_cast<int64_t>(INT32_MIN))));
+  ASSERT_EQ(bytes({0xd3, 0xff, 0xff, 0xff, 0xff, 0x7f, 0xff, 0xff, 0xff}),
+            toMessagePack(Value(static_cast<int64_t>(INT32_MIN) - 1)));
+  ASSERT_EQ(bytes({0xd3, 0x80, 0, 0, 0, 0, 0, 0, 0}),
+            toMessagePack(Value(INT64_MIN)));
+}
+
+TEST(MessagePackTest, DumpLengths) {
+  for (std::size_t length : {0, 31, 32, 255, 256, 65535, 65536}) {
+    std::string const value(length, 'x');
+    std::string const encoded = toMessagePack(Value(value));
+    std::size_t head;
+    if (length < 32) {
+      ASSERT_EQ(static_cast<char>(0xa0 | length), encoded[0]);
+      head = 1;
+    } else if (length <= 255) {
+      ASSERT_EQ(static_cast<char>(0xd9), encoded[0]);
+      head = 2;
+    } else if (length <= 65535) {
+      ASSERT_EQ(static_cast<char>(0xda), encoded[0]);
+      head = 3;
+    } else {
+      ASSERT_EQ(static_cast<char>(0xdb), encoded[0]);
+      head = 5;
+    }
+    ASSERT_EQ(head + length, encoded.size());
+    ASSERT_EQ(value, encoded.substr(head));
+  }
+
+  for (std::size_t length : {0, 15, 16, 65535, 65536}) {
+    Builder b;
+    b.openArray();
+    for (std::size_t i = 0; i < length; ++i) {
+      b.add(Value(1));
+    }
+    b.close();
+    std::string const encoded = MessagePackDumper::toString(b.slice());
+    if (length < 16) {
+      ASSERT_EQ(static_cast<char>(0x90 | length), encoded[0]);
+      ASSERT_EQ(1 + length, encoded.size());
+    } else if (length <= 65535) {
+      ASSERT_EQ(static_cast<char>(0xdc), encoded[0]);
+      ASSERT_EQ(3 + length, encoded.size());
+    } else {
+      ASSERT_EQ(static_cast<char>(0xdd), encoded[0]);
+      ASSERT_EQ(5 + length, encoded.size());
+    }
+  }
+
+  Builder b;
+  b.openObject();
+  for (std::size_t i = 0; i < 16; ++i) {
+    b.add(std::string(1, static_cast<char>('a' + i)), Value(i));
+  }
+  b.close();
+  std::string const encoded = MessagePackDumper::toString(b.slice());
+  ASSERT_EQ(bytes({0xde, 0x00, 0x10, 0xa1, 'a', 0x00}), encoded.substr(0, 6));
+  ASSERT_EQ(3 + 16 * 3, encoded.size());
+}
+
+TEST(MessagePackTest, DumpUTCDate) {
+  auto date = [](int64_t v) {
+    return toMessagePack(Value(v, ValueType::UTCDate));
+  };
+
+  // timestamp 32
+  ASSERT_EQ(bytes({0xd6, 0xff, 0x00, 0x00, 0x00, 0x01}), date(1000));
+  // timestamp 64
+  ASSERT_EQ(bytes({0xd7, 0xff, 0x77, 0x35, 0x94, 0x00, 0x00, 0x00, 0x00,
+                   0x01}),
+            date(1500));
+  // timestamp 96, with -2 seconds and 900000000 nanoseconds
+  ASSERT_EQ(bytes({0xc7, 0x0c, 0xff, 0x35, 0xa4, 0xe9, 0x00, 0xff, 0xff,
+                   0xff, 0xff, 0xff, 0xff, 0xff, 0xfe}),
+            date(-1100));
+}
+
+TEST(MessagePackTest, UTCDateRoundTrip) {
+  for (int64_t v : {int64_t(0), int64_t(1), int64_t(999), int64_t(1000),
+                    int64_t(-1), int64_t(-999), int64_t(-1000),
+                    int64_t(-1001), int64_t(1500000000123),
+                    int64_t(17179869183999), int64_t(17179869184000),
+                    INT64_MAX, INT64_MIN, INT64_MIN + 1}) {
+    Builder b;
+    b.add(Value(v, ValueType::UTCDate));
+    std::shared_ptr<Builder> decoded = MessagePackParser::fromMessagePack(
+        MessagePackDumper::toString(b.slice()));
+    ASSERT_TRUE(decoded->slice().isUTCDate());
+    ASSERT_EQ(v, decoded->slice().getUTCDate());
+  }
+}
+
+TEST(MessagePackTest, DumpUnsupportedTypes) {
+  Builder b;
+  b.add(Value(ValueType::MinKey));
+
+  ASSERT_VELOCYPACK_EXCEPTION(MessagePackDumper::toString(b.slice()),
+                              Exception::InvalidValueType);
+
+  Options options;
+  options.unsupportedTypeBehavior = Options::NullifyUnsupportedType;
+  ASSERT_EQ(bytes({0xc0}), MessagePackDumper::toString(b.slice(), &options));
+
+  options.unsupportedTypeBehavior = Options::ConvertUnsupportedType;
+  std::string const expected("(non-representable type min-key)");
+  ASSERT_EQ(std::string(1, static_cast<char>(0xd9)) +
+                std::string(1, static_cast<char>(expected.size())) + expected,
+            MessagePackDumper::toString(b.slice(), &options));
+}
+
+TEST(MessagePackTest, DumpExternal) {
+  Builder inner;
+  inner.add(Value("foo"));
+
+  Builder b;
+  b.openArray();
+  b.add(Value(static_cast<void const*>(inner.slice().start()),
+              ValueType::External));
+  b.close();
+
+  ASSERT_EQ(bytes({0x91, 0xa3, 'f', 'o', 'o'}),
+            MessagePackDumper::toString(b.slice()));
+}
+
+TEST(MessagePackTest, ParseForeignEncodings) {
+  // non-minimal encodings and float32, as other encoders may write them
+  std::string const data = bytes({
+      0x87,                                    // fixmap with 7 entries
+      0xd9, 0x01, 'a', 0xcd, 0x00, 0x01,       // "a": uint16 1
+      0xa1, 'b', 0xd3, 0, 0, 0, 0, 0, 0, 0, 5, // "b": int64 5
+      0xa1, 'c', 0xca, 0x3f, 0xc0, 0, 0,       // "c": float32 1.5
+      0xa1, 'd', 0xdc, 0x00, 0x02, 0xc3, 0xc0, // "d": array16 [true, null]
+      0xa1, 'e', 0xdf, 0, 0, 0, 0,             // "e": map32 {}
+      0xa1, 'f', 0xdb, 0, 0, 0, 1, 'x',        // "f": str32 "x"
+      0xa1, 'g', 0xd0, 0xfe                    // "g": int8 -2
+  });
+
+  std::shared_ptr<Builder> b = MessagePackParser::fromMessagePack(data);
+  ASSERT_EQ("{\"a\":1,\"b\":5,\"c\":1.5,\"d\":[true,null],\"e\":{},"
+            "\"f\":\"x\",\"g\":-2}",
+            Dumper::toString(b->slice()));
+}
+
+TEST(MessagePackTest, ParseBinary) {
+  std::shared_ptr<Builder> b = MessagePackParser::fromMessagePack(
+      bytes({0xc5, 0x00, 0x03, 0x00, 0x01, 0xff}));
+  ASSERT_TRUE(b->slice().isBinary());
+  ASSERT_EQ((std::vector<uint8_t>{0x00, 0x01, 0xff}), b->slice().copyBinary());
+}
+
+TEST(MessagePackTest, ParseErrors) {
+  auto fails = [](std::string const& data) {
+    ASSERT_VELOCYPACK_EXCEPTION(MessagePackParser::fromMessagePack(data),
+                                Exception::ParseError);
+  };
+
+  fails("");
+  fails(bytes({0xc1}));
+  fails(bytes({0xcd, 0x01}));
+  fails(bytes({0xa3, 'f', 'o'}));
+  fails(bytes({0x92, 0x01}));
+  fails(bytes({0xdd, 0xff, 0xff, 0xff, 0xff}));
+  fails(bytes({0x81, 0x01, 0x02}));
+  fails(bytes({0x81, 0xa1, 'a'}));
+  fails(bytes({0xd4, 0x01, 0x00}));
+  fails(bytes({0xd5, 0xff, 0x00, 0x00}));
+  fails(bytes({0xc0, 0xc0}));
+
+  ASSERT_VELOCYPACK_EXCEPTION(
+      MessagePackParser::fromMessagePack(
+          bytes({0xd7, 0xff, 0xff, 0xff, 0xff, 0xfc, 0, 0, 0, 0})),
+      Exception::NumberOutOfRange);
+
+  MessagePackParser parser;
+  try {
+    parser.parse(bytes({0x93, 0x01, 0x02, 0xc1}));
+    ASSERT_TRUE(false);
+  } catch (Exception const& ex) {
+    ASSERT_EQ(Exception::ParseError, ex.errorCode());
+    ASSERT_EQ(3UL, parser.errorPos());
+  }
+}
+
+TEST(MessagePackTest, ParseInvalidUtf8) {
+  std::string const data = bytes({0x81, 0xa1, 'a', 0xa2, 0xc3, 0x28});
+
+  ASSERT_EQ(2UL, MessagePackParser::fromMessagePack(data)
+                     ->slice()
+                     .get("a")
+                     .getStringLength());
+
+  Options options;
+  options.validateUtf8Strings = true;
+  ASSERT_VELOCYPACK_EXCEPTION(
+      MessagePackParser::fromMessagePack(data, &options),
+      Exception::InvalidUtf8Sequence);
+}
+
+TEST(MessagePackTest, ParseMulti) {
+  std::string const data = bytes({0x01, 0xa1, 'x', 0x90});
+
+  MessagePackParser parser;
+  ASSERT_EQ(3UL, parser.parse(data, true));
+
+  std::vector<std::string> values;
+  Slice s = parser.builder().slice();
+  for (std::size_t i = 0; i < 3; ++i) {
+    values.push_back(Dumper::toString(s));
+    s = Slice(s.start() + s.byteSize());
+  }
+  ASSERT_EQ((std::vector<std::string>{"1", "\"x\"", "[]"}), values);
+}
+
+TEST(MessagePackTest, ParseIntoOpenBuilder) {
+  Builder b;
+  b.openObject();
+  b.add("before", Value(1));
+  b.add(Value("value"));
+
+  Options options;
+  options.clearBuilderBeforeParse = false;
+  MessagePackParser parser(b, &options);
+  parser.parse(bytes({0x92, 0x01, 0xa1, 'x'}));
+
+  b.add("after", Value(2));
+  b.close();
+
+  ASSERT_EQ("{\"after\":2,\"before\":1,\"value\":[1,\"x\"]}",
+            Dumper::toString(b.slice()));
+}
+
+TEST(MessagePackTest, RoundTripValues) {
+  checkRoundTrip("null");
+  checkRoundTrip("[]");
+  checkRoundTrip("{}");
+  checkRoundTrip("[1,-1,0,127,128,-32,-33,65536,-2147483649,"
+                 "18446744073709551615,-9223372036854775808]");
+  checkRoundTrip("[1.5,-0.0,1e300,5e-324,0.1]");
+  checkRoundTrip("{\"a\":{\"b\":[{\"c\":\"d\"},[],{}]},\"\":\"\"}");
+}
+
+TEST(MessagePackTest, RoundTripSampleFiles) {
+  for (char const* file :
+       {"api-docs.json", "commits.json", "countries.json",
+        "directory-tree.json", "doubles-small.json", "file-list.json",
+        "object.json", "pass1.json", "pass2.json", "pass3.json",
+        "random1.json", "random2.json", "random3.json", "sample.json",
+        "small.json"}) {
+    checkRoundTrip(readFile(file));
+  }
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
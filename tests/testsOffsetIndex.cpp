@@ -0,0 +1,180 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <string>
+
+#include "tests-common.h"
+
+TEST(OffsetIndexTest, InvalidType) {
+  Builder b;
+  b.add(Value("foo"));
+
+  ASSERT_VELOCYPACK_EXCEPTION(OffsetIndex(b.slice()), Exception::InvalidValueType);
+}
+
+TEST(OffsetIndexTest, CompactArray) {
+  Options options;
+  options.buildUnindexedArrays = true;
+
+  Builder b(&options);
+  b.openArray();
+  for (uint64_t i = 0; i < 1000; ++i) {
+    if (i % 3 == 0) {
+      b.add(Value("value" + std::to_string(i)));
+    } else {
+      b.add(Value(i));
+    }
+  }
+  b.close();
+
+  Slice s = b.slice();
+  ASSERT_EQ(0x13, s.head());
+
+  OffsetIndex index(s);
+  ASSERT_TRUE(index.isCompact());
+  ASSERT_FALSE(index.isBuilt());
+  ASSERT_EQ(1000ULL, index.length());
+
+  for (uint64_t i = 0; i < 1000; ++i) {
+    Slice v = index.at(i);
+    ASSERT_TRUE(index.isBuilt());
+    ASSERT_EQ(s.at(i).start(), v.start());
+    ASSERT_EQ(s.getNthOffset(i), index.getNthOffset(i));
+    if (i % 3 == 0) {
+      ASSERT_EQ("value" + std::to_string(i), v.copyString());
+    } else {
+      ASSERT_EQ(i, v.getUInt());
+    }
+  }
+  // backwards
+  for (uint64_t i = 1000; i > 0; --i) {
+    ASSERT_EQ(s.at(i - 1).start(), index[i - 1].start());
+  }
+
+  ASSERT_VELOCYPACK_EXCEPTION(index.at(1000), Exception::IndexOutOfBounds);
+  ASSERT_VELOCYPACK_EXCEPTION(index.keyAt(0), Exception::InvalidValueType);
+  ASSERT_VELOCYPACK_EXCEPTION(index.valueAt(0), Exception::InvalidValueType);
+}
+
+TEST(OffsetIndexTest, CompactArrayEmpty) {
+  Options options;
+  options.buildUnindexedArrays = true;
+
+  Builder b(&options);
+  b.openArray();
+  b.close();
+
+  OffsetIndex index(b.slice());
+  ASSERT_EQ(0ULL, index.length());
+  ASSERT_VELOCYPACK_EXCEPTION(index.at(0), Exception::IndexOutOfBounds);
+}
+
+TEST(OffsetIndexTest, CompactArrayBuildEagerly) {
+  Options options;
+  options.buildUnindexedArrays = true;
+
+  Builder b(&options);
+  b.openArray();
+  b.add(Value(1));
+  b.openArray();
+  b.add(Value(2));
+  b.add(Value(3));
+  b.close();
+  b.add(Value(4));
+  b.close();
+
+  OffsetIndex index(b.slice());
+  ASSERT_FALSE(index.isBuilt());
+  index.build();
+  ASSERT_TRUE(index.isBuilt());
+
+  ASSERT_EQ(1ULL, index.at(0).getUInt());
+  ASSERT_EQ("[2,3]", index.at(1).toJson());
+  ASSERT_EQ(4ULL, index.at(2).getUInt());
+}
+
+TEST(OffsetIndexTest, CompactObject) {
+  Options options;
+  options.buildUnindexedObjects = true;
+
+  Builder b(&options);
+  b.openObject();
+  for (uint64_t i = 0; i < 500; ++i) {
+    b.add("key" + std::to_string(i), Value(i));
+  }
+  b.close();
+
+  Slice s = b.slice();
+  ASSERT_EQ(0x14, s.head());
+
+  OffsetIndex index(s);
+  ASSERT_TRUE(index.isCompact());
+  ASSERT_EQ(500ULL, index.length());
+
+  for (uint64_t i = 0; i < 500; ++i) {
+    ASSERT_EQ("key" + std::to_string(i), index.keyAt(i).copyString());
+    ASSERT_EQ("key" + std::to_string(i), index.keyAt(i, false).copyString());
+    ASSERT_EQ(i, index.valueAt(i).getUInt());
+  }
+
+  ASSERT_VELOCYPACK_EXCEPTION(index.keyAt(500), Exception::IndexOutOfBounds);
+  ASSERT_VELOCYPACK_EXCEPTION(index.valueAt(500), Exception::IndexOutOfBounds);
+  ASSERT_VELOCYPACK_EXCEPTION(index.at(0), Exception::InvalidValueType);
+}
+
+TEST(OffsetIndexTest, IndexedTypes) {
+  Builder b;
+  b.openObject();
+  b.add("foo", Value(1));
+  b.add("bar", Value(2));
+  b.add("baz", Value(ValueType::Array));
+  b.add(Value(1));
+  b.add(Value("two"));
+  b.close();
+  b.close();
+
+  Slice s = b.slice();
+  OffsetIndex objectIndex(s);
+  ASSERT_FALSE(objectIndex.isCompact());
+  ASSERT_TRUE(objectIndex.isBuilt());
+  ASSERT_EQ(3ULL, objectIndex.length());
+  for (uint64_t i = 0; i < 3; ++i) {
+    ASSERT_EQ(s.keyAt(i).copyString(), objectIndex.keyAt(i).copyString());
+    ASSERT_EQ(s.valueAt(i).start(), objectIndex.valueAt(i).start());
+  }
+
+  OffsetIndex arrayIndex(s.get("baz"));
+  ASSERT_FALSE(arrayIndex.isCompact());
+  ASSERT_EQ(2ULL, arrayIndex.length());
+  ASSERT_EQ(1ULL, arrayIndex.at(0).getUInt());
+  ASSERT_EQ("two", arrayIndex.at(1).copyString());
+  ASSERT_VELOCYPACK_EXCEPTION(arrayIndex.at(2), Exception::IndexOutOfBounds);
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,231 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tests-common.h"
+
+// builds a document with large and small, nested Arrays and Objects
+static Builder makeDocument(Options const* options) {
+  Builder b(options);
+  b.openObject();
+  b.add("name", Value("export/1"));
+  b.add("rows", Value(ValueType::Array));
+  for (std::size_t i = 0; i < 300; ++i) {
+    b.openObject();
+    b.add("_key", Value("k" + std::to_string(i)));
+    b.add("value", Value(i * 1.5));
+    b.add("path", Value("a/b\"c\\" + std::to_string(i)));
+    b.add("tags", Value(ValueType::Array));
+    for (std::size_t j = 0; j < i % 4; ++j) {
+      b.add(Value(j));
+    }
+    b.close();
+    b.close();
+  }
+  b.close();
+  b.add("empty", Value(ValueType::Array));
+  b.close();
+  b.add("matrix", Value(ValueType::Array));
+  for (std::size_t i = 0; i < 20; ++i) {
+    b.openArray();
+    for (std::size_t j = 0; j < 40; ++j) {
+      b.add(Value(static_cast<int64_t>(i * j) - 100));
+    }
+    b.close();
+  }
+  b.close();
+  b.add("meta", Value(ValueType::Object));
+  b.add("count", Value(300));
+  b.add("nested", Value(ValueType::Object));
+  for (std::size_t i = 0; i < 50; ++i) {
+    b.add("attr" + std::to_string(49 - i), Value(std::string(i, 'x')));
+  }
+  b.close();
+  b.close();
+  b.close();
+  return b;
+}
+
+TEST(ParallelDumperTest, CreateWithInvalidArguments) {
+  ASSERT_VELOCYPACK_EXCEPTION(ParallelDumper(nullptr), Exception::InternalError);
+  ASSERT_VELOCYPACK_EXCEPTION(ParallelDumper(&Options::Defaults, 1, 0),
+                              Exception::InternalError);
+
+  ParallelDumper dumper;
+  ASSERT_TRUE(dumper.threads() > 0);
+  ASSERT_VELOCYPACK_EXCEPTION(dumper.dump(Slice::emptyArraySlice(), nullptr),
+                              Exception::InternalError);
+}
+
+TEST(ParallelDumperTest, SmallValues) {
+  ParallelDumper dumper(&Options::Defaults, 2);
+
+  Builder b;
+  b.add(Value("foo\nbar"));
+  ASSERT_EQ("\"foo\\nbar\"", dumper.toString(b.slice()));
+  ASSERT_EQ("[]", dumper.toString(Slice::emptyArraySlice()));
+  ASSERT_EQ("{}", dumper.toString(Slice::emptyObjectSlice()));
+
+  std::shared_ptr<Builder> parsed = Parser::fromJson(R"({"a":[1,2,{"b":null}]})");
+  ASSERT_EQ(R"({"a":[1,2,{"b":null}]})", dumper.toString(parsed->slice()));
+}
+
+TEST(ParallelDumperTest, SameOutputAsDumper) {
+  for (bool prettyPrint : {false, true}) {
+    for (bool compact : {false, true}) {
+      for (bool indexOrder : {false, true}) {
+        Options options;
+        options.prettyPrint = prettyPrint;
+        options.buildUnindexedArrays = compact;
+        options.buildUnindexedObjects = compact;
+        options.dumpAttributesInIndexOrder = indexOrder;
+        options.escapeForwardSlashes = true;
+
+        Builder b = makeDocument(&options);
+        std::string const expected = Dumper::toString(b.slice(), &options);
+
+        for (ValueLength chunkSize : {1, 16, 100, 1000, 1000000}) {
+          for (std::size_t threads : {1, 4}) {
+            ParallelDumper dumper(&options, threads, chunkSize);
+            ASSERT_EQ(expected, dumper.toString(b.slice()));
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(ParallelDumperTest, LargeArray) {
+  Builder b;
+  b.openArray();
+  for (std::size_t i = 0; i < 100000; ++i) {
+    b.add(Value(i % 7 == 0 ? Value("value" + std::to_string(i))
+                           : Value(static_cast<double>(i) / 4)));
+  }
+  b.close();
+
+  ParallelDumper dumper(&Options::Defaults, 4, 4096);
+  ASSERT_EQ(Dumper::toString(b.slice()), dumper.toString(b.slice()));
+}
+
+TEST(ParallelDumperTest, CustomTypeHandlerGetsContainerAsBase) {
+  struct MyCustomTypeHandler : public CustomTypeHandler {
+    void dump(Slice const&, Dumper* dumper, Slice const& base) override {
+      // the key of the Object the custom value is part of
+      dumper->appendString(base.get("_key").copyString());
+      // custom type handlers need not be thread-safe, so they are only
+      // called by the dumping thread
+      if (std::this_thread::get_id() != caller) {
+        ++otherThreads;
+      }
+    }
+
+    std::thread::id caller = std::this_thread::get_id();
+    int otherThreads = 0;
+  };
+
+  MyCustomTypeHandler handler;
+  Options options;
+  options.customTypeHandler = &handler;
+
+  Builder b(&options);
+  b.openArray();
+  for (std::size_t i = 0; i < 100; ++i) {
+    b.openObject();
+    uint8_t* p = b.add("_id", ValuePair(2ULL, ValueType::Custom));
+    *p++ = 0xf0;
+    *p = 0x01;
+    b.add("_key", Value("k" + std::to_string(i)));
+    b.close();
+  }
+  b.close();
+
+  ParallelDumper dumper(&options, 3, 64);
+  std::string const result = dumper.toString(b.slice());
+  ASSERT_EQ(Dumper::toString(b.slice(), &options), result);
+  ASSERT_EQ(0U, result.find(R"([{"_id":"k0","_key":"k0"},{"_id":"k1",)"));
+  ASSERT_EQ(0, handler.otherThreads);
+}
+
+TEST(ParallelDumperTest, ExceptionInRange) {
+  Builder b;
+  b.openArray();
+  for (std::size_t i = 0; i < 1000; ++i) {
+    b.add(Value(i == 700 ? std::nan("1") : static_cast<double>(i)));
+  }
+  b.close();
+
+  ParallelDumper dumper(&Options::Defaults, 4, 100);
+  std::string buffer;
+  StringSink sink(&buffer);
+  ASSERT_VELOCYPACK_EXCEPTION(dumper.dump(b.slice(), &sink),
+                              Exception::NoJsonEquivalent);
+  // the output of the ranges before the failing one was written
+  ASSERT_EQ(0U, buffer.find("[0,1,2,"));
+  ASSERT_EQ(std::string::npos, buffer.find("701"));
+
+  // the dumper can be used again afterwards
+  Builder b2;
+  b2.openArray();
+  for (std::size_t i = 0; i < 1000; ++i) {
+    b2.add(Value(i));
+  }
+  b2.close();
+  ASSERT_EQ(Dumper::toString(b2.slice()), dumper.toString(b2.slice()));
+}
+
+TEST(ParallelDumperTest, ConcurrentDumps) {
+  Options options;
+  Builder b = makeDocument(&options);
+  std::string const expected = Dumper::toString(b.slice(), &options);
+
+  ParallelDumper dumper(&options, 4, 256);
+  std::atomic<int> failures(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 20; ++j) {
+        if (dumper.toString(b.slice()) != expected) {
+          ++failures;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, failures.load());
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,293 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+static std::string const document(
+    "{\"_key\":\"k1\",\"name\":\"test\",\"count\":3,"
+    "\"address\":{\"city\":\"Cologne\",\"zip\":\"50667\","
+    "\"geo\":{\"lat\":50.9,\"lon\":6.9}},"
+    "\"items\":[{\"name\":\"x\",\"price\":1.5},{\"name\":\"y\"},"
+    "{\"price\":2},3,[\"nested\"]],"
+    "\"tags\":[\"a\",\"b\",\"c\"],"
+    "\"map\":{\"0\":true,\"1\":false}}");
+
+// dumps the JSON value with the projection, compact and pretty-printed,
+// and compares the output with the dumped expected JSON
+static void checkProjection(std::string const& json,
+                            Projection const& projection,
+                            std::string const& expected) {
+  std::shared_ptr<Builder> value = Parser::fromJson(json);
+  std::shared_ptr<Builder> result = Parser::fromJson(expected);
+
+  for (bool pretty : {false, true}) {
+    Options options;
+    options.prettyPrint = pretty;
+    std::string const wanted = Dumper::toString(result->slice(), &options);
+
+    options.projection = &projection;
+    ASSERT_EQ(wanted, Dumper::toString(value->slice(), &options));
+    ASSERT_EQ(wanted.size(), Dumper::outputLength(value->slice(), &options));
+  }
+}
+
+TEST(ProjectionTest, InvalidPaths) {
+  ASSERT_VELOCYPACK_EXCEPTION(Projection(std::vector<std::string>{""}),
+                              Exception::InvalidAttributePath);
+  ASSERT_VELOCYPACK_EXCEPTION(
+      Projection(std::vector<std::string>{"a", "$.a[-1]"}),
+      Exception::InvalidAttributePath);
+  ASSERT_VELOCYPACK_EXCEPTION(Projection(std::vector<std::string>{"a..b"}),
+                              Exception::InvalidAttributePath);
+}
+
+TEST(ProjectionTest, Mode) {
+  Projection include(std::vector<std::string>{"a"});
+  ASSERT_EQ(Projection::Mode::Include, include.mode());
+
+  Projection exclude(std::vector<std::string>{"a"},
+                     Projection::Mode::Exclude);
+  ASSERT_EQ(Projection::Mode::Exclude, exclude.mode());
+}
+
+TEST(ProjectionTest, NoPaths) {
+  std::vector<std::string> const paths;
+  checkProjection(document, Projection(paths), "{}");
+  checkProjection(document, Projection(paths, Projection::Mode::Exclude),
+                  document);
+}
+
+TEST(ProjectionTest, IncludeTopLevelLikeKeep) {
+  std::vector<std::string> const keys{"_key", "count", "items", "missing"};
+  std::shared_ptr<Builder> value = Parser::fromJson(document);
+  Builder kept = Collection::keep(value->slice(), keys);
+
+  checkProjection(document, Projection(keys),
+                  Dumper::toString(kept.slice()));
+}
+
+TEST(ProjectionTest, ExcludeTopLevelLikeRemove) {
+  std::vector<std::string> const keys{"_key", "count", "items", "missing"};
+  std::shared_ptr<Builder> value = Parser::fromJson(document);
+  Builder removed = Collection::remove(value->slice(), keys);
+
+  checkProjection(document, Projection(keys, Projection::Mode::Exclude),
+                  Dumper::toString(removed.slice()));
+}
+
+TEST(ProjectionTest, IncludeNestedPaths) {
+  checkProjection(document,
+                  Projection(std::vector<std::string>{
+                      "name", "address.geo.lat", "address.zip", "count.x"}),
+                  "{\"name\":\"test\",\"address\":{\"zip\":\"50667\","
+                  "\"geo\":{\"lat\":50.9}}}");
+}
+
+TEST(ProjectionTest, ExcludeNestedPaths) {
+  checkProjection(document,
+                  Projection(std::vector<std::string>{"address.geo.lat",
+                                                      "address.zip", "items",
+                                                      "tags", "map", "count.x"},
+                             Projection::Mode::Exclude),
+                  "{\"_key\":\"k1\",\"name\":\"test\",\"count\":3,"
+                  "\"address\":{\"city\":\"Cologne\",\"geo\":{\"lon\":6.9}}}");
+}
+
+TEST(ProjectionTest, IncludeArrayWildcard) {
+  // members without the attribute are kept as empty Objects, members that
+  // cannot contain it are left out
+  checkProjection(document,
+                  Projection(std::vector<std::string>{"$.items[*].name"}),
+                  "{\"items\":[{\"name\":\"x\"},{\"name\":\"y\"},{},[]]}");
+}
+
+TEST(ProjectionTest, ExcludeArrayWildcard) {
+  checkProjection(document,
+                  Projection(std::vector<std::string>{"$.items[*].price",
+                                                      "/tags/*", "address",
+                                                      "map"},
+                             Projection::Mode::Exclude),
+                  "{\"_key\":\"k1\",\"name\":\"test\",\"count\":3,"
+                  "\"items\":[{\"name\":\"x\"},{\"name\":\"y\"},{},3,"
+                  "[\"nested\"]],\"tags\":[]}");
+}
+
+TEST(ProjectionTest, ObjectWildcard) {
+  std::string const json(
+      "{\"a\":{\"id\":1,\"x\":2},\"b\":{\"id\":3},\"c\":5,\"d\":[{\"id\":4}]}");
+
+  checkProjection(json, Projection(std::vector<std::string>{"$.*.id"}),
+                  "{\"a\":{\"id\":1},\"b\":{\"id\":3},\"d\":[]}");
+  checkProjection(json,
+                  Projection(std::vector<std::string>{"$.*.id"},
+                             Projection::Mode::Exclude),
+                  "{\"a\":{\"x\":2},\"b\":{},\"c\":5,\"d\":[{\"id\":4}]}");
+  checkProjection(json, Projection(std::vector<std::string>{"$.*.*.id"}),
+                  "{\"a\":{},\"b\":{},\"d\":[{\"id\":4}]}");
+}
+
+TEST(ProjectionTest, WildcardAndNamedPaths) {
+  std::string const json(
+      "{\"a\":{\"x\":1,\"y\":2,\"z\":3},\"b\":{\"x\":4,\"y\":5}}");
+
+  checkProjection(json, Projection(std::vector<std::string>{"a.x", "$.*.y"}),
+                  "{\"a\":{\"x\":1,\"y\":2},\"b\":{\"y\":5}}");
+  checkProjection(json,
+                  Projection(std::vector<std::string>{"a.x", "$.*.y"},
+                             Projection::Mode::Exclude),
+                  "{\"a\":{\"z\":3},\"b\":{\"x\":4}}");
+}
+
+TEST(ProjectionTest, SubtreeAndDeeperPath) {
+  // a selected value is dumped completely, no matter what other paths
+  // select below it
+  checkProjection(document,
+                  Projection(std::vector<std::string>{"address.geo.lat",
+                                                      "address"}),
+                  "{\"address\":{\"city\":\"Cologne\",\"zip\":\"50667\","
+                  "\"geo\":{\"lat\":50.9,\"lon\":6.9}}}");
+}
+
+TEST(ProjectionTest, ArrayIndexes) {
+  checkProjection(document,
+                  Projection(std::vector<std::string>{"$.items[1]",
+                                                      "$.tags[2]",
+                                                      "$.tags[7]"}),
+                  "{\"items\":[{\"name\":\"y\"}],\"tags\":[\"c\"]}");
+  checkProjection(document,
+                  Projection(std::vector<std::string>{"$.tags[0]",
+                                                      "$.items[0].price"},
+                             Projection::Mode::Exclude),
+                  "{\"_key\":\"k1\",\"name\":\"test\",\"count\":3,"
+                  "\"address\":{\"city\":\"Cologne\",\"zip\":\"50667\","
+                  "\"geo\":{\"lat\":50.9,\"lon\":6.9}},"
+                  "\"items\":[{\"name\":\"x\"},{\"name\":\"y\"},"
+                  "{\"price\":2},3,[\"nested\"]],"
+                  "\"tags\":[\"b\",\"c\"],"
+                  "\"map\":{\"0\":true,\"1\":false}}");
+}
+
+TEST(ProjectionTest, JsonPointerDigits) {
+  // JSON Pointer tokens made of digits select array members and
+  // attributes
+  checkProjection(document,
+                  Projection(std::vector<std::string>{"/items/0/name",
+                                                      "/map/1", "/tags/1"}),
+                  "{\"items\":[{\"name\":\"x\"}],\"tags\":[\"b\"],"
+                  "\"map\":{\"1\":false}}");
+}
+
+TEST(ProjectionTest, TopLevelArray) {
+  std::string const json("[{\"a\":1,\"b\":2},{\"a\":3},{\"b\":4},5]");
+
+  checkProjection(json, Projection(std::vector<std::string>{"/*/a"}),
+                  "[{\"a\":1},{\"a\":3},{}]");
+  checkProjection(json,
+                  Projection(std::vector<std::string>{"/*/a", "/3"},
+                             Projection::Mode::Exclude),
+                  "[{\"b\":2},{},{\"b\":4}]");
+}
+
+TEST(ProjectionTest, ScalarsAreDumpedUnchanged) {
+  Projection projection(std::vector<std::string>{"a"});
+  Options options;
+  options.projection = &projection;
+
+  std::shared_ptr<Builder> b = Parser::fromJson("\"foo\"");
+  ASSERT_EQ("\"foo\"", Dumper::toString(b->slice(), &options));
+  b = Parser::fromJson("42");
+  ASSERT_EQ("42", Dumper::toString(b->slice(), &options));
+}
+
+TEST(ProjectionTest, CompiledPaths) {
+  std::vector<CompiledPath> paths;
+  paths.emplace_back(std::vector<std::string>{"address", "city"});
+  paths.emplace_back("$['name']");
+
+  checkProjection(document, Projection(paths),
+                  "{\"name\":\"test\",\"address\":{\"city\":\"Cologne\"}}");
+}
+
+TEST(ProjectionTest, Externals) {
+  std::shared_ptr<Builder> inner = Parser::fromJson("{\"a\":1,\"b\":2}");
+
+  Builder b;
+  b.openObject();
+  b.add("ext", Value(static_cast<void const*>(inner->slice().start()),
+                     ValueType::External));
+  b.add("c", Value(3));
+  b.close();
+
+  Projection projection(std::vector<std::string>{"ext.b"});
+  Options options;
+  options.projection = &projection;
+  ASSERT_EQ("{\"ext\":{\"b\":2}}", Dumper::toString(b.slice(), &options));
+}
+
+TEST(ProjectionTest, Append) {
+  std::shared_ptr<Builder> value = Parser::fromJson(document);
+  Projection projection(std::vector<std::string>{"count"});
+  Options options;
+  options.projection = &projection;
+
+  std::string result;
+  StringSink sink(&result);
+  Dumper dumper(&sink, &options);
+  dumper.append(value->slice());
+  dumper.appendString("x");
+  dumper.append(value->slice());
+
+  ASSERT_EQ("{\"count\":3}\"x\"{\"count\":3}", result);
+}
+
+TEST(ProjectionTest, ParallelDumper) {
+  Builder b;
+  b.openArray();
+  for (std::size_t i = 0; i < 1000; ++i) {
+    b.openObject();
+    b.add("_key", Value(std::to_string(i)));
+    b.add("value", Value(i));
+    b.add("payload", Value(std::string(i % 50, 'x')));
+    b.close();
+  }
+  b.close();
+
+  Projection projection(std::vector<std::string>{"$[*]._key"});
+  Options options;
+  options.projection = &projection;
+
+  ParallelDumper dumper(&options, 2, 1024);
+  ASSERT_EQ(Dumper::toString(b.slice(), &options),
+            dumper.toString(b.slice()));
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,267 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+static std::string describe(Slice const& key, Slice const& value) {
+  std::string result;
+  if (!key.isNone()) {
+    result.append(key.copyString());
+    result.push_back(':');
+  }
+  result.append(value.toJson());
+  return result;
+}
+
+TEST(TraversalTest, InvalidType) {
+  Builder b;
+  b.add(Value("foo"));
+
+  Traversal traversal;
+  ASSERT_VELOCYPACK_EXCEPTION(
+      traversal.visit(b.slice(), Traversal::ValueFirst,
+                      [](Slice const&, Slice const&, Traversal::Path const&) {
+                        return Traversal::Continue;
+                      }),
+      Exception::InvalidValueType);
+}
+
+TEST(TraversalTest, Empty) {
+  Traversal traversal;
+  std::size_t calls = 0;
+  auto counter = [&calls](Slice const&, Slice const&, Traversal::Path const&) {
+    ++calls;
+    return Traversal::Continue;
+  };
+
+  ASSERT_TRUE(traversal.visit(Slice::emptyArraySlice(), Traversal::ValueFirst, counter));
+  ASSERT_TRUE(traversal.visit(Slice::emptyObjectSlice(), Traversal::MembersFirst, counter));
+  ASSERT_EQ(0UL, calls);
+}
+
+TEST(TraversalTest, ValueFirst) {
+  std::shared_ptr<Builder> b = Parser::fromJson("{\"a\":1,\"b\":[2,{\"c\":3}],\"d\":4}");
+
+  std::vector<std::string> seen;
+  Traversal traversal;
+  ASSERT_TRUE(traversal.visit(b->slice(), Traversal::ValueFirst,
+      [&seen](Slice const& key, Slice const& value, Traversal::Path const&) {
+        seen.emplace_back(describe(key, value));
+        return Traversal::Continue;
+      }));
+
+  std::vector<std::string> expected{"a:1", "b:[2,{\"c\":3}]", "2", "{\"c\":3}", "c:3", "d:4"};
+  ASSERT_EQ(expected, seen);
+}
+
+TEST(TraversalTest, MembersFirst) {
+  std::shared_ptr<Builder> b = Parser::fromJson("{\"a\":1,\"b\":[2,{\"c\":3}],\"d\":4}");
+
+  std::vector<std::string> seen;
+  Traversal traversal;
+  ASSERT_TRUE(traversal.visit(b->slice(), Traversal::MembersFirst,
+      [&seen](Slice const& key, Slice const& value, Traversal::Path const&) {
+        seen.emplace_back(describe(key, value));
+        return Traversal::Continue;
+      }));
+
+  std::vector<std::string> expected{"a:1", "2", "c:3", "{\"c\":3}", "b:[2,{\"c\":3}]", "d:4"};
+  ASSERT_EQ(expected, seen);
+}
+
+TEST(TraversalTest, Path) {
+  std::shared_ptr<Builder> b = Parser::fromJson("{\"a\":1,\"b\":[2,{\"c\":3}],\"d\":4}");
+
+  for (auto order : {Traversal::ValueFirst, Traversal::MembersFirst}) {
+    bool found = false;
+    Traversal traversal;
+    traversal.visit(b->slice(), order,
+        [&found](Slice const& key, Slice const& value, Traversal::Path const& path) {
+          if (value.isNumber() && value.getNumber<int>() == 3) {
+            found = true;
+            EXPECT_EQ(3UL, path.size());
+            EXPECT_EQ("b", path[0].key.copyString());
+            EXPECT_EQ(1UL, path[0].index);
+            EXPECT_TRUE(path[1].key.isNone());
+            EXPECT_EQ(1UL, path[1].index);
+            EXPECT_EQ("c", path[2].key.copyString());
+            EXPECT_EQ(0UL, path[2].index);
+            EXPECT_TRUE(key.isEqualString("c"));
+          } else if (value.isNumber() && value.getNumber<int>() == 4) {
+            EXPECT_EQ(1UL, path.size());
+            EXPECT_EQ("d", path[0].key.copyString());
+            EXPECT_EQ(2UL, path[0].index);
+          }
+          return Traversal::Continue;
+        });
+    ASSERT_TRUE(found);
+  }
+}
+
+TEST(TraversalTest, Skip) {
+  std::shared_ptr<Builder> b = Parser::fromJson("{\"a\":{\"secret\":[1,2,3]},\"b\":{\"x\":[4]},\"c\":5}");
+
+  std::vector<std::string> seen;
+  Traversal traversal;
+  ASSERT_TRUE(traversal.visit(b->slice(), Traversal::ValueFirst,
+      [&seen](Slice const& key, Slice const& value, Traversal::Path const&) {
+        seen.emplace_back(describe(key, value));
+        if (key.isString() && key.isEqualString("a")) {
+          return Traversal::Skip;
+        }
+        return Traversal::Continue;
+      }));
+
+  std::vector<std::string> expected{"a:{\"secret\":[1,2,3]}", "b:{\"x\":[4]}", "x:[4]", "4", "c:5"};
+  ASSERT_EQ(expected, seen);
+
+  // Skip has no effect when members are visited first
+  seen.clear();
+  ASSERT_TRUE(traversal.visit(b->slice(), Traversal::MembersFirst,
+      [&seen](Slice const& key, Slice const& value, Traversal::Path const&) {
+        seen.emplace_back(describe(key, value));
+        return Traversal::Skip;
+      }));
+  ASSERT_EQ(9UL, seen.size());
+}
+
+TEST(TraversalTest, Stop) {
+  std::shared_ptr<Builder> b = Parser::fromJson("[[1,[2,3]],[4],5]");
+
+  for (auto order : {Traversal::ValueFirst, Traversal::MembersFirst}) {
+    std::vector<std::string> seen;
+    Traversal traversal;
+    ASSERT_FALSE(traversal.visit(b->slice(), order,
+        [&seen](Slice const& key, Slice const& value, Traversal::Path const&) {
+          seen.emplace_back(describe(key, value));
+          if (value.isNumber() && value.getNumber<int>() == 2) {
+            return Traversal::Stop;
+          }
+          return Traversal::Continue;
+        }));
+
+    if (order == Traversal::ValueFirst) {
+      std::vector<std::string> expected{"[1,[2,3]]", "1", "[2,3]", "2"};
+      ASSERT_EQ(expected, seen);
+    } else {
+      std::vector<std::string> expected{"1", "2"};
+      ASSERT_EQ(expected, seen);
+    }
+  }
+}
+
+TEST(TraversalTest, CompactValues) {
+  Options options;
+  options.buildUnindexedArrays = true;
+  options.buildUnindexedObjects = true;
+  std::shared_ptr<Builder> b = Parser::fromJson("{\"a\":[1,{\"b\":2}],\"c\":{\"d\":3}}", &options);
+  ASSERT_EQ(0x14, b->slice().head());
+
+  std::vector<std::string> seen;
+  Traversal traversal;
+  ASSERT_TRUE(traversal.visit(b->slice(), Traversal::ValueFirst,
+      [&seen](Slice const& key, Slice const& value, Traversal::Path const& path) {
+        seen.emplace_back(describe(key, value) + "@" + std::to_string(path.size()));
+        return Traversal::Continue;
+      }));
+
+  std::vector<std::string> expected{"a:[1,{\"b\":2}]@1", "1@2", "{\"b\":2}@2",
+                                    "b:2@3", "c:{\"d\":3}@1", "d:3@2"};
+  ASSERT_EQ(expected, seen);
+}
+
+TEST(TraversalTest, DeepNesting) {
+  // deep enough to overflow the native stack with a recursive traversal
+  std::size_t const depth = 200000;
+
+  Builder b;
+  for (std::size_t i = 0; i < depth; ++i) {
+    b.openArray();
+  }
+  b.add(Value(42));
+  for (std::size_t i = 0; i < depth; ++i) {
+    b.close();
+  }
+
+  for (auto order : {Traversal::ValueFirst, Traversal::MembersFirst}) {
+    std::size_t calls = 0;
+    std::size_t maxDepth = 0;
+    Traversal traversal;
+    ASSERT_TRUE(traversal.visit(b.slice(), order,
+        [&](Slice const&, Slice const& value, Traversal::Path const& path) {
+          ++calls;
+          if (path.size() > maxDepth) {
+            maxDepth = path.size();
+          }
+          if (value.isInteger()) {
+            EXPECT_EQ(42, value.getInt());
+          }
+          return Traversal::Continue;
+        }));
+    ASSERT_EQ(depth, calls);
+    ASSERT_EQ(depth, maxDepth);
+  }
+
+  std::size_t calls = 0;
+  Collection::visitRecursive(b.slice(), Collection::PreOrder,
+      [&calls](Slice const&, Slice const&) {
+        ++calls;
+        return true;
+      });
+  ASSERT_EQ(depth, calls);
+}
+
+TEST(TraversalTest, Reuse) {
+  std::shared_ptr<Builder> b1 = Parser::fromJson("[[1,[2,[3]]],4]");
+  std::shared_ptr<Builder> b2 = Parser::fromJson("{\"a\":{\"b\":true},\"c\":null}");
+
+  Traversal traversal;
+  std::vector<std::string> seen;
+  auto collect = [&seen](Slice const& key, Slice const& value, Traversal::Path const&) {
+    seen.emplace_back(describe(key, value));
+    return value.isNumber() && value.getNumber<int>() == 2 ? Traversal::Stop : Traversal::Continue;
+  };
+
+  // aborted traversal first, then a complete one with the same instance
+  ASSERT_FALSE(traversal.visit(b1->slice(), Traversal::ValueFirst, collect));
+  seen.clear();
+  ASSERT_TRUE(traversal.visit(b2->slice(), Traversal::ValueFirst, collect));
+  std::vector<std::string> expected{"a:{\"b\":true}", "b:true", "c:null"};
+  ASSERT_EQ(expected, seen);
+
+  seen.clear();
+  ASSERT_TRUE(traversal.visit(b2->slice(), Traversal::MembersFirst, collect));
+  expected = {"b:true", "a:{\"b\":true}", "c:null"};
+  ASSERT_EQ(expected, seen);
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,205 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+template <typename V>
+static std::vector<std::string> collect(V const& view) {
+  std::vector<std::string> result;
+  view.forEach([&result](Slice const& value) {
+    result.emplace_back(value.toJson());
+    return true;
+  });
+  return result;
+}
+
+static bool isEven(Slice const& value) {
+  return value.getNumber<int>() % 2 == 0;
+}
+
+TEST(ViewTest, InvalidType) {
+  Builder b;
+  b.add(Value("foo"));
+
+  ASSERT_VELOCYPACK_EXCEPTION(ArrayView(b.slice()), Exception::InvalidValueType);
+  ASSERT_VELOCYPACK_EXCEPTION(ObjectValuesView(b.slice()), Exception::InvalidValueType);
+  ASSERT_VELOCYPACK_EXCEPTION(ArrayView(Slice::emptyObjectSlice()), Exception::InvalidValueType);
+  ASSERT_VELOCYPACK_EXCEPTION(ObjectValuesView(Slice::emptyArraySlice()), Exception::InvalidValueType);
+}
+
+TEST(ViewTest, EmptyArray) {
+  ArrayView view(Slice::emptyArraySlice());
+  ASSERT_TRUE(view.empty());
+  ASSERT_EQ(0UL, view.length());
+  ASSERT_TRUE(collect(view).empty());
+  ASSERT_TRUE(collect(view.range(3, 2)).empty());
+  ASSERT_EQ("[]", view.toBuilder().slice().toJson());
+}
+
+TEST(ViewTest, ArrayTypes) {
+  std::string const json("[1,2,\"three\",[4],{\"five\":5},6.5]");
+  std::vector<std::string> const expected{"1", "2", "\"three\"", "[4]", "{\"five\":5}", "6.5"};
+
+  Options options;
+  for (bool compact : {false, true}) {
+    options.buildUnindexedArrays = compact;
+    std::shared_ptr<Builder> b = Parser::fromJson(json, &options);
+    ASSERT_EQ(compact, b->slice().head() == 0x13);
+
+    ArrayView view(b->slice());
+    ASSERT_EQ(6UL, view.length());
+    ASSERT_FALSE(view.empty());
+    ASSERT_EQ(expected, collect(view));
+
+    std::vector<std::string> tail{"[4]", "{\"five\":5}", "6.5"};
+    ASSERT_EQ(tail, collect(view.range(3)));
+    std::vector<std::string> middle{"\"three\"", "[4]"};
+    ASSERT_EQ(middle, collect(view.range(2, 2)));
+    ASSERT_EQ(2UL, view.range(2, 2).length());
+    ASSERT_EQ(0UL, view.range(10, 2).length());
+    ASSERT_EQ(0UL, view.range(2, 0).length());
+    // ranges of ranges
+    std::vector<std::string> inner{"[4]"};
+    ASSERT_EQ(inner, collect(view.range(1, 4).range(2, 1)));
+  }
+}
+
+TEST(ViewTest, EqualSizeArray) {
+  Builder b;
+  b.openArray();
+  for (int i = 0; i < 100; ++i) {
+    b.add(Value(i % 10));
+  }
+  b.close();
+  ASSERT_TRUE(b.slice().head() >= 0x02 && b.slice().head() <= 0x05);
+
+  ArrayView view(b.slice());
+  ASSERT_EQ(100UL, view.length());
+  ASSERT_EQ(50UL, view.filter(isEven).length());
+  std::vector<std::string> expected{"7", "8", "9", "0"};
+  ASSERT_EQ(expected, collect(view.range(97, 4).concat(view.range(0, 1))));
+}
+
+TEST(ViewTest, ObjectValues) {
+  std::shared_ptr<Builder> b = Parser::fromJson("{\"b\":2,\"a\":1,\"c\":{\"d\":3}}");
+
+  ObjectValuesView view(b->slice());
+  ASSERT_EQ(3UL, view.length());
+  ASSERT_FALSE(view.empty());
+  ASSERT_EQ(Collection::values(b->slice()).slice().toJson(), view.toBuilder().slice().toJson());
+
+  ObjectValuesView emptyView(Slice::emptyObjectSlice());
+  ASSERT_TRUE(emptyView.empty());
+  ASSERT_EQ(0UL, emptyView.length());
+}
+
+TEST(ViewTest, FilterAndMap) {
+  std::shared_ptr<Builder> b = Parser::fromJson(
+      "[{\"name\":\"a\",\"age\":20},{\"name\":\"b\",\"age\":35},"
+      "{\"name\":\"c\",\"age\":41},{\"name\":\"d\",\"age\":17}]");
+
+  auto names = ArrayView(b->slice())
+                   .filter([](Slice const& value) { return value.get("age").getNumber<int>() >= 18; })
+                   .map([](Slice const& value) { return value.get("name"); });
+
+  std::vector<std::string> expected{"\"a\"", "\"b\"", "\"c\""};
+  ASSERT_EQ(expected, collect(names));
+  ASSERT_EQ(3UL, names.length());
+  ASSERT_FALSE(names.empty());
+  ASSERT_EQ("[\"a\",\"b\",\"c\"]", names.toBuilder().slice().toJson());
+
+  // mapped values point into the original data
+  names.forEach([&b](Slice const& value) {
+    EXPECT_TRUE(value.start() > b->slice().start());
+    EXPECT_TRUE(value.start() < b->slice().start() + b->slice().byteSize());
+    return true;
+  });
+
+  auto none = names.filter([](Slice const&) { return false; });
+  ASSERT_TRUE(none.empty());
+  ASSERT_EQ(0UL, none.length());
+  ASSERT_EQ("[]", none.toBuilder().slice().toJson());
+}
+
+TEST(ViewTest, RangeOverFilter) {
+  Builder b;
+  b.openArray();
+  for (int i = 0; i < 20; ++i) {
+    b.add(Value(i));
+  }
+  b.close();
+
+  auto evens = ArrayView(b.slice()).filter(isEven);
+  std::vector<std::string> expected{"4", "6", "8"};
+  ASSERT_EQ(expected, collect(evens.range(2, 3)));
+  ASSERT_EQ(3UL, evens.range(2, 3).length());
+  ASSERT_EQ(2UL, evens.range(8).length());
+  ASSERT_TRUE(evens.range(10).empty());
+
+  // a range that is exhausted is not reported as aborted
+  ASSERT_TRUE(evens.range(0, 1).forEach([](Slice const&) { return true; }));
+  ASSERT_FALSE(evens.range(0, 2).forEach([](Slice const&) { return false; }));
+}
+
+TEST(ViewTest, Concat) {
+  std::shared_ptr<Builder> a = Parser::fromJson("[1,2,3]");
+  std::shared_ptr<Builder> o = Parser::fromJson("{\"x\":4,\"y\":5}");
+
+  auto view = ArrayView(a->slice()).concat(ObjectValuesView(o->slice())).concat(ArrayView(Slice::emptyArraySlice()));
+  ASSERT_EQ(5UL, view.length());
+  ASSERT_EQ("[1,2,3,4,5]", view.toBuilder().slice().toJson());
+  ASSERT_EQ(2UL, view.filter(isEven).length());
+
+  std::vector<std::string> expected{"3", "4"};
+  ASSERT_EQ(expected, collect(view.range(2, 2)));
+
+  // early termination inside the first part does not visit the second
+  std::size_t calls = 0;
+  ASSERT_FALSE(view.forEach([&calls](Slice const&) { return ++calls < 2; }));
+  ASSERT_EQ(2UL, calls);
+}
+
+TEST(ViewTest, ToExistingBuilder) {
+  std::shared_ptr<Builder> a = Parser::fromJson("[1,2,3,4]");
+
+  Builder b;
+  b.openObject();
+  b.add(Value("evens"));
+  ArrayView(a->slice()).filter(isEven).toBuilder(b);
+  b.add(Value("odds"));
+  ArrayView(a->slice()).filter([](Slice const& value) { return !isEven(value); }).toBuilder(b);
+  b.close();
+
+  ASSERT_EQ("{\"evens\":[2,4],\"odds\":[1,3]}", b.slice().toJson());
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
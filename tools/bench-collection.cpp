@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "velocypack/vpack.h"
+
+using namespace arangodb::velocypack;
+
+static void usage(char* argv[]) {
+  std::cout << "Usage: " << argv[0] << " [MEMBERS] [RUNS]" << std::endl;
+  std::cout << "This program measures the per-member overhead of the Collection"
+            << std::endl;
+  std::cout << "algorithms when called with a std::function and with a lambda,"
+            << std::endl;
+  std::cout << "on an Array with MEMBERS numbers (default: 1000000). Each"
+            << std::endl;
+  std::cout << "measurement is repeated RUNS times (default: 20)." << std::endl;
+}
+
+// runs the callback the specified number of times and prints the time
+// spent per Array member
+template <typename F>
+static void measure(char const* name, ValueLength members, int runs, F&& callback) {
+  uint64_t result = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < runs; ++i) {
+    result += callback();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+
+  std::chrono::duration<double, std::nano> total = end - start;
+  std::cout << "  " << name;
+  for (std::size_t i = std::strlen(name); i < 32; ++i) {
+    std::cout << ' ';
+  }
+  std::cout << total.count() / static_cast<double>(members * runs)
+            << " ns/member (result " << result << ")" << std::endl;
+}
+
+static void run(Slice array, int runs) {
+  ValueLength const n = array.length();
+
+  Collection::Predicate const isOdd = [](Slice const& value, ValueLength) {
+    return (value.getUInt() & 1) == 1;
+  };
+  Collection::Predicate const isSmall = [](Slice const& value, ValueLength) {
+    return value.getUInt() < UINT64_MAX;
+  };
+
+  measure("forEach std::function", n, runs, [&]() {
+    uint64_t sum = 0;
+    Collection::Predicate const f = [&sum](Slice const& value, ValueLength) {
+      sum += value.getUInt();
+      return true;
+    };
+    Collection::forEach(array, f);
+    return sum;
+  });
+  measure("forEach lambda", n, runs, [&]() {
+    uint64_t sum = 0;
+    Collection::forEach(array, [&sum](Slice const& value, ValueLength) {
+      sum += value.getUInt();
+      return true;
+    });
+    return sum;
+  });
+
+  measure("filter std::function", n, runs, [&]() {
+    return Collection::filter(array, isOdd).slice().length();
+  });
+  measure("filter lambda", n, runs, [&]() {
+    return Collection::filter(array, [](Slice const& value, ValueLength) {
+      return (value.getUInt() & 1) == 1;
+    }).slice().length();
+  });
+
+  measure("all std::function", n, runs, [&]() {
+    return static_cast<uint64_t>(Collection::all(array, isSmall));
+  });
+  measure("all lambda", n, runs, [&]() {
+    return static_cast<uint64_t>(Collection::all(array, [](Slice const& value, ValueLength) {
+      return value.getUInt() < UINT64_MAX;
+    }));
+  });
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 3 || (argc > 1 && (::strcmp(argv[1], "--help") == 0 ||
+                                ::strcmp(argv[1], "-h") == 0))) {
+    usage(argv);
+    return EXIT_FAILURE;
+  }
+
+  ValueLength members = 1000000;
+  int runs = 20;
+  if (argc > 1) {
+    members = std::stoull(argv[1]);
+  }
+  if (argc > 2) {
+    runs = std::stoi(argv[2]);
+  }
+
+  try {
+    for (bool compact : { false, true }) {
+      Options options;
+      options.buildUnindexedArrays = compact;
+
+      Builder b(&options);
+      b.openArray();
+      for (ValueLength i = 0; i < members; ++i) {
+        b.add(Value(i));
+      }
+      b.close();
+
+      std::cout << (compact ? "compact" : "indexed") << " Array with "
+                << members << " members:" << std::endl;
+      run(b.slice(), runs);
+    }
+  } catch (Exception const& ex) {
+    std::cerr << "An exception occurred while running bench: " << ex.what()
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
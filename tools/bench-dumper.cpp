@@ -0,0 +1,259 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "velocypack/vpack.h"
+
+using namespace arangodb::velocypack;
+
+static void usage(char* argv[]) {
+  std::cout << "Usage: " << argv[0] << " RUNS [FILE...]" << std::endl;
+  std::cout << "This program measures the throughput of converting VPack into"
+            << std::endl;
+  std::cout << "JSON with the Dumper. Each JSON input FILE is parsed into VPack"
+            << std::endl;
+  std::cout << "once and then dumped RUNS times (default: 1000). The default"
+            << std::endl;
+  std::cout << "input files are countries.json and api-docs.json from the"
+            << std::endl;
+  std::cout << "tests/jsonSample directory. Each file is also dumped with the"
+            << std::endl;
+  std::cout << "ParallelDumper, using one thread per hardware thread and"
+            << std::endl;
+  std::cout << "64 KB chunks. Writing the compact output to /dev/null is"
+            << std::endl;
+  std::cout << "measured with an std::ofstream and with a FileDescriptorSink."
+            << std::endl;
+}
+
+// a Sink that forwards to a StringSink and counts the calls made to it
+struct CountingSink final : public Sink {
+  explicit CountingSink(std::string* buffer) : sink(buffer), calls(0) {}
+
+  void push_back(char c) override final {
+    ++calls;
+    sink.push_back(c);
+  }
+
+  void append(std::string const& p) override final {
+    ++calls;
+    sink.append(p);
+  }
+
+  void append(char const* p) override final {
+    ++calls;
+    sink.append(p);
+  }
+
+  void append(char const* p, ValueLength len) override final {
+    ++calls;
+    sink.append(p, len);
+  }
+
+  void reserve(ValueLength len) override final { sink.reserve(len); }
+
+  StringSink sink;
+  uint64_t calls;
+};
+
+static std::string readFile(std::string const& filename) {
+  std::ifstream ifs(filename, std::ifstream::in | std::ifstream::binary);
+  if (!ifs.is_open()) {
+    throw std::runtime_error("cannot open input file '" + filename + "'");
+  }
+  std::ostringstream s;
+  s << ifs.rdbuf();
+  return s.str();
+}
+
+// dumps the slice the specified number of times with the callback and
+// prints the throughput
+template <typename F>
+static void measure(char const* name, int runs, F&& callback) {
+  std::string output;
+  uint64_t calls = 0;
+  std::size_t total = 0;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < runs; ++i) {
+    output.clear();
+    CountingSink sink(&output);
+    callback(&sink);
+    calls += sink.calls;
+    total += output.size();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+
+  std::chrono::duration<double> duration = end - start;
+  std::cout << "  " << name;
+  for (std::size_t i = std::strlen(name); i < 18; ++i) {
+    std::cout << ' ';
+  }
+  std::cout << (total / duration.count()) / (1024.0 * 1024.0) << " MB/s, "
+            << (duration.count() * 1000000.0 / runs) << " us/dump, "
+            << (calls / static_cast<uint64_t>(runs)) << " sink calls/dump"
+            << std::endl;
+}
+
+#ifndef _WIN32
+// dumps the slice into /dev/null the specified number of times, creating
+// the sink for each run with the callback, and prints the throughput
+template <typename F>
+static void measureFile(char const* name, int runs, Slice const& slice,
+                        ValueLength length, F&& callback) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < runs; ++i) {
+    callback([&](Sink* sink) {
+      Dumper dumper(sink);
+      dumper.dump(slice);
+    });
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+
+  std::chrono::duration<double> duration = end - start;
+  std::cout << "  " << name;
+  for (std::size_t i = std::strlen(name); i < 18; ++i) {
+    std::cout << ' ';
+  }
+  std::cout << (length * runs / duration.count()) / (1024.0 * 1024.0)
+            << " MB/s, " << (duration.count() * 1000000.0 / runs)
+            << " us/dump" << std::endl;
+}
+#endif
+
+static void run(std::string const& filename, int runs) {
+  std::string const json = readFile(filename);
+  std::shared_ptr<Builder> b = Parser::fromJson(json);
+  Slice const slice = b->slice();
+
+  std::cout << filename << " (" << slice.byteSize() << " bytes of VPack):"
+            << std::endl;
+
+  for (bool pretty : { false, true }) {
+    Options options;
+    options.prettyPrint = pretty;
+
+    measure(pretty ? "pretty" : "compact", runs, [&](Sink* sink) {
+      Dumper dumper(sink, &options);
+      dumper.dump(slice);
+    });
+
+    ParallelDumper parallel(&options, 0, 64 * 1024);
+    measure(pretty ? "parallel pretty" : "parallel compact", runs,
+            [&](Sink* sink) { parallel.dump(slice, sink); });
+
+    // the sizing pass, reported as the throughput of the output it sizes
+    ValueLength length = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < runs; ++i) {
+      length = Dumper::outputLength(slice, &options);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << "  " << (pretty ? "pretty length   " : "compact length  ")
+              << "  " << (length * runs / duration.count()) / (1024.0 * 1024.0)
+              << " MB/s, " << (duration.count() * 1000000.0 / runs)
+              << " us/call, " << length << " bytes" << std::endl;
+  }
+
+#ifndef _WIN32
+  ValueLength const length = Dumper::outputLength(slice);
+
+  measureFile("ofstream", runs, slice, length,
+              [](std::function<void(Sink*)> const& dump) {
+    std::ofstream ofs("/dev/null", std::ofstream::out | std::ofstream::binary);
+    OutputFileStreamSink sink(&ofs);
+    dump(&sink);
+  });
+
+  int fd = ::open("/dev/null", O_WRONLY);
+  if (fd == -1) {
+    throw std::runtime_error("cannot open /dev/null");
+  }
+  for (bool background : { false, true }) {
+    measureFile(background ? "fd background" : "fd", runs, slice, length,
+                [fd, background](std::function<void(Sink*)> const& dump) {
+      FileDescriptorSink sink(fd, FileDescriptorSink::defaultBufferSize,
+                              background);
+      dump(&sink);
+      sink.flush();
+    });
+  }
+  ::close(fd);
+#endif
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1 && (::strcmp(argv[1], "--help") == 0 ||
+                   ::strcmp(argv[1], "-h") == 0)) {
+    usage(argv);
+    return EXIT_FAILURE;
+  }
+
+  int runs = 1000;
+  if (argc > 1) {
+    runs = std::stoi(argv[1]);
+  }
+
+  std::vector<std::string> files;
+  for (int i = 2; i < argc; ++i) {
+    files.emplace_back(argv[i]);
+  }
+  if (files.empty()) {
+    files.emplace_back("tests/jsonSample/countries.json");
+    files.emplace_back("tests/jsonSample/api-docs.json");
+  }
+
+  try {
+    for (auto const& filename : files) {
+      run(filename, runs);
+    }
+  } catch (Exception const& ex) {
+    std::cerr << "An exception occurred while running bench: " << ex.what()
+              << std::endl;
+    return EXIT_FAILURE;
+  } catch (std::exception const& ex) {
+    std::cerr << "An exception occurred while running bench: " << ex.what()
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
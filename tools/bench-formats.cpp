@@ -0,0 +1,284 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "velocypack/vpack.h"
+
+using namespace arangodb::velocypack;
+
+static void usage(char* argv[]) {
+  std::cout << "Usage: " << argv[0] << " RUNS [FILE...]" << std::endl;
+  std::cout << "       " << argv[0] << " --sizes [FILE...]" << std::endl;
+  std::cout << "This program compares converting VPack into other formats and"
+            << std::endl;
+  std::cout << "back. Each JSON input FILE is parsed into VPack once, and is"
+            << std::endl;
+  std::cout << "then encoded into each format and decoded into VPack again"
+            << std::endl;
+  std::cout << "RUNS times (default: 100). The throughput is reported relative"
+            << std::endl;
+  std::cout << "to the VPack size. By default, the files from the"
+            << std::endl;
+  std::cout << "tests/jsonSample directory listed in Performance.md are used."
+            << std::endl;
+  std::cout << "With --sizes, the size comparison table from Performance.md is"
+            << std::endl;
+  std::cout << "printed instead." << std::endl;
+}
+
+// a format VPack can be converted into and back
+struct Format {
+  char const* name;
+  std::function<void(Slice const&, std::string&)> encode;
+  std::function<void(std::string const&, Builder&)> decode;
+};
+
+static std::vector<Format> formats() {
+  std::vector<Format> result;
+
+  result.push_back(Format{
+      "JSON",
+      [](Slice const& slice, std::string& output) {
+        StringSink sink(&output);
+        Dumper::dump(slice, &sink);
+      },
+      [](std::string const& input, Builder& builder) {
+        Parser parser(builder);
+        parser.parse(input);
+      }});
+
+  result.push_back(Format{
+      "MessagePack",
+      [](Slice const& slice, std::string& output) {
+        StringSink sink(&output);
+        MessagePackDumper::dump(slice, &sink);
+      },
+      [](std::string const& input, Builder& builder) {
+        MessagePackParser parser(builder);
+        parser.parse(input);
+      }});
+
+  result.push_back(Format{
+      "BSON",
+      [](Slice const& slice, std::string& output) {
+        StringSink sink(&output);
+        BsonDumper::dump(slice, &sink);
+      },
+      [](std::string const& input, Builder& builder) {
+        BsonParser parser(builder);
+        parser.parse(input);
+      }});
+
+  return result;
+}
+
+static std::string readFile(std::string const& filename) {
+  std::ifstream ifs(filename, std::ifstream::in | std::ifstream::binary);
+  if (!ifs.is_open()) {
+    throw std::runtime_error("cannot open input file '" + filename + "'");
+  }
+  std::ostringstream s;
+  s << ifs.rdbuf();
+  return s.str();
+}
+
+template <typename F>
+static double measure(int runs, F&& callback) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < runs; ++i) {
+    callback();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> duration = end - start;
+  return duration.count();
+}
+
+static void run(std::string const& filename, int runs,
+                std::vector<Format> const& formats) {
+  std::shared_ptr<Builder> b = Parser::fromJson(readFile(filename));
+  Slice const slice = b->slice();
+  double const megabytes = slice.byteSize() * runs / (1024.0 * 1024.0);
+
+  std::cout << filename << " (" << slice.byteSize() << " bytes of VPack):"
+            << std::endl;
+
+  for (auto const& format : formats) {
+    std::string encoded;
+    try {
+      format.encode(slice, encoded);
+    } catch (Exception const& ex) {
+      // e.g. BSON cannot store all values
+      std::cout << "  " << std::left << std::setw(12) << format.name
+                << std::right << "n/a: " << ex.what() << std::endl;
+      continue;
+    }
+
+    double const encodeTime = measure(runs, [&]() {
+      encoded.clear();
+      format.encode(slice, encoded);
+    });
+
+    Builder decoded;
+    double const decodeTime = measure(runs, [&]() {
+      decoded.clear();
+      format.decode(encoded, decoded);
+    });
+
+    std::cout << "  " << std::left << std::setw(12) << format.name
+              << std::right << std::setw(10) << encoded.size() << " bytes, "
+              << "encode " << std::setw(8) << std::fixed
+              << std::setprecision(1) << (megabytes / encodeTime)
+              << " MB/s, decode " << std::setw(8)
+              << (megabytes / decodeTime) << " MB/s, round trip "
+              << std::setw(9) << ((encodeTime + decodeTime) * 1000000.0 / runs)
+              << " us" << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+  }
+}
+
+// formats a byte size with thousands separators
+static std::string formatSize(std::size_t value) {
+  std::string result = std::to_string(value);
+  for (std::size_t i = result.size(); i > 3; i -= 3) {
+    result.insert(i - 3, 1, ',');
+  }
+  return result;
+}
+
+// prints the size comparison table from Performance.md
+static void printSizes(std::vector<std::string> const& files,
+                       std::vector<Format> const& formats) {
+  Options compactOptions;
+  compactOptions.buildUnindexedArrays = true;
+  compactOptions.buildUnindexedObjects = true;
+
+  std::cout << std::left << std::setw(18) << "test case" << std::right
+            << std::setw(13) << "original JSON" << std::setw(12) << "net JSON"
+            << std::setw(12) << "MsgPack" << std::setw(12) << "BSON"
+            << std::setw(12) << "VPack" << std::setw(12) << "VPack-c"
+            << std::endl;
+  std::cout << std::string(18 + 13 + 5 * 12, '-') << std::endl;
+
+  auto encodedSize = [&formats](char const* name, Slice const& slice) {
+    for (auto const& format : formats) {
+      if (::strcmp(format.name, name) == 0) {
+        std::string encoded;
+        try {
+          format.encode(slice, encoded);
+        } catch (Exception const&) {
+          return std::string("n/a");
+        }
+        return formatSize(encoded.size());
+      }
+    }
+    return std::string("n/a");
+  };
+
+  for (auto const& filename : files) {
+    std::string const json = readFile(filename);
+    std::shared_ptr<Builder> b = Parser::fromJson(json);
+    std::shared_ptr<Builder> compact = Parser::fromJson(json, &compactOptions);
+    Slice const slice = b->slice();
+
+    std::string name = filename;
+    std::size_t const pos = name.find_last_of("/\\");
+    if (pos != std::string::npos) {
+      name = name.substr(pos + 1);
+    }
+
+    std::cout << std::left << std::setw(18) << name << std::right
+              << std::setw(13) << formatSize(json.size()) << std::setw(12)
+              << encodedSize("JSON", slice) << std::setw(12)
+              << encodedSize("MessagePack", slice) << std::setw(12)
+              << encodedSize("BSON", slice) << std::setw(12)
+              << formatSize(slice.byteSize()) << std::setw(12)
+              << formatSize(compact->slice().byteSize()) << std::endl;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1 && (::strcmp(argv[1], "--help") == 0 ||
+                   ::strcmp(argv[1], "-h") == 0)) {
+    usage(argv);
+    return EXIT_FAILURE;
+  }
+
+  bool sizes = false;
+  int runs = 100;
+  if (argc > 1) {
+    if (::strcmp(argv[1], "--sizes") == 0) {
+      sizes = true;
+    } else {
+      runs = std::stoi(argv[1]);
+    }
+  }
+
+  std::vector<std::string> files;
+  for (int i = 2; i < argc; ++i) {
+    files.emplace_back(argv[i]);
+  }
+  if (files.empty()) {
+    for (char const* name :
+         {"api-docs.json", "commits.json", "countries.json",
+          "directory-tree.json", "doubles.json", "doubles-small.json",
+          "file-list.json", "object.json", "pass1.json", "pass2.json",
+          "pass3.json", "random1.json", "random2.json", "random3.json",
+          "sample.json", "small.json"}) {
+      files.emplace_back(std::string("tests/jsonSample/") + name);
+    }
+  }
+
+  try {
+    std::vector<Format> const all = formats();
+    if (sizes) {
+      printSizes(files, all);
+      return EXIT_SUCCESS;
+    }
+    for (auto const& filename : files) {
+      run(filename, runs, all);
+    }
+  } catch (Exception const& ex) {
+    std::cerr << "An exception occurred while running bench: " << ex.what()
+              << std::endl;
+    return EXIT_FAILURE;
+  } catch (std::exception const& ex) {
+    std::cerr << "An exception occurred while running bench: " << ex.what()
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -24,10 +24,17 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <cstdio>
 #include <iostream>
 #include <string>
 #include <fstream>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "velocypack/vpack.h"
 #include "velocypack/velocypack-exception-macros.h"
 
@@ -199,45 +206,105 @@ int main(int argc, char* argv[]) {
   options.unsupportedTypeBehavior = 
     (printUnsupported ? Options::ConvertUnsupportedType : Options::FailOnUnsupportedType);
 
-  Buffer<char> buffer(4096);
-  CharBufferSink sink(&buffer);
+  // the JSON is written into a temporary file next to the outfile, which
+  // replaces the outfile only if the conversion succeeds
+#ifdef _WIN32
+  std::string const tempName = std::string(outfileName) + ".tmp";
+  std::ofstream ofs(tempName, std::ofstream::out | std::ofstream::binary);
+
+  if (!ofs.is_open()) {
+    std::cerr << "Cannot write outfile '" << outfileName << "'" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  OutputFileStreamSink sink(&ofs);
+#else
+  // special files such as /dev/null or pipes are written to directly
+  struct stat st;
+  bool const useTempFile =
+      !toStdOut && (::stat(outfileName, &st) != 0 || S_ISREG(st.st_mode));
+
+  // write the JSON directly into the file while it is generated
+  int fd = STDOUT_FILENO;
+  std::string tempName;
+  if (useTempFile) {
+    tempName = std::string(outfileName) + ".XXXXXX";
+    fd = ::mkstemp(&tempName[0]);
+    if (fd != -1) {
+      // mkstemp creates the file with mode 0600
+      mode_t const mask = ::umask(0);
+      ::umask(mask);
+      ::fchmod(fd, 0666 & ~mask);
+    }
+  } else if (!toStdOut) {
+    fd = ::open(outfileName, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  }
+
+  if (fd == -1) {
+    std::cerr << "Cannot write outfile '" << outfileName << "'" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  FileDescriptorSink sink(fd, FileDescriptorSink::defaultBufferSize, true);
+#endif
   Dumper dumper(&sink, &options);
 
+  auto removeTempFile = [&]() {
+#ifdef _WIN32
+    // open files cannot be removed on Windows
+    ofs.close();
+#endif
+    if (!tempName.empty()) {
+      std::remove(tempName.c_str());
+    }
+  };
+
   try {
     dumper.dump(slice);
+#ifndef _WIN32
+    sink.flush();
+#endif
   } catch (Exception const& ex) {
+    removeTempFile();
     std::cerr << "An exception occurred while processing infile '" << infile
               << "': " << ex.what() << std::endl;
     return EXIT_FAILURE;
   } catch (...) {
+    removeTempFile();
     std::cerr << "An unknown exception occurred while processing infile '"
               << infile << "'" << std::endl;
     return EXIT_FAILURE;
   }
 
-  std::ofstream ofs(outfileName, std::ofstream::out);
-
-  if (!ofs.is_open()) {
+#ifdef _WIN32
+  ValueLength const outputSize = static_cast<ValueLength>(ofs.tellp());
+  ofs.close();
+  // rename does not replace existing files on Windows
+  std::remove(outfileName);
+  if (ofs.fail() || std::rename(tempName.c_str(), outfileName) != 0) {
+    removeTempFile();
     std::cerr << "Cannot write outfile '" << outfileName << "'" << std::endl;
     return EXIT_FAILURE;
   }
-
-  // reset stream
-  if (!toStdOut) {
-    ofs.seekp(0);
+#else
+  ValueLength const outputSize = sink.length();
+  if (!toStdOut && ::close(fd) != 0) {
+    removeTempFile();
+    std::cerr << "Cannot write outfile '" << outfileName << "'" << std::endl;
+    return EXIT_FAILURE;
   }
-
-  // write into stream
-  char const* start = buffer.data();
-  ofs.write(start, buffer.size());
-
-  ofs.close();
+  if (useTempFile && std::rename(tempName.c_str(), outfileName) != 0) {
+    removeTempFile();
+    std::cerr << "Cannot write outfile '" << outfileName << "'" << std::endl;
+    return EXIT_FAILURE;
+  }
+#endif
 
   if (!toStdOut) {
     std::cout << "Successfully converted JSON infile '" << infile << "'"
               << std::endl;
     std::cout << "VPack Infile size: " << s.size() << std::endl;
-    std::cout << "JSON Outfile size: " << buffer.size() << std::endl;
+    std::cout << "JSON Outfile size: " << outputSize << std::endl;
   }
   
   VELOCYPACK_GLOBAL_EXCEPTION_CATCH